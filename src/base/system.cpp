@@ -40,6 +40,7 @@
 #include <netinet/in.h>
 #include <pthread.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
 
 #include <dirent.h>
@@ -110,6 +111,17 @@ void net_buffer_init(NETSOCKET_BUFFER *buffer);
 void net_buffer_reinit(NETSOCKET_BUFFER *buffer);
 void net_buffer_simple(NETSOCKET_BUFFER *buffer, char **buf, int *size);
 
+#ifdef CONF_PLATFORM_LINUX
+typedef struct
+{
+	int num;
+	struct mmsghdr msgs[VLEN];
+	struct iovec iovecs[VLEN];
+	char bufs[VLEN][PACKETSIZE];
+	struct sockaddr_in6 sockaddrs[VLEN];
+} NETSOCKET_SENDQUEUE;
+#endif
+
 struct NETSOCKET_INTERNAL
 {
 	int type;
@@ -118,6 +130,12 @@ struct NETSOCKET_INTERNAL
 	int web_ipv4sock;
 
 	NETSOCKET_BUFFER buffer;
+
+#ifdef CONF_PLATFORM_LINUX
+	bool batching;
+	NETSOCKET_SENDQUEUE *ipv4queue;
+	NETSOCKET_SENDQUEUE *ipv6queue;
+#endif
 };
 static NETSOCKET_INTERNAL invalid_socket = {NETTYPE_INVALID, -1, -1, -1};
 
@@ -440,6 +458,56 @@ int io_error(IOHANDLE io)
 	return ferror((FILE *)io);
 }
 
+void *io_map(IOHANDLE io, size_t size)
+{
+#if defined(CONF_FAMILY_WINDOWS)
+	HANDLE mapping = CreateFileMappingW((HANDLE)_get_osfhandle(_fileno((FILE *)io)), nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	if(mapping == nullptr)
+	{
+		return nullptr;
+	}
+	// the view keeps the mapping object alive
+	void *data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, size);
+	CloseHandle(mapping);
+	return data;
+#else
+	void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno((FILE *)io), 0);
+	return data == MAP_FAILED ? nullptr : data;
+#endif
+}
+
+void io_unmap(void *data, size_t size)
+{
+#if defined(CONF_FAMILY_WINDOWS)
+	UnmapViewOfFile(data);
+#else
+	munmap(data, size);
+#endif
+}
+
+void io_map_release(void *data, size_t size)
+{
+#if defined(CONF_FAMILY_WINDOWS)
+	SYSTEM_INFO system_info;
+	GetSystemInfo(&system_info);
+	const uintptr_t page_size = system_info.dwPageSize;
+#else
+	const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+#endif
+	const uintptr_t start = ((uintptr_t)data + page_size - 1) / page_size * page_size;
+	const uintptr_t end = ((uintptr_t)data + size) / page_size * page_size;
+	if(start >= end)
+	{
+		return;
+	}
+#if defined(CONF_FAMILY_WINDOWS)
+	// unlocking pages that are not locked removes them from the working set
+	VirtualUnlock((void *)start, end - start);
+#else
+	madvise((void *)start, end - start, MADV_DONTNEED);
+#endif
+}
+
 IOHANDLE io_stdin()
 {
 	return stdin;
@@ -502,6 +570,9 @@ struct ASYNCIO
 	SEMAPHORE sphore;
 	void *thread;
 
+	ASYNCIO_FILTER filter;
+	void *filter_user;
+
 	unsigned char *buffer;
 	unsigned int buffer_size;
 	unsigned int read_pos;
@@ -509,6 +580,7 @@ struct ASYNCIO
 
 	int error;
 	unsigned char finish;
+	unsigned char flush;
 	unsigned char refcount;
 };
 
@@ -575,6 +647,17 @@ static void aio_thread(void *user)
 		{
 			if(aio->finish != ASYNCIO_RUNNING)
 			{
+				if(aio->filter)
+				{
+					// nothing is queued after finishing, so don't block the other threads while filtering
+					aio->lock.unlock();
+					const int result_filter_error = aio->filter(aio->io, nullptr, 0, aio->filter_user);
+					aio->lock.lock();
+					if(result_filter_error)
+					{
+						aio->error = result_filter_error;
+					}
+				}
 				if(aio->finish == ASYNCIO_CLOSE)
 				{
 					io_close(aio->io);
@@ -582,6 +665,21 @@ static void aio_thread(void *user)
 				aio_handle_free_and_unlock(aio);
 				break;
 			}
+			if(aio->flush)
+			{
+				aio->flush = 0;
+				if(aio->filter)
+				{
+					aio->lock.unlock();
+					const int result_filter_error = aio->filter(aio->io, nullptr, 0, aio->filter_user);
+					aio->lock.lock();
+					if(result_filter_error)
+					{
+						aio->error = result_filter_error;
+					}
+				}
+				continue;
+			}
 			aio->lock.unlock();
 			sphore_wait(&aio->sphore);
 			aio->lock.lock();
@@ -610,16 +708,31 @@ static void aio_thread(void *user)
 		aio->read_pos = (aio->read_pos + buffers.len1 + buffers.len2) % aio->buffer_size;
 		aio->lock.unlock();
 
-		io_write(aio->io, local_buffer, local_buffer_len);
-		io_flush(aio->io);
-		result_io_error = io_error(aio->io);
+		if(aio->filter)
+		{
+			result_io_error = aio->filter(aio->io, local_buffer, local_buffer_len, aio->filter_user);
+		}
+		else
+		{
+			io_write(aio->io, local_buffer, local_buffer_len);
+			io_flush(aio->io);
+			result_io_error = io_error(aio->io);
+		}
 
 		aio->lock.lock();
-		aio->error = result_io_error;
+		if(result_io_error)
+		{
+			aio->error = result_io_error;
+		}
 	}
 }
 
 ASYNCIO *aio_new(IOHANDLE io)
+{
+	return aio_new_filtered(io, nullptr, nullptr);
+}
+
+ASYNCIO *aio_new_filtered(IOHANDLE io, ASYNCIO_FILTER filter, void *user)
 {
 	ASYNCIO *aio = new ASYNCIO;
 	if(!aio)
@@ -629,6 +742,8 @@ ASYNCIO *aio_new(IOHANDLE io)
 	aio->io = io;
 	sphore_init(&aio->sphore);
 	aio->thread = nullptr;
+	aio->filter = filter;
+	aio->filter_user = user;
 
 	aio->buffer = (unsigned char *)malloc(ASYNC_BUFSIZE);
 	if(!aio->buffer)
@@ -642,6 +757,7 @@ ASYNCIO *aio_new(IOHANDLE io)
 	aio->write_pos = 0;
 	aio->error = 0;
 	aio->finish = ASYNCIO_RUNNING;
+	aio->flush = 0;
 	aio->refcount = 2;
 
 	aio->thread = thread_init(aio_thread, aio, "aio");
@@ -766,6 +882,15 @@ int aio_error(ASYNCIO *aio)
 	return aio->error;
 }
 
+void aio_flush(ASYNCIO *aio)
+{
+	{
+		CLockScope ls(aio->lock);
+		aio->flush = 1;
+	}
+	sphore_signal(&aio->sphore);
+}
+
 void aio_close(ASYNCIO *aio)
 {
 	{
@@ -1470,6 +1595,12 @@ static void priv_net_close_socket(int sock)
 
 static int priv_net_close_all_sockets(NETSOCKET sock)
 {
+#if defined(CONF_PLATFORM_LINUX)
+	net_udp_set_batching(sock, false);
+	free(sock->ipv4queue);
+	free(sock->ipv6queue);
+#endif
+
 	/* close down ipv4 */
 	if(sock->ipv4sock >= 0)
 	{
@@ -1674,6 +1805,70 @@ NETSOCKET net_udp_create(NETADDR bindaddr)
 	return sock;
 }
 
+#if defined(CONF_PLATFORM_LINUX)
+static void priv_net_udp_flush_queue(int socket, NETSOCKET_SENDQUEUE *queue)
+{
+	if(!queue || queue->num == 0)
+		return;
+
+	int sent = 0;
+	while(sent < queue->num)
+	{
+		int result = sendmmsg(socket, queue->msgs + sent, queue->num - sent, 0);
+		if(result < 0)
+		{
+			// like with sendto, packets that can't be sent right now are dropped
+			if(net_would_block())
+				break;
+			// any other error only concerns the first message, e.g. an unreachable peer
+			if(errno != EINTR)
+				sent++;
+			continue;
+		}
+		if(result == 0)
+			break;
+		sent += result;
+	}
+	queue->num = 0;
+}
+
+static int priv_net_udp_sendto(NETSOCKET sock, int socket, NETSOCKET_SENDQUEUE **queue, const void *sa, socklen_t salen, const void *data, int size)
+{
+	if(!sock->batching || size > PACKETSIZE)
+	{
+		// keep packets to the same peer in order
+		priv_net_udp_flush_queue(socket, *queue);
+		return sendto(socket, (const char *)data, size, 0, (const struct sockaddr *)sa, salen);
+	}
+
+	if(!*queue)
+	{
+		*queue = (NETSOCKET_SENDQUEUE *)malloc(sizeof(NETSOCKET_SENDQUEUE));
+		(*queue)->num = 0;
+		for(int i = 0; i < VLEN; ++i)
+		{
+			(*queue)->iovecs[i].iov_base = (*queue)->bufs[i];
+			mem_zero(&(*queue)->msgs[i], sizeof((*queue)->msgs[i]));
+			(*queue)->msgs[i].msg_hdr.msg_iov = &(*queue)->iovecs[i];
+			(*queue)->msgs[i].msg_hdr.msg_iovlen = 1;
+			(*queue)->msgs[i].msg_hdr.msg_name = &(*queue)->sockaddrs[i];
+		}
+	}
+	else if((*queue)->num == VLEN)
+	{
+		priv_net_udp_flush_queue(socket, *queue);
+	}
+
+	NETSOCKET_SENDQUEUE *q = *queue;
+	mem_copy(q->bufs[q->num], data, size);
+	q->iovecs[q->num].iov_len = size;
+	mem_copy(&q->sockaddrs[q->num], sa, salen);
+	q->msgs[q->num].msg_hdr.msg_namelen = salen;
+	q->num++;
+	return size;
+}
+#endif
+
 int net_udp_send(NETSOCKET sock, const NETADDR *addr, const void *data, int size)
 {
 	int d = -1;
@@ -1693,7 +1888,11 @@ int net_udp_send(NETSOCKET sock, const NETADDR *addr, const void *data, int size
 			else
 				netaddr_to_sockaddr_in(addr, &sa);
 
+#if defined(CONF_PLATFORM_LINUX)
+			d = priv_net_udp_sendto(sock, sock->ipv4sock, &sock->ipv4queue, &sa, sizeof(sa), data, size);
+#else
 			d = sendto((int)sock->ipv4sock, (const char *)data, size, 0, (struct sockaddr *)&sa, sizeof(sa));
+#endif
 		}
 		else
 		{
@@ -1733,7 +1932,11 @@ int net_udp_send(NETSOCKET sock, const NETADDR *addr, const void *data, int size
 			else
 				netaddr_to_sockaddr_in6(addr, &sa);
 
+#if defined(CONF_PLATFORM_LINUX)
+			d = priv_net_udp_sendto(sock, sock->ipv6sock, &sock->ipv6queue, &sa, sizeof(sa), data, size);
+#else
 			d = sendto((int)sock->ipv6sock, (const char *)data, size, 0, (struct sockaddr *)&sa, sizeof(sa));
+#endif
 		}
 		else
 			log_error("net", "Cannot send IPv6 traffic to this socket");
@@ -1744,6 +1947,25 @@ int net_udp_send(NETSOCKET sock, const NETADDR *addr, const void *data, int size
 	return d;
 }
 
+void net_udp_set_batching(NETSOCKET sock, bool batching)
+{
+#if defined(CONF_PLATFORM_LINUX)
+	if(!batching)
+		net_udp_flush(sock);
+	sock->batching = batching;
+#endif
+}
+
+void net_udp_flush(NETSOCKET sock)
+{
+#if defined(CONF_PLATFORM_LINUX)
+	if(sock->ipv4sock >= 0)
+		priv_net_udp_flush_queue(sock->ipv4sock, sock->ipv4queue);
+	if(sock->ipv6sock >= 0)
+		priv_net_udp_flush_queue(sock->ipv6sock, sock->ipv6queue);
+#endif
+}
+
 void net_buffer_init(NETSOCKET_BUFFER *buffer)
 {
 #if defined(CONF_PLATFORM_LINUX)
@@ -458,6 +458,49 @@ int io_sync(IOHANDLE io);
  */
 int io_error(IOHANDLE io);
 
+/**
+ * Maps the start of a file into memory.
+ *
+ * @ingroup File-IO
+ *
+ * @param io Handle to the file, must be opened for reading.
+ * @param size Number of bytes to map, must be greater than zero and not larger than the file.
+ *
+ * @return Pointer to the mapped memory, or `nullptr` if the file could not be mapped.
+ *
+ * @remark The mapping is copy-on-write, changes to the memory are never written to the file.
+ * @remark The mapping stays valid after the file has been closed.
+ * @remark The file must not be truncated or overwritten in place while it is mapped, accessing
+ * pages past its new end raises `SIGBUS` on POSIX systems. Replacing the file by renaming
+ * another one over it is safe.
+ *
+ * @see io_unmap
+ */
+void *io_map(IOHANDLE io, size_t size);
+
+/**
+ * Unmaps memory that was mapped with @link io_map @endlink.
+ *
+ * @ingroup File-IO
+ *
+ * @param data Pointer returned by @link io_map @endlink.
+ * @param size Number of bytes that were mapped.
+ */
+void io_unmap(void *data, size_t size);
+
+/**
+ * Allows the operating system to reclaim the physical memory of a
+ * range of mapped memory. Only whole pages inside the range are released.
+ *
+ * @ingroup File-IO
+ *
+ * @param data Start of the range inside memory mapped with @link io_map @endlink.
+ * @param size Size of the range in bytes.
+ *
+ * @remark The range must not have been written to, released pages are read from the file again when they are accessed.
+ */
+void io_map_release(void *data, size_t size);
+
 /**
  * Returns a handle for the standard input.
  *
@@ -518,6 +561,39 @@ typedef struct ASYNCIO ASYNCIO;
  */
 ASYNCIO *aio_new(IOHANDLE io);
 
+/**
+ * Function that processes the queued data on the writer thread of an
+ * `ASYNCIO` instead of it being written to the file directly. It is
+ * also called with `buffer` set to `nullptr` and `size` set to `0` after
+ * @link aio_flush @endlink and before the file is closed, so the data it
+ * holds back can be written.
+ *
+ * @ingroup File-IO
+ *
+ * @param io Handle to the file.
+ * @param buffer Pointer to the queued data.
+ * @param size Number of queued bytes.
+ * @param user Pointer passed to @link aio_new_filtered @endlink.
+ *
+ * @return `0` on success, or non-`0` on error.
+ */
+typedef int (*ASYNCIO_FILTER)(IOHANDLE io, const void *buffer, unsigned size, void *user);
+
+/**
+ * Wraps a @link IOHANDLE @endlink for asynchronous writing, passing the
+ * data through a filter on the writer thread.
+ *
+ * @ingroup File-IO
+ *
+ * @param io Handle to the file.
+ * @param filter Function writing the data to the file.
+ * @param user Pointer passed to the filter, must stay valid until
+ * @link aio_wait @endlink returned.
+ *
+ * @return The handle for asynchronous writing.
+ */
+ASYNCIO *aio_new_filtered(IOHANDLE io, ASYNCIO_FILTER filter, void *user);
+
 /**
  * Locks the `ASYNCIO` structure so it can't be written into by
  * other threads.
@@ -595,6 +671,17 @@ void aio_write_newline_unlocked(ASYNCIO *aio);
  */
 int aio_error(ASYNCIO *aio);
 
+/**
+ * Queues passing the data held back by the filter to the file, see
+ * @link ASYNCIO_FILTER @endlink. Unfiltered data is written without
+ * delay anyway.
+ *
+ * @ingroup File-IO
+ *
+ * @param aio Handle to the file.
+ */
+void aio_flush(ASYNCIO *aio);
+
 /**
  * Queues file closing.
  *
@@ -1038,6 +1125,32 @@ NETSOCKET net_udp_create(NETADDR bindaddr);
  */
 int net_udp_send(NETSOCKET sock, const NETADDR *addr, const void *data, int size);
 
+/**
+ * Enables or disables send batching on an UDP socket. While enabled,
+ * packets passed to @link net_udp_send @endlink are queued and sent
+ * together with as few system calls as possible once the queue is full or
+ * @link net_udp_flush @endlink is called. Disabling batching flushes the
+ * queue.
+ *
+ * @ingroup Network-UDP
+ *
+ * @param sock Socket to use.
+ * @param batching Whether to queue outgoing packets.
+ *
+ * @remark Only has an effect on Linux, other platforms always send directly.
+ * @remark Only use this on sockets that are sent on from a single thread.
+ */
+void net_udp_set_batching(NETSOCKET sock, bool batching);
+
+/**
+ * Sends all packets queued on an UDP socket with batching enabled.
+ *
+ * @ingroup Network-UDP
+ *
+ * @param sock Socket to use.
+ */
+void net_udp_flush(NETSOCKET sock);
+
 /**
  * Receives a packet over an UDP socket.
  *
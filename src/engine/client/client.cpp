@@ -487,6 +487,7 @@ void CClient::OnEnterGame(bool Dummy)
 	// reset snapshots
 	m_aapSnapshots[Dummy][SNAP_CURRENT] = nullptr;
 	m_aapSnapshots[Dummy][SNAP_PREV] = nullptr;
+	InvalidateSnapIndices(Dummy);
 	m_aSnapshotStorage[Dummy].PurgeAll();
 	m_aReceivedSnapshots[Dummy] = 0;
 	m_aSnapshotParts[Dummy] = 0;
@@ -732,6 +733,7 @@ void CClient::DisconnectWithReason(const char *pReason)
 	// clear snapshots
 	m_aapSnapshots[0][SNAP_CURRENT] = nullptr;
 	m_aapSnapshots[0][SNAP_PREV] = nullptr;
+	InvalidateSnapIndices(0);
 	m_aReceivedSnapshots[0] = 0;
 	m_LastDummy = false;
 
@@ -819,6 +821,7 @@ void CClient::DummyDisconnect(const char *pReason)
 	m_aRconAuthed[1] = 0;
 	m_aapSnapshots[1][SNAP_CURRENT] = nullptr;
 	m_aapSnapshots[1][SNAP_PREV] = nullptr;
+	InvalidateSnapIndices(1);
 	m_aReceivedSnapshots[1] = 0;
 	m_DummyConnected = false;
 	m_DummyConnecting = false;
@@ -850,13 +853,28 @@ void CClient::LoadDebugFont()
 
 // ---
 
+const CSnapshotIndex &CClient::SnapIndex(int SnapId) const
+{
+	const CSnapshot *pSnapshot = m_aapSnapshots[g_Config.m_ClDummy][SnapId]->m_pAltSnap;
+	CSnapshotIndex &Index = m_aaSnapshotIndices[g_Config.m_ClDummy][SnapId];
+	if(Index.Snapshot() != pSnapshot)
+		Index.Build(pSnapshot);
+	return Index;
+}
+
+void CClient::InvalidateSnapIndices(int Conn)
+{
+	for(CSnapshotIndex &Index : m_aaSnapshotIndices[Conn])
+		Index.Reset();
+}
+
 IClient::CSnapItem CClient::SnapGetItem(int SnapId, int Index) const
 {
 	dbg_assert(SnapId >= 0 && SnapId < NUM_SNAPSHOT_TYPES, "invalid SnapId");
 	const CSnapshot *pSnapshot = m_aapSnapshots[g_Config.m_ClDummy][SnapId]->m_pAltSnap;
 	const CSnapshotItem *pSnapshotItem = pSnapshot->GetItem(Index);
 	CSnapItem Item;
-	Item.m_Type = pSnapshot->GetItemType(Index);
+	Item.m_Type = SnapIndex(SnapId).GetItemType(Index);
 	Item.m_Id = pSnapshotItem->Id();
 	Item.m_pData = pSnapshotItem->Data();
 	Item.m_DataSize = pSnapshot->GetItemSize(Index);
@@ -868,7 +886,7 @@ const void *CClient::SnapFindItem(int SnapId, int Type, int Id) const
 	if(!m_aapSnapshots[g_Config.m_ClDummy][SnapId])
 		return nullptr;
 
-	return m_aapSnapshots[g_Config.m_ClDummy][SnapId]->m_pAltSnap->FindItem(Type, Id);
+	return SnapIndex(SnapId).FindItem(Type, Id);
 }
 
 int CClient::SnapNumItems(int SnapId) const
@@ -923,6 +941,10 @@ void CClient::RenderDebug()
 	str_format(aBuffer, sizeof(aBuffer), "Frametime: %4d us", round_to_int(m_FrameTimeAverage * 1000000.0f));
 	Graphics()->QuadsText(20.0f * FontSize, 2 + FontSize, FontSize, aBuffer);
 
+	const CSnapshotStorage &SnapshotStorage = m_aSnapshotStorage[g_Config.m_ClDummy];
+	str_format(aBuffer, sizeof(aBuffer), "Snapshot allocs: %" PRIu64 " arena, %" PRIu64 " heap (%" PRIzu " KiB arena)", SnapshotStorage.NumArenaAllocations(), SnapshotStorage.NumHeapAllocations(), SnapshotStorage.ArenaSize() / 1024);
+	Graphics()->QuadsText(2, 2 + 2 * FontSize, FontSize, aBuffer);
+
 	str_format(aBuffer, sizeof(aBuffer), "%16s: %" PRIu64 " KiB", "Texture memory", Graphics()->TextureMemoryUsage() / 1024);
 	Graphics()->QuadsText(32.0f * FontSize, 2, FontSize, aBuffer);
 
@@ -980,7 +1002,7 @@ void CClient::RenderDebug()
 		{
 			if(m_SnapshotDelta.GetDataRate(i) && m_aapSnapshots[g_Config.m_ClDummy][IClient::SNAP_CURRENT])
 			{
-				const int Type = m_aapSnapshots[g_Config.m_ClDummy][IClient::SNAP_CURRENT]->m_pAltSnap->GetExternalItemType(i);
+				const int Type = SnapIndex(IClient::SNAP_CURRENT).GetExternalItemType(i);
 				if(Type == UUID_INVALID)
 				{
 					str_format(
@@ -1110,7 +1132,10 @@ const char *CClient::LoadMap(const char *pName, const char *pFilename, SHA256_DI
 	if((bool)m_LoadingCallback)
 		m_LoadingCallback(IClient::LOADING_CALLBACK_DETAIL_MAP);
 
-	if(!m_pMap->Load(pFilename))
+	// downloaded maps are named by their hash and only ever replaced by renaming a new
+	// download into place, so they can be mapped. Maps in other folders may be overwritten.
+	const bool AllowMapping = str_startswith(pFilename, "downloadedmaps/") != nullptr;
+	if(!m_pMap->Load(pFilename, AllowMapping))
 	{
 		str_format(s_aErrorMsg, sizeof(s_aErrorMsg), "map '%s' not found", pFilename);
 		return s_aErrorMsg;
@@ -2155,6 +2180,7 @@ void CClient::ProcessServerPacket(CNetChunk *pPacket, int Conn, bool Dummy)
 						m_aGameTime[Conn].Init((GameTick - 1) * time_freq() / GameTickSpeed());
 						m_aapSnapshots[Conn][SNAP_PREV] = m_aSnapshotStorage[Conn].m_pFirst;
 						m_aapSnapshots[Conn][SNAP_CURRENT] = m_aSnapshotStorage[Conn].m_pLast;
+						InvalidateSnapIndices(Conn);
 						m_aPrevGameTick[Conn] = m_aapSnapshots[Conn][SNAP_PREV]->m_Tick;
 						m_aCurGameTick[Conn] = m_aapSnapshots[Conn][SNAP_CURRENT]->m_Tick;
 						if(Conn == CONN_MAIN)
@@ -2672,6 +2698,7 @@ void CClient::OnDemoPlayerSnapshot(void *pData, int Size)
 	std::swap(m_aapSnapshots[0][SNAP_PREV], m_aapSnapshots[0][SNAP_CURRENT]);
 	mem_copy(m_aapSnapshots[0][SNAP_CURRENT]->m_pSnap, pData, Size);
 	mem_copy(m_aapSnapshots[0][SNAP_CURRENT]->m_pAltSnap, pAltSnapBuffer, AltSnapSize);
+	InvalidateSnapIndices(0);
 
 	GameClient()->OnNewSnapshot();
 }
@@ -2771,6 +2798,7 @@ void CClient::Update()
 
 				m_aapSnapshots[!g_Config.m_ClDummy][SNAP_PREV] = m_aapSnapshots[!g_Config.m_ClDummy][SNAP_CURRENT];
 				m_aapSnapshots[!g_Config.m_ClDummy][SNAP_CURRENT] = m_aapSnapshots[!g_Config.m_ClDummy][SNAP_CURRENT]->m_pNext;
+				InvalidateSnapIndices(!g_Config.m_ClDummy);
 
 				// set ticks
 				m_aCurGameTick[!g_Config.m_ClDummy] = m_aapSnapshots[!g_Config.m_ClDummy][SNAP_CURRENT]->m_Tick;
@@ -2802,6 +2830,7 @@ void CClient::Update()
 
 				m_aapSnapshots[g_Config.m_ClDummy][SNAP_PREV] = m_aapSnapshots[g_Config.m_ClDummy][SNAP_CURRENT];
 				m_aapSnapshots[g_Config.m_ClDummy][SNAP_CURRENT] = m_aapSnapshots[g_Config.m_ClDummy][SNAP_CURRENT]->m_pNext;
+				InvalidateSnapIndices(g_Config.m_ClDummy);
 
 				// set ticks
 				m_aCurGameTick[g_Config.m_ClDummy] = m_aapSnapshots[g_Config.m_ClDummy][SNAP_CURRENT]->m_Tick;
@@ -3931,6 +3960,7 @@ const char *CClient::DemoPlayer_Play(const char *pFilename, int StorageType)
 
 	// try to start playback
 	m_DemoPlayer.SetListener(this);
+	m_DemoPlayer.SetUseIndex(g_Config.m_ClDemoIndex);
 	if(m_DemoPlayer.Load(Storage(), m_pConsole, pFilename, StorageType))
 	{
 		DisconnectWithReason(m_DemoPlayer.ErrorMessage());
@@ -3984,6 +4014,7 @@ const char *CClient::DemoPlayer_Play(const char *pFilename, int StorageType)
 		m_aapSnapshots[0][SnapshotType]->m_AltSnapSize = 0;
 		m_aapSnapshots[0][SnapshotType]->m_Tick = -1;
 	}
+	InvalidateSnapIndices(0);
 
 	m_DemoPlayer.Play();
 	GameClient()->OnEnterGame();
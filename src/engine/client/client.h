@@ -203,6 +203,8 @@ class CClient : public IClient, public CDemoPlayer::IListener
 	// the game snapshots are modifiable by the game
 	CSnapshotStorage m_aSnapshotStorage[NUM_DUMMIES];
 	CSnapshotStorage::CHolder *m_aapSnapshots[NUM_DUMMIES][NUM_SNAPSHOT_TYPES];
+	// lazily built item lookup tables for m_aapSnapshots
+	mutable CSnapshotIndex m_aaSnapshotIndices[NUM_DUMMIES][NUM_SNAPSHOT_TYPES];
 
 	int m_aReceivedSnapshots[NUM_DUMMIES] = {0, 0};
 	char m_aaSnapshotIncomingData[NUM_DUMMIES][CSnapshot::MAX_SIZE];
@@ -361,6 +363,8 @@ public:
 	int GetPredictionTick() override;
 	const void *SnapFindItem(int SnapId, int Type, int Id) const override;
 	int SnapNumItems(int SnapId) const override;
+	const CSnapshotIndex &SnapIndex(int SnapId) const;
+	void InvalidateSnapIndices(int Conn);
 	void SnapSetStaticsize(int ItemType, int Size) override;
 	void SnapSetStaticsize7(int ItemType, int Size) override;
 
@@ -0,0 +1,40 @@
+#include "glyph_cache.h"
+
+#include <base/math.h>
+#include <base/system.h>
+
+bool ReadGlyphCache(const void *pData, size_t DataSize, const SHA256_DIGEST &FontKey, int NumFaces, std::vector<SCachedGlyph> &vGlyphs)
+{
+	const unsigned char *pCurrent = static_cast<const unsigned char *>(pData);
+	const unsigned char *pEnd = pCurrent + DataSize;
+	SGlyphCacheHeader Header;
+	if(DataSize < sizeof(Header))
+		return false;
+	mem_copy(&Header, pCurrent, sizeof(Header));
+	pCurrent += sizeof(Header);
+	if(mem_comp(Header.m_aMagic, SGlyphCacheHeader::MAGIC, sizeof(Header.m_aMagic)) != 0 || Header.m_Version != SGlyphCacheHeader::VERSION || Header.m_FontKey != FontKey)
+		return false;
+
+	// the count comes from disk, don't reserve more glyphs than the file can hold
+	const int NumGlyphs = minimum<size_t>(maximum(Header.m_NumGlyphs, 0), (DataSize - sizeof(Header)) / sizeof(SGlyphCacheEntry));
+	vGlyphs.reserve(vGlyphs.size() + NumGlyphs);
+	for(int i = 0; i < NumGlyphs; i++)
+	{
+		SGlyphCacheEntry Entry;
+		if((size_t)(pEnd - pCurrent) < sizeof(Entry))
+			break;
+		mem_copy(&Entry, pCurrent, sizeof(Entry));
+		pCurrent += sizeof(Entry);
+		const size_t GlyphDataSize = (size_t)Entry.m_Width * Entry.m_Height;
+		if(Entry.m_FaceIndex < 0 || Entry.m_FaceIndex >= NumFaces || (size_t)(pEnd - pCurrent) < GlyphDataSize * 2)
+			break;
+
+		SCachedGlyph &Glyph = vGlyphs.emplace_back();
+		Glyph.m_Entry = Entry;
+		Glyph.m_vFill.assign(pCurrent, pCurrent + GlyphDataSize);
+		pCurrent += GlyphDataSize;
+		Glyph.m_vOutline.assign(pCurrent, pCurrent + GlyphDataSize);
+		pCurrent += GlyphDataSize;
+	}
+	return true;
+}
@@ -0,0 +1,65 @@
+#ifndef ENGINE_CLIENT_GLYPH_CACHE_H
+#define ENGINE_CLIENT_GLYPH_CACHE_H
+
+#include <base/hash.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Layout of the glyph cache file, which stores rendered glyphs between
+ * sessions. Entries are followed by the fill and outline bitmaps.
+ */
+struct SGlyphCacheHeader
+{
+	static constexpr const char MAGIC[8] = "DDGLYPH";
+	static constexpr int VERSION = 1;
+
+	char m_aMagic[8];
+	int32_t m_Version;
+	SHA256_DIGEST m_FontKey;
+	int32_t m_NumGlyphs;
+};
+
+struct SGlyphCacheEntry
+{
+	int32_t m_FaceIndex;
+	int32_t m_Chr;
+	int32_t m_FontSize;
+	uint32_t m_GlyphIndex;
+	uint16_t m_Width;
+	uint16_t m_Height;
+	uint16_t m_CharWidth;
+	uint16_t m_CharHeight;
+	float m_OffsetX;
+	float m_OffsetY;
+	float m_AdvanceX;
+};
+
+/**
+ * A glyph read from the glyph cache file.
+ */
+struct SCachedGlyph
+{
+	SGlyphCacheEntry m_Entry;
+	std::vector<uint8_t> m_vFill;
+	std::vector<uint8_t> m_vOutline;
+};
+
+/**
+ * Reads the glyphs from the contents of a glyph cache file.
+ *
+ * @param pData Contents of the file.
+ * @param DataSize Size of the contents in bytes.
+ * @param FontKey Key of the loaded font faces.
+ * @param NumFaces Number of loaded font faces.
+ * @param vGlyphs Receives the glyphs. Reading stops at the first truncated
+ *        entry or entry of an unknown face, the glyphs before it are kept.
+ *
+ * @return `false` if the file is too short for the header or was written
+ *         with another format version or other font faces.
+ */
+bool ReadGlyphCache(const void *pData, size_t DataSize, const SHA256_DIGEST &FontKey, int NumFaces, std::vector<SCachedGlyph> &vGlyphs);
+
+#endif // ENGINE_CLIENT_GLYPH_CACHE_H
@@ -29,40 +29,16 @@
 #include <engine/http.h>
 #include <engine/storage.h>
 
-class CSortWrap
-{
-	typedef bool (CServerBrowser::*SortFunc)(int, int) const;
-	SortFunc m_pfnSort;
-	CServerBrowser *m_pThis;
-
-public:
-	CSortWrap(CServerBrowser *pServer, SortFunc Func) :
-		m_pfnSort(Func), m_pThis(pServer) {}
-	bool operator()(int a, int b) { return (g_Config.m_BrSortOrder ? (m_pThis->*m_pfnSort)(b, a) : (m_pThis->*m_pfnSort)(a, b)); }
-};
-
-bool matchesPart(const char *a, const char *b)
-{
-	return str_utf8_find_nocase(a, b) != nullptr;
-}
-
-bool matchesExactly(const char *a, const char *b)
-{
-	return str_comp(a, &b[1]) == 0;
-}
-
 CServerBrowser::CServerBrowser() :
 	m_CommunityCache(this),
 	m_CountriesFilter(&m_CommunityCache),
 	m_TypesFilter(&m_CommunityCache)
 {
 	m_ppServerlist = nullptr;
-	m_pSortedServerlist = nullptr;
 
 	m_NeedResort = false;
 	m_Sorthash = 0;
 
-	m_NumSortedServersCapacity = 0;
 	m_NumServerCapacity = 0;
 
 	m_ServerlistType = 0;
@@ -75,7 +51,6 @@ CServerBrowser::CServerBrowser() :
 CServerBrowser::~CServerBrowser()
 {
 	free(m_ppServerlist);
-	free(m_pSortedServerlist);
 	json_value_free(m_pDDNetInfo);
 
 	delete m_pHttp;
@@ -319,9 +294,9 @@ int CServerBrowser::Max(const CServerInfo &Item) const
 
 const CServerInfo *CServerBrowser::SortedGet(int Index) const
 {
-	if(Index < 0 || Index >= m_NumSortedServers)
+	if(Index < 0 || Index >= (int)m_vSortedServerlist.size())
 		return nullptr;
-	return &m_ppServerlist[m_pSortedServerlist[Index]]->m_Info;
+	return &m_ppServerlist[m_vSortedServerlist[Index]]->m_Info;
 }
 
 int CServerBrowser::GenerateToken(const NETADDR &Addr) const
@@ -344,6 +319,39 @@ int CServerBrowser::GetExtraToken(int Token)
 	return Token >> 8;
 }
 
+CServerBrowser::FSortCompare CServerBrowser::SortCompareFunc() const
+{
+	if(g_Config.m_BrSortOrder == 2 && (g_Config.m_BrSort == IServerBrowser::SORT_NUMPLAYERS || g_Config.m_BrSort == IServerBrowser::SORT_PING))
+		return &CServerBrowser::SortCompareNumPlayersAndPing;
+	else if(g_Config.m_BrSort == IServerBrowser::SORT_NAME)
+		return &CServerBrowser::SortCompareName;
+	else if(g_Config.m_BrSort == IServerBrowser::SORT_PING)
+		return &CServerBrowser::SortComparePing;
+	else if(g_Config.m_BrSort == IServerBrowser::SORT_MAP)
+		return &CServerBrowser::SortCompareMap;
+	else if(g_Config.m_BrSort == IServerBrowser::SORT_NUMFRIENDS)
+		return &CServerBrowser::SortCompareNumFriends;
+	else if(g_Config.m_BrSort == IServerBrowser::SORT_NUMPLAYERS)
+		return &CServerBrowser::SortCompareNumPlayers;
+	else if(g_Config.m_BrSort == IServerBrowser::SORT_GAMETYPE)
+		return &CServerBrowser::SortCompareGametype;
+	return nullptr;
+}
+
+bool CServerBrowser::SortLess(FSortCompare pfnCompare, int Index1, int Index2) const
+{
+	if(pfnCompare != nullptr)
+	{
+		if(g_Config.m_BrSortOrder ? (this->*pfnCompare)(Index2, Index1) : (this->*pfnCompare)(Index1, Index2))
+			return true;
+		if(g_Config.m_BrSortOrder ? (this->*pfnCompare)(Index1, Index2) : (this->*pfnCompare)(Index2, Index1))
+			return false;
+	}
+	// equal servers keep the order of the server list, so merging changed
+	// servers into the sorted list gives the same order as sorting all of them
+	return Index1 < Index2;
+}
+
 bool CServerBrowser::SortCompareName(int Index1, int Index2) const
 {
 	CServerEntry *pIndex1 = m_ppServerlist[Index1];
@@ -412,184 +420,207 @@ bool CServerBrowser::SortCompareNumPlayersAndPing(int Index1, int Index2) const
 		return pIndex1->m_Info.m_Latency > pIndex2->m_Info.m_Latency;
 }
 
-void CServerBrowser::Filter()
+void CServerBrowser::ParseSearchTokens(const char *pSearch, std::vector<CSearchToken> &vTokens)
 {
-	m_NumSortedServers = 0;
-	m_NumSortedPlayers = 0;
-
-	// allocate the sorted list
-	if(m_NumSortedServersCapacity < m_NumServers)
+	vTokens.clear();
+	char aToken[256];
+	char aTokenTrimmed[256];
+	while((pSearch = str_next_token(pSearch, IServerBrowser::SEARCH_EXCLUDE_TOKEN, aToken, sizeof(aToken))))
 	{
-		free(m_pSortedServerlist);
-		m_NumSortedServersCapacity = m_NumServers;
-		m_pSortedServerlist = (int *)calloc(m_NumSortedServersCapacity, sizeof(int));
-	}
+		str_copy(aTokenTrimmed, str_utf8_skip_whitespaces(aToken));
+		str_utf8_trim_right(aTokenTrimmed);
 
-	// filter the servers
-	for(int i = 0; i < m_NumServers; i++)
-	{
-		CServerInfo &Info = m_ppServerlist[i]->m_Info;
-		bool Filtered = false;
+		if(aTokenTrimmed[0] == '\0')
+		{
+			continue;
+		}
 
-		if(g_Config.m_BrFilterEmpty && Info.m_NumFilteredPlayers == 0)
-			Filtered = true;
-		else if(g_Config.m_BrFilterFull && Players(Info) == Max(Info))
-			Filtered = true;
-		else if(g_Config.m_BrFilterPw && Info.m_Flags & SERVER_FLAG_PASSWORD)
-			Filtered = true;
-		else if(g_Config.m_BrFilterServerAddress[0] && !str_find_nocase(Info.m_aAddress, g_Config.m_BrFilterServerAddress))
-			Filtered = true;
-		else if(g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && str_comp_nocase(Info.m_aGameType, g_Config.m_BrFilterGametype))
-			Filtered = true;
-		else if(!g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && !str_utf8_find_nocase(Info.m_aGameType, g_Config.m_BrFilterGametype))
-			Filtered = true;
-		else if(g_Config.m_BrFilterUnfinishedMap && Info.m_HasRank == CServerInfo::RANK_RANKED)
-			Filtered = true;
-		else if(g_Config.m_BrFilterLogin && Info.m_RequiresLogin)
-			Filtered = true;
+		CSearchToken Token;
+		const int TokenLen = str_length(aTokenTrimmed);
+		Token.m_Exact = aTokenTrimmed[0] == '"' && aTokenTrimmed[TokenLen - 1] == '"';
+		if(Token.m_Exact)
+		{
+			aTokenTrimmed[TokenLen - 1] = '\0';
+			Token.m_Text = TokenLen > 1 ? &aTokenTrimmed[1] : "";
+		}
 		else
 		{
-			if(!Communities().empty())
+			Token.m_Text = aTokenTrimmed;
+		}
+		char aLower[sizeof(aTokenTrimmed) * 2];
+		str_utf8_tolower(Token.m_Text.c_str(), aLower, sizeof(aLower));
+		Token.m_LowerText = aLower;
+		vTokens.push_back(std::move(Token));
+	}
+}
+
+bool CServerBrowser::MatchesSearchToken(const CSearchToken &Token, const char *pStr, const std::string &LowerStr)
+{
+	// lowercase UTF-8 needles only match at code point boundaries, so a byte
+	// search is equivalent to str_utf8_find_nocase on the original strings
+	if(Token.m_Exact)
+		return str_comp(pStr, Token.m_Text.c_str()) == 0;
+	return str_find(LowerStr.c_str(), Token.m_LowerText.c_str()) != nullptr;
+}
+
+void CServerBrowser::UpdateSearchIndex(const CServerEntry *pEntry)
+{
+	const auto &&ToLower = [](const char *pStr, std::string &Lower) {
+		// lowercase code points need at most 1.5 times the bytes
+		char aLower[512];
+		str_utf8_tolower(pStr, aLower, minimum<size_t>(sizeof(aLower), str_length(pStr) * 2 + 1));
+		Lower = aLower;
+	};
+
+	const CServerInfo &Info = pEntry->m_Info;
+	if((int)m_vSearchIndex.size() <= Info.m_ServerIndex)
+		m_vSearchIndex.resize(Info.m_ServerIndex + 1);
+	CSearchIndex &Index = m_vSearchIndex[Info.m_ServerIndex];
+	ToLower(Info.m_aName, Index.m_Name);
+	ToLower(Info.m_aMap, Index.m_Map);
+	ToLower(Info.m_aGameType, Index.m_GameType);
+	const int NumClients = std::clamp(Info.m_NumClients, 0, (int)MAX_CLIENTS);
+	Index.m_vClientNames.resize(NumClients);
+	Index.m_vClientClans.resize(NumClients);
+	for(int p = 0; p < NumClients; p++)
+	{
+		ToLower(Info.m_aClients[p].m_aName, Index.m_vClientNames[p]);
+		ToLower(Info.m_aClients[p].m_aClan, Index.m_vClientClans[p]);
+	}
+}
+
+bool CServerBrowser::FilterServer(int ServerIndex)
+{
+	CServerInfo &Info = m_ppServerlist[ServerIndex]->m_Info;
+	const CSearchIndex &Index = m_vSearchIndex[ServerIndex];
+	bool Filtered = false;
+
+	if(g_Config.m_BrFilterEmpty && Info.m_NumFilteredPlayers == 0)
+		Filtered = true;
+	else if(g_Config.m_BrFilterFull && Players(Info) == Max(Info))
+		Filtered = true;
+	else if(g_Config.m_BrFilterPw && Info.m_Flags & SERVER_FLAG_PASSWORD)
+		Filtered = true;
+	else if(g_Config.m_BrFilterServerAddress[0] && !str_find_nocase(Info.m_aAddress, g_Config.m_BrFilterServerAddress))
+		Filtered = true;
+	else if(g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && str_comp_nocase(Info.m_aGameType, g_Config.m_BrFilterGametype))
+		Filtered = true;
+	else if(!g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && !str_utf8_find_nocase(Info.m_aGameType, g_Config.m_BrFilterGametype))
+		Filtered = true;
+	else if(g_Config.m_BrFilterUnfinishedMap && Info.m_HasRank == CServerInfo::RANK_RANKED)
+		Filtered = true;
+	else if(g_Config.m_BrFilterLogin && Info.m_RequiresLogin)
+		Filtered = true;
+	else
+	{
+		if(!Communities().empty())
+		{
+			if(m_ServerlistType == IServerBrowser::TYPE_INTERNET || m_ServerlistType == IServerBrowser::TYPE_FAVORITES)
 			{
-				if(m_ServerlistType == IServerBrowser::TYPE_INTERNET || m_ServerlistType == IServerBrowser::TYPE_FAVORITES)
-				{
-					Filtered = CommunitiesFilter().Filtered(Info.m_aCommunityId);
-				}
-				if(m_ServerlistType == IServerBrowser::TYPE_INTERNET || m_ServerlistType == IServerBrowser::TYPE_FAVORITES ||
-					(m_ServerlistType >= IServerBrowser::TYPE_FAVORITE_COMMUNITY_1 && m_ServerlistType <= IServerBrowser::TYPE_FAVORITE_COMMUNITY_5))
-				{
-					Filtered = Filtered || CountriesFilter().Filtered(Info.m_aCommunityCountry);
-					Filtered = Filtered || TypesFilter().Filtered(Info.m_aCommunityType);
-				}
+				Filtered = CommunitiesFilter().Filtered(Info.m_aCommunityId);
 			}
+			if(m_ServerlistType == IServerBrowser::TYPE_INTERNET || m_ServerlistType == IServerBrowser::TYPE_FAVORITES ||
+				(m_ServerlistType >= IServerBrowser::TYPE_FAVORITE_COMMUNITY_1 && m_ServerlistType <= IServerBrowser::TYPE_FAVORITE_COMMUNITY_5))
+			{
+				Filtered = Filtered || CountriesFilter().Filtered(Info.m_aCommunityCountry);
+				Filtered = Filtered || TypesFilter().Filtered(Info.m_aCommunityType);
+			}
+		}
 
-			if(!Filtered && g_Config.m_BrFilterCountry)
+		if(!Filtered && g_Config.m_BrFilterCountry)
+		{
+			Filtered = true;
+			// match against player country
+			for(int p = 0; p < minimum(Info.m_NumClients, (int)MAX_CLIENTS); p++)
 			{
-				Filtered = true;
-				// match against player country
-				for(int p = 0; p < minimum(Info.m_NumClients, (int)MAX_CLIENTS); p++)
+				if(Info.m_aClients[p].m_Country == g_Config.m_BrFilterCountryIndex)
 				{
-					if(Info.m_aClients[p].m_Country == g_Config.m_BrFilterCountryIndex)
-					{
-						Filtered = false;
-						break;
-					}
+					Filtered = false;
+					break;
 				}
 			}
+		}
 
-			if(!Filtered && g_Config.m_BrFilterString[0] != '\0')
-			{
-				Info.m_QuickSearchHit = 0;
+		if(!Filtered && m_HasFilterString)
+		{
+			Info.m_QuickSearchHit = 0;
 
-				const char *pStr = g_Config.m_BrFilterString;
-				char aFilterStr[sizeof(g_Config.m_BrFilterString)];
-				char aFilterStrTrimmed[sizeof(g_Config.m_BrFilterString)];
-				while((pStr = str_next_token(pStr, IServerBrowser::SEARCH_EXCLUDE_TOKEN, aFilterStr, sizeof(aFilterStr))))
+			for(const CSearchToken &Token : m_vFilterTokens)
+			{
+				// match against server name
+				if(MatchesSearchToken(Token, Info.m_aName, Index.m_Name))
 				{
-					str_copy(aFilterStrTrimmed, str_utf8_skip_whitespaces(aFilterStr));
-					str_utf8_trim_right(aFilterStrTrimmed);
-
-					if(aFilterStrTrimmed[0] == '\0')
-					{
-						continue;
-					}
-					auto MatchesFn = matchesPart;
-					const int FilterLen = str_length(aFilterStrTrimmed);
-					if(aFilterStrTrimmed[0] == '"' && aFilterStrTrimmed[FilterLen - 1] == '"')
-					{
-						aFilterStrTrimmed[FilterLen - 1] = '\0';
-						MatchesFn = matchesExactly;
-					}
-
-					// match against server name
-					if(MatchesFn(Info.m_aName, aFilterStrTrimmed))
-					{
-						Info.m_QuickSearchHit |= IServerBrowser::QUICK_SERVERNAME;
-					}
+					Info.m_QuickSearchHit |= IServerBrowser::QUICK_SERVERNAME;
+				}
 
-					// match against players
-					for(int p = 0; p < minimum(Info.m_NumClients, (int)MAX_CLIENTS); p++)
+				// match against players
+				for(int p = 0; p < (int)Index.m_vClientNames.size(); p++)
+				{
+					if(MatchesSearchToken(Token, Info.m_aClients[p].m_aName, Index.m_vClientNames[p]) ||
+						MatchesSearchToken(Token, Info.m_aClients[p].m_aClan, Index.m_vClientClans[p]))
 					{
-						if(MatchesFn(Info.m_aClients[p].m_aName, aFilterStrTrimmed) ||
-							MatchesFn(Info.m_aClients[p].m_aClan, aFilterStrTrimmed))
+						if(g_Config.m_BrFilterConnectingPlayers &&
+							str_comp(Info.m_aClients[p].m_aName, "(connecting)") == 0 &&
+							Info.m_aClients[p].m_aClan[0] == '\0')
 						{
-							if(g_Config.m_BrFilterConnectingPlayers &&
-								str_comp(Info.m_aClients[p].m_aName, "(connecting)") == 0 &&
-								Info.m_aClients[p].m_aClan[0] == '\0')
-							{
-								continue;
-							}
-							Info.m_QuickSearchHit |= IServerBrowser::QUICK_PLAYER;
-							break;
+							continue;
 						}
-					}
-
-					// match against map
-					if(MatchesFn(Info.m_aMap, aFilterStrTrimmed))
-					{
-						Info.m_QuickSearchHit |= IServerBrowser::QUICK_MAPNAME;
+						Info.m_QuickSearchHit |= IServerBrowser::QUICK_PLAYER;
+						break;
 					}
 				}
 
-				if(!Info.m_QuickSearchHit)
-					Filtered = true;
+				// match against map
+				if(MatchesSearchToken(Token, Info.m_aMap, Index.m_Map))
+				{
+					Info.m_QuickSearchHit |= IServerBrowser::QUICK_MAPNAME;
+				}
 			}
 
-			if(!Filtered && g_Config.m_BrExcludeString[0] != '\0')
+			if(!Info.m_QuickSearchHit)
+				Filtered = true;
+		}
+
+		if(!Filtered)
+		{
+			for(const CSearchToken &Token : m_vExcludeTokens)
 			{
-				const char *pStr = g_Config.m_BrExcludeString;
-				char aExcludeStr[sizeof(g_Config.m_BrExcludeString)];
-				char aExcludeStrTrimmed[sizeof(g_Config.m_BrExcludeString)];
-				while((pStr = str_next_token(pStr, IServerBrowser::SEARCH_EXCLUDE_TOKEN, aExcludeStr, sizeof(aExcludeStr))))
+				// match against server name, map and gametype
+				if(MatchesSearchToken(Token, Info.m_aName, Index.m_Name) ||
+					MatchesSearchToken(Token, Info.m_aMap, Index.m_Map) ||
+					MatchesSearchToken(Token, Info.m_aGameType, Index.m_GameType))
 				{
-					str_copy(aExcludeStrTrimmed, str_utf8_skip_whitespaces(aExcludeStr));
-					str_utf8_trim_right(aExcludeStrTrimmed);
+					Filtered = true;
+					break;
+				}
+			}
+		}
+	}
 
-					if(aExcludeStrTrimmed[0] == '\0')
-					{
-						continue;
-					}
-					auto MatchesFn = matchesPart;
-					const int FilterLen = str_length(aExcludeStrTrimmed);
-					if(aExcludeStrTrimmed[0] == '"' && aExcludeStrTrimmed[FilterLen - 1] == '"')
-					{
-						aExcludeStrTrimmed[FilterLen - 1] = '\0';
-						MatchesFn = matchesExactly;
-					}
+	if(Filtered)
+		return false;
 
-					// match against server name
-					if(MatchesFn(Info.m_aName, aExcludeStrTrimmed))
-					{
-						Filtered = true;
-						break;
-					}
+	UpdateServerFriends(&Info);
+	return !g_Config.m_BrFilterFriends || Info.m_FriendState != IFriends::FRIEND_NO;
+}
 
-					// match against map
-					if(MatchesFn(Info.m_aMap, aExcludeStrTrimmed))
-					{
-						Filtered = true;
-						break;
-					}
+void CServerBrowser::Filter()
+{
+	m_vSortedServerlist.clear();
+	m_NumSortedPlayers = 0;
 
-					// match against gametype
-					if(MatchesFn(Info.m_aGameType, aExcludeStrTrimmed))
-					{
-						Filtered = true;
-						break;
-					}
-				}
-			}
-		}
+	// the search strings are tokenized once instead of for every server
+	ParseSearchTokens(g_Config.m_BrFilterString, m_vFilterTokens);
+	ParseSearchTokens(g_Config.m_BrExcludeString, m_vExcludeTokens);
+	m_HasFilterString = g_Config.m_BrFilterString[0] != '\0';
 
-		if(!Filtered)
+	// filter the servers
+	for(int i = 0; i < m_NumServers; i++)
+	{
+		if(FilterServer(i))
 		{
-			UpdateServerFriends(&Info);
-
-			if(!g_Config.m_BrFilterFriends || Info.m_FriendState != IFriends::FRIEND_NO)
-			{
-				m_NumSortedPlayers += Info.m_NumFilteredPlayers;
-				m_pSortedServerlist[m_NumSortedServers++] = i;
-			}
+			m_NumSortedPlayers += m_ppServerlist[i]->m_Info.m_NumFilteredPlayers;
+			m_vSortedServerlist.push_back(i);
 		}
 	}
 }
@@ -623,22 +654,56 @@ void CServerBrowser::Sort()
 	Filter();
 
 	// sort
-	if(g_Config.m_BrSortOrder == 2 && (g_Config.m_BrSort == IServerBrowser::SORT_NUMPLAYERS || g_Config.m_BrSort == IServerBrowser::SORT_PING))
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareNumPlayersAndPing));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_NAME)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareName));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_PING)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortComparePing));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_MAP)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareMap));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_NUMFRIENDS)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareNumFriends));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_NUMPLAYERS)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareNumPlayers));
-	else if(g_Config.m_BrSort == IServerBrowser::SORT_GAMETYPE)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareGametype));
+	const FSortCompare pfnCompare = SortCompareFunc();
+	std::sort(m_vSortedServerlist.begin(), m_vSortedServerlist.end(), [&](int Index1, int Index2) { return SortLess(pfnCompare, Index1, Index2); });
 
 	m_Sorthash = SortHash();
+	m_vDirtyServers.clear();
+}
+
+void CServerBrowser::MarkServerDirty(int ServerIndex)
+{
+	m_vDirtyServers.push_back(ServerIndex);
+}
+
+void CServerBrowser::MergeDirtyServers(std::vector<int> &vSortedServers, std::vector<int> &vDirtyServers, const std::function<bool(int)> &Filter, const std::function<bool(int, int)> &Less)
+{
+	std::sort(vDirtyServers.begin(), vDirtyServers.end());
+	vDirtyServers.erase(std::unique(vDirtyServers.begin(), vDirtyServers.end()), vDirtyServers.end());
+
+	// take the changed servers out of the sorted list
+	vSortedServers.erase(std::remove_if(vSortedServers.begin(), vSortedServers.end(), [&](int Index) {
+		return std::binary_search(vDirtyServers.begin(), vDirtyServers.end(), Index);
+	}),
+		vSortedServers.end());
+
+	// filter them again and merge the ones passing into the unchanged list
+	const size_t NumUnchanged = vSortedServers.size();
+	for(int Index : vDirtyServers)
+	{
+		if(Filter(Index))
+			vSortedServers.push_back(Index);
+	}
+	std::sort(vSortedServers.begin() + NumUnchanged, vSortedServers.end(), Less);
+	std::inplace_merge(vSortedServers.begin(), vSortedServers.begin() + NumUnchanged, vSortedServers.end(), Less);
+	vDirtyServers.clear();
+}
+
+void CServerBrowser::SortDirtyServers()
+{
+	const FSortCompare pfnCompare = SortCompareFunc();
+	MergeDirtyServers(
+		m_vSortedServerlist, m_vDirtyServers, [&](int Index) {
+			UpdateServerFilteredPlayers(&m_ppServerlist[Index]->m_Info);
+			return FilterServer(Index);
+		},
+		[&](int Index1, int Index2) { return SortLess(pfnCompare, Index1, Index2); });
+
+	m_NumSortedPlayers = 0;
+	for(int Index : m_vSortedServerlist)
+	{
+		m_NumSortedPlayers += m_ppServerlist[Index]->m_Info.m_NumFilteredPlayers;
+	}
 }
 
 void CServerBrowser::RemoveRequest(CServerEntry *pEntry)
@@ -703,7 +768,7 @@ static void ServerBrowserFormatAddresses(char *pBuffer, int BufferSize, NETADDR
 	}
 }
 
-void CServerBrowser::SetInfo(CServerEntry *pEntry, const CServerInfo &Info) const
+void CServerBrowser::SetInfo(CServerEntry *pEntry, const CServerInfo &Info)
 {
 	const CServerInfo TmpInfo = pEntry->m_Info;
 	pEntry->m_Info = Info;
@@ -775,6 +840,7 @@ void CServerBrowser::SetInfo(CServerEntry *pEntry, const CServerInfo &Info) cons
 	std::sort(pEntry->m_Info.m_aClients, pEntry->m_Info.m_aClients + Info.m_NumReceivedClients, CPlayerScoreNameLess(pEntry->m_Info.m_ClientScoreKind));
 
 	pEntry->m_GotInfo = 1;
+	UpdateSearchIndex(pEntry);
 }
 
 void CServerBrowser::SetLatency(NETADDR Addr, int Latency)
@@ -810,6 +876,7 @@ void CServerBrowser::SetLatency(NETADDR Addr, int Latency)
 		}
 		m_ppServerlist[i]->m_Info.m_Latency = Ping;
 		m_ppServerlist[i]->m_Info.m_LatencyIsEstimated = false;
+		MarkServerDirty(i);
 	}
 }
 
@@ -853,6 +920,7 @@ CServerBrowser::CServerEntry *CServerBrowser::Add(const NETADDR *pAddrs, int Num
 	m_ppServerlist[m_NumServers] = pEntry;
 	pEntry->m_Info.m_ServerIndex = m_NumServers;
 	m_NumServers++;
+	UpdateSearchIndex(pEntry);
 
 	return pEntry;
 }
@@ -881,6 +949,7 @@ CServerBrowser::CServerEntry *CServerBrowser::ReplaceEntry(CServerEntry *pEntry,
 	{
 		m_ByAddr[pAddrs[i]] = pEntry->m_Info.m_ServerIndex;
 	}
+	UpdateSearchIndex(pEntry);
 
 	return pEntry;
 }
@@ -978,7 +1047,7 @@ void CServerBrowser::OnServerInfoUpdate(const NETADDR &Addr, int Token, const CS
 		pEntry->m_RequestTime = -1; // Request has been answered
 	}
 	RemoveRequest(pEntry);
-	RequestResort();
+	MarkServerDirty(pEntry->m_Info.m_ServerIndex);
 }
 
 void CServerBrowser::Refresh(int Type, bool Force)
@@ -1249,7 +1318,9 @@ void CServerBrowser::CleanUp()
 	// clear out everything
 	m_ServerlistHeap.Reset();
 	m_NumServers = 0;
-	m_NumSortedServers = 0;
+	m_vSortedServerlist.clear();
+	m_vDirtyServers.clear();
+	m_vSearchIndex.clear();
 	m_NumSortedPlayers = 0;
 	m_ByAddr.clear();
 	m_pFirstReqServer = nullptr;
@@ -1348,6 +1419,10 @@ void CServerBrowser::Update()
 		Sort();
 		m_NeedResort = false;
 	}
+	else if(!m_vDirtyServers.empty())
+	{
+		SortDirtyServers();
+	}
 }
 
 const json_value *CServerBrowser::LoadDDNetInfo()
@@ -1360,6 +1435,7 @@ const json_value *CServerBrowser::LoadDDNetInfo()
 		UpdateServerCommunity(&m_ppServerlist[i]->m_Info);
 		UpdateServerRank(&m_ppServerlist[i]->m_Info);
 	}
+	RequestResort();
 	return m_pDDNetInfo;
 }
 
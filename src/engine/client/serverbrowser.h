@@ -13,6 +13,8 @@
 #include <functional>
 #include <map>
 #include <set>
+#include <string>
+#include <vector>
 
 typedef struct _json_value json_value;
 class CNetClient;
@@ -262,7 +264,7 @@ public:
 	int NumServers() const override { return m_NumServers; }
 	int Players(const CServerInfo &Item) const override;
 	int Max(const CServerInfo &Item) const override;
-	int NumSortedServers() const override { return m_NumSortedServers; }
+	int NumSortedServers() const override { return m_vSortedServerlist.size(); }
 	int NumSortedPlayers() const override { return m_NumSortedPlayers; }
 	const CServerInfo *SortedGet(int Index) const override;
 
@@ -309,6 +311,9 @@ public:
 	void SetBaseInfo(class CNetClient *pClient, const char *pNetVersion);
 	void OnInit();
 
+	// removes the dirty servers from the sorted list and merges the ones passing the filter back in
+	static void MergeDirtyServers(std::vector<int> &vSortedServers, std::vector<int> &vDirtyServers, const std::function<bool(int)> &Filter, const std::function<bool(int, int)> &Less);
+
 	void QueueRequest(CServerEntry *pEntry);
 	CServerEntry *Find(const NETADDR &Addr) override;
 	int GetCurrentType() override { return m_ServerlistType; }
@@ -332,7 +337,9 @@ private:
 
 	CHeap m_ServerlistHeap;
 	CServerEntry **m_ppServerlist;
-	int *m_pSortedServerlist;
+	std::vector<int> m_vSortedServerlist;
+	// servers whose info or latency changed since they were last filtered
+	std::vector<int> m_vDirtyServers;
 	std::unordered_map<NETADDR, int> m_ByAddr;
 
 	std::vector<CCommunity> m_vCommunities;
@@ -356,11 +363,33 @@ private:
 	bool m_NeedResort;
 	int m_Sorthash;
 
+	// lowercase copies of the searchable strings of a server, updated when its info changes
+	class CSearchIndex
+	{
+	public:
+		std::string m_Name;
+		std::string m_Map;
+		std::string m_GameType;
+		std::vector<std::string> m_vClientNames;
+		std::vector<std::string> m_vClientClans;
+	};
+	std::vector<CSearchIndex> m_vSearchIndex;
+
+	class CSearchToken
+	{
+	public:
+		std::string m_Text;
+		std::string m_LowerText;
+		bool m_Exact;
+	};
+	std::vector<CSearchToken> m_vFilterTokens;
+	std::vector<CSearchToken> m_vExcludeTokens;
+	// a filter string without tokens (only whitespace) matches no server
+	bool m_HasFilterString = false;
+
 	// used instead of g_Config.br_max_requests to get more servers
 	int m_CurrentMaxRequests;
 
-	int m_NumSortedServers;
-	int m_NumSortedServersCapacity;
 	int m_NumSortedPlayers;
 	int m_NumServers;
 	int m_NumServerCapacity;
@@ -374,6 +403,9 @@ private:
 	static int GetExtraToken(int Token);
 
 	// sorting criteria
+	typedef bool (CServerBrowser::*FSortCompare)(int Index1, int Index2) const;
+	FSortCompare SortCompareFunc() const;
+	bool SortLess(FSortCompare pfnCompare, int Index1, int Index2) const;
 	bool SortCompareName(int Index1, int Index2) const;
 	bool SortCompareMap(int Index1, int Index2) const;
 	bool SortComparePing(int Index1, int Index2) const;
@@ -384,8 +416,14 @@ private:
 	bool SortCompareNumPlayersAndPing(int Index1, int Index2) const;
 
 	//
+	static void ParseSearchTokens(const char *pSearch, std::vector<CSearchToken> &vTokens);
+	static bool MatchesSearchToken(const CSearchToken &Token, const char *pStr, const std::string &LowerStr);
+	void UpdateSearchIndex(const CServerEntry *pEntry);
+	bool FilterServer(int ServerIndex);
 	void Filter();
 	void Sort();
+	void MarkServerDirty(int ServerIndex);
+	void SortDirtyServers();
 	int SortHash() const;
 
 public:
@@ -416,7 +454,7 @@ private:
 	bool ValidateCountryName(const char *pCountryName) const;
 	bool ValidateTypeName(const char *pTypeName) const;
 
-	void SetInfo(CServerEntry *pEntry, const CServerInfo &Info) const;
+	void SetInfo(CServerEntry *pEntry, const CServerInfo &Info);
 	void SetLatency(NETADDR Addr, int Latency);
 
 	static bool ParseCommunityFinishes(CCommunity *pCommunity, const json_value &Finishes);
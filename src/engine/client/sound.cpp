@@ -10,6 +10,7 @@
 #include <engine/storage.h>
 
 #include "sound.h"
+#include "sound_mix.h"
 
 #if defined(CONF_VIDEORECORDER)
 #include <engine/shared/video.h>
@@ -32,6 +33,8 @@ void CSound::Mix(short *pFinalOut, unsigned Frames)
 	// acquire lock while we are mixing
 	m_SoundLock.lock();
 
+	ApplyVoiceCommands();
+
 	const int MasterVol = m_SoundVolume.load(std::memory_order_relaxed);
 
 	for(auto &Voice : m_aVoices)
@@ -39,13 +42,6 @@ void CSound::Mix(short *pFinalOut, unsigned Frames)
 		if(!Voice.m_pSample)
 			continue;
 
-		// mix voice
-		int *pOut = m_pMixBuffer;
-
-		const int Step = Voice.m_pSample->m_Channels; // setup input sources
-		short *pInL = &Voice.m_pSample->m_pData[Voice.m_Tick * Step];
-		short *pInR = &Voice.m_pSample->m_pData[Voice.m_Tick * Step + 1];
-
 		unsigned End = Voice.m_pSample->m_NumFrames - Voice.m_Tick;
 
 		int VolumeR = round_truncate(Voice.m_pChannel->m_Vol * (Voice.m_Vol / 255.0f));
@@ -55,10 +51,6 @@ void CSound::Mix(short *pFinalOut, unsigned Frames)
 		if(Frames < End)
 			End = Frames;
 
-		// check if we have a mono sound
-		if(Voice.m_pSample->m_Channels == 1)
-			pInR = pInL;
-
 		// volume calculation
 		if(Voice.m_Flags & ISound::FLAG_POS && Voice.m_pChannel->m_Pan)
 		{
@@ -132,14 +124,9 @@ void CSound::Mix(short *pFinalOut, unsigned Frames)
 		}
 
 		// process all frames
-		for(unsigned s = 0; s < End; s++)
-		{
-			*pOut++ += (*pInL) * VolumeL;
-			*pOut++ += (*pInR) * VolumeR;
-			pInL += Step;
-			pInR += Step;
-			Voice.m_Tick++;
-		}
+		const int Channels = Voice.m_pSample->m_Channels;
+		SoundMixVoice(m_pMixBuffer, &Voice.m_pSample->m_pData[Voice.m_Tick * Channels], Channels, End, VolumeL, VolumeR);
+		Voice.m_Tick += End;
 
 		// free voice if not used any more
 		if(Voice.m_Tick == Voice.m_pSample->m_NumFrames)
@@ -723,82 +710,128 @@ void CSound::SetListenerPosition(vec2 Position)
 	m_ListenerPositionY.store(Position.y, std::memory_order_relaxed);
 }
 
-void CSound::SetVoiceVolume(CVoiceHandle Voice, float Volume)
+void CSound::PushVoiceCommand(int Type, CVoiceHandle Voice, float Arg0, float Arg1)
 {
-	if(!Voice.IsValid())
-		return;
-
-	int VoiceId = Voice.Id();
+	const CLockScope LockScope(m_VoiceCommandLock);
+	const unsigned Write = m_VoiceCommandWrite.load(std::memory_order_relaxed);
+	if(Write - m_VoiceCommandRead.load(std::memory_order_acquire) == VOICE_COMMAND_QUEUE_SIZE)
+	{
+		// nobody is mixing, e.g. because the audio device is paused
+		const CLockScope SoundLockScope(m_SoundLock);
+		ApplyVoiceCommands();
+	}
 
-	const CLockScope LockScope(m_SoundLock);
-	if(m_aVoices[VoiceId].m_Age != Voice.Age())
-		return;
+	CVoiceCommand &Command = m_aVoiceCommands[Write % VOICE_COMMAND_QUEUE_SIZE];
+	Command.m_Type = Type;
+	Command.m_VoiceId = Voice.Id();
+	Command.m_Age = Voice.Age();
+	Command.m_aArgs[0] = Arg0;
+	Command.m_aArgs[1] = Arg1;
+	m_VoiceCommandWrite.store(Write + 1, std::memory_order_release);
+}
 
-	Volume = clamp(Volume, 0.0f, 1.0f);
-	m_aVoices[VoiceId].m_Vol = (int)(Volume * 255.0f);
+void CSound::ApplyVoiceCommands()
+{
+	unsigned Read = m_VoiceCommandRead.load(std::memory_order_relaxed);
+	const unsigned Write = m_VoiceCommandWrite.load(std::memory_order_acquire);
+	for(; Read != Write; Read++)
+		ApplyVoiceCommand(m_aVoiceCommands[Read % VOICE_COMMAND_QUEUE_SIZE]);
+	m_VoiceCommandRead.store(Read, std::memory_order_release);
 }
 
-void CSound::SetVoiceFalloff(CVoiceHandle Voice, float Falloff)
+void CSound::ApplyVoiceCommand(const CVoiceCommand &Command)
 {
-	if(!Voice.IsValid())
+	CVoice &Voice = m_aVoices[Command.m_VoiceId];
+	if(Voice.m_Age != Command.m_Age)
 		return;
 
-	int VoiceId = Voice.Id();
+	switch(Command.m_Type)
+	{
+	case CVoiceCommand::VOLUME:
+		Voice.m_Vol = (int)(clamp(Command.m_aArgs[0], 0.0f, 1.0f) * 255.0f);
+		break;
 
-	const CLockScope LockScope(m_SoundLock);
-	if(m_aVoices[VoiceId].m_Age != Voice.Age())
-		return;
+	case CVoiceCommand::FALLOFF:
+		Voice.m_Falloff = clamp(Command.m_aArgs[0], 0.0f, 1.0f);
+		break;
+
+	case CVoiceCommand::POSITION:
+		Voice.m_Position = vec2(Command.m_aArgs[0], Command.m_aArgs[1]);
+		break;
+
+	case CVoiceCommand::TIME_OFFSET:
+	{
+		if(!Voice.m_pSample)
+			return;
 
-	Falloff = clamp(Falloff, 0.0f, 1.0f);
-	m_aVoices[VoiceId].m_Falloff = Falloff;
+		const float TimeOffset = Command.m_aArgs[0];
+		int Tick = 0;
+		bool IsLooping = Voice.m_Flags & ISound::FLAG_LOOP;
+		uint64_t TickOffset = Voice.m_pSample->m_Rate * TimeOffset;
+		if(Voice.m_pSample->m_NumFrames > 0 && IsLooping)
+			Tick = TickOffset % Voice.m_pSample->m_NumFrames;
+		else
+			Tick = clamp(TickOffset, (uint64_t)0, (uint64_t)Voice.m_pSample->m_NumFrames);
+
+		// at least 200msec off, else depend on buffer size
+		float Threshold = maximum(0.2f * Voice.m_pSample->m_Rate, (float)m_MaxFrames);
+		if(absolute(Voice.m_Tick - Tick) > Threshold)
+		{
+			// take care of looping (modulo!)
+			if(!(IsLooping && (minimum(Voice.m_Tick, Tick) + Voice.m_pSample->m_NumFrames - maximum(Voice.m_Tick, Tick)) <= Threshold))
+			{
+				Voice.m_Tick = Tick;
+			}
+		}
+		break;
+	}
+
+	case CVoiceCommand::CIRCLE:
+		Voice.m_Shape = ISound::SHAPE_CIRCLE;
+		Voice.m_Circle.m_Radius = maximum(0.0f, Command.m_aArgs[0]);
+		break;
+
+	case CVoiceCommand::RECTANGLE:
+		Voice.m_Shape = ISound::SHAPE_RECTANGLE;
+		Voice.m_Rectangle.m_Width = maximum(0.0f, Command.m_aArgs[0]);
+		Voice.m_Rectangle.m_Height = maximum(0.0f, Command.m_aArgs[1]);
+		break;
+
+	default:
+		dbg_assert(false, "invalid voice command");
+	}
 }
 
-void CSound::SetVoicePosition(CVoiceHandle Voice, vec2 Position)
+void CSound::SetVoiceVolume(CVoiceHandle Voice, float Volume)
 {
 	if(!Voice.IsValid())
 		return;
 
-	int VoiceId = Voice.Id();
+	PushVoiceCommand(CVoiceCommand::VOLUME, Voice, Volume);
+}
 
-	const CLockScope LockScope(m_SoundLock);
-	if(m_aVoices[VoiceId].m_Age != Voice.Age())
+void CSound::SetVoiceFalloff(CVoiceHandle Voice, float Falloff)
+{
+	if(!Voice.IsValid())
 		return;
 
-	m_aVoices[VoiceId].m_Position = Position;
+	PushVoiceCommand(CVoiceCommand::FALLOFF, Voice, Falloff);
 }
 
-void CSound::SetVoiceTimeOffset(CVoiceHandle Voice, float TimeOffset)
+void CSound::SetVoicePosition(CVoiceHandle Voice, vec2 Position)
 {
 	if(!Voice.IsValid())
 		return;
 
-	int VoiceId = Voice.Id();
-
-	const CLockScope LockScope(m_SoundLock);
-	if(m_aVoices[VoiceId].m_Age != Voice.Age())
-		return;
+	PushVoiceCommand(CVoiceCommand::POSITION, Voice, Position.x, Position.y);
+}
 
-	if(!m_aVoices[VoiceId].m_pSample)
+void CSound::SetVoiceTimeOffset(CVoiceHandle Voice, float TimeOffset)
+{
+	if(!Voice.IsValid())
 		return;
 
-	int Tick = 0;
-	bool IsLooping = m_aVoices[VoiceId].m_Flags & ISound::FLAG_LOOP;
-	uint64_t TickOffset = m_aVoices[VoiceId].m_pSample->m_Rate * TimeOffset;
-	if(m_aVoices[VoiceId].m_pSample->m_NumFrames > 0 && IsLooping)
-		Tick = TickOffset % m_aVoices[VoiceId].m_pSample->m_NumFrames;
-	else
-		Tick = clamp(TickOffset, (uint64_t)0, (uint64_t)m_aVoices[VoiceId].m_pSample->m_NumFrames);
-
-	// at least 200msec off, else depend on buffer size
-	float Threshold = maximum(0.2f * m_aVoices[VoiceId].m_pSample->m_Rate, (float)m_MaxFrames);
-	if(absolute(m_aVoices[VoiceId].m_Tick - Tick) > Threshold)
-	{
-		// take care of looping (modulo!)
-		if(!(IsLooping && (minimum(m_aVoices[VoiceId].m_Tick, Tick) + m_aVoices[VoiceId].m_pSample->m_NumFrames - maximum(m_aVoices[VoiceId].m_Tick, Tick)) <= Threshold))
-		{
-			m_aVoices[VoiceId].m_Tick = Tick;
-		}
-	}
+	PushVoiceCommand(CVoiceCommand::TIME_OFFSET, Voice, TimeOffset);
 }
 
 void CSound::SetVoiceCircle(CVoiceHandle Voice, float Radius)
@@ -806,14 +839,7 @@ void CSound::SetVoiceCircle(CVoiceHandle Voice, float Radius)
 	if(!Voice.IsValid())
 		return;
 
-	int VoiceId = Voice.Id();
-
-	const CLockScope LockScope(m_SoundLock);
-	if(m_aVoices[VoiceId].m_Age != Voice.Age())
-		return;
-
-	m_aVoices[VoiceId].m_Shape = ISound::SHAPE_CIRCLE;
-	m_aVoices[VoiceId].m_Circle.m_Radius = maximum(0.0f, Radius);
+	PushVoiceCommand(CVoiceCommand::CIRCLE, Voice, Radius);
 }
 
 void CSound::SetVoiceRectangle(CVoiceHandle Voice, float Width, float Height)
@@ -821,15 +847,7 @@ void CSound::SetVoiceRectangle(CVoiceHandle Voice, float Width, float Height)
 	if(!Voice.IsValid())
 		return;
 
-	int VoiceId = Voice.Id();
-
-	const CLockScope LockScope(m_SoundLock);
-	if(m_aVoices[VoiceId].m_Age != Voice.Age())
-		return;
-
-	m_aVoices[VoiceId].m_Shape = ISound::SHAPE_RECTANGLE;
-	m_aVoices[VoiceId].m_Rectangle.m_Width = maximum(0.0f, Width);
-	m_aVoices[VoiceId].m_Rectangle.m_Height = maximum(0.0f, Height);
+	PushVoiceCommand(CVoiceCommand::RECTANGLE, Voice, Width, Height);
 }
 
 ISound::CVoiceHandle CSound::Play(int ChannelId, int SampleId, int Flags, float Volume, vec2 Position)
@@ -81,6 +81,38 @@ class CSound : public IEngineSound
 	int m_NextVoice GUARDED_BY(m_SoundLock) = 0;
 	uint32_t m_MaxFrames = 0;
 
+	// Voice parameter changes are queued by the game and applied by Mix, so
+	// updating voices every frame never contends with the audio callback.
+	// Producers are serialized by m_VoiceCommandLock, the consumer always
+	// holds m_SoundLock.
+	struct CVoiceCommand
+	{
+		enum
+		{
+			VOLUME = 0,
+			FALLOFF,
+			POSITION,
+			TIME_OFFSET,
+			CIRCLE,
+			RECTANGLE,
+		};
+
+		int m_Type;
+		int m_VoiceId;
+		int m_Age;
+		float m_aArgs[2];
+	};
+
+	enum
+	{
+		VOICE_COMMAND_QUEUE_SIZE = 1024,
+	};
+
+	CLock m_VoiceCommandLock ACQUIRED_BEFORE(m_SoundLock);
+	CVoiceCommand m_aVoiceCommands[VOICE_COMMAND_QUEUE_SIZE];
+	std::atomic<unsigned> m_VoiceCommandRead = 0;
+	std::atomic<unsigned> m_VoiceCommandWrite = 0;
+
 	// This is not an std::atomic<vec2> as this would require linking with
 	// libatomic with clang x86 as there is no native support for this.
 	std::atomic<float> m_ListenerPositionX = 0.0f;
@@ -101,6 +133,10 @@ class CSound : public IEngineSound
 
 	void UpdateVolume();
 
+	void PushVoiceCommand(int Type, CVoiceHandle Voice, float Arg0, float Arg1 = 0.0f) REQUIRES(!m_VoiceCommandLock, !m_SoundLock);
+	void ApplyVoiceCommands() REQUIRES(m_SoundLock);
+	void ApplyVoiceCommand(const CVoiceCommand &Command) REQUIRES(m_SoundLock);
+
 public:
 	int Init() override REQUIRES(!m_SoundLock);
 	int Update() override;
@@ -121,13 +157,13 @@ public:
 	void SetChannel(int ChannelId, float Vol, float Pan) override REQUIRES(!m_SoundLock);
 	void SetListenerPosition(vec2 Position) override;
 
-	void SetVoiceVolume(CVoiceHandle Voice, float Volume) override REQUIRES(!m_SoundLock);
-	void SetVoiceFalloff(CVoiceHandle Voice, float Falloff) override REQUIRES(!m_SoundLock);
-	void SetVoicePosition(CVoiceHandle Voice, vec2 Position) override REQUIRES(!m_SoundLock);
-	void SetVoiceTimeOffset(CVoiceHandle Voice, float TimeOffset) override REQUIRES(!m_SoundLock); // in s
+	void SetVoiceVolume(CVoiceHandle Voice, float Volume) override REQUIRES(!m_VoiceCommandLock, !m_SoundLock);
+	void SetVoiceFalloff(CVoiceHandle Voice, float Falloff) override REQUIRES(!m_VoiceCommandLock, !m_SoundLock);
+	void SetVoicePosition(CVoiceHandle Voice, vec2 Position) override REQUIRES(!m_VoiceCommandLock, !m_SoundLock);
+	void SetVoiceTimeOffset(CVoiceHandle Voice, float TimeOffset) override REQUIRES(!m_VoiceCommandLock, !m_SoundLock); // in s
 
-	void SetVoiceCircle(CVoiceHandle Voice, float Radius) override REQUIRES(!m_SoundLock);
-	void SetVoiceRectangle(CVoiceHandle Voice, float Width, float Height) override REQUIRES(!m_SoundLock);
+	void SetVoiceCircle(CVoiceHandle Voice, float Radius) override REQUIRES(!m_VoiceCommandLock, !m_SoundLock);
+	void SetVoiceRectangle(CVoiceHandle Voice, float Width, float Height) override REQUIRES(!m_VoiceCommandLock, !m_SoundLock);
 
 	CVoiceHandle Play(int ChannelId, int SampleId, int Flags, float Volume, vec2 Position) REQUIRES(!m_SoundLock);
 	CVoiceHandle PlayAt(int ChannelId, int SampleId, int Flags, float Volume, vec2 Position) override REQUIRES(!m_SoundLock);
@@ -0,0 +1,109 @@
+#include "sound_mix.h"
+
+#include <base/detect.h>
+
+#include <cstdint>
+#include <limits>
+
+#if defined(CONF_ARCH_AMD64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SOUND_MIX_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define SOUND_MIX_NEON
+#include <arm_neon.h>
+#endif
+
+void SoundMixVoiceScalar(int *pOut, const short *pIn, int Channels, unsigned Frames, int VolumeL, int VolumeR)
+{
+	const short *pInL = pIn;
+	const short *pInR = Channels == 1 ? pIn : pIn + 1;
+	for(unsigned s = 0; s < Frames; s++)
+	{
+		*pOut++ += (*pInL) * VolumeL;
+		*pOut++ += (*pInR) * VolumeR;
+		pInL += Channels;
+		pInR += Channels;
+	}
+}
+
+#if defined(SOUND_MIX_SSE2)
+// 16x16 bit multiplications, the low and high halves of the products are
+// interleaved back into 32 bit integers
+static unsigned MixVoiceSimd(int *pOut, const short *pIn, int Channels, unsigned Frames, int VolumeL, int VolumeR)
+{
+	const __m128i Volume = _mm_set_epi16(VolumeR, VolumeL, VolumeR, VolumeL, VolumeR, VolumeL, VolumeR, VolumeL);
+	const auto &&Accumulate = [&](int *pDst, __m128i Samples) {
+		const __m128i Low = _mm_mullo_epi16(Samples, Volume);
+		const __m128i High = _mm_mulhi_epi16(Samples, Volume);
+		__m128i *pDst0 = reinterpret_cast<__m128i *>(pDst);
+		__m128i *pDst1 = reinterpret_cast<__m128i *>(pDst + 4);
+		_mm_storeu_si128(pDst0, _mm_add_epi32(_mm_loadu_si128(pDst0), _mm_unpacklo_epi16(Low, High)));
+		_mm_storeu_si128(pDst1, _mm_add_epi32(_mm_loadu_si128(pDst1), _mm_unpackhi_epi16(Low, High)));
+	};
+
+	unsigned Frame = 0;
+	if(Channels == 2)
+	{
+		for(; Frame + 4 <= Frames; Frame += 4)
+			Accumulate(pOut + Frame * 2, _mm_loadu_si128(reinterpret_cast<const __m128i *>(pIn + Frame * 2)));
+	}
+	else
+	{
+		for(; Frame + 8 <= Frames; Frame += 8)
+		{
+			const __m128i Samples = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pIn + Frame));
+			Accumulate(pOut + Frame * 2, _mm_unpacklo_epi16(Samples, Samples));
+			Accumulate(pOut + Frame * 2 + 8, _mm_unpackhi_epi16(Samples, Samples));
+		}
+	}
+	return Frame;
+}
+#elif defined(SOUND_MIX_NEON)
+static unsigned MixVoiceSimd(int *pOut, const short *pIn, int Channels, unsigned Frames, int VolumeL, int VolumeR)
+{
+	const int16_t aVolume[4] = {(int16_t)VolumeL, (int16_t)VolumeR, (int16_t)VolumeL, (int16_t)VolumeR};
+	const int16x4_t Volume = vld1_s16(aVolume);
+	const auto &&Accumulate = [&](int *pDst, int16x4_t Samples) {
+		vst1q_s32(pDst, vmlal_s16(vld1q_s32(pDst), Samples, Volume));
+	};
+
+	unsigned Frame = 0;
+	if(Channels == 2)
+	{
+		for(; Frame + 4 <= Frames; Frame += 4)
+		{
+			const int16x8_t Samples = vld1q_s16(pIn + Frame * 2);
+			Accumulate(pOut + Frame * 2, vget_low_s16(Samples));
+			Accumulate(pOut + Frame * 2 + 4, vget_high_s16(Samples));
+		}
+	}
+	else
+	{
+		for(; Frame + 4 <= Frames; Frame += 4)
+		{
+			const int16x4_t Samples = vld1_s16(pIn + Frame);
+			const int16x4x2_t Duplicated = vzip_s16(Samples, Samples);
+			Accumulate(pOut + Frame * 2, Duplicated.val[0]);
+			Accumulate(pOut + Frame * 2 + 4, Duplicated.val[1]);
+		}
+	}
+	return Frame;
+}
+#endif
+
+void SoundMixVoice(int *pOut, const short *pIn, int Channels, unsigned Frames, int VolumeL, int VolumeR)
+{
+#if defined(SOUND_MIX_SSE2) || defined(SOUND_MIX_NEON)
+	const auto &&FitsShort = [](int Volume) {
+		return Volume >= std::numeric_limits<short>::min() && Volume <= std::numeric_limits<short>::max();
+	};
+	if(FitsShort(VolumeL) && FitsShort(VolumeR))
+	{
+		const unsigned Done = MixVoiceSimd(pOut, pIn, Channels, Frames, VolumeL, VolumeR);
+		pOut += Done * 2;
+		pIn += Done * Channels;
+		Frames -= Done;
+	}
+#endif
+	SoundMixVoiceScalar(pOut, pIn, Channels, Frames, VolumeL, VolumeR);
+}
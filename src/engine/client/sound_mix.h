@@ -0,0 +1,25 @@
+#ifndef ENGINE_CLIENT_SOUND_MIX_H
+#define ENGINE_CLIENT_SOUND_MIX_H
+
+/**
+ * Adds `Frames` frames of a voice to an interleaved stereo mix buffer.
+ *
+ * @param pOut Mix buffer, two accumulators per frame.
+ * @param pIn Sample data of the first frame to mix, interleaved if stereo.
+ * @param Channels Number of channels of the sample data, 1 or 2.
+ * @param Frames Number of frames to mix.
+ * @param VolumeL Volume of the left channel.
+ * @param VolumeR Volume of the right channel.
+ *
+ * @remark Uses SSE2 or NEON for volumes that fit into 16 bits, which all
+ *         regular voices do. The result is always identical to
+ *         @link SoundMixVoiceScalar @endlink.
+ */
+void SoundMixVoice(int *pOut, const short *pIn, int Channels, unsigned Frames, int VolumeL, int VolumeR);
+
+/**
+ * Plain C++ version of @link SoundMixVoice @endlink.
+ */
+void SoundMixVoiceScalar(int *pOut, const short *pIn, int Channels, unsigned Frames, int VolumeL, int VolumeR);
+
+#endif
@@ -1,11 +1,16 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/hash.h>
 #include <base/log.h>
 #include <base/math.h>
 #include <base/system.h>
 
+#include <engine/client/glyph_cache.h>
 #include <engine/console.h>
+#include <engine/engine.h>
 #include <engine/graphics.h>
+#include <engine/shared/config.h>
+#include <engine/shared/jobs.h>
 #include <engine/shared/json.h>
 #include <engine/storage.h>
 #include <engine/textrender.h>
@@ -17,6 +22,7 @@
 #include <chrono>
 #include <cstddef>
 #include <limits>
+#include <string>
 #include <tuple>
 #include <unordered_map>
 #include <vector>
@@ -41,11 +47,14 @@ enum
 	FONT_NAME_SIZE = 128,
 };
 
+static const char *const GLYPH_CACHE_FILE = "glyph_cache.bin";
+
 struct SGlyph
 {
 	enum class EState
 	{
 		UNINITIALIZED,
+		QUEUED, // requested from a rasterize job, can still be rendered directly
 		RENDERED,
 		ERROR,
 	};
@@ -89,6 +98,254 @@ struct SGlyphKeyEquals
 	}
 };
 
+/**
+ * A glyph rasterized with FreeType, which is not in the atlas yet.
+ */
+struct SGlyphBitmap
+{
+	FT_Face m_Face;
+	int m_Chr;
+	int m_FontSize;
+	FT_UInt m_GlyphIndex;
+
+	// size including the outline padding
+	unsigned m_Width;
+	unsigned m_Height;
+	unsigned m_CharWidth;
+	unsigned m_CharHeight;
+	float m_OffsetX;
+	float m_OffsetY;
+	float m_AdvanceX;
+
+	std::vector<uint8_t> m_vFill;
+	std::vector<uint8_t> m_vOutline;
+};
+
+static void GrowOutline(const unsigned char *pIn, unsigned char *pOut, int w, int h, int OutlineCount)
+{
+	for(int y = 0; y < h; y++)
+	{
+		for(int x = 0; x < w; x++)
+		{
+			int c = pIn[y * w + x];
+
+			for(int sy = -OutlineCount; sy <= OutlineCount; sy++)
+			{
+				for(int sx = -OutlineCount; sx <= OutlineCount; sx++)
+				{
+					int GetX = x + sx;
+					int GetY = y + sy;
+					if(GetX >= 0 && GetY >= 0 && GetX < w && GetY < h)
+					{
+						int Index = GetY * w + GetX;
+						float Mask = 1.f - clamp(length(vec2(sx, sy)) - OutlineCount, 0.f, 1.f);
+						c = maximum(c, int(pIn[Index] * Mask));
+					}
+				}
+			}
+
+			pOut[y * w + x] = c;
+		}
+	}
+}
+
+static int AdjustOutlineThicknessToFontSize(int OutlineThickness, int FontSize)
+{
+	if(FontSize > 48)
+		OutlineThickness *= 4;
+	else if(FontSize >= 18)
+		OutlineThickness *= 2;
+	return OutlineThickness;
+}
+
+/**
+ * Renders the fill and outline bitmaps of a glyph. Only touches the given face,
+ * so it can run on any thread which owns the face.
+ */
+static bool RasterizeGlyph(FT_Face Face, FT_UInt GlyphIndex, int Chr, int FontSize, SGlyphBitmap &Bitmap)
+{
+	FT_Set_Pixel_Sizes(Face, 0, FontSize);
+
+	if(FT_Load_Glyph(Face, GlyphIndex, FT_LOAD_RENDER | FT_LOAD_NO_BITMAP))
+	{
+		log_debug("textrender", "Error loading glyph. Chr=%d GlyphIndex=%u", Chr, GlyphIndex);
+		return false;
+	}
+
+	const FT_Bitmap *pBitmap = &Face->glyph->bitmap;
+	if(pBitmap->pixel_mode != FT_PIXEL_MODE_GRAY)
+	{
+		log_debug("textrender", "Error loading glyph, unsupported pixel mode. Chr=%d GlyphIndex=%u PixelMode=%d", Chr, GlyphIndex, pBitmap->pixel_mode);
+		return false;
+	}
+
+	const unsigned RealWidth = pBitmap->width;
+	const unsigned RealHeight = pBitmap->rows;
+
+	// adjust spacing
+	int OutlineThickness = 0;
+	int x = 0;
+	int y = 0;
+	if(RealWidth > 0)
+	{
+		OutlineThickness = AdjustOutlineThicknessToFontSize(1, FontSize);
+		x += (OutlineThickness + 1);
+		y += (OutlineThickness + 1);
+	}
+
+	Bitmap.m_Face = Face;
+	Bitmap.m_Chr = Chr;
+	Bitmap.m_FontSize = FontSize;
+	Bitmap.m_GlyphIndex = GlyphIndex;
+	Bitmap.m_Width = RealWidth + x * 2;
+	Bitmap.m_Height = RealHeight + y * 2;
+	Bitmap.m_CharWidth = RealWidth;
+	Bitmap.m_CharHeight = RealHeight;
+	Bitmap.m_OffsetX = (Face->glyph->metrics.horiBearingX >> 6);
+	Bitmap.m_OffsetY = -((Face->glyph->metrics.height >> 6) - (Face->glyph->metrics.horiBearingY >> 6));
+	Bitmap.m_AdvanceX = (Face->glyph->advance.x >> 6);
+
+	if(Bitmap.m_Width > 0 && Bitmap.m_Height > 0)
+	{
+		const size_t GlyphDataSize = (size_t)Bitmap.m_Width * Bitmap.m_Height;
+		Bitmap.m_vFill.assign(GlyphDataSize, 0);
+		Bitmap.m_vOutline.resize(GlyphDataSize);
+		for(unsigned py = 0; py < pBitmap->rows; ++py)
+		{
+			mem_copy(&Bitmap.m_vFill[(py + y) * Bitmap.m_Width + x], &pBitmap->buffer[py * pBitmap->width], pBitmap->width);
+		}
+		GrowOutline(Bitmap.m_vFill.data(), Bitmap.m_vOutline.data(), Bitmap.m_Width, Bitmap.m_Height, OutlineThickness);
+	}
+	return true;
+}
+
+/**
+ * Rasterizes glyphs on a worker thread, optionally after reading the glyph
+ * cache file. FreeType faces must not be used by multiple threads at once, so
+ * the job opens its own faces from the font data of the requested faces.
+ */
+class CGlyphRasterizeJob : public IJob
+{
+public:
+	struct SRequest
+	{
+		FT_Face m_Face;
+		int m_Chr;
+		FT_UInt m_GlyphIndex;
+		int m_FontSize;
+	};
+
+private:
+	std::vector<FT_Face> m_vFaces;
+	SHA256_DIGEST m_FontKey;
+	IOHANDLE m_CacheFile;
+	bool m_ReadsCache;
+	std::vector<SRequest> m_vRequests;
+	std::vector<SGlyphBitmap> m_vResults;
+
+	void ReadCache()
+	{
+		void *pData;
+		unsigned DataSize;
+		const bool Read = io_read_all(m_CacheFile, &pData, &DataSize);
+		io_close(m_CacheFile);
+		m_CacheFile = nullptr;
+		if(!Read)
+			return;
+
+		std::vector<SCachedGlyph> vGlyphs;
+		const bool Valid = ReadGlyphCache(pData, DataSize, m_FontKey, (int)m_vFaces.size(), vGlyphs);
+		free(pData);
+		if(!Valid)
+		{
+			log_debug("textrender", "Ignoring outdated glyph cache");
+			return;
+		}
+
+		m_vResults.reserve(vGlyphs.size());
+		for(SCachedGlyph &Glyph : vGlyphs)
+		{
+			if(State() == IJob::STATE_ABORTED)
+				break;
+			const SGlyphCacheEntry &Entry = Glyph.m_Entry;
+			SGlyphBitmap &Bitmap = m_vResults.emplace_back();
+			Bitmap.m_Face = m_vFaces[Entry.m_FaceIndex];
+			Bitmap.m_Chr = Entry.m_Chr;
+			Bitmap.m_FontSize = Entry.m_FontSize;
+			Bitmap.m_GlyphIndex = Entry.m_GlyphIndex;
+			Bitmap.m_Width = Entry.m_Width;
+			Bitmap.m_Height = Entry.m_Height;
+			Bitmap.m_CharWidth = Entry.m_CharWidth;
+			Bitmap.m_CharHeight = Entry.m_CharHeight;
+			Bitmap.m_OffsetX = Entry.m_OffsetX;
+			Bitmap.m_OffsetY = Entry.m_OffsetY;
+			Bitmap.m_AdvanceX = Entry.m_AdvanceX;
+			Bitmap.m_vFill = std::move(Glyph.m_vFill);
+			Bitmap.m_vOutline = std::move(Glyph.m_vOutline);
+		}
+		log_debug("textrender", "Loaded %" PRIzu " glyphs from glyph cache", m_vResults.size());
+	}
+
+	void Run() override
+	{
+		if(m_CacheFile)
+			ReadCache();
+		if(m_vRequests.empty() || State() == IJob::STATE_ABORTED)
+			return;
+
+		FT_Library Library;
+		if(FT_Init_FreeType(&Library))
+			return;
+		std::unordered_map<FT_Face, FT_Face> OwnFaces;
+		for(const SRequest &Request : m_vRequests)
+		{
+			if(State() == IJob::STATE_ABORTED)
+				break;
+
+			auto FaceIt = OwnFaces.find(Request.m_Face);
+			if(FaceIt == OwnFaces.end())
+			{
+				// faces of the glyph map are always loaded from memory, so the stream holds the whole font file
+				FT_Face OwnFace;
+				if(FT_New_Memory_Face(Library, Request.m_Face->stream->base, Request.m_Face->stream->size, Request.m_Face->face_index, &OwnFace))
+					OwnFace = nullptr;
+				FaceIt = OwnFaces.emplace(Request.m_Face, OwnFace).first;
+			}
+			if(FaceIt->second == nullptr)
+				continue;
+
+			SGlyphBitmap Bitmap;
+			if(RasterizeGlyph(FaceIt->second, Request.m_GlyphIndex, Request.m_Chr, Request.m_FontSize, Bitmap))
+			{
+				Bitmap.m_Face = Request.m_Face;
+				m_vResults.push_back(std::move(Bitmap));
+			}
+		}
+		// also frees the faces
+		FT_Done_FreeType(Library);
+	}
+
+public:
+	CGlyphRasterizeJob(const std::vector<FT_Face> &vFaces, const SHA256_DIGEST &FontKey, IOHANDLE CacheFile, std::vector<SRequest> &&vRequests) :
+		m_vFaces(vFaces),
+		m_FontKey(FontKey),
+		m_CacheFile(CacheFile),
+		m_ReadsCache(CacheFile != nullptr),
+		m_vRequests(std::move(vRequests))
+	{
+		Abortable(true);
+	}
+
+	~CGlyphRasterizeJob() override
+	{
+		if(m_CacheFile)
+			io_close(m_CacheFile);
+	}
+
+	bool ReadsCache() const { return m_ReadsCache; }
+	std::vector<SGlyphBitmap> &Results() { return m_vResults; }
+};
+
 class CAtlas
 {
 	struct SSectionKeyHash
@@ -322,8 +579,25 @@ private:
 	 */
 	static constexpr int REPLACEMENT_CHARACTER = 0x25a1;
 
+	/**
+	 * The maximum number of glyphs saved in the glyph cache file.
+	 */
+	static constexpr size_t MAX_CACHED_GLYPHS = 16 * 1024;
+
+	/**
+	 * The number of font sizes which are prewarmed for new text.
+	 */
+	static constexpr int NUM_PREWARM_FONT_SIZES = 6;
+
+	/**
+	 * Results of rasterize jobs with more glyphs than this are written to the
+	 * atlas first and uploaded with a single texture update.
+	 */
+	static constexpr size_t FULL_UPLOAD_GLYPH_THRESHOLD = 64;
+
 	IGraphics *m_pGraphics;
 	IGraphics *Graphics() { return m_pGraphics; }
+	IEngine *m_pEngine;
 
 	// Atlas textures and data
 	IGraphics::CTextureHandle m_aTextures[NUM_FONT_TEXTURES];
@@ -333,6 +607,12 @@ private:
 	uint8_t *m_apTextureData[NUM_FONT_TEXTURES];
 	CAtlas m_TextureAtlas;
 	std::unordered_map<std::tuple<FT_Face, int, int>, SGlyph, SGlyphKeyHash, SGlyphKeyEquals> m_Glyphs;
+	// Number of glyphs added to the atlas per font size, to find the font sizes worth prewarming
+	int m_aNumGlyphsPerFontSize[MAX_FONT_SIZE + 1] = {0};
+
+	// Background rasterization, results are added to the atlas in the order the jobs were started
+	std::vector<std::shared_ptr<CGlyphRasterizeJob>> m_vpRasterizeJobs;
+	SHA256_DIGEST m_FontKey = SHA256_ZEROED;
 
 	// Font faces
 	FT_Face m_DefaultFace = nullptr;
@@ -425,7 +705,12 @@ private:
 
 	FT_UInt GetCharGlyph(int Chr, FT_Face *pFace, bool AllowReplacementCharacter)
 	{
-		for(FT_Face Face : {m_SelectedFace, m_DefaultFace, m_VariantFace})
+		return GetCharGlyph(Chr, m_SelectedFace, pFace, AllowReplacementCharacter);
+	}
+
+	FT_UInt GetCharGlyph(int Chr, FT_Face SelectedFace, FT_Face *pFace, bool AllowReplacementCharacter)
+	{
+		for(FT_Face Face : {SelectedFace, m_DefaultFace, m_VariantFace})
 		{
 			if(Face && Face->charmap)
 			{
@@ -468,50 +753,27 @@ private:
 		return GlyphIndex;
 	}
 
-	void Grow(const unsigned char *pIn, unsigned char *pOut, int w, int h, int OutlineCount) const
+	void WriteGlyph(int TextureIndex, int PosX, int PosY, size_t Width, size_t Height, const uint8_t *pData)
 	{
-		for(int y = 0; y < h; y++)
+		for(size_t y = 0; y < Height; ++y)
 		{
-			for(int x = 0; x < w; x++)
-			{
-				int c = pIn[y * w + x];
-
-				for(int sy = -OutlineCount; sy <= OutlineCount; sy++)
-				{
-					for(int sx = -OutlineCount; sx <= OutlineCount; sx++)
-					{
-						int GetX = x + sx;
-						int GetY = y + sy;
-						if(GetX >= 0 && GetY >= 0 && GetX < w && GetY < h)
-						{
-							int Index = GetY * w + GetX;
-							float Mask = 1.f - clamp(length(vec2(sx, sy)) - OutlineCount, 0.f, 1.f);
-							c = maximum(c, int(pIn[Index] * Mask));
-						}
-					}
-				}
-
-				pOut[y * w + x] = c;
-			}
+			mem_copy(&m_apTextureData[TextureIndex][PosX + ((y + PosY) * m_TextureDimension)], &pData[y * Width], Width);
 		}
 	}
 
-	int AdjustOutlineThicknessToFontSize(int OutlineThickness, int FontSize) const
+	void UploadGlyph(int TextureIndex, int PosX, int PosY, size_t Width, size_t Height, const uint8_t *pData)
 	{
-		if(FontSize > 48)
-			OutlineThickness *= 4;
-		else if(FontSize >= 18)
-			OutlineThickness *= 2;
-		return OutlineThickness;
+		WriteGlyph(TextureIndex, PosX, PosY, Width, Height, pData);
+		const size_t GlyphDataSize = Width * Height;
+		uint8_t *pUploadData = static_cast<uint8_t *>(malloc(GlyphDataSize));
+		mem_copy(pUploadData, pData, GlyphDataSize);
+		Graphics()->UpdateTextTexture(m_aTextures[TextureIndex], PosX, PosY, Width, Height, pUploadData, true);
 	}
 
-	void UploadGlyph(int TextureIndex, int PosX, int PosY, size_t Width, size_t Height, uint8_t *pData)
+	void UploadTexturesFull()
 	{
-		for(size_t y = 0; y < Height; ++y)
-		{
-			mem_copy(&m_apTextureData[TextureIndex][PosX + ((y + PosY) * m_TextureDimension)], &pData[y * Width], Width);
-		}
-		Graphics()->UpdateTextTexture(m_aTextures[TextureIndex], PosX, PosY, Width, Height, pData, true);
+		for(size_t TextureIndex = 0; TextureIndex < NUM_FONT_TEXTURES; ++TextureIndex)
+			Graphics()->UpdateTextTexture(m_aTextures[TextureIndex], 0, 0, m_TextureDimension, m_TextureDimension, m_apTextureData[TextureIndex], false);
 	}
 
 	bool FitGlyph(size_t Width, size_t Height, int &PosX, int &PosY)
@@ -519,95 +781,141 @@ private:
 		return m_TextureAtlas.Add(Width, Height, PosX, PosY);
 	}
 
-	bool RenderGlyph(SGlyph &Glyph)
+	// Places a rasterized glyph in the atlas, the textures are only updated if Upload is set
+	bool AddGlyph(SGlyph &Glyph, const SGlyphBitmap &Bitmap, bool Upload)
 	{
-		FT_Set_Pixel_Sizes(Glyph.m_Face, 0, Glyph.m_FontSize);
-
-		if(FT_Load_Glyph(Glyph.m_Face, Glyph.m_GlyphIndex, FT_LOAD_RENDER | FT_LOAD_NO_BITMAP))
-		{
-			log_debug("textrender", "Error loading glyph. Chr=%d GlyphIndex=%u", Glyph.m_Chr, Glyph.m_GlyphIndex);
-			return false;
-		}
-
-		const FT_Bitmap *pBitmap = &Glyph.m_Face->glyph->bitmap;
-		if(pBitmap->pixel_mode != FT_PIXEL_MODE_GRAY)
-		{
-			log_debug("textrender", "Error loading glyph, unsupported pixel mode. Chr=%d GlyphIndex=%u PixelMode=%d", Glyph.m_Chr, Glyph.m_GlyphIndex, pBitmap->pixel_mode);
-			return false;
-		}
-
-		const unsigned RealWidth = pBitmap->width;
-		const unsigned RealHeight = pBitmap->rows;
-
-		// adjust spacing
-		int OutlineThickness = 0;
-		int x = 0;
-		int y = 0;
-		if(RealWidth > 0)
-		{
-			OutlineThickness = AdjustOutlineThicknessToFontSize(1, Glyph.m_FontSize);
-			x += (OutlineThickness + 1);
-			y += (OutlineThickness + 1);
-		}
-
-		const unsigned Width = RealWidth + x * 2;
-		const unsigned Height = RealHeight + y * 2;
-
 		int X = 0;
 		int Y = 0;
 
-		if(Width > 0 && Height > 0)
+		if(Bitmap.m_Width > 0 && Bitmap.m_Height > 0)
 		{
 			// find space in atlas, or increase size if necessary
-			while(!FitGlyph(Width, Height, X, Y))
+			while(!FitGlyph(Bitmap.m_Width, Bitmap.m_Height, X, Y))
 			{
 				if(!IncreaseGlyphMapSize())
 				{
-					log_debug("textrender", "Cannot fit glyph into atlas, which is already at maximum size. Chr=%d GlyphIndex=%u", Glyph.m_Chr, Glyph.m_GlyphIndex);
+					log_debug("textrender", "Cannot fit glyph into atlas, which is already at maximum size. Chr=%d GlyphIndex=%u", Bitmap.m_Chr, Bitmap.m_GlyphIndex);
 					return false;
 				}
 			}
 
-			// prepare glyph data
-			const size_t GlyphDataSize = (size_t)Width * Height * sizeof(uint8_t);
-			uint8_t *pGlyphDataFill = static_cast<uint8_t *>(malloc(GlyphDataSize));
-			uint8_t *pGlyphDataOutline = static_cast<uint8_t *>(malloc(GlyphDataSize));
-			mem_zero(pGlyphDataFill, GlyphDataSize);
-			for(unsigned py = 0; py < pBitmap->rows; ++py)
+			if(Upload)
 			{
-				mem_copy(&pGlyphDataFill[(py + y) * Width + x], &pBitmap->buffer[py * pBitmap->width], pBitmap->width);
+				UploadGlyph(FONT_TEXTURE_FILL, X, Y, Bitmap.m_Width, Bitmap.m_Height, Bitmap.m_vFill.data());
+				UploadGlyph(FONT_TEXTURE_OUTLINE, X, Y, Bitmap.m_Width, Bitmap.m_Height, Bitmap.m_vOutline.data());
+			}
+			else
+			{
+				WriteGlyph(FONT_TEXTURE_FILL, X, Y, Bitmap.m_Width, Bitmap.m_Height, Bitmap.m_vFill.data());
+				WriteGlyph(FONT_TEXTURE_OUTLINE, X, Y, Bitmap.m_Width, Bitmap.m_Height, Bitmap.m_vOutline.data());
 			}
-			Grow(pGlyphDataFill, pGlyphDataOutline, Width, Height, OutlineThickness);
-
-			// upload the glyph
-			UploadGlyph(FONT_TEXTURE_FILL, X, Y, Width, Height, pGlyphDataFill);
-			UploadGlyph(FONT_TEXTURE_OUTLINE, X, Y, Width, Height, pGlyphDataOutline);
 		}
 
 		// set glyph info
 		{
-			Glyph.m_Height = Height;
-			Glyph.m_Width = Width;
-			Glyph.m_CharHeight = RealHeight;
-			Glyph.m_CharWidth = RealWidth;
-			Glyph.m_OffsetX = (Glyph.m_Face->glyph->metrics.horiBearingX >> 6);
-			Glyph.m_OffsetY = -((Glyph.m_Face->glyph->metrics.height >> 6) - (Glyph.m_Face->glyph->metrics.horiBearingY >> 6));
-			Glyph.m_AdvanceX = (Glyph.m_Face->glyph->advance.x >> 6);
+			Glyph.m_FontSize = Bitmap.m_FontSize;
+			Glyph.m_Face = Bitmap.m_Face;
+			Glyph.m_Chr = Bitmap.m_Chr;
+			Glyph.m_GlyphIndex = Bitmap.m_GlyphIndex;
+
+			Glyph.m_Height = Bitmap.m_Height;
+			Glyph.m_Width = Bitmap.m_Width;
+			Glyph.m_CharHeight = Bitmap.m_CharHeight;
+			Glyph.m_CharWidth = Bitmap.m_CharWidth;
+			Glyph.m_OffsetX = Bitmap.m_OffsetX;
+			Glyph.m_OffsetY = Bitmap.m_OffsetY;
+			Glyph.m_AdvanceX = Bitmap.m_AdvanceX;
 
 			Glyph.m_aUVs[0] = X;
 			Glyph.m_aUVs[1] = Y;
-			Glyph.m_aUVs[2] = Glyph.m_aUVs[0] + Width;
-			Glyph.m_aUVs[3] = Glyph.m_aUVs[1] + Height;
+			Glyph.m_aUVs[2] = Glyph.m_aUVs[0] + Bitmap.m_Width;
+			Glyph.m_aUVs[3] = Glyph.m_aUVs[1] + Bitmap.m_Height;
 
 			Glyph.m_State = SGlyph::EState::RENDERED;
 		}
+		m_aNumGlyphsPerFontSize[Bitmap.m_FontSize]++;
 		return true;
 	}
 
+	bool RenderGlyph(SGlyph &Glyph)
+	{
+		SGlyphBitmap Bitmap;
+		if(!RasterizeGlyph(Glyph.m_Face, Glyph.m_GlyphIndex, Glyph.m_Chr, Glyph.m_FontSize, Bitmap))
+			return false;
+		return AddGlyph(Glyph, Bitmap, true);
+	}
+
+	// Whether GetGlyph would use this face and glyph for the character with any font preset
+	bool IsGlyphFace(int Chr, FT_Face Face, FT_UInt GlyphIndex)
+	{
+		for(FT_Face SelectedFace : {(FT_Face) nullptr, m_IconFace})
+		{
+			FT_Face ResolvedFace;
+			if(GetCharGlyph(Chr, SelectedFace, &ResolvedFace, false) == GlyphIndex && ResolvedFace == Face)
+				return true;
+		}
+		return false;
+	}
+
+	void QueueGlyph(std::vector<CGlyphRasterizeJob::SRequest> &vRequests, int Chr, int FontSize)
+	{
+		FT_Face Face;
+		const FT_UInt GlyphIndex = GetCharGlyph(Chr, &Face, false);
+		if(GlyphIndex == 0)
+			return;
+		SGlyph &Glyph = m_Glyphs[std::make_tuple(Face, Chr, FontSize)];
+		if(Glyph.m_State != SGlyph::EState::UNINITIALIZED)
+			return;
+		Glyph.m_State = SGlyph::EState::QUEUED;
+		vRequests.push_back({Face, Chr, GlyphIndex, FontSize});
+	}
+
+	void StartRasterizeJob(IOHANDLE CacheFile, std::vector<CGlyphRasterizeJob::SRequest> &&vRequests)
+	{
+		if(CacheFile == nullptr && vRequests.empty())
+			return;
+		auto pJob = std::make_shared<CGlyphRasterizeJob>(m_vFtFaces, m_FontKey, CacheFile, std::move(vRequests));
+		m_pEngine->AddJob(pJob);
+		m_vpRasterizeJobs.push_back(std::move(pJob));
+	}
+
+	// Font sizes with the most glyphs, most used first
+	std::vector<int> PrewarmFontSizes() const
+	{
+		std::vector<int> vFontSizes;
+		for(int FontSize = MIN_FONT_SIZE; FontSize <= MAX_FONT_SIZE; FontSize++)
+		{
+			if(m_aNumGlyphsPerFontSize[FontSize] > 0)
+				vFontSizes.push_back(FontSize);
+		}
+		std::stable_sort(vFontSizes.begin(), vFontSizes.end(), [&](int Lhs, int Rhs) {
+			return m_aNumGlyphsPerFontSize[Lhs] > m_aNumGlyphsPerFontSize[Rhs];
+		});
+		if(vFontSizes.size() > (size_t)NUM_PREWARM_FONT_SIZES)
+			vFontSizes.resize(NUM_PREWARM_FONT_SIZES);
+		return vFontSizes;
+	}
+
+	// Printable ASCII and Latin-1 are needed by almost every text
+	void PrewarmCommonRanges()
+	{
+		std::vector<CGlyphRasterizeJob::SRequest> vRequests;
+		for(int FontSize : PrewarmFontSizes())
+		{
+			for(int Chr = 0x20; Chr <= 0xff; Chr++)
+			{
+				if(Chr < 0x7f || Chr >= 0xa0)
+					QueueGlyph(vRequests, Chr, FontSize);
+			}
+		}
+		StartRasterizeJob(nullptr, std::move(vRequests));
+	}
+
 public:
-	CGlyphMap(IGraphics *pGraphics)
+	CGlyphMap(IGraphics *pGraphics, IEngine *pEngine)
 	{
 		m_pGraphics = pGraphics;
+		m_pEngine = pEngine;
 		for(auto &pTextureData : m_apTextureData)
 		{
 			pTextureData = new uint8_t[m_TextureDimension * m_TextureDimension];
@@ -620,6 +928,10 @@ public:
 
 	~CGlyphMap()
 	{
+		// the job pool is shut down before the text render, so no job can still be running
+		for(auto &pJob : m_vpRasterizeJobs)
+			pJob->Abort();
+		m_vpRasterizeJobs.clear();
 		UnloadTextures();
 		for(auto &pTextureData : m_apTextureData)
 		{
@@ -728,6 +1040,147 @@ public:
 		m_Glyphs.clear();
 	}
 
+	/**
+	 * Identifies the loaded font faces, so cached glyphs are only used with the fonts they were rendered with.
+	 */
+	void UpdateFontKey()
+	{
+		char aFreetypeVersion[32];
+		str_format(aFreetypeVersion, sizeof(aFreetypeVersion), "%d.%d.%d", FREETYPE_MAJOR, FREETYPE_MINOR, FREETYPE_PATCH);
+		std::string FontDescription = aFreetypeVersion;
+		for(FT_Face Face : m_vFtFaces)
+		{
+			char aFace[FONT_NAME_SIZE * 2 + 64];
+			str_format(aFace, sizeof(aFace), "|%s|%s|%ld|%ld|%lu", Face->family_name, Face->style_name, Face->face_index, Face->num_glyphs, Face->stream->size);
+			FontDescription += aFace;
+		}
+		m_FontKey = sha256(FontDescription.c_str(), FontDescription.size());
+	}
+
+	/**
+	 * Reads the glyph cache file in the background and prewarms common glyphs afterwards.
+	 *
+	 * @param File The glyph cache file, which is closed by the glyph map.
+	 */
+	void LoadCache(IOHANDLE File)
+	{
+		StartRasterizeJob(File, {});
+	}
+
+	// Writes the glyph cache and closes the file, returns false if writing failed
+	bool SaveCache(IOHANDLE File) const
+	{
+		std::vector<std::pair<const std::tuple<FT_Face, int, int> *, const SGlyph *>> vpGlyphs;
+		for(const auto &[Key, Glyph] : m_Glyphs)
+		{
+			// replacement characters are stored under the key of the missing character
+			if(Glyph.m_State != SGlyph::EState::RENDERED || std::get<0>(Key) != Glyph.m_Face || std::get<1>(Key) != Glyph.m_Chr)
+				continue;
+			vpGlyphs.emplace_back(&Key, &Glyph);
+			if(vpGlyphs.size() >= MAX_CACHED_GLYPHS)
+				break;
+		}
+
+		SGlyphCacheHeader Header;
+		mem_copy(Header.m_aMagic, SGlyphCacheHeader::MAGIC, sizeof(Header.m_aMagic));
+		Header.m_Version = SGlyphCacheHeader::VERSION;
+		Header.m_FontKey = m_FontKey;
+		Header.m_NumGlyphs = vpGlyphs.size();
+		io_write(File, &Header, sizeof(Header));
+
+		std::vector<uint8_t> vGlyphData;
+		for(const auto &[pKey, pGlyph] : vpGlyphs)
+		{
+			SGlyphCacheEntry Entry;
+			Entry.m_FaceIndex = std::find(m_vFtFaces.begin(), m_vFtFaces.end(), pGlyph->m_Face) - m_vFtFaces.begin();
+			Entry.m_Chr = pGlyph->m_Chr;
+			Entry.m_FontSize = pGlyph->m_FontSize;
+			Entry.m_GlyphIndex = pGlyph->m_GlyphIndex;
+			Entry.m_Width = pGlyph->m_Width;
+			Entry.m_Height = pGlyph->m_Height;
+			Entry.m_CharWidth = pGlyph->m_CharWidth;
+			Entry.m_CharHeight = pGlyph->m_CharHeight;
+			Entry.m_OffsetX = pGlyph->m_OffsetX;
+			Entry.m_OffsetY = pGlyph->m_OffsetY;
+			Entry.m_AdvanceX = pGlyph->m_AdvanceX;
+			io_write(File, &Entry, sizeof(Entry));
+
+			// the atlas keeps a copy of all glyph bitmaps
+			vGlyphData.resize((size_t)Entry.m_Width * Entry.m_Height);
+			for(const uint8_t *pTextureData : m_apTextureData)
+			{
+				for(size_t y = 0; y < Entry.m_Height; ++y)
+					mem_copy(&vGlyphData[y * Entry.m_Width], &pTextureData[(size_t)pGlyph->m_aUVs[0] + ((y + (size_t)pGlyph->m_aUVs[1]) * m_TextureDimension)], Entry.m_Width);
+				io_write(File, vGlyphData.data(), vGlyphData.size());
+			}
+		}
+		const bool Failed = io_error(File) != 0;
+		if(io_close(File) != 0 || Failed)
+			return false;
+		log_debug("textrender", "Saved %" PRIzu " glyphs to glyph cache", vpGlyphs.size());
+		return true;
+	}
+
+	/**
+	 * Adds the glyphs of finished rasterize jobs to the atlas.
+	 */
+	void UpdateRasterizeJobs()
+	{
+		while(!m_vpRasterizeJobs.empty() && m_vpRasterizeJobs.front()->Done())
+		{
+			const std::shared_ptr<CGlyphRasterizeJob> pJob = m_vpRasterizeJobs.front();
+			m_vpRasterizeJobs.erase(m_vpRasterizeJobs.begin());
+			if(pJob->State() != IJob::STATE_DONE)
+				continue;
+
+			const bool FullUpload = pJob->Results().size() > FULL_UPLOAD_GLYPH_THRESHOLD;
+			for(const SGlyphBitmap &Bitmap : pJob->Results())
+			{
+				if(Bitmap.m_FontSize < MIN_FONT_SIZE || Bitmap.m_FontSize > MAX_FONT_SIZE)
+					continue;
+				const auto Key = std::make_tuple(Bitmap.m_Face, Bitmap.m_Chr, Bitmap.m_FontSize);
+				auto GlyphIt = m_Glyphs.find(Key);
+				if(GlyphIt != m_Glyphs.end() && (GlyphIt->second.m_State == SGlyph::EState::RENDERED || GlyphIt->second.m_State == SGlyph::EState::ERROR))
+					continue;
+				// the fonts may have changed since the job was started
+				if(!IsGlyphFace(Bitmap.m_Chr, Bitmap.m_Face, Bitmap.m_GlyphIndex))
+				{
+					if(GlyphIt != m_Glyphs.end())
+						m_Glyphs.erase(GlyphIt);
+					continue;
+				}
+				SGlyph &Glyph = GlyphIt != m_Glyphs.end() ? GlyphIt->second : m_Glyphs[Key];
+				if(!AddGlyph(Glyph, Bitmap, !FullUpload))
+					Glyph.m_State = SGlyph::EState::UNINITIALIZED;
+			}
+			if(FullUpload)
+				UploadTexturesFull();
+			if(pJob->ReadsCache())
+				PrewarmCommonRanges();
+		}
+	}
+
+	/**
+	 * Rasterizes the glyphs of the text in the background in the font sizes used the most so far.
+	 */
+	void PrewarmText(const char *pText)
+	{
+		const std::vector<int> vFontSizes = PrewarmFontSizes();
+		if(vFontSizes.empty())
+			return;
+
+		std::vector<CGlyphRasterizeJob::SRequest> vRequests;
+		while(*pText)
+		{
+			const int Chr = str_utf8_decode(&pText);
+			if(Chr <= 0)
+				continue;
+			for(int FontSize : vFontSizes)
+				QueueGlyph(vRequests, Chr, FontSize);
+		}
+		StartRasterizeJob(nullptr, std::move(vRequests));
+	}
+
 	const SGlyph *GetGlyph(int Chr, int FontSize)
 	{
 		FontSize = clamp(FontSize, MIN_FONT_SIZE, MAX_FONT_SIZE);
@@ -959,12 +1412,14 @@ class CTextRender : public IEngineTextRender
 	IConsole *m_pConsole;
 	IGraphics *m_pGraphics;
 	IStorage *m_pStorage;
+	IEngine *m_pEngine;
 	IConsole *Console() { return m_pConsole; }
 	IGraphics *Graphics() { return m_pGraphics; }
 	IStorage *Storage() { return m_pStorage; }
 
 	CGlyphMap *m_pGlyphMap;
 	std::vector<void *> m_vpFontData;
+	bool m_FontsLoaded = false;
 
 	std::vector<SFontLanguageVariant> m_vVariants;
 
@@ -1102,6 +1557,7 @@ public:
 		m_pConsole = nullptr;
 		m_pGraphics = nullptr;
 		m_pStorage = nullptr;
+		m_pEngine = nullptr;
 		m_pGlyphMap = nullptr;
 
 		m_Color = DefaultTextColor();
@@ -1119,8 +1575,9 @@ public:
 		m_pConsole = Kernel()->RequestInterface<IConsole>();
 		m_pGraphics = Kernel()->RequestInterface<IGraphics>();
 		m_pStorage = Kernel()->RequestInterface<IStorage>();
+		m_pEngine = Kernel()->RequestInterface<IEngine>();
 		FT_Init_FreeType(&m_FTLibrary);
-		m_pGlyphMap = new CGlyphMap(m_pGraphics);
+		m_pGlyphMap = new CGlyphMap(m_pGraphics, m_pEngine);
 
 		// print freetype version
 		{
@@ -1165,6 +1622,26 @@ public:
 			delete pTextCont;
 		m_vpTextContainers.clear();
 
+		if(m_FontsLoaded && g_Config.m_ClTextGlyphCache)
+		{
+			// write to a temporary file first, so a crash can't leave a partial cache behind
+			char aCacheFileTmp[IO_MAX_PATH_LENGTH];
+			IOHANDLE File = Storage()->OpenFile(IStorage::FormatTmpPath(aCacheFileTmp, sizeof(aCacheFileTmp), GLYPH_CACHE_FILE), IOFLAG_WRITE, IStorage::TYPE_SAVE);
+			if(!File)
+			{
+				log_error("textrender", "Failed to open glyph cache '%s' for writing", aCacheFileTmp);
+			}
+			else if(!m_pGlyphMap->SaveCache(File))
+			{
+				log_error("textrender", "Failed to write glyph cache '%s'", aCacheFileTmp);
+				Storage()->RemoveFile(aCacheFileTmp, IStorage::TYPE_SAVE);
+			}
+			else if(!Storage()->RenameFile(aCacheFileTmp, GLYPH_CACHE_FILE, IStorage::TYPE_SAVE))
+			{
+				log_error("textrender", "Failed to rename '%s' to glyph cache '%s'", aCacheFileTmp, GLYPH_CACHE_FILE);
+			}
+		}
+
 		delete m_pGlyphMap;
 		m_pGlyphMap = nullptr;
 
@@ -1181,6 +1658,7 @@ public:
 		m_pConsole = nullptr;
 		m_pGraphics = nullptr;
 		m_pStorage = nullptr;
+		m_pEngine = nullptr;
 	}
 	// TClient
 	static int LaziestFileCallback(const char *pFilename, int IsDir, int StorageType, void *pUser)
@@ -1419,9 +1897,23 @@ public:
 		}
 
 		json_value_free(pJsonData);
+
+		m_FontsLoaded = true;
+		m_pGlyphMap->UpdateFontKey();
+		if(g_Config.m_ClTextGlyphCache)
+		{
+			IOHANDLE File = Storage()->OpenFile(GLYPH_CACHE_FILE, IOFLAG_READ, IStorage::TYPE_SAVE);
+			if(File)
+				m_pGlyphMap->LoadCache(File);
+		}
 		return Success;
 	}
 
+	void PrewarmText(const char *pText) override
+	{
+		m_pGlyphMap->PrewarmText(pText);
+	}
+
 	void SetFontPreset(EFontPreset FontPreset) override
 	{
 		m_pGlyphMap->SetFontPreset(FontPreset);
@@ -1651,6 +2143,8 @@ public:
 
 	void AppendTextContainer(STextContainerIndex TextContainerIndex, CTextCursor *pCursor, const char *pText, int Length = -1) override
 	{
+		m_pGlyphMap->UpdateRasterizeJobs();
+
 		STextContainer &TextContainer = GetTextContainer(TextContainerIndex);
 		str_append(TextContainer.m_aDebugText, pText);
 
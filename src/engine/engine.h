@@ -6,8 +6,10 @@
 #include "kernel.h"
 
 #include <memory>
+#include <vector>
 
 class CFutureLogger;
+class CJobQueueStats;
 class IJob;
 class ILogger;
 
@@ -21,6 +23,7 @@ public:
 	virtual void Init() = 0;
 	virtual void AddJob(std::shared_ptr<IJob> pJob) = 0;
 	virtual void ShutdownJobs() = 0;
+	virtual void GetJobStats(std::vector<CJobQueueStats> &vStats) = 0;
 	virtual void SetAdditionalLogger(std::shared_ptr<ILogger> &&pLogger) = 0;
 };
 
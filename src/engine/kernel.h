@@ -36,6 +36,7 @@ class IKernel
 	virtual void RegisterInterfaceImpl(const char *pInterfaceName, IInterface *pInterface, bool Destroy) = 0;
 	virtual void ReregisterInterfaceImpl(const char *pInterfaceName, IInterface *pInterface) = 0;
 	virtual IInterface *RequestInterfaceImpl(const char *pInterfaceName) = 0;
+	virtual IInterface *FindInterfaceImpl(const char *pInterfaceName) = 0;
 
 public:
 	static IKernel *Create();
@@ -61,6 +62,13 @@ public:
 	{
 		return reinterpret_cast<TINTERFACE *>(RequestInterfaceImpl(TINTERFACE::InterfaceName()));
 	}
+
+	// like RequestInterface, but returns nullptr if the interface is not registered
+	template<class TINTERFACE>
+	TINTERFACE *FindInterface()
+	{
+		return reinterpret_cast<TINTERFACE *>(FindInterfaceImpl(TINTERFACE::InterfaceName()));
+	}
 };
 
 #endif
@@ -7,6 +7,8 @@
 #include <base/hash.h>
 #include <base/types.h>
 
+#include <vector>
+
 enum
 {
 	MAX_MAP_LENGTH = 128
@@ -21,6 +23,7 @@ public:
 	virtual void *GetDataSwapped(int Index) = 0;
 	virtual const char *GetDataString(int Index) = 0;
 	virtual void UnloadData(int Index) = 0;
+	virtual void PrefetchData(const std::vector<int> &vIndices) = 0; // loads the data in parallel on the job pool
 	virtual int NumData() const = 0;
 
 	virtual int GetItemSize(int Index) = 0;
@@ -35,7 +38,8 @@ class IEngineMap : public IMap
 {
 	MACRO_INTERFACE("enginemap")
 public:
-	virtual bool Load(const char *pMapName) = 0;
+	// only allow mapping the file into memory if it is never changed in place, see CDataFileReader::Open
+	virtual bool Load(const char *pMapName, bool AllowMapping = false) = 0;
 	virtual void Unload() = 0;
 	virtual bool IsLoaded() const = 0;
 	virtual IOHANDLE File() const = 0;
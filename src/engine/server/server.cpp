@@ -946,7 +946,12 @@ void CServer::DoSnapshot()
 			m_aDemoRecorder[RECORDER_AUTO].RecordSnapshot(Tick(), aData, SnapshotSize);
 	}
 
+	if(Config()->m_SvSnapshotThreads != m_SnapshotWorkers.NumThreads())
+		InitSnapshotWorkers(Config()->m_SvSnapshotThreads);
+	const bool Threaded = m_SnapshotWorkers.NumThreads() > 0;
+
 	// create snapshots for all clients
+	int NumJobs = 0;
 	for(int i = 0; i < MaxClients(); i++)
 	{
 		// client must be ingame to receive snapshots
@@ -961,101 +966,153 @@ void CServer::DoSnapshot()
 		if(m_aClients[i].m_SnapRate == CClient::SNAPRATE_INIT && (Tick() % 10) != 0)
 			continue;
 
+		// the game state is only accessed on the tick thread, the finished
+		// snapshot is all the snapshot workers get to see
+		CSnapshotJob *pJob = SnapshotJob(Threaded ? NumJobs++ : 0);
+		pJob->m_ClientId = i;
+
+		m_SnapshotBuilder.Init(m_aClients[i].m_Sixup);
+
+		GameServer()->OnSnap(i);
+
+		// finish snapshot
+		pJob->m_SnapshotSize = m_SnapshotBuilder.Finish(pJob->m_aSnapshotData);
+
+		if(m_aDemoRecorder[i].IsRecording())
 		{
-			m_SnapshotBuilder.Init(m_aClients[i].m_Sixup);
+			// write snapshot
+			m_aDemoRecorder[i].RecordSnapshot(Tick(), pJob->m_aSnapshotData, pJob->m_SnapshotSize);
+		}
 
-			GameServer()->OnSnap(i);
+		if(!Threaded)
+		{
+			char aDeltaData[CSnapshot::MAX_SIZE];
+			CreateSnapshotDelta(pJob, aDeltaData);
+			SendSnapshot(pJob);
+		}
+	}
 
-			// finish snapshot
-			char aData[CSnapshot::MAX_SIZE];
-			CSnapshot *pData = (CSnapshot *)aData; // Fix compiler warning for strict-aliasing
-			int SnapshotSize = m_SnapshotBuilder.Finish(pData);
+	if(Threaded)
+	{
+		m_SnapshotWorkers.Process(NumJobs, [this](int Worker, int Job) {
+			CSnapshotWorkerData *pWorkerData = m_vpSnapshotWorkerData[Worker].get();
+			CreateSnapshotDelta(m_apSnapshotJobs[Job].get(), pWorkerData->m_aDeltaData);
+		});
 
-			if(m_aDemoRecorder[i].IsRecording())
-			{
-				// write snapshot
-				m_aDemoRecorder[i].RecordSnapshot(Tick(), aData, SnapshotSize);
-			}
+		// the network is not thread-safe, send in client order like the tick thread would
+		for(int Job = 0; Job < NumJobs; Job++)
+			SendSnapshot(m_apSnapshotJobs[Job].get());
+	}
 
-			int Crc = pData->Crc();
+	GameServer()->OnPostSnap();
+}
 
-			// remove old snapshots
-			// keep 3 seconds worth of snapshots
-			m_aClients[i].m_Snapshots.PurgeUntil(m_CurrentGameTick - TickSpeed() * 3);
+void CServer::InitSnapshotWorkers(int NumThreads)
+{
+	m_SnapshotWorkers.Init(NumThreads);
+	m_vpSnapshotWorkerData.clear();
+	if(NumThreads <= 0)
+		return;
 
-			// save the snapshot
-			m_aClients[i].m_Snapshots.Add(m_CurrentGameTick, time_get(), SnapshotSize, pData, 0, nullptr);
+	for(int i = 0; i < m_SnapshotWorkers.NumWorkers(); i++)
+		m_vpSnapshotWorkerData.push_back(std::make_unique<CSnapshotWorkerData>());
+	log_info("server", "creating snapshot deltas on %d threads", m_SnapshotWorkers.NumWorkers());
+}
 
-			// find snapshot that we can perform delta against
-			int DeltaTick = -1;
-			const CSnapshot *pDeltashot = CSnapshot::EmptySnapshot();
-			{
-				int DeltashotSize = m_aClients[i].m_Snapshots.Get(m_aClients[i].m_LastAckedSnapshot, nullptr, &pDeltashot, nullptr);
-				if(DeltashotSize >= 0)
-					DeltaTick = m_aClients[i].m_LastAckedSnapshot;
-				else
-				{
-					// no acked package found, force client to recover rate
-					if(m_aClients[i].m_SnapRate == CClient::SNAPRATE_FULL)
-						m_aClients[i].m_SnapRate = CClient::SNAPRATE_RECOVER;
-				}
-			}
+CServer::CSnapshotJob *CServer::SnapshotJob(int Index)
+{
+	if(!m_apSnapshotJobs[Index])
+		m_apSnapshotJobs[Index] = std::make_unique<CSnapshotJob>();
+	return m_apSnapshotJobs[Index].get();
+}
 
-			// create delta
-			m_SnapshotDelta.SetStaticsize(protocol7::NETEVENTTYPE_SOUNDWORLD, m_aClients[i].m_Sixup);
-			m_SnapshotDelta.SetStaticsize(protocol7::NETEVENTTYPE_DAMAGE, m_aClients[i].m_Sixup);
-			char aDeltaData[CSnapshot::MAX_SIZE];
-			int DeltaSize = m_SnapshotDelta.CreateDelta(pDeltashot, pData, aDeltaData);
+void CServer::CreateSnapshotDelta(CSnapshotJob *pJob, char *pDeltaData)
+{
+	CClient &Client = m_aClients[pJob->m_ClientId];
+	const CSnapshot *pData = (CSnapshot *)pJob->m_aSnapshotData;
 
-			if(DeltaSize)
-			{
-				// compress it
-				const int MaxSize = MAX_SNAPSHOT_PACKSIZE;
+	pJob->m_Crc = pData->Crc();
 
-				char aCompData[CSnapshot::MAX_SIZE];
-				SnapshotSize = CVariableInt::Compress(aDeltaData, DeltaSize, aCompData, sizeof(aCompData));
-				int NumPackets = (SnapshotSize + MaxSize - 1) / MaxSize;
+	// remove old snapshots
+	// keep 3 seconds worth of snapshots
+	Client.m_Snapshots.PurgeUntil(m_CurrentGameTick - TickSpeed() * 3);
 
-				for(int n = 0, Left = SnapshotSize; Left > 0; n++)
-				{
-					int Chunk = Left < MaxSize ? Left : MaxSize;
-					Left -= Chunk;
+	// save the snapshot
+	Client.m_Snapshots.Add(m_CurrentGameTick, time_get(), pJob->m_SnapshotSize, pData, 0, nullptr);
 
-					if(NumPackets == 1)
-					{
-						CMsgPacker Msg(NETMSG_SNAPSINGLE, true);
-						Msg.AddInt(m_CurrentGameTick);
-						Msg.AddInt(m_CurrentGameTick - DeltaTick);
-						Msg.AddInt(Crc);
-						Msg.AddInt(Chunk);
-						Msg.AddRaw(&aCompData[n * MaxSize], Chunk);
-						SendMsg(&Msg, MSGFLAG_FLUSH, i);
-					}
-					else
-					{
-						CMsgPacker Msg(NETMSG_SNAP, true);
-						Msg.AddInt(m_CurrentGameTick);
-						Msg.AddInt(m_CurrentGameTick - DeltaTick);
-						Msg.AddInt(NumPackets);
-						Msg.AddInt(n);
-						Msg.AddInt(Crc);
-						Msg.AddInt(Chunk);
-						Msg.AddRaw(&aCompData[n * MaxSize], Chunk);
-						SendMsg(&Msg, MSGFLAG_FLUSH, i);
-					}
-				}
+	// find snapshot that we can perform delta against
+	pJob->m_DeltaTick = -1;
+	const CSnapshot *pDeltashot = CSnapshot::EmptySnapshot();
+	{
+		int DeltashotSize = Client.m_Snapshots.Get(Client.m_LastAckedSnapshot, nullptr, &pDeltashot, nullptr);
+		if(DeltashotSize >= 0)
+			pJob->m_DeltaTick = Client.m_LastAckedSnapshot;
+		else
+		{
+			// no acked package found, force client to recover rate
+			if(Client.m_SnapRate == CClient::SNAPRATE_FULL)
+				Client.m_SnapRate = CClient::SNAPRATE_RECOVER;
+		}
+	}
+
+	// create delta, the static sizes differ per protocol so work on a copy of them
+	// instead of changing them on the delta shared by all workers
+	short aItemSizes[CSnapshotDelta::MAX_NETOBJSIZES];
+	mem_copy(aItemSizes, m_SnapshotDelta.Staticsizes(), sizeof(aItemSizes));
+	aItemSizes[protocol7::NETEVENTTYPE_SOUNDWORLD] = Client.m_Sixup;
+	aItemSizes[protocol7::NETEVENTTYPE_DAMAGE] = Client.m_Sixup;
+	int DeltaSize = CSnapshotDelta::CreateDelta(pDeltashot, pData, pDeltaData, aItemSizes);
+
+	// compress it
+	pJob->m_CompressedSize = DeltaSize ? CVariableInt::Compress(pDeltaData, DeltaSize, pJob->m_aCompressedData, sizeof(pJob->m_aCompressedData)) : 0;
+}
+
+void CServer::SendSnapshot(const CSnapshotJob *pJob)
+{
+	const int ClientId = pJob->m_ClientId;
+	const int DeltaTick = pJob->m_DeltaTick;
+
+	if(pJob->m_CompressedSize)
+	{
+		const int MaxSize = MAX_SNAPSHOT_PACKSIZE;
+		const int NumPackets = (pJob->m_CompressedSize + MaxSize - 1) / MaxSize;
+
+		for(int n = 0, Left = pJob->m_CompressedSize; Left > 0; n++)
+		{
+			int Chunk = Left < MaxSize ? Left : MaxSize;
+			Left -= Chunk;
+
+			if(NumPackets == 1)
+			{
+				CMsgPacker Msg(NETMSG_SNAPSINGLE, true);
+				Msg.AddInt(m_CurrentGameTick);
+				Msg.AddInt(m_CurrentGameTick - DeltaTick);
+				Msg.AddInt(pJob->m_Crc);
+				Msg.AddInt(Chunk);
+				Msg.AddRaw(&pJob->m_aCompressedData[n * MaxSize], Chunk);
+				SendMsg(&Msg, MSGFLAG_FLUSH, ClientId);
 			}
 			else
 			{
-				CMsgPacker Msg(NETMSG_SNAPEMPTY, true);
+				CMsgPacker Msg(NETMSG_SNAP, true);
 				Msg.AddInt(m_CurrentGameTick);
 				Msg.AddInt(m_CurrentGameTick - DeltaTick);
-				SendMsg(&Msg, MSGFLAG_FLUSH, i);
+				Msg.AddInt(NumPackets);
+				Msg.AddInt(n);
+				Msg.AddInt(pJob->m_Crc);
+				Msg.AddInt(Chunk);
+				Msg.AddRaw(&pJob->m_aCompressedData[n * MaxSize], Chunk);
+				SendMsg(&Msg, MSGFLAG_FLUSH, ClientId);
 			}
 		}
 	}
-
-	GameServer()->OnPostSnap();
+	else
+	{
+		CMsgPacker Msg(NETMSG_SNAPEMPTY, true);
+		Msg.AddInt(m_CurrentGameTick);
+		Msg.AddInt(m_CurrentGameTick - DeltaTick);
+		SendMsg(&Msg, MSGFLAG_FLUSH, ClientId);
+	}
 }
 
 int CServer::ClientRejoinCallback(int ClientId, void *pUser)
@@ -3018,6 +3075,8 @@ int CServer::Run()
 		m_GameStartTime = time_get();
 
 		UpdateServerInfo();
+		// queue everything sent during a tick and send it in one go before waiting
+		net_udp_set_batching(m_NetServer.Socket(), true);
 		while(m_RunServer < STOPPING)
 		{
 			if(NonActive)
@@ -3262,6 +3321,8 @@ int CServer::Run()
 				m_ReloadedWhenEmpty = false;
 			}
 
+			net_udp_flush(m_NetServer.Socket());
+
 			// wait for incoming data
 			if(NonActive &&
 				!m_aDemoRecorder[RECORDER_MANUAL].IsRecording() &&
@@ -3286,6 +3347,7 @@ int CServer::Run()
 				break;
 			}
 		}
+		net_udp_set_batching(m_NetServer.Socket(), false);
 	}
 	const char *pDisconnectReason = "Server shutdown";
 	if(m_aShutdownReason[0])
@@ -3306,6 +3368,7 @@ int CServer::Run()
 	m_pRegister->OnShutdown();
 	m_Econ.Shutdown();
 	m_Fifo.Shutdown();
+	m_SnapshotWorkers.Shutdown();
 	Engine()->ShutdownJobs();
 
 	GameServer()->OnShutdown(nullptr);
@@ -3882,6 +3945,27 @@ void CServer::ConDumpSqlServers(IConsole::IResult *pResult, void *pUserData)
 	}
 }
 
+void CServer::ConDumpSnapshotStorage(IConsole::IResult *pResult, void *pUserData)
+{
+	CServer *pThis = static_cast<CServer *>(pUserData);
+	char aBuf[128];
+	uint64_t TotalHeapAllocations = 0;
+	size_t TotalArenaSize = 0;
+	for(int ClientId = 0; ClientId < MAX_CLIENTS; ClientId++)
+	{
+		const CSnapshotStorage &Snapshots = pThis->m_aClients[ClientId].m_Snapshots;
+		TotalHeapAllocations += Snapshots.NumHeapAllocations();
+		TotalArenaSize += Snapshots.ArenaSize();
+		if(pThis->m_aClients[ClientId].m_State == CClient::STATE_EMPTY || (!Snapshots.NumArenaAllocations() && !Snapshots.NumHeapAllocations()))
+			continue;
+
+		str_format(aBuf, sizeof(aBuf), "id=%d arena=%" PRIu64 " heap=%" PRIu64 " arena_size=%" PRIzu "KiB", ClientId, Snapshots.NumArenaAllocations(), Snapshots.NumHeapAllocations(), Snapshots.ArenaSize() / 1024);
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
+	}
+	str_format(aBuf, sizeof(aBuf), "total heap=%" PRIu64 " arena_size=%" PRIzu "KiB", TotalHeapAllocations, TotalArenaSize / 1024);
+	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
+}
+
 void CServer::ConReloadAnnouncement(IConsole::IResult *pResult, void *pUserData)
 {
 	CServer *pThis = static_cast<CServer *>(pUserData);
@@ -4156,6 +4240,7 @@ void CServer::RegisterCommands()
 
 	Console()->Register("add_sqlserver", "s['r'|'w'] s[Database] s[Prefix] s[User] s[Password] s[IP] i[Port] ?i[SetUpDatabase ?]", CFGFLAG_SERVER | CFGFLAG_NONTEEHISTORIC, ConAddSqlServer, this, "add a sqlserver");
 	Console()->Register("dump_sqlservers", "s['r'|'w']", CFGFLAG_SERVER, ConDumpSqlServers, this, "dumps all sqlservers readservers = r, writeservers = w");
+	Console()->Register("dump_snapshot_storage", "", CFGFLAG_SERVER, ConDumpSnapshotStorage, this, "dumps how many snapshots of each client were stored in the arena and on the heap, and the arena sizes");
 
 	Console()->Register("auth_add", "s[ident] s[level] r[pw]", CFGFLAG_SERVER | CFGFLAG_NONTEEHISTORIC, ConAuthAdd, this, "Add a rcon key");
 	Console()->Register("auth_add_p", "s[ident] s[level] s[hash] s[salt]", CFGFLAG_SERVER | CFGFLAG_NONTEEHISTORIC, ConAuthAddHashed, this, "Add a prehashed rcon key");
@@ -26,6 +26,7 @@
 #include "authmanager.h"
 #include "name_ban.h"
 #include "snap_id_pool.h"
+#include "snapshot_workers.h"
 
 #if defined(CONF_UPNP)
 #include "upnp.h"
@@ -212,6 +213,29 @@ public:
 
 	CSnapshotDelta m_SnapshotDelta;
 	CSnapshotBuilder m_SnapshotBuilder;
+
+	// snapshot of a single client, built on the tick thread and turned into a delta by a snapshot worker
+	class CSnapshotJob
+	{
+	public:
+		int m_ClientId;
+		int m_SnapshotSize;
+		int m_Crc;
+		int m_DeltaTick;
+		int m_CompressedSize;
+		char m_aSnapshotData[CSnapshot::MAX_SIZE];
+		char m_aCompressedData[CSnapshot::MAX_SIZE];
+	};
+
+	class CSnapshotWorkerData
+	{
+	public:
+		char m_aDeltaData[CSnapshot::MAX_SIZE];
+	};
+
+	CSnapshotWorkers m_SnapshotWorkers;
+	std::unique_ptr<CSnapshotJob> m_apSnapshotJobs[MAX_CLIENTS];
+	std::vector<std::unique_ptr<CSnapshotWorkerData>> m_vpSnapshotWorkerData;
 	CSnapIdPool m_IdPool;
 	CNetServer m_NetServer;
 	CEcon m_Econ;
@@ -332,6 +356,10 @@ public:
 	int SendMsg(CMsgPacker *pMsg, int Flags, int ClientId) override;
 
 	void DoSnapshot();
+	void InitSnapshotWorkers(int NumThreads);
+	CSnapshotJob *SnapshotJob(int Index);
+	void CreateSnapshotDelta(CSnapshotJob *pJob, char *pDeltaData);
+	void SendSnapshot(const CSnapshotJob *pJob);
 
 	static int NewClientCallback(int ClientId, void *pUser, bool Sixup);
 	static int NewClientNoAuthCallback(int ClientId, void *pUser);
@@ -445,6 +473,7 @@ public:
 	// console commands for sqlmasters
 	static void ConAddSqlServer(IConsole::IResult *pResult, void *pUserData);
 	static void ConDumpSqlServers(IConsole::IResult *pResult, void *pUserData);
+	static void ConDumpSnapshotStorage(IConsole::IResult *pResult, void *pUserData);
 
 	static void ConReloadAnnouncement(IConsole::IResult *pResult, void *pUserData);
 	static void ConReloadMaplist(IConsole::IResult *pResult, void *pUserData);
@@ -0,0 +1,92 @@
+#include "snapshot_workers.h"
+
+#include <base/math.h>
+
+CSnapshotWorkers::~CSnapshotWorkers()
+{
+	Shutdown();
+}
+
+void CSnapshotWorkers::Init(int NumThreads)
+{
+	Shutdown();
+	if(NumThreads <= 0)
+		return;
+
+	sphore_init(&m_StartSemaphore);
+	sphore_init(&m_DoneSemaphore);
+	m_Shutdown = false;
+
+	m_vThreadData.resize(NumThreads);
+	m_vpThreads.reserve(NumThreads);
+	for(int i = 0; i < NumThreads; i++)
+	{
+		m_vThreadData[i].m_pWorkers = this;
+		m_vThreadData[i].m_Worker = i + 1;
+		m_vpThreads.push_back(thread_init(WorkerThread, &m_vThreadData[i], "snapshot worker"));
+	}
+}
+
+void CSnapshotWorkers::Shutdown()
+{
+	if(m_vpThreads.empty())
+		return;
+
+	m_Shutdown = true;
+	for(size_t i = 0; i < m_vpThreads.size(); i++)
+		sphore_signal(&m_StartSemaphore);
+	for(void *pThread : m_vpThreads)
+		thread_wait(pThread);
+	m_vpThreads.clear();
+	m_vThreadData.clear();
+
+	sphore_destroy(&m_StartSemaphore);
+	sphore_destroy(&m_DoneSemaphore);
+}
+
+void CSnapshotWorkers::WorkerThread(void *pUser)
+{
+	CThreadData *pData = static_cast<CThreadData *>(pUser);
+	CSnapshotWorkers *pThis = pData->m_pWorkers;
+	while(true)
+	{
+		sphore_wait(&pThis->m_StartSemaphore);
+		if(pThis->m_Shutdown)
+			break;
+		pThis->ProcessItems(pData->m_Worker);
+		sphore_signal(&pThis->m_DoneSemaphore);
+	}
+}
+
+void CSnapshotWorkers::ProcessItems(int Worker)
+{
+	while(true)
+	{
+		const int Item = m_NextItem.fetch_add(1);
+		if(Item >= m_NumItems)
+			break;
+		(*m_pfnProcess)(Worker, Item);
+	}
+}
+
+void CSnapshotWorkers::Process(int NumItems, const FProcess &pfnProcess)
+{
+	if(NumItems <= 0)
+		return;
+
+	m_pfnProcess = &pfnProcess;
+	m_NumItems = NumItems;
+	m_NextItem = 0;
+
+	// don't wake more threads than there are items for
+	const int NumWoken = minimum(NumThreads(), NumItems - 1);
+	for(int i = 0; i < NumWoken; i++)
+		sphore_signal(&m_StartSemaphore);
+
+	ProcessItems(0);
+
+	for(int i = 0; i < NumWoken; i++)
+		sphore_wait(&m_DoneSemaphore);
+
+	m_pfnProcess = nullptr;
+}
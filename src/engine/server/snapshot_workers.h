@@ -0,0 +1,70 @@
+#ifndef ENGINE_SERVER_SNAPSHOT_WORKERS_H
+#define ENGINE_SERVER_SNAPSHOT_WORKERS_H
+
+#include <base/system.h>
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+/**
+ * A fixed set of worker threads that processes a batch of independent work
+ * items and blocks the calling thread until the whole batch is done.
+ *
+ * The calling thread takes part in processing the batch as worker 0, so a
+ * pool without threads runs every item on the calling thread.
+ */
+class CSnapshotWorkers
+{
+public:
+	/**
+	 * Processes a single work item.
+	 *
+	 * @param Worker Index of the worker processing the item, from 0 to `NumWorkers() - 1`.
+	 * @param Item Index of the work item.
+	 */
+	typedef std::function<void(int Worker, int Item)> FProcess;
+
+private:
+	class CThreadData
+	{
+	public:
+		CSnapshotWorkers *m_pWorkers;
+		int m_Worker;
+	};
+
+	std::vector<void *> m_vpThreads;
+	std::vector<CThreadData> m_vThreadData;
+	SEMAPHORE m_StartSemaphore;
+	SEMAPHORE m_DoneSemaphore;
+	bool m_Shutdown = false;
+
+	const FProcess *m_pfnProcess = nullptr;
+	int m_NumItems = 0;
+	std::atomic<int> m_NextItem = 0;
+
+	static void WorkerThread(void *pUser);
+	void ProcessItems(int Worker);
+
+public:
+	~CSnapshotWorkers();
+
+	/**
+	 * Starts the given number of worker threads, stopping existing ones first.
+	 *
+	 * @param NumThreads Number of threads in addition to the calling thread.
+	 */
+	void Init(int NumThreads);
+	void Shutdown();
+
+	int NumThreads() const { return m_vpThreads.size(); }
+	int NumWorkers() const { return NumThreads() + 1; }
+
+	/**
+	 * Processes all work items from 0 to `NumItems - 1` and waits until all
+	 * of them are done. Items may be processed in any order.
+	 */
+	void Process(int NumItems, const FProcess &pfnProcess);
+};
+
+#endif
@@ -14,6 +14,7 @@
 #include "console.h"
 #include "linereader.h"
 
+#include <algorithm>
 #include <iterator> // std::size
 #include <new>
 
@@ -601,9 +602,48 @@ int CConsole::PossibleCommands(const char *pStr, int FlagMask, bool Temp, FPossi
 	return Index;
 }
 
+unsigned CConsole::CommandHash(const char *pName)
+{
+	// FNV-1a over the ASCII lowercased name, matching str_comp_nocase
+	unsigned Hash = 2166136261u;
+	for(; *pName; pName++)
+	{
+		unsigned char Char = *pName;
+		if(Char >= 'A' && Char <= 'Z')
+			Char += 'a' - 'A';
+		Hash = (Hash ^ Char) * 16777619u;
+	}
+	return Hash;
+}
+
+void CConsole::IndexCommand(CCommand *pCommand)
+{
+	// keep the bucket sorted like the command list so lookups pick the same command
+	std::vector<CCommand *> &vpBucket = m_CommandIndex[CommandHash(pCommand->m_pName)];
+	auto It = vpBucket.begin();
+	while(It != vpBucket.end() && str_comp(pCommand->m_pName, (*It)->m_pName) > 0)
+		++It;
+	vpBucket.insert(It, pCommand);
+}
+
+void CConsole::UnindexCommand(CCommand *pCommand)
+{
+	auto BucketIt = m_CommandIndex.find(CommandHash(pCommand->m_pName));
+	if(BucketIt == m_CommandIndex.end())
+		return;
+	std::vector<CCommand *> &vpBucket = BucketIt->second;
+	vpBucket.erase(std::remove(vpBucket.begin(), vpBucket.end(), pCommand), vpBucket.end());
+	if(vpBucket.empty())
+		m_CommandIndex.erase(BucketIt);
+}
+
 CConsole::CCommand *CConsole::FindCommand(const char *pName, int FlagMask)
 {
-	for(CCommand *pCommand = m_pFirstCommand; pCommand; pCommand = pCommand->m_pNext)
+	auto BucketIt = m_CommandIndex.find(CommandHash(pName));
+	if(BucketIt == m_CommandIndex.end())
+		return nullptr;
+
+	for(CCommand *pCommand : BucketIt->second)
 	{
 		if(pCommand->m_Flags & FlagMask)
 		{
@@ -922,10 +962,7 @@ void CConsole::AddCommandSorted(CCommand *pCommand)
 {
 	if(!m_pFirstCommand || str_comp(pCommand->m_pName, m_pFirstCommand->m_pName) <= 0)
 	{
-		if(m_pFirstCommand && m_pFirstCommand->m_pNext)
-			pCommand->m_pNext = m_pFirstCommand;
-		else
-			pCommand->m_pNext = nullptr;
+		pCommand->m_pNext = m_pFirstCommand;
 		m_pFirstCommand = pCommand;
 	}
 	else
@@ -940,6 +977,7 @@ void CConsole::AddCommandSorted(CCommand *pCommand)
 			}
 		}
 	}
+	IndexCommand(pCommand);
 }
 
 void CConsole::Register(const char *pName, const char *pParams,
@@ -1030,6 +1068,7 @@ void CConsole::DeregisterTemp(const char *pName)
 	// add to recycle list
 	if(pRemoved)
 	{
+		UnindexCommand(pRemoved);
 		pRemoved->m_pNext = m_pRecycleList;
 		m_pRecycleList = pRemoved;
 	}
@@ -1053,6 +1092,16 @@ void CConsole::DeregisterTempAll()
 		}
 	}
 
+	for(auto BucketIt = m_CommandIndex.begin(); BucketIt != m_CommandIndex.end();)
+	{
+		std::vector<CCommand *> &vpBucket = BucketIt->second;
+		vpBucket.erase(std::remove_if(vpBucket.begin(), vpBucket.end(), [](const CCommand *pCommand) { return pCommand->m_Temp; }), vpBucket.end());
+		if(vpBucket.empty())
+			BucketIt = m_CommandIndex.erase(BucketIt);
+		else
+			++BucketIt;
+	}
+
 	m_TempCommands.Reset();
 	m_pRecycleList = nullptr;
 }
@@ -1103,7 +1152,11 @@ void CConsole::StoreCommands(bool Store)
 
 const IConsole::CCommandInfo *CConsole::GetCommandInfo(const char *pName, int FlagMask, bool Temp)
 {
-	for(CCommand *pCommand = m_pFirstCommand; pCommand; pCommand = pCommand->m_pNext)
+	auto BucketIt = m_CommandIndex.find(CommandHash(pName));
+	if(BucketIt == m_CommandIndex.end())
+		return nullptr;
+
+	for(CCommand *pCommand : BucketIt->second)
 	{
 		if(pCommand->m_Flags & FlagMask && pCommand->m_Temp == Temp)
 		{
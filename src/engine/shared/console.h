@@ -9,6 +9,9 @@
 #include <engine/console.h>
 #include <engine/storage.h>
 
+#include <unordered_map>
+#include <vector>
+
 class CConsole : public IConsole
 {
 	class CCommand : public CCommandInfo
@@ -87,10 +90,10 @@ class CConsole : public IConsole
 		CResult(int ClientId) :
 			IResult(ClientId)
 		{
-			mem_zero(m_aStringStorage, sizeof(m_aStringStorage));
+			// only the first m_NumArgs arguments are ever read, so don't clear the whole 40 KiB
+			m_aStringStorage[0] = '\0';
 			m_pArgsStart = nullptr;
 			m_pCommand = nullptr;
-			mem_zero(m_apArgs, sizeof(m_apArgs));
 		}
 
 		CResult(const CResult &Other) :
@@ -170,6 +173,12 @@ class CConsole : public IConsole
 	};
 	std::vector<CExecutionQueueEntry> m_vExecutionQueue;
 
+	// case insensitive name hash -> commands, in the same order as the m_pFirstCommand list
+	std::unordered_map<unsigned, std::vector<CCommand *>> m_CommandIndex;
+	static unsigned CommandHash(const char *pName);
+	void IndexCommand(CCommand *pCommand);
+	void UnindexCommand(CCommand *pCommand);
+
 	void AddCommandSorted(CCommand *pCommand);
 	CCommand *FindCommand(const char *pName, int FlagMask);
 
@@ -10,10 +10,15 @@
 
 #include <engine/storage.h>
 
+#include "jobs.h"
 #include "uuid_manager.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdlib>
 #include <limits>
+#include <numeric>
+#include <thread>
 #include <unordered_set>
 
 #include <zlib.h>
@@ -138,6 +143,22 @@ public:
 	void **m_ppDataPtrs;
 	int *m_pDataSizes;
 	char *m_pData;
+	char *m_pMapped; // the whole file if it could be mapped into memory, otherwise nullptr
+
+	bool IsMapped(const void *pData) const
+	{
+		return m_pMapped != nullptr && (uintptr_t)pData >= (uintptr_t)m_pMapped && (uintptr_t)pData < (uintptr_t)m_pMapped + m_FileSize;
+	}
+
+	void FreeData(int Index)
+	{
+		// uncompressed data may point directly into the mapped file
+		if(!IsMapped(m_ppDataPtrs[Index]))
+		{
+			free(m_ppDataPtrs[Index]);
+		}
+		m_ppDataPtrs[Index] = nullptr;
+	}
 
 	int GetFileDataSize(int Index) const
 	{
@@ -206,41 +227,56 @@ public:
 			const unsigned OriginalUncompressedSize = m_Info.m_pDataSizes[Index];
 			log_trace("datafile", "loading data. index=%d size=%d uncompressed=%d", Index, DataSize, OriginalUncompressedSize);
 
-			// read the compressed data
-			void *pCompressedData = malloc(DataSize);
-			if(pCompressedData == nullptr)
-			{
-				log_error("datafile", "out of memory. could not allocate memory for compressed data. index=%d size=%d", Index, DataSize);
-				m_ppDataPtrs[Index] = nullptr;
-				m_pDataSizes[Index] = -1;
-				return nullptr;
-			}
-			unsigned ActualDataSize = 0;
-			if(io_seek(m_File, m_DataStartOffset + m_Info.m_pDataOffsets[Index], IOSEEK_START) == 0)
+			// read the compressed data, unless it can be decompressed straight from the mapped file
+			void *pCompressedData;
+			void *pCompressedBuffer = nullptr;
+			if(m_pMapped != nullptr)
 			{
-				ActualDataSize = io_read(m_File, pCompressedData, DataSize);
+				pCompressedData = m_pMapped + m_DataStartOffset + m_Info.m_pDataOffsets[Index];
 			}
-			if(DataSize != ActualDataSize)
+			else
 			{
-				log_error("datafile", "truncation error. could not read all compressed data. index=%d wanted=%d got=%d", Index, DataSize, ActualDataSize);
-				free(pCompressedData);
-				m_ppDataPtrs[Index] = nullptr;
-				m_pDataSizes[Index] = -1;
-				return nullptr;
+				pCompressedBuffer = malloc(DataSize);
+				if(pCompressedBuffer == nullptr)
+				{
+					log_error("datafile", "out of memory. could not allocate memory for compressed data. index=%d size=%d", Index, DataSize);
+					m_ppDataPtrs[Index] = nullptr;
+					m_pDataSizes[Index] = -1;
+					return nullptr;
+				}
+				unsigned ActualDataSize = 0;
+				if(io_seek(m_File, m_DataStartOffset + m_Info.m_pDataOffsets[Index], IOSEEK_START) == 0)
+				{
+					ActualDataSize = io_read(m_File, pCompressedBuffer, DataSize);
+				}
+				if(DataSize != ActualDataSize)
+				{
+					log_error("datafile", "truncation error. could not read all compressed data. index=%d wanted=%d got=%d", Index, DataSize, ActualDataSize);
+					free(pCompressedBuffer);
+					m_ppDataPtrs[Index] = nullptr;
+					m_pDataSizes[Index] = -1;
+					return nullptr;
+				}
+				pCompressedData = pCompressedBuffer;
 			}
 
 			// decompress the data
 			m_ppDataPtrs[Index] = static_cast<char *>(malloc(OriginalUncompressedSize));
 			if(m_ppDataPtrs[Index] == nullptr)
 			{
-				free(pCompressedData);
+				free(pCompressedBuffer);
 				log_error("datafile", "out of memory. could not allocate memory for uncompressed data. index=%d size=%d", Index, OriginalUncompressedSize);
 				m_pDataSizes[Index] = -1;
 				return nullptr;
 			}
 			unsigned long UncompressedSize = OriginalUncompressedSize;
 			const int Result = uncompress(static_cast<Bytef *>(m_ppDataPtrs[Index]), &UncompressedSize, static_cast<Bytef *>(pCompressedData), DataSize);
-			free(pCompressedData);
+			free(pCompressedBuffer);
+			if(m_pMapped != nullptr)
+			{
+				// the compressed data is only needed again if the data is unloaded
+				io_map_release(pCompressedData, DataSize);
+			}
 			if(Result != Z_OK || UncompressedSize != OriginalUncompressedSize)
 			{
 				log_error("datafile", "failed to uncompress data. index=%d result=%d wanted=%d got=%ld", Index, Result, OriginalUncompressedSize, UncompressedSize);
@@ -254,25 +290,48 @@ public:
 		else
 		{
 			log_trace("datafile", "loading data. index=%d size=%d", Index, DataSize);
-			m_ppDataPtrs[Index] = malloc(DataSize);
-			if(m_ppDataPtrs[Index] == nullptr)
+			if(m_pMapped != nullptr)
 			{
-				log_error("datafile", "out of memory. could not allocate memory for uncompressed data. index=%d size=%d", Index, DataSize);
-				m_pDataSizes[Index] = -1;
-				return nullptr;
-			}
-			unsigned ActualDataSize = 0;
-			if(io_seek(m_File, m_DataStartOffset + m_Info.m_pDataOffsets[Index], IOSEEK_START) == 0)
-			{
-				ActualDataSize = io_read(m_File, m_ppDataPtrs[Index], DataSize);
+				// use the mapped file directly if it is aligned like allocated memory
+				char *pFileData = m_pMapped + m_DataStartOffset + m_Info.m_pDataOffsets[Index];
+				if((uintptr_t)pFileData % alignof(std::max_align_t) == 0)
+				{
+					m_ppDataPtrs[Index] = pFileData;
+				}
+				else
+				{
+					m_ppDataPtrs[Index] = malloc(DataSize);
+					if(m_ppDataPtrs[Index] == nullptr)
+					{
+						log_error("datafile", "out of memory. could not allocate memory for uncompressed data. index=%d size=%d", Index, DataSize);
+						m_pDataSizes[Index] = -1;
+						return nullptr;
+					}
+					mem_copy(m_ppDataPtrs[Index], pFileData, DataSize);
+				}
 			}
-			if(DataSize != ActualDataSize)
+			else
 			{
-				log_error("datafile", "truncation error. could not read all uncompressed data. index=%d wanted=%d got=%d", Index, DataSize, ActualDataSize);
-				free(m_ppDataPtrs[Index]);
-				m_ppDataPtrs[Index] = nullptr;
-				m_pDataSizes[Index] = -1;
-				return nullptr;
+				m_ppDataPtrs[Index] = malloc(DataSize);
+				if(m_ppDataPtrs[Index] == nullptr)
+				{
+					log_error("datafile", "out of memory. could not allocate memory for uncompressed data. index=%d size=%d", Index, DataSize);
+					m_pDataSizes[Index] = -1;
+					return nullptr;
+				}
+				unsigned ActualDataSize = 0;
+				if(io_seek(m_File, m_DataStartOffset + m_Info.m_pDataOffsets[Index], IOSEEK_START) == 0)
+				{
+					ActualDataSize = io_read(m_File, m_ppDataPtrs[Index], DataSize);
+				}
+				if(DataSize != ActualDataSize)
+				{
+					log_error("datafile", "truncation error. could not read all uncompressed data. index=%d wanted=%d got=%d", Index, DataSize, ActualDataSize);
+					free(m_ppDataPtrs[Index]);
+					m_ppDataPtrs[Index] = nullptr;
+					m_pDataSizes[Index] = -1;
+					return nullptr;
+				}
 			}
 			m_pDataSizes[Index] = DataSize;
 		}
@@ -429,7 +488,7 @@ CDataFileReader &CDataFileReader::operator=(CDataFileReader &&Other)
 	return *this;
 }
 
-bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int StorageType)
+bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int StorageType, bool AllowMapping)
 {
 	dbg_assert(m_pDataFile == nullptr, "File already open");
 
@@ -442,6 +501,23 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 		return false;
 	}
 
+	// map the file into memory if possible, so the item data does not
+	// need to be copied and data can be decompressed straight from it
+	constexpr int64_t MaxAllocSize = (int64_t)2 * 1024 * 1024 * 1024;
+	const int64_t MappedSize = io_length(File);
+	char *pMapped = nullptr;
+	if(AllowMapping && MappedSize > 0 && MappedSize <= MaxAllocSize)
+	{
+		pMapped = static_cast<char *>(io_map(File, MappedSize));
+	}
+	const auto &&CloseFile = [&]() {
+		if(pMapped != nullptr)
+		{
+			io_unmap(pMapped, MappedSize);
+		}
+		io_close(File);
+	};
+
 	// determine size and hashes of the file and store them
 	int64_t FileSize = 0;
 	unsigned Crc = 0;
@@ -449,30 +525,57 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 	{
 		SHA256_CTX Sha256Ctxt;
 		sha256_init(&Sha256Ctxt);
-		unsigned char aBuffer[64 * 1024];
-		while(true)
+		constexpr unsigned HashChunkSize = 64 * 1024;
+		if(pMapped != nullptr)
 		{
-			const unsigned Bytes = io_read(File, aBuffer, sizeof(aBuffer));
-			if(Bytes == 0)
-				break;
-			FileSize += Bytes;
-			Crc = crc32(Crc, aBuffer, Bytes);
-			sha256_update(&Sha256Ctxt, aBuffer, Bytes);
+			for(FileSize = 0; FileSize < MappedSize; FileSize += HashChunkSize)
+			{
+				const unsigned Bytes = minimum<int64_t>(HashChunkSize, MappedSize - FileSize);
+				Crc = crc32(Crc, reinterpret_cast<const Bytef *>(pMapped + FileSize), Bytes);
+				sha256_update(&Sha256Ctxt, pMapped + FileSize, Bytes);
+			}
+			FileSize = MappedSize;
 		}
-		Sha256 = sha256_finish(&Sha256Ctxt);
-		if(io_seek(File, 0, IOSEEK_START) != 0)
+		else
 		{
-			io_close(File);
-			log_error("datafile", "could not seek to start after calculating hashes");
-			return false;
+			unsigned char aBuffer[HashChunkSize];
+			while(true)
+			{
+				const unsigned Bytes = io_read(File, aBuffer, sizeof(aBuffer));
+				if(Bytes == 0)
+					break;
+				FileSize += Bytes;
+				Crc = crc32(Crc, aBuffer, Bytes);
+				sha256_update(&Sha256Ctxt, aBuffer, Bytes);
+			}
+			if(io_seek(File, 0, IOSEEK_START) != 0)
+			{
+				CloseFile();
+				log_error("datafile", "could not seek to start after calculating hashes");
+				return false;
+			}
 		}
+		Sha256 = sha256_finish(&Sha256Ctxt);
 	}
 
 	// read header
 	CDatafileHeader Header;
-	if(io_read(File, &Header, sizeof(Header)) != sizeof(Header))
+	bool HeaderRead;
+	if(pMapped != nullptr)
 	{
-		io_close(File);
+		HeaderRead = FileSize >= (int64_t)sizeof(Header);
+		if(HeaderRead)
+		{
+			mem_copy(&Header, pMapped, sizeof(Header));
+		}
+	}
+	else
+	{
+		HeaderRead = io_read(File, &Header, sizeof(Header)) == sizeof(Header);
+	}
+	if(!HeaderRead)
+	{
+		CloseFile();
 		log_error("datafile", "could not read file header. file truncated or not a datafile.");
 		return false;
 	}
@@ -481,7 +584,7 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 	if((Header.m_aId[0] != 'A' || Header.m_aId[1] != 'T' || Header.m_aId[2] != 'A' || Header.m_aId[3] != 'D') &&
 		(Header.m_aId[0] != 'D' || Header.m_aId[1] != 'A' || Header.m_aId[2] != 'T' || Header.m_aId[3] != 'A'))
 	{
-		io_close(File);
+		CloseFile();
 		log_error("datafile", "wrong header magic. magic=%x%x%x%x", Header.m_aId[0], Header.m_aId[1], Header.m_aId[2], Header.m_aId[3]);
 		return false;
 	}
@@ -491,7 +594,7 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 	// check header version
 	if(Header.m_Version != 3 && Header.m_Version != 4)
 	{
-		io_close(File);
+		CloseFile();
 		log_error("datafile", "unsupported header version. version=%d", Header.m_Version);
 		return false;
 	}
@@ -505,7 +608,7 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 		Header.m_ItemSize % sizeof(int) != 0 ||
 		Header.m_DataSize < 0)
 	{
-		io_close(File);
+		CloseFile();
 		log_error("datafile", "invalid header information. num_types=%d num_items=%d num_data=%d item_size=%d data_size=%d",
 			Header.m_NumItemTypes, Header.m_NumItems, Header.m_NumRawData, Header.m_ItemSize, Header.m_DataSize);
 		return false;
@@ -531,7 +634,7 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 
 	if((int64_t)sizeof(Header) + Size + (int64_t)Header.m_DataSize != FileSize)
 	{
-		io_close(File);
+		CloseFile();
 		log_error("datafile", "invalid header data size or truncated file. data_size=%" PRId64 " file_size=%" PRId64, Header.m_DataSize, FileSize);
 		return false;
 	}
@@ -546,7 +649,7 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 		}
 		else
 		{
-			io_close(File);
+			CloseFile();
 			log_error("datafile", "invalid header size or truncated file. size=%" PRId64 " actual=%" PRId64, HeaderFileSize, FileSize);
 			return false;
 		}
@@ -563,20 +666,19 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 		}
 		else
 		{
-			io_close(File);
+			CloseFile();
 			log_error("datafile", "invalid header swaplen or truncated file. swaplen=%" PRId64 " actual=%" PRId64, HeaderSwaplen, FileSizeSwaplen);
 			return false;
 		}
 	}
 
-	constexpr int64_t MaxAllocSize = (int64_t)2 * 1024 * 1024 * 1024;
-	int64_t AllocSize = Size;
+	int64_t AllocSize = pMapped != nullptr ? 0 : Size; // mapped files use the item data in place
 	AllocSize += sizeof(CDatafile); // add space for info structure
 	AllocSize += (int64_t)Header.m_NumRawData * sizeof(void *); // add space for data pointers
 	AllocSize += (int64_t)Header.m_NumRawData * sizeof(int); // add space for data sizes
 	if(AllocSize > MaxAllocSize)
 	{
-		io_close(File);
+		CloseFile();
 		log_error("datafile", "file too large. alloc_size=%" PRId64 " max=%" PRId64, AllocSize, MaxAllocSize);
 		return false;
 	}
@@ -584,7 +686,7 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 	CDatafile *pTmpDataFile = static_cast<CDatafile *>(malloc(AllocSize));
 	if(pTmpDataFile == nullptr)
 	{
-		io_close(File);
+		CloseFile();
 		log_error("datafile", "out of memory. could not allocate memory for datafile. alloc_size=%" PRId64, AllocSize);
 		return false;
 	}
@@ -592,7 +694,8 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 	pTmpDataFile->m_DataStartOffset = sizeof(CDatafileHeader) + Size;
 	pTmpDataFile->m_ppDataPtrs = (void **)(pTmpDataFile + 1);
 	pTmpDataFile->m_pDataSizes = (int *)(pTmpDataFile->m_ppDataPtrs + Header.m_NumRawData);
-	pTmpDataFile->m_pData = (char *)(pTmpDataFile->m_pDataSizes + Header.m_NumRawData);
+	pTmpDataFile->m_pData = pMapped != nullptr ? pMapped + sizeof(CDatafileHeader) : (char *)(pTmpDataFile->m_pDataSizes + Header.m_NumRawData);
+	pTmpDataFile->m_pMapped = pMapped;
 	pTmpDataFile->m_File = File;
 	pTmpDataFile->m_FileSize = FileSize;
 	pTmpDataFile->m_Sha256 = Sha256;
@@ -603,13 +706,16 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 	mem_zero(pTmpDataFile->m_pDataSizes, Header.m_NumRawData * sizeof(int));
 
 	// read types, offsets, sizes and item data
-	const unsigned ReadSize = io_read(pTmpDataFile->m_File, pTmpDataFile->m_pData, Size);
-	if((int64_t)ReadSize != Size)
+	if(pMapped == nullptr)
 	{
-		io_close(pTmpDataFile->m_File);
-		free(pTmpDataFile);
-		log_error("datafile", "truncation error. could not read all item data. wanted=%" PRIzu " got=%d", Size, ReadSize);
-		return false;
+		const unsigned ReadSize = io_read(pTmpDataFile->m_File, pTmpDataFile->m_pData, Size);
+		if((int64_t)ReadSize != Size)
+		{
+			CloseFile();
+			free(pTmpDataFile);
+			log_error("datafile", "truncation error. could not read all item data. wanted=%" PRIzu " got=%d", Size, ReadSize);
+			return false;
+		}
 	}
 
 	SwapEndianInPlace(pTmpDataFile->m_pData, pTmpDataFile->m_Header.m_Swaplen);
@@ -631,7 +737,7 @@ bool CDataFileReader::Open(class IStorage *pStorage, const char *pFilename, int
 
 	if(!pTmpDataFile->Validate())
 	{
-		io_close(pTmpDataFile->m_File);
+		CloseFile();
 		free(pTmpDataFile);
 		return false;
 	}
@@ -651,9 +757,13 @@ void CDataFileReader::Close()
 
 	for(int i = 0; i < m_pDataFile->m_Header.m_NumRawData; i++)
 	{
-		free(m_pDataFile->m_ppDataPtrs[i]);
+		m_pDataFile->FreeData(i);
 	}
 
+	if(m_pDataFile->m_pMapped != nullptr)
+	{
+		io_unmap(m_pDataFile->m_pMapped, m_pDataFile->m_FileSize);
+	}
 	io_close(m_pDataFile->m_File);
 	free(m_pDataFile);
 	m_pDataFile = nullptr;
@@ -720,7 +830,7 @@ void CDataFileReader::ReplaceData(int Index, char *pData, size_t Size)
 	dbg_assert(m_pDataFile != nullptr, "File not open");
 	dbg_assert(Index >= 0 && Index < m_pDataFile->m_Header.m_NumRawData, "Index invalid: %d", Index);
 
-	free(m_pDataFile->m_ppDataPtrs[Index]);
+	m_pDataFile->FreeData(Index);
 	m_pDataFile->m_ppDataPtrs[Index] = pData;
 	m_pDataFile->m_pDataSizes[Index] = Size;
 }
@@ -732,11 +842,40 @@ void CDataFileReader::UnloadData(int Index)
 	if(Index < 0 || Index >= m_pDataFile->m_Header.m_NumRawData)
 		return;
 
-	free(m_pDataFile->m_ppDataPtrs[Index]);
-	m_pDataFile->m_ppDataPtrs[Index] = nullptr;
+	m_pDataFile->FreeData(Index);
 	m_pDataFile->m_pDataSizes[Index] = 0;
 }
 
+void CDataFileReader::PrefetchData(std::vector<int> vIndices, const std::function<void(std::shared_ptr<IJob>)> &AddJob)
+{
+	dbg_assert(m_pDataFile != nullptr, "File not open");
+
+	// the same data must not be loaded by two threads at once
+	std::sort(vIndices.begin(), vIndices.end());
+	vIndices.erase(std::unique(vIndices.begin(), vIndices.end()), vIndices.end());
+	auto LoadedEnd = std::remove_if(vIndices.begin(), vIndices.end(), [&](int Index) {
+		return Index < 0 || Index >= m_pDataFile->m_Header.m_NumRawData || m_pDataFile->m_ppDataPtrs[Index] != nullptr || m_pDataFile->m_pDataSizes[Index] < 0;
+	});
+	vIndices.erase(LoadedEnd, vIndices.end());
+
+	// reading from the file handle cannot be done in parallel
+	if(m_pDataFile->m_pMapped == nullptr || vIndices.size() < 2 || !AddJob)
+	{
+		for(int Index : vIndices)
+		{
+			m_pDataFile->GetData(Index, false);
+		}
+		return;
+	}
+
+	CDatafile *pDataFile = m_pDataFile;
+	CWorkBatch Batch(vIndices.size(), [&](size_t i) {
+		pDataFile->GetData(vIndices[i], false);
+	});
+	Batch.Start(AddJob, minimum<size_t>(vIndices.size() - 1, std::thread::hardware_concurrency()));
+	Batch.Wait();
+}
+
 int CDataFileReader::NumData() const
 {
 	dbg_assert(m_pDataFile != nullptr, "File not open");
@@ -1052,16 +1191,12 @@ int CDataFileWriter::AddDataSwapped(size_t Size, const void *pData)
 	dbg_assert(m_vDatas.size() < (size_t)std::numeric_limits<int>::max(), "Too many data");
 	dbg_assert(Size % sizeof(int) == 0, "Invalid data boundary");
 
+	const int Index = AddData(Size, pData);
 #if defined(CONF_ARCH_ENDIAN_BIG)
-	void *pSwapped = malloc(Size); // temporary buffer that we use during compression
-	mem_copy(pSwapped, pData, Size);
-	swap_endian(pSwapped, sizeof(int), Size / sizeof(int));
-	int Index = AddData(Size, pSwapped);
-	free(pSwapped);
-	return Index;
-#else
-	return AddData(Size, pData);
+	// swap the copy that is kept until compression
+	swap_endian(m_vDatas[Index].m_pUncompressedData, sizeof(int), Size / sizeof(int));
 #endif
+	return Index;
 }
 
 int CDataFileWriter::AddDataString(const char *pStr)
@@ -1089,14 +1224,22 @@ static int CompressionLevelToZlib(CDataFileWriter::ECompressionLevel Compression
 	}
 }
 
-void CDataFileWriter::Finish()
+void CDataFileWriter::Finish(const std::function<void(std::shared_ptr<IJob>)> &AddJob)
 {
 	dbg_assert((bool)m_File, "File not open");
 
 	// Compress data. This takes the majority of the time when saving a datafile,
-	// so it's delayed until the end so it can be off-loaded to another thread.
-	for(CDataInfo &DataInfo : m_vDatas)
-	{
+	// so it's delayed until the end so it can be off-loaded to other threads.
+	// Every data is compressed on its own, so the result is the same no matter
+	// which thread compresses it. The largest data is started first so that it
+	// does not end up running alone at the end.
+	std::vector<int> vOrder(m_vDatas.size());
+	std::iota(vOrder.begin(), vOrder.end(), 0);
+	std::stable_sort(vOrder.begin(), vOrder.end(), [&](int Left, int Right) {
+		return m_vDatas[Left].m_UncompressedSize > m_vDatas[Right].m_UncompressedSize;
+	});
+	CWorkBatch Batch(vOrder.size(), [&](size_t i) {
+		CDataInfo &DataInfo = m_vDatas[vOrder[i]];
 		unsigned long CompressedSize = compressBound(DataInfo.m_UncompressedSize);
 		DataInfo.m_pCompressedData = malloc(CompressedSize);
 		const int Result = compress2(static_cast<Bytef *>(DataInfo.m_pCompressedData), &CompressedSize, static_cast<Bytef *>(DataInfo.m_pUncompressedData), DataInfo.m_UncompressedSize, CompressionLevelToZlib(DataInfo.m_CompressionLevel));
@@ -1104,7 +1247,12 @@ void CDataFileWriter::Finish()
 		free(DataInfo.m_pUncompressedData);
 		DataInfo.m_pUncompressedData = nullptr;
 		dbg_assert(Result == Z_OK, "datafile zlib compression failed with error %d", Result);
+	});
+	if(AddJob && vOrder.size() >= 2)
+	{
+		Batch.Start(AddJob, minimum<size_t>(vOrder.size() - 1, std::thread::hardware_concurrency()));
 	}
+	Batch.Wait();
 
 	// Calculate total size of items
 	int64_t ItemSize = 0;
@@ -11,9 +11,13 @@
 #include "uuid_manager.h"
 
 #include <cstdint>
+#include <functional>
 #include <map>
+#include <memory>
 #include <vector>
 
+class IJob;
+
 enum
 {
 	ITEMTYPE_EX = 0xFFFF,
@@ -31,7 +35,9 @@ public:
 	~CDataFileReader();
 	CDataFileReader &operator=(CDataFileReader &&Other);
 
-	bool Open(class IStorage *pStorage, const char *pFilename, int StorageType);
+	// mapped files must not be truncated or overwritten in place while they are open (see io_map),
+	// so only allow mapping for files that are known to be replaced by renaming, if at all
+	bool Open(class IStorage *pStorage, const char *pFilename, int StorageType, bool AllowMapping = false);
 	void Close();
 	bool IsOpen() const;
 	IOHANDLE File() const;
@@ -42,6 +48,8 @@ public:
 	const char *GetDataString(int Index);
 	void ReplaceData(int Index, char *pData, size_t Size); // memory for data must have been allocated with malloc
 	void UnloadData(int Index);
+	// loads the data like GetData, in parallel with jobs added using AddJob if the file is mapped into memory
+	void PrefetchData(std::vector<int> vIndices, const std::function<void(std::shared_ptr<IJob>)> &AddJob);
 	int NumData() const;
 
 	int GetItemSize(int Index) const;
@@ -130,7 +138,8 @@ public:
 	int AddData(size_t Size, const void *pData, ECompressionLevel CompressionLevel = COMPRESSION_DEFAULT);
 	int AddDataSwapped(size_t Size, const void *pData);
 	int AddDataString(const char *pStr);
-	void Finish();
+	// compresses the data in parallel with jobs added using AddJob, the written file does not depend on it
+	void Finish(const std::function<void(std::shared_ptr<IJob>)> &AddJob = nullptr);
 };
 
 #endif
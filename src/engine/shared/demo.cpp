@@ -1,5 +1,7 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/hash_ctxt.h>
+#include <base/lock.h>
 #include <base/math.h>
 #include <base/system.h>
 
@@ -17,6 +19,13 @@
 #include "network.h"
 #include "snapshot.h"
 
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
 const CUuid SHA256_EXTENSION =
 	{{0x6b, 0xe6, 0xda, 0x4a, 0xce, 0xbd, 0x38, 0x0c,
 		0x9b, 0x5b, 0x12, 0x89, 0xc8, 0x42, 0xd7, 0x80}};
@@ -28,6 +37,105 @@ static const unsigned char gs_VersionTickCompression = 5; // demo files with thi
 
 static constexpr ColorRGBA gs_DemoPrintColor{0.75f, 0.7f, 0.7f, 1.0f};
 
+static const unsigned char gs_aIndexMarker[8] = {'T', 'W', 'D', 'E', 'M', 'O', 'I', 'X'};
+static const unsigned gs_IndexVersion = 2;
+static const int gs_IndexMinLength = 60; // in seconds, shorter demos are scanned quickly enough
+static const size_t gs_IndexMaxFiles = 100; // least recently used indices are removed beyond this
+static const time_t gs_IndexRefreshAge = 24 * 60 * 60; // in seconds, used indices older than this are rewritten to mark them as recently used
+static const int gs_SeekPointInterval = 30 * SERVER_TICK_SPEED; // in ticks, only fills in for demos with sparse key frames
+
+// Hands raw chunks from a recording thread to the demo writer thread, which
+// compresses them and writes them to the demo file in batches. The queue is a
+// single-producer single-consumer byte ring, so pushing never takes a lock.
+class CDemoWriter
+{
+	friend class CDemoWriterThread;
+
+public:
+	enum
+	{
+		QUEUE_SIZE = 256 * 1024,
+		MAX_CHUNK_SIZE = 64 * 1024,
+		MAX_TICKMARKER_SIZE = sizeof(int32_t) + 1,
+	};
+
+	CDemoWriter(IOHANDLE File);
+	// Waits until all queued chunks are written to the file.
+	~CDemoWriter();
+
+	// Returns false if the queue is full and Wait is not set, nothing is queued in that case.
+	bool Push(const unsigned char *pTickMarker, int TickMarkerSize, int Type, const void *pData, int Size, bool Wait);
+
+private:
+	enum
+	{
+		ENTRY_PADDING = -1,
+	};
+
+	struct CEntryHeader
+	{
+		int m_Type;
+		int m_Size;
+		int m_TickMarkerSize;
+		unsigned char m_aTickMarker[MAX_TICKMARKER_SIZE];
+	};
+
+	IOHANDLE m_File;
+	SEMAPHORE m_SpaceSemaphore;
+	SEMAPHORE m_StoppedSemaphore;
+	std::atomic<bool> m_Stopping;
+	std::atomic<bool> m_WaitingForSpace;
+
+	// positions grow monotonically, the offset into the queue is the position modulo QUEUE_SIZE
+	std::atomic<uint64_t> m_ReadPos;
+	std::atomic<uint64_t> m_WritePos;
+	std::unique_ptr<unsigned char[]> m_pQueue;
+};
+
+// A single thread serves the queues of all demo writers, so recording many demos
+// at once, e.g. one per client on a server, does not need a thread and compression
+// buffers per demo. The thread only runs while writers exist.
+class CDemoWriterThread
+{
+public:
+	CDemoWriterThread();
+	~CDemoWriterThread();
+
+	static CDemoWriterThread *Instance();
+
+	void AddWriter(CDemoWriter *pWriter) REQUIRES(!m_ThreadLock, !m_WritersLock);
+	// Writes the remaining chunks of the writer, it must not push anymore.
+	void RemoveWriter(CDemoWriter *pWriter) REQUIRES(!m_ThreadLock, !m_WritersLock);
+	void Signal() { sphore_signal(&m_DataSemaphore); }
+
+private:
+	enum
+	{
+		BATCH_SIZE = 128 * 1024,
+	};
+
+	CLock m_ThreadLock;
+	void *m_pThread GUARDED_BY(m_ThreadLock) = nullptr;
+	std::atomic<bool> m_Shutdown = false;
+	SEMAPHORE m_DataSemaphore;
+
+	CLock m_WritersLock;
+	std::vector<CDemoWriter *> m_vpWriters GUARDED_BY(m_WritersLock);
+
+	// only used by the writer thread
+	std::vector<CDemoWriter *> m_vpDrainWriters;
+	unsigned char m_aBatch[BATCH_SIZE];
+	int m_BatchSize = 0;
+	char m_aCompressBuffer[CDemoWriter::MAX_CHUNK_SIZE];
+	char m_aCompressBuffer2[CDemoWriter::MAX_CHUNK_SIZE];
+
+	static void ThreadFunc(void *pUser);
+	void Run() REQUIRES(!m_WritersLock);
+	void Drain(CDemoWriter *pWriter);
+	void WriteChunk(IOHANDLE File, int Type, const void *pData, int Size);
+	void FlushBatch(IOHANDLE File);
+};
+
 bool CDemoHeader::Valid() const
 {
 	// Check marker and ensure that strings are zero-terminated and valid UTF-8.
@@ -52,6 +160,7 @@ CDemoRecorder::CDemoRecorder(class CSnapshotDelta *pSnapshotDelta, bool NoMapDat
 CDemoRecorder::~CDemoRecorder()
 {
 	dbg_assert(m_File == 0, "Demo recorder was not stopped");
+	dbg_assert(m_pWriter == nullptr, "Demo writer was not stopped");
 }
 
 // Record
@@ -195,6 +304,7 @@ int CDemoRecorder::Start(class IStorage *pStorage, class IConsole *pConsole, con
 	m_LastTickMarker = -1;
 	m_FirstTick = -1;
 	m_NumTimelineMarkers = 0;
+	m_NumDroppedChunks = 0;
 
 	if(m_pConsole)
 	{
@@ -207,6 +317,7 @@ int CDemoRecorder::Start(class IStorage *pStorage, class IConsole *pConsole, con
 	m_pUser = pUser;
 
 	m_File = DemoFile;
+	m_pWriter = new CDemoWriter(DemoFile);
 	str_copy(m_aCurrentFilename, pFilename);
 
 	return 0;
@@ -240,110 +351,323 @@ enum
 	CHUNKTYPE_DELTA = 3,
 };
 
-void CDemoRecorder::WriteTickMarker(int Tick, bool Keyframe)
+CDemoWriter::CDemoWriter(IOHANDLE File) :
+	m_File(File), m_Stopping(false), m_WaitingForSpace(false), m_ReadPos(0), m_WritePos(0), m_pQueue(std::make_unique<unsigned char[]>(QUEUE_SIZE))
 {
-	if(m_LastTickMarker == -1 || Tick - m_LastTickMarker > CHUNKMASK_TICK || Keyframe)
+	sphore_init(&m_SpaceSemaphore);
+	sphore_init(&m_StoppedSemaphore);
+	CDemoWriterThread::Instance()->AddWriter(this);
+}
+
+CDemoWriter::~CDemoWriter()
+{
+	CDemoWriterThread::Instance()->RemoveWriter(this);
+	sphore_destroy(&m_SpaceSemaphore);
+	sphore_destroy(&m_StoppedSemaphore);
+}
+
+bool CDemoWriter::Push(const unsigned char *pTickMarker, int TickMarkerSize, int Type, const void *pData, int Size, bool Wait)
+{
+	dbg_assert(TickMarkerSize >= 0 && TickMarkerSize <= MAX_TICKMARKER_SIZE, "invalid tick marker size");
+	dbg_assert(Size >= 0 && Size <= MAX_CHUNK_SIZE, "invalid demo chunk size");
+
+	const uint64_t WritePos = m_WritePos.load(std::memory_order_relaxed);
+	const int EntrySize = (sizeof(CEntryHeader) + Size + 3) & ~3;
+	const int Offset = WritePos % QUEUE_SIZE;
+	// entries are never split, skip the rest of the queue if the entry does not fit in there
+	const int Skip = Offset + EntrySize > QUEUE_SIZE ? QUEUE_SIZE - Offset : 0;
+
+	while(QUEUE_SIZE - (WritePos - m_ReadPos.load(std::memory_order_acquire)) < (uint64_t)(Skip + EntrySize))
 	{
-		unsigned char aChunk[sizeof(int32_t) + 1];
-		aChunk[0] = CHUNKTYPEFLAG_TICKMARKER;
-		uint_to_bytes_be(aChunk + 1, Tick);
+		if(!Wait)
+			return false;
+		m_WaitingForSpace.store(true);
+		// the writer might have freed space before seeing the flag
+		if(QUEUE_SIZE - (WritePos - m_ReadPos.load()) >= (uint64_t)(Skip + EntrySize))
+		{
+			m_WaitingForSpace.store(false);
+			break;
+		}
+		sphore_wait(&m_SpaceSemaphore);
+	}
 
-		if(Keyframe)
-			aChunk[0] |= CHUNKTICKFLAG_KEYFRAME;
+	CEntryHeader Header;
+	if(Skip >= (int)sizeof(CEntryHeader))
+	{
+		Header.m_Type = ENTRY_PADDING;
+		mem_copy(m_pQueue.get() + Offset, &Header, sizeof(Header));
+	}
 
-		io_write(m_File, aChunk, sizeof(aChunk));
+	Header.m_Type = Type;
+	Header.m_Size = Size;
+	Header.m_TickMarkerSize = TickMarkerSize;
+	if(TickMarkerSize > 0)
+		mem_copy(Header.m_aTickMarker, pTickMarker, TickMarkerSize);
+	unsigned char *pEntry = m_pQueue.get() + (WritePos + Skip) % QUEUE_SIZE;
+	mem_copy(pEntry, &Header, sizeof(Header));
+	if(Size > 0)
+		mem_copy(pEntry + sizeof(Header), pData, Size);
+
+	m_WritePos.store(WritePos + Skip + EntrySize, std::memory_order_release);
+	CDemoWriterThread::Instance()->Signal();
+	return true;
+}
+
+CDemoWriterThread::CDemoWriterThread()
+{
+	sphore_init(&m_DataSemaphore);
+}
+
+CDemoWriterThread::~CDemoWriterThread()
+{
+	sphore_destroy(&m_DataSemaphore);
+}
+
+CDemoWriterThread *CDemoWriterThread::Instance()
+{
+	static CDemoWriterThread s_Instance;
+	return &s_Instance;
+}
+
+void CDemoWriterThread::AddWriter(CDemoWriter *pWriter)
+{
+	const CLockScope ThreadLockScope(m_ThreadLock);
+	{
+		const CLockScope WritersLockScope(m_WritersLock);
+		m_vpWriters.push_back(pWriter);
 	}
-	else
+	if(!m_pThread)
 	{
-		unsigned char aChunk[1];
-		aChunk[0] = CHUNKTYPEFLAG_TICKMARKER | CHUNKTICKFLAG_TICK_COMPRESSED | (Tick - m_LastTickMarker);
-		io_write(m_File, aChunk, sizeof(aChunk));
+		m_Shutdown.store(false);
+		m_pThread = thread_init(ThreadFunc, this, "demo writer");
 	}
+}
 
-	m_LastTickMarker = Tick;
-	if(m_FirstTick < 0)
-		m_FirstTick = Tick;
+void CDemoWriterThread::RemoveWriter(CDemoWriter *pWriter)
+{
+	pWriter->m_Stopping.store(true);
+	Signal();
+	sphore_wait(&pWriter->m_StoppedSemaphore);
+
+	// stop the thread with the last writer, adding a writer waits for this
+	const CLockScope ThreadLockScope(m_ThreadLock);
+	{
+		const CLockScope WritersLockScope(m_WritersLock);
+		if(!m_vpWriters.empty())
+			return;
+	}
+	if(m_pThread)
+	{
+		m_Shutdown.store(true);
+		Signal();
+		thread_wait(m_pThread);
+		m_pThread = nullptr;
+	}
 }
 
-void CDemoRecorder::Write(int Type, const void *pData, int Size)
+void CDemoWriterThread::ThreadFunc(void *pUser)
 {
-	if(!m_File)
-		return;
+	static_cast<CDemoWriterThread *>(pUser)->Run();
+}
 
-	if(Size > 64 * 1024)
+void CDemoWriterThread::Run()
+{
+	while(true)
+	{
+		sphore_wait(&m_DataSemaphore);
+		const bool Shutdown = m_Shutdown.load();
+		{
+			const CLockScope LockScope(m_WritersLock);
+			m_vpDrainWriters = m_vpWriters;
+		}
+		// the semaphore is signaled once per entry, entries drained early make later wakeups no-ops
+		for(CDemoWriter *pWriter : m_vpDrainWriters)
+		{
+			// a stopping writer does not push anymore, so everything it queued is drained below
+			const bool Stopping = pWriter->m_Stopping.load();
+			Drain(pWriter);
+			FlushBatch(pWriter->m_File);
+			if(Stopping)
+			{
+				{
+					const CLockScope LockScope(m_WritersLock);
+					m_vpWriters.erase(std::find(m_vpWriters.begin(), m_vpWriters.end(), pWriter));
+				}
+				sphore_signal(&pWriter->m_StoppedSemaphore);
+			}
+		}
+		if(Shutdown)
+			break;
+	}
+}
+
+void CDemoWriterThread::Drain(CDemoWriter *pWriter)
+{
+	uint64_t ReadPos = pWriter->m_ReadPos.load(std::memory_order_relaxed);
+	const uint64_t WritePos = pWriter->m_WritePos.load(std::memory_order_acquire);
+	if(ReadPos == WritePos)
 		return;
 
+	while(ReadPos != WritePos)
+	{
+		const int Offset = ReadPos % CDemoWriter::QUEUE_SIZE;
+		if(CDemoWriter::QUEUE_SIZE - Offset < (int)sizeof(CDemoWriter::CEntryHeader))
+		{
+			ReadPos += CDemoWriter::QUEUE_SIZE - Offset;
+			continue;
+		}
+
+		CDemoWriter::CEntryHeader Header;
+		mem_copy(&Header, pWriter->m_pQueue.get() + Offset, sizeof(Header));
+		if(Header.m_Type == CDemoWriter::ENTRY_PADDING)
+		{
+			ReadPos += CDemoWriter::QUEUE_SIZE - Offset;
+			continue;
+		}
+
+		if(m_BatchSize + CDemoWriter::MAX_TICKMARKER_SIZE > BATCH_SIZE)
+			FlushBatch(pWriter->m_File);
+		mem_copy(m_aBatch + m_BatchSize, Header.m_aTickMarker, Header.m_TickMarkerSize);
+		m_BatchSize += Header.m_TickMarkerSize;
+		if(Header.m_Type != 0)
+			WriteChunk(pWriter->m_File, Header.m_Type, pWriter->m_pQueue.get() + Offset + sizeof(Header), Header.m_Size);
+
+		ReadPos += (sizeof(CDemoWriter::CEntryHeader) + Header.m_Size + 3) & ~3;
+	}
+
+	pWriter->m_ReadPos.store(ReadPos, std::memory_order_release);
+	if(pWriter->m_WaitingForSpace.exchange(false))
+		sphore_signal(&pWriter->m_SpaceSemaphore);
+}
+
+void CDemoWriterThread::WriteChunk(IOHANDLE File, int Type, const void *pData, int Size)
+{
 	/* pad the data with 0 so we get an alignment of 4,
 	else the compression won't work and miss some bytes */
-	char aBuffer[64 * 1024];
-	char aBuffer2[64 * 1024];
-	mem_copy(aBuffer2, pData, Size);
+	mem_copy(m_aCompressBuffer2, pData, Size);
 	while(Size & 3)
-		aBuffer2[Size++] = 0;
-	Size = CVariableInt::Compress(aBuffer2, Size, aBuffer, sizeof(aBuffer)); // buffer2 -> buffer
+		m_aCompressBuffer2[Size++] = 0;
+	Size = CVariableInt::Compress(m_aCompressBuffer2, Size, m_aCompressBuffer, sizeof(m_aCompressBuffer)); // buffer2 -> buffer
 	if(Size < 0)
 		return;
 
-	Size = CNetBase::Compress(aBuffer, Size, aBuffer2, sizeof(aBuffer2)); // buffer -> buffer2
+	Size = CNetBase::Compress(m_aCompressBuffer, Size, m_aCompressBuffer2, sizeof(m_aCompressBuffer2)); // buffer -> buffer2
 	if(Size < 0)
 		return;
 
-	unsigned char aChunk[3];
-	aChunk[0] = ((Type & 0x3) << 5);
+	if(m_BatchSize + 3 + Size > BATCH_SIZE)
+		FlushBatch(File);
+
+	unsigned char *pChunk = m_aBatch + m_BatchSize;
+	pChunk[0] = ((Type & 0x3) << 5);
 	if(Size < 30)
 	{
-		aChunk[0] |= Size;
-		io_write(m_File, aChunk, 1);
+		pChunk[0] |= Size;
+		m_BatchSize += 1;
 	}
 	else
 	{
 		if(Size < 256)
 		{
-			aChunk[0] |= 30;
-			aChunk[1] = Size & 0xff;
-			io_write(m_File, aChunk, 2);
+			pChunk[0] |= 30;
+			pChunk[1] = Size & 0xff;
+			m_BatchSize += 2;
 		}
 		else
 		{
-			aChunk[0] |= 31;
-			aChunk[1] = Size & 0xff;
-			aChunk[2] = Size >> 8;
-			io_write(m_File, aChunk, 3);
+			pChunk[0] |= 31;
+			pChunk[1] = Size & 0xff;
+			pChunk[2] = Size >> 8;
+			m_BatchSize += 3;
 		}
 	}
 
-	io_write(m_File, aBuffer2, Size);
+	mem_copy(m_aBatch + m_BatchSize, m_aCompressBuffer2, Size);
+	m_BatchSize += Size;
+}
+
+void CDemoWriterThread::FlushBatch(IOHANDLE File)
+{
+	if(m_BatchSize == 0)
+		return;
+	io_write(File, m_aBatch, m_BatchSize);
+	m_BatchSize = 0;
+}
+
+int CDemoRecorder::WriteTickMarker(int Tick, bool Keyframe, unsigned char *pOut) const
+{
+	if(m_LastTickMarker == -1 || Tick - m_LastTickMarker > CHUNKMASK_TICK || Keyframe)
+	{
+		pOut[0] = CHUNKTYPEFLAG_TICKMARKER;
+		uint_to_bytes_be(pOut + 1, Tick);
+
+		if(Keyframe)
+			pOut[0] |= CHUNKTICKFLAG_KEYFRAME;
+
+		return sizeof(int32_t) + 1;
+	}
+	else
+	{
+		pOut[0] = CHUNKTYPEFLAG_TICKMARKER | CHUNKTICKFLAG_TICK_COMPRESSED | (Tick - m_LastTickMarker);
+		return 1;
+	}
+}
+
+void CDemoRecorder::UpdateTickMarker(int Tick)
+{
+	m_LastTickMarker = Tick;
+	if(m_FirstTick < 0)
+		m_FirstTick = Tick;
+}
+
+bool CDemoRecorder::Write(const unsigned char *pTickMarker, int TickMarkerSize, int Type, const void *pData, int Size)
+{
+	if(!m_pWriter)
+		return false;
+
+	if(Size > CDemoWriter::MAX_CHUNK_SIZE)
+		return false;
+
+	if(!m_pWriter->Push(pTickMarker, TickMarkerSize, Type, pData, Size, !m_DropChunks))
+	{
+		m_NumDroppedChunks++;
+		return false;
+	}
+	return true;
 }
 
 void CDemoRecorder::RecordSnapshot(int Tick, const void *pData, int Size)
 {
+	// state is only advanced for chunks that were queued, so a dropped
+	// snapshot leaves the next delta based on what is actually in the file
+	unsigned char aTickMarker[CDemoWriter::MAX_TICKMARKER_SIZE];
 	if(m_LastKeyFrame == -1 || (Tick - m_LastKeyFrame) > SERVER_TICK_SPEED * 5)
 	{
-		// write full tickmarker
-		WriteTickMarker(Tick, true);
-
-		// write snapshot
-		Write(CHUNKTYPE_SNAPSHOT, pData, Size);
+		// write full tickmarker and snapshot
+		const int TickMarkerSize = WriteTickMarker(Tick, true, aTickMarker);
+		if(!Write(aTickMarker, TickMarkerSize, CHUNKTYPE_SNAPSHOT, pData, Size))
+			return;
 
+		UpdateTickMarker(Tick);
 		m_LastKeyFrame = Tick;
 		mem_copy(m_aLastSnapshotData, pData, Size);
 	}
 	else
 	{
-		// write tickmarker
-		WriteTickMarker(Tick, false);
-
 		// create delta
 		char aDeltaData[CSnapshot::MAX_SIZE + sizeof(int)];
 		m_pSnapshotDelta->SetStaticsize(protocol7::NETEVENTTYPE_SOUNDWORLD, true);
 		m_pSnapshotDelta->SetStaticsize(protocol7::NETEVENTTYPE_DAMAGE, true);
 		const int DeltaSize = m_pSnapshotDelta->CreateDelta((CSnapshot *)m_aLastSnapshotData, (CSnapshot *)pData, &aDeltaData);
+
+		// write tickmarker and delta, if any
+		const int TickMarkerSize = WriteTickMarker(Tick, false, aTickMarker);
+		if(!Write(aTickMarker, TickMarkerSize, DeltaSize ? CHUNKTYPE_DELTA : 0, aDeltaData, DeltaSize))
+			return;
+
+		UpdateTickMarker(Tick);
 		if(DeltaSize)
-		{
-			// record delta
-			Write(CHUNKTYPE_DELTA, aDeltaData, DeltaSize);
 			mem_copy(m_aLastSnapshotData, pData, Size);
-		}
 	}
 }
 
@@ -356,7 +680,7 @@ void CDemoRecorder::RecordMessage(const void *pData, int Size)
 			return;
 		}
 	}
-	Write(CHUNKTYPE_MESSAGE, pData, Size);
+	Write(nullptr, 0, CHUNKTYPE_MESSAGE, pData, Size);
 }
 
 int CDemoRecorder::Stop(IDemoRecorder::EStopMode Mode, const char *pTargetFilename)
@@ -364,6 +688,17 @@ int CDemoRecorder::Stop(IDemoRecorder::EStopMode Mode, const char *pTargetFilena
 	if(!m_File)
 		return -1;
 
+	// flushes all queued chunks before the header is patched
+	delete m_pWriter;
+	m_pWriter = nullptr;
+
+	if(m_NumDroppedChunks > 0 && m_pConsole)
+	{
+		char aBuf[64 + IO_MAX_PATH_LENGTH];
+		str_format(aBuf, sizeof(aBuf), "Dropped %d chunks while recording to '%s'", m_NumDroppedChunks, m_aCurrentFilename);
+		m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "demo_recorder", aBuf, gs_DemoPrintColor);
+	}
+
 	if(Mode == IDemoRecorder::EStopMode::KEEP_FILE)
 	{
 		// add the demo length to the header
@@ -492,6 +827,7 @@ void CDemoPlayer::Construct(class CSnapshotDelta *pSnapshotDelta, bool UseVideo)
 	m_LastSnapshotDataSize = -1;
 	m_pListener = nullptr;
 	m_UseVideo = UseVideo;
+	m_UseIndex = false;
 
 	m_aFilename[0] = '\0';
 	m_aErrorMessage[0] = '\0';
@@ -502,6 +838,11 @@ void CDemoPlayer::SetListener(IListener *pListener)
 	m_pListener = pListener;
 }
 
+void CDemoPlayer::SetUseIndex(bool UseIndex)
+{
+	m_UseIndex = UseIndex;
+}
+
 CDemoPlayer::EReadChunkHeaderResult CDemoPlayer::ReadChunkHeader(int *pType, int *pSize, int *pTick)
 {
 	*pSize = 0;
@@ -567,14 +908,44 @@ CDemoPlayer::EReadChunkHeaderResult CDemoPlayer::ReadChunkHeader(int *pType, int
 	return CHUNKHEADER_SUCCESS;
 }
 
-bool CDemoPlayer::ScanFile()
+int CDemoPlayer::ReadChunkData(int ChunkSize, const char **ppError)
+{
+	if(io_read(m_File, m_aCompressedSnapshotData, ChunkSize) != (unsigned)ChunkSize)
+	{
+		*ppError = "Error reading chunk data";
+		return -1;
+	}
+
+	int DataSize = CNetBase::Decompress(m_aCompressedSnapshotData, ChunkSize, m_aDecompressedSnapshotData, sizeof(m_aDecompressedSnapshotData));
+	if(DataSize < 0)
+	{
+		*ppError = "Error during network decompression";
+		return -1;
+	}
+
+	DataSize = CVariableInt::Decompress(m_aDecompressedSnapshotData, DataSize, m_aChunkData, sizeof(m_aChunkData));
+	if(DataSize < 0)
+	{
+		*ppError = "Error during intpack decompression";
+		return -1;
+	}
+	return DataSize;
+}
+
+bool CDemoPlayer::ScanFile(bool CreateSeekPoints)
 {
 	const int64_t StartPos = io_tell(m_File);
 	m_vKeyFrames.clear();
+	m_vSeekPoints.clear();
+	m_vSeekPointData.clear();
 	if(StartPos < 0)
 		return false;
 
 	int ChunkTick = -1;
+	int LastSeekTick = -1;
+	m_LastSnapshotDataSize = -1;
+	// a separate delta keeps the scan out of the data rate stats of playback
+	std::unique_ptr<CSnapshotDelta> pScanDelta = CreateSeekPoints ? std::make_unique<CSnapshotDelta>(*m_pSnapshotDelta) : nullptr;
 	while(true)
 	{
 		const int64_t CurrentPos = io_tell(m_File);
@@ -585,6 +956,7 @@ bool CDemoPlayer::ScanFile()
 		}
 
 		int ChunkType, ChunkSize;
+		const int PreviousTick = ChunkTick;
 		const EReadChunkHeaderResult Result = ReadChunkHeader(&ChunkType, &ChunkSize, &ChunkTick);
 		if(Result == CHUNKHEADER_EOF)
 		{
@@ -601,12 +973,49 @@ bool CDemoPlayer::ScanFile()
 			if(ChunkType & CHUNKTICKFLAG_KEYFRAME)
 			{
 				m_vKeyFrames.emplace_back(CurrentPos, ChunkTick);
+				LastSeekTick = ChunkTick;
+			}
+			else if(CreateSeekPoints && m_LastSnapshotDataSize != -1 && PreviousTick != -1 && ChunkTick - LastSeekTick >= gs_SeekPointInterval)
+			{
+				AddSeekPoint(CurrentPos, ChunkTick, PreviousTick);
+				LastSeekTick = ChunkTick;
 			}
 
 			if(m_Info.m_Info.m_FirstTick == -1)
 				m_Info.m_Info.m_FirstTick = ChunkTick;
 			m_Info.m_Info.m_LastTick = ChunkTick;
 		}
+		else if(ChunkSize && CreateSeekPoints && (ChunkType == CHUNKTYPE_SNAPSHOT || ChunkType == CHUNKTYPE_DELTA))
+		{
+			// track the snapshots the same way DoTick does
+			const char *pError;
+			const int DataSize = ReadChunkData(ChunkSize, &pError);
+			if(DataSize < 0)
+			{
+				// playback stops here, so seek points past this chunk are useless
+				CreateSeekPoints = false;
+				if(io_seek(m_File, CurrentPos, IOSEEK_START) != 0 || ReadChunkHeader(&ChunkType, &ChunkSize, &ChunkTick) != CHUNKHEADER_SUCCESS || io_skip(m_File, ChunkSize) != 0)
+				{
+					m_vKeyFrames.clear();
+					return false;
+				}
+			}
+			else if(ChunkType == CHUNKTYPE_DELTA)
+			{
+				CSnapshot *pNewsnap = (CSnapshot *)m_aSnapshot;
+				const int SnapSize = pScanDelta->UnpackDelta((CSnapshot *)m_aLastSnapshotData, pNewsnap, m_aChunkData, DataSize, IsSixup());
+				if(SnapSize >= 0 && pNewsnap->IsValid(SnapSize))
+				{
+					m_LastSnapshotDataSize = SnapSize;
+					mem_copy(m_aLastSnapshotData, m_aSnapshot, SnapSize);
+				}
+			}
+			else if(((CSnapshot *)m_aChunkData)->IsValid(DataSize))
+			{
+				m_LastSnapshotDataSize = DataSize;
+				mem_copy(m_aLastSnapshotData, m_aChunkData, DataSize);
+			}
+		}
 		else if(ChunkSize)
 		{
 			if(io_skip(m_File, ChunkSize) != 0)
@@ -616,6 +1025,7 @@ bool CDemoPlayer::ScanFile()
 			}
 		}
 	}
+	m_LastSnapshotDataSize = -1;
 
 	if(io_seek(m_File, StartPos, IOSEEK_START) != 0)
 	{
@@ -626,6 +1036,276 @@ bool CDemoPlayer::ScanFile()
 	return !m_vKeyFrames.empty();
 }
 
+void CDemoPlayer::AddSeekPoint(int64_t Filepos, int Tick, int PreviousTick)
+{
+	// same encoding as the snapshot chunks in the demo itself
+	int Size = CVariableInt::Compress(m_aLastSnapshotData, m_LastSnapshotDataSize, m_aDecompressedSnapshotData, sizeof(m_aDecompressedSnapshotData));
+	if(Size < 0)
+		return;
+	Size = CNetBase::Compress(m_aDecompressedSnapshotData, Size, m_aCompressedSnapshotData, sizeof(m_aCompressedSnapshotData));
+	if(Size < 0)
+		return;
+
+	CSeekPoint SeekPoint;
+	SeekPoint.m_Filepos = Filepos;
+	SeekPoint.m_Tick = Tick;
+	SeekPoint.m_PreviousTick = PreviousTick;
+	SeekPoint.m_DataOffset = m_vSeekPointData.size();
+	SeekPoint.m_DataSize = Size;
+	m_vSeekPointData.insert(m_vSeekPointData.end(), m_aCompressedSnapshotData, m_aCompressedSnapshotData + Size);
+	m_vSeekPoints.push_back(SeekPoint);
+}
+
+bool CDemoPlayer::SeekToSeekPoint(const CSeekPoint &SeekPoint)
+{
+	int DataSize = CNetBase::Decompress(m_vSeekPointData.data() + SeekPoint.m_DataOffset, SeekPoint.m_DataSize, m_aDecompressedSnapshotData, sizeof(m_aDecompressedSnapshotData));
+	if(DataSize < 0)
+		return false;
+	DataSize = CVariableInt::Decompress(m_aDecompressedSnapshotData, DataSize, m_aLastSnapshotData, sizeof(m_aLastSnapshotData));
+	if(DataSize < 0 || !((CSnapshot *)m_aLastSnapshotData)->IsValid(DataSize))
+		return false;
+	if(io_seek(m_File, SeekPoint.m_Filepos, IOSEEK_START) != 0)
+		return false;
+
+	m_LastSnapshotDataSize = DataSize;
+	return true;
+}
+
+bool CDemoPlayer::CalculateFingerprint()
+{
+	// Hashing the whole demo would cost as much as scanning it, so only the
+	// size and the blocks at the start (with the header) and the end are used.
+	const int64_t StartPos = io_tell(m_File);
+	const int64_t Length = io_length(m_File);
+	if(StartPos < 0 || Length < 0)
+		return false;
+
+	SHA256_CTX Sha256Ctxt;
+	sha256_init(&Sha256Ctxt);
+	unsigned char aLength[sizeof(int64_t)];
+	uint_to_bytes_be(aLength, Length >> 32);
+	uint_to_bytes_be(aLength + sizeof(int32_t), Length & 0xffffffff);
+	sha256_update(&Sha256Ctxt, aLength, sizeof(aLength));
+
+	unsigned char aBuffer[16 * 1024];
+	const int64_t aBlockPositions[] = {0, maximum<int64_t>(Length - sizeof(aBuffer), 0)};
+	for(const int64_t BlockPosition : aBlockPositions)
+	{
+		if(io_seek(m_File, BlockPosition, IOSEEK_START) != 0)
+			return false;
+		const unsigned Bytes = io_read(m_File, aBuffer, sizeof(aBuffer));
+		sha256_update(&Sha256Ctxt, aBuffer, Bytes);
+	}
+	m_Fingerprint = sha256_finish(&Sha256Ctxt);
+
+	return io_seek(m_File, StartPos, IOSEEK_START) == 0;
+}
+
+void CDemoPlayer::IndexFilename(char *pBuffer, size_t BufferSize) const
+{
+	char aFingerprint[SHA256_MAXSTRSIZE];
+	sha256_str(m_Fingerprint, aFingerprint, sizeof(aFingerprint));
+	str_format(pBuffer, BufferSize, "demos/index/%s.idx", aFingerprint);
+}
+
+class CDemoIndexReader
+{
+	const unsigned char *m_pData;
+	unsigned m_Size;
+	unsigned m_Offset;
+
+public:
+	bool m_Error;
+
+	CDemoIndexReader(const void *pData, unsigned Size) :
+		m_pData((const unsigned char *)pData), m_Size(Size), m_Offset(0), m_Error(false) {}
+
+	const unsigned char *Raw(unsigned Size)
+	{
+		if(m_Error || Size > m_Size - m_Offset)
+		{
+			m_Error = true;
+			return nullptr;
+		}
+		const unsigned char *pResult = m_pData + m_Offset;
+		m_Offset += Size;
+		return pResult;
+	}
+
+	unsigned Uint()
+	{
+		const unsigned char *pData = Raw(sizeof(int32_t));
+		return pData ? bytes_be_to_uint(pData) : 0;
+	}
+
+	int64_t Int64()
+	{
+		const uint64_t High = Uint();
+		return (int64_t)((High << 32) | Uint());
+	}
+
+	bool AtEnd() const { return !m_Error && m_Offset == m_Size; }
+};
+
+bool CDemoPlayer::LoadIndex(IStorage *pStorage)
+{
+	char aFilename[IO_MAX_PATH_LENGTH];
+	IndexFilename(aFilename, sizeof(aFilename));
+	void *pData;
+	unsigned DataSize;
+	if(!pStorage->ReadFile(aFilename, IStorage::TYPE_SAVE, &pData, &DataSize))
+		return false;
+
+	const int64_t Length = io_length(m_File);
+	const int64_t StartPos = m_MapOffset + m_MapInfo.m_Size;
+	if(Length < 0 || io_seek(m_File, StartPos, IOSEEK_START) != 0)
+	{
+		free(pData);
+		return false;
+	}
+
+	CDemoIndexReader Reader(pData, DataSize);
+	const unsigned char *pMarker = Reader.Raw(sizeof(gs_aIndexMarker));
+	const unsigned Version = Reader.Uint();
+	const unsigned char *pFingerprint = Reader.Raw(sizeof(m_Fingerprint.data));
+	const int FirstTick = Reader.Uint();
+	const int LastTick = Reader.Uint();
+	const unsigned NumKeyFrames = Reader.Uint();
+	const unsigned NumSeekPoints = Reader.Uint();
+	const unsigned SeekPointDataSize = Reader.Uint();
+	bool Valid = !Reader.m_Error &&
+		     mem_comp(pMarker, gs_aIndexMarker, sizeof(gs_aIndexMarker)) == 0 &&
+		     Version == gs_IndexVersion &&
+		     mem_comp(pFingerprint, m_Fingerprint.data, sizeof(m_Fingerprint.data)) == 0 &&
+		     NumKeyFrames > 0 && NumKeyFrames <= DataSize && NumSeekPoints <= DataSize;
+
+	m_vKeyFrames.clear();
+	m_vSeekPoints.clear();
+	m_vSeekPointData.clear();
+	for(unsigned i = 0; Valid && i < NumKeyFrames; i++)
+	{
+		const int64_t Filepos = Reader.Int64();
+		const int Tick = Reader.Uint();
+		Valid = !Reader.m_Error && Filepos >= StartPos && Filepos < Length && Tick >= FirstTick && Tick <= LastTick &&
+			(m_vKeyFrames.empty() || Tick > m_vKeyFrames.back().m_Tick);
+		m_vKeyFrames.emplace_back(Filepos, Tick);
+	}
+	for(unsigned i = 0; Valid && i < NumSeekPoints; i++)
+	{
+		CSeekPoint SeekPoint;
+		SeekPoint.m_Filepos = Reader.Int64();
+		SeekPoint.m_Tick = Reader.Uint();
+		SeekPoint.m_PreviousTick = Reader.Uint();
+		SeekPoint.m_DataOffset = Reader.Uint();
+		SeekPoint.m_DataSize = Reader.Uint();
+		Valid = !Reader.m_Error && SeekPoint.m_Filepos >= StartPos && SeekPoint.m_Filepos < Length &&
+			SeekPoint.m_PreviousTick >= FirstTick && SeekPoint.m_PreviousTick < SeekPoint.m_Tick && SeekPoint.m_Tick <= LastTick &&
+			(m_vSeekPoints.empty() || SeekPoint.m_Tick > m_vSeekPoints.back().m_Tick) &&
+			SeekPoint.m_DataOffset <= SeekPointDataSize && SeekPoint.m_DataSize <= SeekPointDataSize - SeekPoint.m_DataOffset;
+		m_vSeekPoints.push_back(SeekPoint);
+	}
+	if(Valid)
+	{
+		const unsigned char *pSeekPointData = Reader.Raw(SeekPointDataSize);
+		Valid = Reader.AtEnd();
+		if(Valid)
+			m_vSeekPointData.assign(pSeekPointData, pSeekPointData + SeekPointDataSize);
+	}
+	free(pData);
+
+	if(!Valid)
+	{
+		m_vKeyFrames.clear();
+		m_vSeekPoints.clear();
+		return false;
+	}
+
+	m_Info.m_Info.m_FirstTick = FirstTick;
+	m_Info.m_Info.m_LastTick = LastTick;
+
+	// the modification time orders the indices for pruning, so refresh it now and then
+	time_t Created, Modified;
+	if(pStorage->RetrieveTimes(aFilename, IStorage::TYPE_SAVE, &Created, &Modified) && time(nullptr) - Modified > gs_IndexRefreshAge)
+		SaveIndex(pStorage);
+	return true;
+}
+
+void CDemoPlayer::SaveIndex(IStorage *pStorage) const
+{
+	std::vector<unsigned char> vData;
+	const auto &&AddUint = [&vData](unsigned Value) {
+		unsigned char aBytes[sizeof(int32_t)];
+		uint_to_bytes_be(aBytes, Value);
+		vData.insert(vData.end(), aBytes, aBytes + sizeof(aBytes));
+	};
+	const auto &&AddInt64 = [&AddUint](int64_t Value) {
+		AddUint((uint64_t)Value >> 32);
+		AddUint((uint64_t)Value & 0xffffffff);
+	};
+
+	vData.insert(vData.end(), gs_aIndexMarker, gs_aIndexMarker + sizeof(gs_aIndexMarker));
+	AddUint(gs_IndexVersion);
+	vData.insert(vData.end(), m_Fingerprint.data, m_Fingerprint.data + sizeof(m_Fingerprint.data));
+	AddUint(m_Info.m_Info.m_FirstTick);
+	AddUint(m_Info.m_Info.m_LastTick);
+	AddUint(m_vKeyFrames.size());
+	AddUint(m_vSeekPoints.size());
+	AddUint(m_vSeekPointData.size());
+	for(const CKeyFrame &KeyFrame : m_vKeyFrames)
+	{
+		AddInt64(KeyFrame.m_Filepos);
+		AddUint(KeyFrame.m_Tick);
+	}
+	for(const CSeekPoint &SeekPoint : m_vSeekPoints)
+	{
+		AddInt64(SeekPoint.m_Filepos);
+		AddUint(SeekPoint.m_Tick);
+		AddUint(SeekPoint.m_PreviousTick);
+		AddUint(SeekPoint.m_DataOffset);
+		AddUint(SeekPoint.m_DataSize);
+	}
+	vData.insert(vData.end(), m_vSeekPointData.begin(), m_vSeekPointData.end());
+
+	char aFilename[IO_MAX_PATH_LENGTH];
+	IndexFilename(aFilename, sizeof(aFilename));
+	IOHANDLE File = pStorage->OpenFile(aFilename, IOFLAG_WRITE, IStorage::TYPE_SAVE);
+	if(!File)
+		return;
+	io_write(File, vData.data(), vData.size());
+	io_close(File);
+
+	PruneIndex(pStorage);
+}
+
+void CDemoPlayer::PruneIndex(IStorage *pStorage)
+{
+	struct SIndexFile
+	{
+		std::string m_Name;
+		time_t m_Modified;
+	};
+	std::vector<SIndexFile> vIndexFiles;
+	pStorage->ListDirectoryInfo(
+		IStorage::TYPE_SAVE, "demos/index", [](const CFsFileInfo *pInfo, int IsDir, int StorageType, void *pUser) {
+			if(!IsDir && str_endswith(pInfo->m_pName, ".idx"))
+				static_cast<std::vector<SIndexFile> *>(pUser)->push_back({pInfo->m_pName, pInfo->m_TimeModified});
+			return 0;
+		},
+		&vIndexFiles);
+	if(vIndexFiles.size() <= gs_IndexMaxFiles)
+		return;
+
+	std::sort(vIndexFiles.begin(), vIndexFiles.end(), [](const SIndexFile &Left, const SIndexFile &Right) {
+		return Left.m_Modified < Right.m_Modified;
+	});
+	for(size_t i = 0; i < vIndexFiles.size() - gs_IndexMaxFiles; i++)
+	{
+		char aFilename[IO_MAX_PATH_LENGTH];
+		str_format(aFilename, sizeof(aFilename), "demos/index/%s", vIndexFiles[i].m_Name.c_str());
+		pStorage->RemoveFile(aFilename, IStorage::TYPE_SAVE);
+	}
+}
+
 void CDemoPlayer::DoTick()
 {
 	// update ticks
@@ -667,23 +1347,11 @@ void CDemoPlayer::DoTick()
 		int DataSize = 0;
 		if(ChunkSize)
 		{
-			if(io_read(m_File, m_aCompressedSnapshotData, ChunkSize) != (unsigned)ChunkSize)
-			{
-				Stop("Error reading chunk data");
-				break;
-			}
-
-			DataSize = CNetBase::Decompress(m_aCompressedSnapshotData, ChunkSize, m_aDecompressedSnapshotData, sizeof(m_aDecompressedSnapshotData));
+			const char *pError;
+			DataSize = ReadChunkData(ChunkSize, &pError);
 			if(DataSize < 0)
 			{
-				Stop("Error during network decompression");
-				break;
-			}
-
-			DataSize = CVariableInt::Decompress(m_aDecompressedSnapshotData, DataSize, m_aChunkData, sizeof(m_aChunkData));
-			if(DataSize < 0)
-			{
-				Stop("Error during intpack decompression");
+				Stop(pError);
 				break;
 			}
 		}
@@ -839,11 +1507,17 @@ int CDemoPlayer::Load(class IStorage *pStorage, class IConsole *pConsole, const
 		}
 	}
 
-	// scan the file for interesting points
-	if(!ScanFile())
+	// scan the file for interesting points, long demos keep the result in an index
+	const bool UseIndex = m_UseIndex && bytes_be_to_uint(m_Info.m_Header.m_aLength) >= (unsigned)gs_IndexMinLength && CalculateFingerprint();
+	if(!UseIndex || !LoadIndex(pStorage))
 	{
-		Stop("Error scanning demo file");
-		return -1;
+		if(!ScanFile(UseIndex))
+		{
+			Stop("Error scanning demo file");
+			return -1;
+		}
+		if(UseIndex)
+			SaveIndex(pStorage);
 	}
 
 	// reset slice markers
@@ -1012,14 +1686,40 @@ int CDemoPlayer::SetPos(int WantedTick)
 	while(KeyFrame > 0 && m_vKeyFrames[KeyFrame].m_Tick > KeyFrameWantedTick)
 		KeyFrame--;
 
-	// seek to the correct key frame
-	if(io_seek(m_File, m_vKeyFrames[KeyFrame].m_Filepos, IOSEEK_START) != 0)
+	// a seek point after the key frame saves replaying the ticks in between
+	const CSeekPoint *pSeekPoint = nullptr;
+	const auto SeekPointIt = std::upper_bound(m_vSeekPoints.begin(), m_vSeekPoints.end(), KeyFrameWantedTick, [](int Tick, const CSeekPoint &SeekPoint) { return Tick < SeekPoint.m_Tick; });
+	if(SeekPointIt != m_vSeekPoints.begin() && std::prev(SeekPointIt)->m_Tick > m_vKeyFrames[KeyFrame].m_Tick)
+		pSeekPoint = &*std::prev(SeekPointIt);
+	const int StartTick = pSeekPoint ? pSeekPoint->m_Tick : m_vKeyFrames[KeyFrame].m_Tick;
+
+	// when seeking forward, just continue if we are already past the start
+	if(m_Info.m_PreviousTick != -1 && m_Info.m_NextTick < WantedTick && m_Info.m_Info.m_CurrentTick >= StartTick)
 	{
-		Stop("Error seeking keyframe position");
-		return -1;
+		while(m_Info.m_NextTick < WantedTick && IsPlaying())
+			DoTick();
+
+		Play();
+
+		return 0;
+	}
+
+	if(pSeekPoint && SeekToSeekPoint(*pSeekPoint))
+	{
+		// the tick marker at the seek point may be relative to the previous one
+		m_Info.m_NextTick = pSeekPoint->m_PreviousTick;
+	}
+	else
+	{
+		// seek to the correct key frame
+		if(io_seek(m_File, m_vKeyFrames[KeyFrame].m_Filepos, IOSEEK_START) != 0)
+		{
+			Stop("Error seeking keyframe position");
+			return -1;
+		}
+		m_Info.m_NextTick = -1;
 	}
 
-	m_Info.m_NextTick = -1;
 	m_Info.m_Info.m_CurrentTick = -1;
 	m_Info.m_PreviousTick = -1;
 
@@ -1119,6 +1819,8 @@ void CDemoPlayer::Stop(const char *pErrorMessage)
 	io_close(m_File);
 	m_File = nullptr;
 	m_vKeyFrames.clear();
+	m_vSeekPoints.clear();
+	m_vSeekPointData.clear();
 	str_copy(m_aFilename, "");
 	str_copy(m_aErrorMessage, pErrorMessage);
 }
@@ -1274,6 +1976,7 @@ bool CDemoEditor::Slice(const char *pDemo, const char *pDst, int StartTick, int
 	}
 
 	CDemoRecorder DemoRecorder(m_pSnapshotDelta);
+	DemoRecorder.SetDropChunks(false);
 	unsigned char *pMapData = DemoPlayer.GetMapData(m_pStorage);
 	const int Result = DemoRecorder.Start(m_pStorage, m_pConsole, pDst, pInfo->m_Header.m_aNetversion, pMapInfo->m_aName, Sha256, pMapInfo->m_Crc, pInfo->m_Header.m_aType, pMapInfo->m_Size, pMapData, nullptr, pfnFilter, pUser) == -1;
 	free(pMapData);
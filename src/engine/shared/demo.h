@@ -37,8 +37,13 @@ class CDemoRecorder : public IDemoRecorder
 	DEMOFUNC_FILTER m_pfnFilter;
 	void *m_pUser;
 
-	void WriteTickMarker(int Tick, bool Keyframe);
-	void Write(int Type, const void *pData, int Size);
+	class CDemoWriter *m_pWriter = nullptr;
+	bool m_DropChunks = true;
+	int m_NumDroppedChunks = 0;
+
+	int WriteTickMarker(int Tick, bool Keyframe, unsigned char *pOut) const;
+	void UpdateTickMarker(int Tick);
+	bool Write(const unsigned char *pTickMarker, int TickMarkerSize, int Type, const void *pData, int Size);
 
 public:
 	CDemoRecorder(class CSnapshotDelta *pSnapshotDelta, bool NoMapData = false);
@@ -54,6 +59,11 @@ public:
 	void RecordSnapshot(int Tick, const void *pData, int Size);
 	void RecordMessage(const void *pData, int Size);
 
+	// When the writer thread cannot keep up, chunks are dropped by default so that
+	// recording never blocks the game loop. Offline tools should wait instead.
+	void SetDropChunks(bool DropChunks) { m_DropChunks = DropChunks; }
+	int NumDroppedChunks() const { return m_NumDroppedChunks; }
+
 	bool IsRecording() const override { return m_File != nullptr; }
 	const char *CurrentFilename() const override { return m_aCurrentFilename; }
 
@@ -108,12 +118,27 @@ private:
 		}
 	};
 
+	// Position right before a tick marker together with the snapshot that was
+	// current at that point, so playback can resume there without a keyframe.
+	class CSeekPoint
+	{
+	public:
+		int64_t m_Filepos;
+		int m_Tick;
+		int m_PreviousTick;
+		unsigned m_DataOffset;
+		unsigned m_DataSize;
+	};
+
 	class IConsole *m_pConsole;
 	IOHANDLE m_File;
 	int64_t m_MapOffset;
 	char m_aFilename[IO_MAX_PATH_LENGTH];
 	char m_aErrorMessage[256];
 	std::vector<CKeyFrame> m_vKeyFrames;
+	std::vector<CSeekPoint> m_vSeekPoints;
+	std::vector<unsigned char> m_vSeekPointData; // compressed snapshots of the seek points
+	SHA256_DIGEST m_Fingerprint;
 	CMapInfo m_MapInfo;
 	int m_SpeedIndex;
 
@@ -132,6 +157,7 @@ private:
 	class CSnapshotDelta *m_pSnapshotDelta;
 
 	bool m_UseVideo;
+	bool m_UseIndex;
 #if defined(CONF_VIDEORECORDER)
 	bool m_WasRecording = false;
 #endif
@@ -143,8 +169,16 @@ private:
 		CHUNKHEADER_EOF,
 	};
 	EReadChunkHeaderResult ReadChunkHeader(int *pType, int *pSize, int *pTick);
+	int ReadChunkData(int ChunkSize, const char **ppError);
 	void DoTick();
-	bool ScanFile();
+	bool ScanFile(bool CreateSeekPoints);
+	void AddSeekPoint(int64_t Filepos, int Tick, int PreviousTick);
+	bool SeekToSeekPoint(const CSeekPoint &SeekPoint);
+	bool CalculateFingerprint();
+	void IndexFilename(char *pBuffer, size_t BufferSize) const;
+	bool LoadIndex(class IStorage *pStorage);
+	void SaveIndex(class IStorage *pStorage) const;
+	static void PruneIndex(class IStorage *pStorage);
 	void UpdateTimes();
 
 	int64_t Time();
@@ -158,6 +192,7 @@ public:
 	void Construct(class CSnapshotDelta *pSnapshotDelta, bool UseVideo);
 
 	void SetListener(IListener *pListener);
+	void SetUseIndex(bool UseIndex);
 
 	int Load(class IStorage *pStorage, class IConsole *pConsole, const char *pFilename, int StorageType);
 	unsigned char *GetMapData(class IStorage *pStorage);
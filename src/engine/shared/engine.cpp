@@ -47,6 +47,23 @@ class CEngine : public IEngine
 		}
 	}
 
+	static void Con_DbgJobs(IConsole::IResult *pResult, void *pUserData)
+	{
+		CEngine *pEngine = static_cast<CEngine *>(pUserData);
+
+		std::vector<CJobQueueStats> vStats;
+		pEngine->m_JobPool.GetStats(vStats);
+		char aBuf[256];
+		for(const CJobQueueStats &Stats : vStats)
+		{
+			str_format(aBuf, sizeof(aBuf), "worker=%d priority=%s depth=%d added=%" PRIu64 " taken=%" PRIu64 " stolen=%" PRIu64 " wait_avg=%.3fms wait_max=%.3fms",
+				Stats.m_Worker, Stats.m_Priority == IJob::PRIORITY_HIGH ? "high" : "normal", (int)Stats.m_Depth,
+				Stats.m_NumAdded, Stats.m_NumTaken, Stats.m_NumStolen,
+				Stats.m_NumTaken == 0 ? 0.0 : Stats.m_WaitTotal / 1000.0 / Stats.m_NumTaken, Stats.m_WaitMax / 1000.0);
+			pEngine->m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "jobs", aBuf);
+		}
+	}
+
 public:
 	CEngine(bool Test, const char *pAppname, std::shared_ptr<CFutureLogger> pFutureLogger) :
 		m_pFutureLogger(std::move(pFutureLogger))
@@ -94,6 +111,7 @@ public:
 			return;
 
 		m_pConsole->Register("dbg_lognetwork", "", CFGFLAG_SERVER | CFGFLAG_CLIENT, Con_DbgLognetwork, this, "Log the network");
+		m_pConsole->Register("dbg_jobs", "", CFGFLAG_SERVER | CFGFLAG_CLIENT, Con_DbgJobs, this, "Print the queue statistics of the job pool");
 	}
 
 	void AddJob(std::shared_ptr<IJob> pJob) override
@@ -106,6 +124,11 @@ public:
 		m_JobPool.Shutdown();
 	}
 
+	void GetJobStats(std::vector<CJobQueueStats> &vStats) override
+	{
+		m_JobPool.GetStats(vStats);
+	}
+
 	void SetAdditionalLogger(std::shared_ptr<ILogger> &&pLogger) override
 	{
 		m_pFutureLogger->Set(pLogger);
@@ -12,6 +12,8 @@ CHostLookup::CHostLookup(const char *pHostname, int Nettype)
 	str_copy(m_aHostname, pHostname);
 	m_Nettype = Nettype;
 	Abortable(true);
+	// clients joining and connecting wait for the lookup
+	SetPriority(PRIORITY_HIGH);
 }
 
 void CHostLookup::Run()
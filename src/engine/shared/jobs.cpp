@@ -2,11 +2,16 @@
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
 #include "jobs.h"
 #include <algorithm>
+#include <iterator>
 
 IJob::IJob() :
-	m_pNext(nullptr),
 	m_State(STATE_QUEUED),
-	m_Abortable(false)
+	m_Abortable(false),
+	m_Priority(PRIORITY_NORMAL),
+	m_EnqueueTime(0),
+	m_pPool(nullptr),
+	m_NumPendingDependencies(0),
+	m_Finished(false)
 {
 }
 
@@ -42,9 +47,29 @@ bool IJob::IsAbortable() const
 	return m_Abortable;
 }
 
+void IJob::SetPriority(EJobPriority Priority)
+{
+	dbg_assert(Priority >= 0 && Priority < NUM_PRIORITIES, "Job priority invalid: %d", (int)Priority);
+	m_Priority = Priority;
+}
+
+IJob::EJobPriority IJob::Priority() const
+{
+	return m_Priority;
+}
+
+void IJob::AddDependency(std::shared_ptr<IJob> pDependency)
+{
+	dbg_assert(m_pPool == nullptr, "Dependencies must be added before the job is added to a job pool");
+	m_vpDependencies.push_back(std::move(pDependency));
+}
+
+thread_local CJobPool::CWorker *CJobPool::ms_pCurrentWorker = nullptr;
+
 CJobPool::CJobPool()
 {
 	m_Shutdown = true;
+	m_NextWorker = 0;
 }
 
 CJobPool::~CJobPool()
@@ -57,29 +82,52 @@ CJobPool::~CJobPool()
 
 void CJobPool::WorkerThread(void *pUser)
 {
-	static_cast<CJobPool *>(pUser)->RunLoop();
+	CWorker *pWorker = static_cast<CWorker *>(pUser);
+	pWorker->m_pPool->RunLoop(pWorker);
+}
+
+std::shared_ptr<IJob> CJobPool::TakeJob(CWorker *pWorker)
+{
+	const size_t NumWorkers = m_vpWorkers.size();
+	for(int Priority = 0; Priority < IJob::NUM_PRIORITIES; Priority++)
+	{
+		// own queue first, then steal from the other workers
+		for(size_t Offset = 0; Offset < NumWorkers; Offset++)
+		{
+			CQueue &Queue = m_vpWorkers[(pWorker->m_Index + Offset) % NumWorkers]->m_aQueues[Priority];
+			const CLockScope LockScope(Queue.m_Lock);
+			if(Queue.m_vpJobs.empty())
+				continue;
+
+			std::shared_ptr<IJob> pJob = std::move(Queue.m_vpJobs.front());
+			Queue.m_vpJobs.pop_front();
+			const int64_t Wait = (time_get() - pJob->m_EnqueueTime) * 1000000 / time_freq();
+			Queue.m_NumTaken++;
+			if(Offset != 0)
+				Queue.m_NumStolen++;
+			Queue.m_WaitTotal += Wait;
+			Queue.m_WaitMax = std::max(Queue.m_WaitMax, Wait);
+			return pJob;
+		}
+	}
+	return nullptr;
 }
 
-void CJobPool::RunLoop()
+void CJobPool::RunLoop(CWorker *pWorker)
 {
+	ms_pCurrentWorker = pWorker;
 	while(true)
 	{
 		// wait for job to become available
 		sphore_wait(&m_Semaphore);
 
-		// fetch job from queue
-		std::shared_ptr<IJob> pJob = nullptr;
+		// every signal belongs to a queued job, but another worker may have
+		// taken that one, leaving its own job in a queue we already checked
+		std::shared_ptr<IJob> pJob = TakeJob(pWorker);
+		while(!pJob && !m_Shutdown)
 		{
-			const CLockScope LockScope(m_Lock);
-			if(m_pFirstJob)
-			{
-				pJob = m_pFirstJob;
-				m_pFirstJob = m_pFirstJob->m_pNext;
-				// allow remaining objects in list to destruct, even when current object stays alive
-				pJob->m_pNext = nullptr;
-				if(!m_pFirstJob)
-					m_pLastJob = nullptr;
-			}
+			thread_yield();
+			pJob = TakeJob(pWorker);
 		}
 
 		if(pJob)
@@ -91,6 +139,7 @@ void CJobPool::RunLoop()
 				{
 					// job was aborted before it was started
 					pJob->m_State = IJob::STATE_ABORTED;
+					Finish(pJob.get());
 					continue;
 				}
 				dbg_assert(false, "Job state invalid. Job was reused or uninitialized.");
@@ -117,32 +166,44 @@ void CJobPool::RunLoop()
 					dbg_assert(false, "Job state invalid, must be either running or aborted");
 				}
 			}
+			Finish(pJob.get());
 		}
-		else if(m_Shutdown)
+		else
 		{
 			// shut down worker thread when pool is shutting down and no more jobs are left
 			break;
 		}
 	}
+	ms_pCurrentWorker = nullptr;
 }
 
 void CJobPool::Init(int NumThreads)
 {
 	dbg_assert(m_Shutdown, "Job pool already running");
+	dbg_assert(NumThreads > 0, "Job pool needs at least one worker thread");
 	m_Shutdown = false;
 
-	const CLockScope LockScope(m_Lock);
 	sphore_init(&m_Semaphore);
-	m_pFirstJob = nullptr;
-	m_pLastJob = nullptr;
+	m_NextWorker = 0;
+
+	// all workers must exist before the first one starts stealing
+	m_vpWorkers.clear();
+	m_vpWorkers.reserve(NumThreads);
+	for(int i = 0; i < NumThreads; i++)
+	{
+		std::unique_ptr<CWorker> pWorker = std::make_unique<CWorker>();
+		pWorker->m_pPool = this;
+		pWorker->m_Index = i;
+		pWorker->m_pThread = nullptr;
+		m_vpWorkers.push_back(std::move(pWorker));
+	}
 
 	// start worker threads
 	char aName[16]; // unix kernel length limit
-	m_vpThreads.reserve(NumThreads);
-	for(int i = 0; i < NumThreads; i++)
+	for(const std::unique_ptr<CWorker> &pWorker : m_vpWorkers)
 	{
-		str_format(aName, sizeof(aName), "CJobPool W%d", i);
-		m_vpThreads.push_back(thread_init(WorkerThread, this, aName));
+		str_format(aName, sizeof(aName), "CJobPool W%d", pWorker->m_Index);
+		pWorker->m_pThread = thread_init(WorkerThread, pWorker.get(), aName);
 	}
 }
 
@@ -151,34 +212,21 @@ void CJobPool::Shutdown()
 	dbg_assert(!m_Shutdown, "Job pool already shut down");
 	m_Shutdown = true;
 
-	// abort queued jobs
+	// abort queued jobs, only abortable jobs are removed from the queues
+	std::vector<std::shared_ptr<IJob>> vpAbortedJobs;
+	for(const std::unique_ptr<CWorker> &pWorker : m_vpWorkers)
 	{
-		const CLockScope LockScope(m_Lock);
-		std::shared_ptr<IJob> pJob = m_pFirstJob;
-		std::shared_ptr<IJob> pPrev = nullptr;
-		while(pJob != nullptr)
+		for(CQueue &Queue : pWorker->m_aQueues)
 		{
-			std::shared_ptr<IJob> pNext = pJob->m_pNext;
-			if(pJob->Abort())
-			{
-				// only remove abortable jobs from queue
-				pJob->m_pNext = nullptr;
-				if(pPrev)
-				{
-					pPrev->m_pNext = pNext;
-				}
-				else
-				{
-					m_pFirstJob = pNext;
-				}
-			}
-			else
-			{
-				pPrev = pJob;
-			}
-			pJob = pNext;
+			const CLockScope LockScope(Queue.m_Lock);
+			auto NewEnd = std::stable_partition(Queue.m_vpJobs.begin(), Queue.m_vpJobs.end(), [](const std::shared_ptr<IJob> &pJob) { return !pJob->Abort(); });
+			std::move(NewEnd, Queue.m_vpJobs.end(), std::back_inserter(vpAbortedJobs));
+			Queue.m_vpJobs.erase(NewEnd, Queue.m_vpJobs.end());
 		}
-		m_pLastJob = pPrev;
+	}
+	for(const std::shared_ptr<IJob> &pJob : vpAbortedJobs)
+	{
+		Finish(pJob.get());
 	}
 
 	// abort running jobs
@@ -191,40 +239,190 @@ void CJobPool::Shutdown()
 	}
 
 	// wake up all worker threads
-	for(size_t i = 0; i < m_vpThreads.size(); i++)
+	for(size_t i = 0; i < m_vpWorkers.size(); i++)
 	{
 		sphore_signal(&m_Semaphore);
 	}
 
 	// wait for all worker threads to finish
-	for(void *pThread : m_vpThreads)
+	for(const std::unique_ptr<CWorker> &pWorker : m_vpWorkers)
 	{
-		thread_wait(pThread);
+		thread_wait(pWorker->m_pThread);
 	}
 
-	m_vpThreads.clear();
 	sphore_destroy(&m_Semaphore);
 }
 
-void CJobPool::Add(std::shared_ptr<IJob> pJob)
+void CJobPool::Enqueue(std::shared_ptr<IJob> pJob)
 {
 	if(m_Shutdown)
 	{
 		// no jobs are accepted when the job pool is already shutting down
 		pJob->Abort();
+		Finish(pJob.get());
 		return;
 	}
 
-	// add job to queue
+	// jobs added by a worker stay with it, others are spread over all workers
+	CWorker *pWorker = ms_pCurrentWorker;
+	if(pWorker == nullptr || pWorker->m_pPool != this)
+		pWorker = m_vpWorkers[m_NextWorker.fetch_add(1) % m_vpWorkers.size()].get();
+
+	CQueue &Queue = pWorker->m_aQueues[pJob->m_Priority];
+	pJob->m_EnqueueTime = time_get();
 	{
-		const CLockScope LockScope(m_Lock);
-		if(m_pLastJob)
-			m_pLastJob->m_pNext = pJob;
-		m_pLastJob = std::move(pJob);
-		if(!m_pFirstJob)
-			m_pFirstJob = m_pLastJob;
+		const CLockScope LockScope(Queue.m_Lock);
+		Queue.m_vpJobs.push_back(std::move(pJob));
+		Queue.m_NumAdded++;
 	}
 
 	// signal a worker thread that a job is available
 	sphore_signal(&m_Semaphore);
 }
+
+void CJobPool::Finish(IJob *pJob)
+{
+	std::vector<std::shared_ptr<IJob>> vpDependents;
+	{
+		const CLockScope LockScope(pJob->m_DependentsLock);
+		pJob->m_Finished = true;
+		std::swap(vpDependents, pJob->m_vpDependents);
+	}
+
+	// the last finished dependency queues the dependent job
+	for(std::shared_ptr<IJob> &pDependent : vpDependents)
+	{
+		if(pDependent->m_NumPendingDependencies.fetch_sub(1) == 1)
+			pDependent->m_pPool->Enqueue(std::move(pDependent));
+	}
+}
+
+void CJobPool::Add(std::shared_ptr<IJob> pJob)
+{
+	dbg_assert(pJob->m_pPool == nullptr, "Job was already added to a job pool");
+	pJob->m_pPool = this;
+
+	// one extra count until all dependencies are registered, so finishing
+	// dependencies cannot queue the job early
+	pJob->m_NumPendingDependencies = 1;
+	for(const std::shared_ptr<IJob> &pDependency : pJob->m_vpDependencies)
+	{
+		const CLockScope LockScope(pDependency->m_DependentsLock);
+		if(!pDependency->m_Finished)
+		{
+			pJob->m_NumPendingDependencies++;
+			pDependency->m_vpDependents.push_back(pJob);
+		}
+	}
+	pJob->m_vpDependencies.clear();
+
+	if(pJob->m_NumPendingDependencies.fetch_sub(1) == 1)
+		Enqueue(std::move(pJob));
+}
+
+void CJobPool::GetStats(std::vector<CJobQueueStats> &vStats)
+{
+	vStats.clear();
+	for(const std::unique_ptr<CWorker> &pWorker : m_vpWorkers)
+	{
+		for(int Priority = 0; Priority < IJob::NUM_PRIORITIES; Priority++)
+		{
+			CQueue &Queue = pWorker->m_aQueues[Priority];
+			const CLockScope LockScope(Queue.m_Lock);
+			CJobQueueStats Stats;
+			Stats.m_Worker = pWorker->m_Index;
+			Stats.m_Priority = (IJob::EJobPriority)Priority;
+			Stats.m_Depth = Queue.m_vpJobs.size();
+			Stats.m_NumAdded = Queue.m_NumAdded;
+			Stats.m_NumTaken = Queue.m_NumTaken;
+			Stats.m_NumStolen = Queue.m_NumStolen;
+			Stats.m_WaitTotal = Queue.m_WaitTotal;
+			Stats.m_WaitMax = Queue.m_WaitMax;
+			vStats.push_back(Stats);
+		}
+	}
+}
+
+class CWorkBatch::CState
+{
+public:
+	size_t m_Num;
+	std::function<void(size_t Index)> m_Func;
+	std::atomic<size_t> m_NextIndex = 0;
+	std::unique_ptr<std::atomic<bool>[]> m_pDone;
+
+	// processes one work item, returns false when all have been claimed
+	bool ProcessNext()
+	{
+		const size_t Index = m_NextIndex.fetch_add(1);
+		if(Index >= m_Num)
+			return false;
+		m_Func(Index);
+		m_pDone[Index].store(true);
+		return true;
+	}
+};
+
+class CWorkBatch::CWorkJob : public IJob
+{
+	std::shared_ptr<CState> m_pState;
+
+	void Run() override
+	{
+		// jobs starting after all items have been claimed do not touch the function
+		while(m_pState->ProcessNext())
+		{
+		}
+	}
+
+public:
+	CWorkJob(std::shared_ptr<CState> pState) :
+		m_pState(std::move(pState))
+	{
+		// something is always waiting for a work batch
+		SetPriority(PRIORITY_HIGH);
+	}
+};
+
+CWorkBatch::CWorkBatch(size_t Num, std::function<void(size_t Index)> &&Func) :
+	m_pState(std::make_shared<CState>())
+{
+	m_pState->m_Num = Num;
+	m_pState->m_Func = std::move(Func);
+	m_pState->m_pDone = std::make_unique<std::atomic<bool>[]>(Num);
+	for(size_t i = 0; i < Num; i++)
+		m_pState->m_pDone[i].store(false);
+}
+
+CWorkBatch::~CWorkBatch()
+{
+	Wait();
+}
+
+void CWorkBatch::Start(const std::function<void(std::shared_ptr<IJob>)> &AddJob, size_t MaxJobs)
+{
+	const size_t NumJobs = std::min(MaxJobs, m_pState->m_Num);
+	for(size_t i = 0; i < NumJobs; i++)
+		AddJob(std::make_shared<CWorkJob>(m_pState));
+}
+
+void CWorkBatch::Wait(size_t Index)
+{
+	dbg_assert(Index < m_pState->m_Num, "Work item index invalid: %d", (int)Index);
+	while(!m_pState->m_pDone[Index].load())
+	{
+		if(m_pState->m_NextIndex.load() > Index || !m_pState->ProcessNext())
+		{
+			// the item is being processed by a job
+			thread_yield();
+		}
+	}
+}
+
+void CWorkBatch::Wait()
+{
+	if(m_pState->m_Num > 0)
+		Wait(m_pState->m_Num - 1);
+	for(size_t i = 0; i < m_pState->m_Num; i++)
+		Wait(i);
+}
@@ -8,9 +8,12 @@
 
 #include <atomic>
 #include <deque>
+#include <functional>
 #include <memory>
 #include <vector>
 
+class CJobPool;
+
 /**
  * A job which runs in a worker thread of a job pool.
  *
@@ -21,6 +24,25 @@ class IJob
 	friend class CJobPool;
 
 public:
+	/**
+	 * The priority class of a job. Workers always run queued jobs of a higher
+	 * priority before jobs of a lower priority.
+	 */
+	enum EJobPriority
+	{
+		/**
+		 * Job which something is waiting for, e.g. while loading a map.
+		 */
+		PRIORITY_HIGH = 0,
+
+		/**
+		 * Background job which nothing is waiting for immediately.
+		 */
+		PRIORITY_NORMAL,
+
+		NUM_PRIORITIES,
+	};
+
 	/**
 	 * The state of a job in the job pool.
 	 */
@@ -51,9 +73,17 @@ public:
 	};
 
 private:
-	std::shared_ptr<IJob> m_pNext;
 	std::atomic<EJobState> m_State;
 	std::atomic<bool> m_Abortable;
+	EJobPriority m_Priority;
+	int64_t m_EnqueueTime;
+
+	CJobPool *m_pPool;
+	std::vector<std::shared_ptr<IJob>> m_vpDependencies;
+	std::atomic<int> m_NumPendingDependencies;
+	CLock m_DependentsLock;
+	std::vector<std::shared_ptr<IJob>> m_vpDependents GUARDED_BY(m_DependentsLock);
+	bool m_Finished GUARDED_BY(m_DependentsLock);
 
 protected:
 	/**
@@ -70,6 +100,15 @@ protected:
 	 */
 	void Abortable(bool Abortable);
 
+	/**
+	 * Sets the priority class of this job.
+	 *
+	 * @remark Must be called before the job is added to a job pool.
+	 *
+	 * @see Priority
+	 */
+	void SetPriority(EJobPriority Priority);
+
 public:
 	IJob();
 	virtual ~IJob();
@@ -117,28 +156,106 @@ public:
 	 * @return `true` if the job can be aborted, `false` otherwise.
 	 */
 	bool IsAbortable() const;
+
+	/**
+	 * Returns the priority class of the job.
+	 *
+	 * @return Priority of the job.
+	 */
+	EJobPriority Priority() const;
+
+	/**
+	 * Makes this job a continuation of another job. The job is only queued
+	 * once all of its dependencies have finished, either because they were
+	 * completed or because they were aborted. A job whose dependency is never
+	 * added to a job pool never runs.
+	 *
+	 * @param pDependency The job which has to finish first.
+	 *
+	 * @remark Must be called before this job is added to a job pool.
+	 */
+	void AddDependency(std::shared_ptr<IJob> pDependency);
+};
+
+/**
+ * Statistics of one job queue of a worker thread.
+ *
+ * @see CJobPool::GetStats
+ */
+class CJobQueueStats
+{
+public:
+	int m_Worker;
+	IJob::EJobPriority m_Priority;
+	/**
+	 * Number of jobs currently waiting in the queue.
+	 */
+	size_t m_Depth;
+	uint64_t m_NumAdded;
+	/**
+	 * Number of jobs taken from the queue, including stolen ones.
+	 */
+	uint64_t m_NumTaken;
+	/**
+	 * Number of jobs taken from the queue by other worker threads.
+	 */
+	uint64_t m_NumStolen;
+	/**
+	 * Time in microseconds the taken jobs spent waiting in the queue.
+	 */
+	int64_t m_WaitTotal;
+	int64_t m_WaitMax;
 };
 
 /**
  * A job pool which runs jobs in one or more worker threads.
  *
+ * Every worker thread has its own queue for each priority class. Jobs added
+ * by a worker thread go to the queue of that worker, other jobs are spread
+ * over the workers. Workers which run out of jobs steal them from the other
+ * workers, higher priority jobs first.
+ *
  * @see IJob
  */
 class CJobPool
 {
-	std::vector<void *> m_vpThreads;
+	class CQueue
+	{
+	public:
+		CLock m_Lock;
+		std::deque<std::shared_ptr<IJob>> m_vpJobs GUARDED_BY(m_Lock);
+		uint64_t m_NumAdded GUARDED_BY(m_Lock) = 0;
+		uint64_t m_NumTaken GUARDED_BY(m_Lock) = 0;
+		uint64_t m_NumStolen GUARDED_BY(m_Lock) = 0;
+		int64_t m_WaitTotal GUARDED_BY(m_Lock) = 0;
+		int64_t m_WaitMax GUARDED_BY(m_Lock) = 0;
+	};
+
+	class CWorker
+	{
+	public:
+		CJobPool *m_pPool;
+		int m_Index;
+		void *m_pThread;
+		CQueue m_aQueues[IJob::NUM_PRIORITIES];
+	};
+
+	static thread_local CWorker *ms_pCurrentWorker;
+
+	std::vector<std::unique_ptr<CWorker>> m_vpWorkers;
 	std::atomic<bool> m_Shutdown;
+	std::atomic<unsigned> m_NextWorker;
 
-	CLock m_Lock;
 	SEMAPHORE m_Semaphore;
-	std::shared_ptr<IJob> m_pFirstJob GUARDED_BY(m_Lock);
-	std::shared_ptr<IJob> m_pLastJob GUARDED_BY(m_Lock);
 
 	CLock m_LockRunning;
 	std::deque<std::shared_ptr<IJob>> m_RunningJobs GUARDED_BY(m_LockRunning);
 
 	static void WorkerThread(void *pUser) NO_THREAD_SAFETY_ANALYSIS;
-	void RunLoop() NO_THREAD_SAFETY_ANALYSIS;
+	void RunLoop(CWorker *pWorker) NO_THREAD_SAFETY_ANALYSIS;
+	std::shared_ptr<IJob> TakeJob(CWorker *pWorker) NO_THREAD_SAFETY_ANALYSIS;
+	void Enqueue(std::shared_ptr<IJob> pJob) NO_THREAD_SAFETY_ANALYSIS;
+	void Finish(IJob *pJob) NO_THREAD_SAFETY_ANALYSIS;
 
 public:
 	CJobPool();
@@ -151,7 +268,7 @@ public:
 	 *
 	 * @remark Must be called on the main thread.
 	 */
-	void Init(int NumThreads) REQUIRES(!m_Lock);
+	void Init(int NumThreads);
 
 	/**
 	 * Shuts down the job pool. Aborts all abortable jobs. Then waits for all
@@ -159,16 +276,76 @@ public:
 	 *
 	 * @remark Must be called on the main thread.
 	 */
-	void Shutdown() REQUIRES(!m_Lock) REQUIRES(!m_LockRunning);
+	void Shutdown() REQUIRES(!m_LockRunning);
 
 	/**
-	 * Adds a job to the queue of the job pool.
+	 * Adds a job to the queue of the job pool. Jobs with unfinished
+	 * dependencies are queued once the dependencies have finished.
 	 *
 	 * @param pJob The job to enqueue.
 	 *
 	 * @remark If the job pool is already shutting down, no additional jobs
 	 * will be enqueue anymore. Abortable jobs will immediately be aborted.
 	 */
-	void Add(std::shared_ptr<IJob> pJob) REQUIRES(!m_Lock);
+	void Add(std::shared_ptr<IJob> pJob);
+
+	/**
+	 * Returns the statistics of all queues, ordered by worker and priority.
+	 *
+	 * @param vStats Receives the statistics.
+	 */
+	void GetStats(std::vector<CJobQueueStats> &vStats);
+};
+
+/**
+ * A fixed number of work items which are processed in parallel by jobs and
+ * by the thread waiting for them. Items are claimed in ascending order, so
+ * waiting never depends on a job pool having idle worker threads.
+ *
+ * @see CJobPool
+ */
+class CWorkBatch
+{
+	class CState;
+	class CWorkJob;
+	std::shared_ptr<CState> m_pState;
+
+public:
+	/**
+	 * Creates a batch of work items.
+	 *
+	 * @param Num The number of work items.
+	 * @param Func The function processing the work item with the given index.
+	 */
+	CWorkBatch(size_t Num, std::function<void(size_t Index)> &&Func);
+
+	/**
+	 * Waits for all work items to be processed.
+	 */
+	~CWorkBatch();
+
+	CWorkBatch(const CWorkBatch &Other) = delete;
+	CWorkBatch &operator=(const CWorkBatch &Other) = delete;
+
+	/**
+	 * Adds jobs which process work items until none are left.
+	 *
+	 * @param AddJob Function adding a job to a job pool.
+	 * @param MaxJobs The maximum number of jobs to add.
+	 */
+	void Start(const std::function<void(std::shared_ptr<IJob>)> &AddJob, size_t MaxJobs);
+
+	/**
+	 * Waits until a work item has been processed. Unclaimed work items up to
+	 * and including this one are processed on the calling thread.
+	 *
+	 * @param Index The index of the work item.
+	 */
+	void Wait(size_t Index);
+
+	/**
+	 * Waits until all work items have been processed.
+	 */
+	void Wait();
 };
 #endif
@@ -91,6 +91,12 @@ public:
 		dbg_assert(pInfo != nullptr, "Interface not found");
 		return pInfo->m_pInterface;
 	}
+
+	IInterface *FindInterfaceImpl(const char *pName) override
+	{
+		CInterfaceInfo *pInfo = FindInterfaceInfo(pName);
+		return pInfo == nullptr ? nullptr : pInfo->m_pInterface;
+	}
 };
 
 IKernel *IKernel::Create() { return new CKernel; }
@@ -4,6 +4,8 @@
 
 #include <base/log.h>
 
+#include <engine/engine.h>
+#include <engine/shared/jobs.h>
 #include <engine/storage.h>
 
 #include <game/mapitems.h>
@@ -35,6 +37,25 @@ void CMap::UnloadData(int Index)
 	m_DataFile.UnloadData(Index);
 }
 
+void CMap::PrefetchData(const std::vector<int> &vIndices)
+{
+	PrefetchReaderData(m_DataFile, vIndices);
+}
+
+void CMap::PrefetchReaderData(CDataFileReader &DataFile, const std::vector<int> &vIndices)
+{
+	// without an engine (e.g. in tools) the data is loaded on the calling thread
+	IEngine *pEngine = Kernel()->FindInterface<IEngine>();
+	if(pEngine == nullptr)
+	{
+		DataFile.PrefetchData(vIndices, nullptr);
+		return;
+	}
+	DataFile.PrefetchData(vIndices, [pEngine](std::shared_ptr<IJob> pJob) {
+		pEngine->AddJob(std::move(pJob));
+	});
+}
+
 int CMap::NumData() const
 {
 	return m_DataFile.NumData();
@@ -70,7 +91,7 @@ int CMap::NumItems() const
 	return m_DataFile.NumItems();
 }
 
-bool CMap::Load(const char *pMapName)
+bool CMap::Load(const char *pMapName, bool AllowMapping)
 {
 	IStorage *pStorage = Kernel()->RequestInterface<IStorage>();
 	if(!pStorage)
@@ -79,7 +100,7 @@ bool CMap::Load(const char *pMapName)
 	// Ensure current datafile is not left in an inconsistent state if loading fails,
 	// by loading the new datafile separately first.
 	CDataFileReader NewDataFile;
-	if(!NewDataFile.Open(pStorage, pMapName, IStorage::TYPE_ALL))
+	if(!NewDataFile.Open(pStorage, pMapName, IStorage::TYPE_ALL, AllowMapping))
 		return false;
 
 	// Check version
@@ -95,6 +116,19 @@ bool CMap::Load(const char *pMapName)
 	int GroupsStart, GroupsNum, LayersStart, LayersNum;
 	NewDataFile.GetType(MAPITEMTYPE_GROUP, &GroupsStart, &GroupsNum);
 	NewDataFile.GetType(MAPITEMTYPE_LAYER, &LayersStart, &LayersNum);
+
+	// Decompress the tile data of all layers in parallel first
+	std::vector<int> vTileData;
+	for(int l = 0; l < LayersNum; l++)
+	{
+		const CMapItemLayer *pLayer = static_cast<CMapItemLayer *>(NewDataFile.GetItem(LayersStart + l));
+		if(pLayer->m_Type == LAYERTYPE_TILES)
+		{
+			vTileData.push_back(reinterpret_cast<const CMapItemLayerTilemap *>(pLayer)->m_Data);
+		}
+	}
+	PrefetchReaderData(NewDataFile, vTileData);
+
 	for(int g = 0; g < GroupsNum; g++)
 	{
 		const CMapItemGroup *pGroup = static_cast<CMapItemGroup *>(NewDataFile.GetItem(GroupsStart + g));
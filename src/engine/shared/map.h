@@ -12,6 +12,8 @@ class CMap : public IEngineMap
 {
 	CDataFileReader m_DataFile;
 
+	void PrefetchReaderData(CDataFileReader &DataFile, const std::vector<int> &vIndices);
+
 public:
 	CMap();
 
@@ -22,6 +24,7 @@ public:
 	void *GetDataSwapped(int Index) override;
 	const char *GetDataString(int Index) override;
 	void UnloadData(int Index) override;
+	void PrefetchData(const std::vector<int> &vIndices) override;
 	int NumData() const override;
 
 	int GetItemSize(int Index) override;
@@ -31,7 +34,7 @@ public:
 	void *FindItem(int Type, int Id) override;
 	int NumItems() const override;
 
-	bool Load(const char *pMapName) override;
+	bool Load(const char *pMapName, bool AllowMapping = false) override;
 	void Unload() override;
 	bool IsLoaded() const override;
 	IOHANDLE File() const override;
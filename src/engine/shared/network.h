@@ -7,9 +7,12 @@
 #include "stun.h"
 
 #include <base/math.h>
+#include <base/system.h>
 #include <base/types.h>
 
 #include <array>
+#include <unordered_map>
+#include <vector>
 
 class CHuffman;
 class CNetBan;
@@ -389,6 +392,9 @@ class CNetServer
 	{
 	public:
 		CNetConnection m_Connection;
+		// address the slot is registered under in m_SlotsByAddr and m_SlotsByIp
+		NETADDR m_IndexedAddr;
+		bool m_Indexed = false;
 	};
 
 	struct CSpamConn
@@ -421,8 +427,16 @@ class CNetServer
 
 	CSpamConn m_aSpamConns[NET_CONNLIMIT_IPS];
 
+	// slots by peer address and by peer address without port, updated
+	// whenever a slot gets a new peer or is dropped
+	std::unordered_map<NETADDR, int> m_SlotsByAddr;
+	std::unordered_map<NETADDR, std::vector<int>> m_SlotsByIp;
+
 	CNetRecvUnpacker m_RecvUnpacker;
 
+	void IndexSlot(int Slot);
+	void UnindexSlot(int Slot);
+
 	void OnTokenCtrlMsg(NETADDR &Addr, int ControlMsg, const CNetPacketConstruct &Packet);
 	int OnSixupCtrlMsg(NETADDR &Addr, CNetChunk *pChunk, int ControlMsg, const CNetPacketConstruct &Packet, SECURITY_TOKEN &ResponseToken, SECURITY_TOKEN Token);
 	void OnPreConnMsg(NETADDR &Addr, CNetPacketConstruct &Packet);
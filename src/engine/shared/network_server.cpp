@@ -10,6 +10,8 @@
 #include <engine/shared/packer.h>
 #include <engine/shared/protocol.h>
 
+#include <algorithm>
+
 const int g_DummyMapCrc = 0xD6909B17;
 const unsigned char g_aDummyMapData[] = {
 	0x44, 0x41, 0x54, 0x41, 0x04, 0x00, 0x00, 0x00, 0xFA, 0x00, 0x00, 0x00,
@@ -100,6 +102,7 @@ int CNetServer::Drop(int ClientId, const char *pReason)
 		m_pfnDelClient(ClientId, pReason, m_pUser);
 
 	m_aSlots[ClientId].m_Connection.Disconnect(pReason);
+	UnindexSlot(ClientId);
 
 	return 0;
 }
@@ -146,10 +149,53 @@ void CNetServer::SendControl(NETADDR &Addr, int ControlMsg, const void *pExtra,
 	CNetBase::SendControlMsg(m_Socket, &Addr, 0, ControlMsg, pExtra, ExtraSize, SecurityToken);
 }
 
+static NETADDR AddrWithoutPort(NETADDR Addr)
+{
+	Addr.port = 0;
+	return Addr;
+}
+
+void CNetServer::IndexSlot(int Slot)
+{
+	UnindexSlot(Slot);
+
+	CSlot &IndexedSlot = m_aSlots[Slot];
+	IndexedSlot.m_IndexedAddr = *IndexedSlot.m_Connection.PeerAddress();
+	IndexedSlot.m_Indexed = true;
+	m_SlotsByAddr[IndexedSlot.m_IndexedAddr] = Slot;
+	m_SlotsByIp[AddrWithoutPort(IndexedSlot.m_IndexedAddr)].push_back(Slot);
+}
+
+void CNetServer::UnindexSlot(int Slot)
+{
+	CSlot &IndexedSlot = m_aSlots[Slot];
+	if(!IndexedSlot.m_Indexed)
+		return;
+	IndexedSlot.m_Indexed = false;
+
+	// another slot may have taken over the address while this one was timing out
+	auto AddrIt = m_SlotsByAddr.find(IndexedSlot.m_IndexedAddr);
+	if(AddrIt != m_SlotsByAddr.end() && AddrIt->second == Slot)
+		m_SlotsByAddr.erase(AddrIt);
+
+	auto IpIt = m_SlotsByIp.find(AddrWithoutPort(IndexedSlot.m_IndexedAddr));
+	if(IpIt != m_SlotsByIp.end())
+	{
+		std::vector<int> &vSlots = IpIt->second;
+		vSlots.erase(std::remove(vSlots.begin(), vSlots.end(), Slot), vSlots.end());
+		if(vSlots.empty())
+			m_SlotsByIp.erase(IpIt);
+	}
+}
+
 int CNetServer::NumClientsWithAddr(NETADDR Addr)
 {
+	auto IpIt = m_SlotsByIp.find(AddrWithoutPort(Addr));
+	if(IpIt == m_SlotsByIp.end())
+		return 0;
+
 	int FoundAddr = 0;
-	for(int i = 0; i < MaxClients(); ++i)
+	for(int i : IpIt->second)
 	{
 		if(m_aSlots[i].m_Connection.State() == NET_CONNSTATE_OFFLINE ||
 			(m_aSlots[i].m_Connection.State() == NET_CONNSTATE_ERROR &&
@@ -242,6 +288,7 @@ int CNetServer::TryAcceptClient(NETADDR &Addr, SECURITY_TOKEN SecurityToken, boo
 
 	// init connection slot
 	m_aSlots[Slot].m_Connection.DirectInit(Addr, SecurityToken, Token, Sixup);
+	IndexSlot(Slot);
 
 	if(VanillaAuth)
 	{
@@ -571,17 +618,16 @@ int CNetServer::OnSixupCtrlMsg(NETADDR &Addr, CNetChunk *pChunk, int ControlMsg,
 
 int CNetServer::GetClientSlot(const NETADDR &Addr)
 {
-	int Slot = -1;
+	auto AddrIt = m_SlotsByAddr.find(Addr);
+	if(AddrIt == m_SlotsByAddr.end())
+		return -1;
 
-	for(int i = 0; i < MaxClients(); i++)
+	const int Slot = AddrIt->second;
+	if(m_aSlots[Slot].m_Connection.State() == NET_CONNSTATE_OFFLINE ||
+		m_aSlots[Slot].m_Connection.State() == NET_CONNSTATE_ERROR ||
+		net_addr_comp(m_aSlots[Slot].m_Connection.PeerAddress(), &Addr) != 0)
 	{
-		if(m_aSlots[i].m_Connection.State() != NET_CONNSTATE_OFFLINE &&
-			m_aSlots[i].m_Connection.State() != NET_CONNSTATE_ERROR &&
-			net_addr_comp(m_aSlots[i].m_Connection.PeerAddress(), &Addr) == 0)
-
-		{
-			Slot = i;
-		}
+		return -1;
 	}
 
 	return Slot;
@@ -780,6 +826,8 @@ bool CNetServer::SetTimedOut(int ClientId, int OrigId)
 
 	m_aSlots[ClientId].m_Connection.SetTimedOut(ClientAddr(OrigId), m_aSlots[OrigId].m_Connection.SeqSequence(), m_aSlots[OrigId].m_Connection.AckSequence(), m_aSlots[OrigId].m_Connection.SecurityToken(), m_aSlots[OrigId].m_Connection.ResendBuffer(), m_aSlots[OrigId].m_Connection.m_Sixup);
 	m_aSlots[OrigId].m_Connection.Reset();
+	UnindexSlot(OrigId);
+	IndexSlot(ClientId);
 	return true;
 }
 
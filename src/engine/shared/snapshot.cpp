@@ -4,8 +4,10 @@
 #include "compression.h"
 #include "uuid_manager.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <limits>
+#include <utility>
 
 #include <base/math.h>
 #include <base/system.h>
@@ -57,7 +59,7 @@ int CSnapshot::GetExternalItemType(int InternalType) const
 
 int CSnapshot::GetItemIndex(int Key) const
 {
-	// TODO: OPT: this should not be a linear search. very bad
+	// linear search, use CSnapshotIndex for repeated lookups
 	for(int i = 0; i < m_NumItems; i++)
 	{
 		if(GetItem(i)->Key() == Key)
@@ -159,6 +161,133 @@ bool CSnapshot::IsValid(size_t ActualSize) const
 	return true;
 }
 
+// CSnapshotIndex
+
+void CSnapshotIndex::Build(const CSnapshot *pSnapshot)
+{
+	m_pSnapshot = pSnapshot;
+	m_NumItems = pSnapshot->NumItems();
+	m_SortedValid = false;
+	dbg_assert(m_NumItems <= CSnapshot::MAX_ITEMS, "Too many snap items");
+
+	for(short &TableIndex : m_aTableIndices)
+		TableIndex = -1;
+
+	for(int i = 0; i < m_NumItems; i++)
+	{
+		const int Key = pSnapshot->GetItem(i)->Key();
+		unsigned Slot = Hash(Key) & TABLE_MASK;
+		while(m_aTableIndices[Slot] != -1 && m_aTableKeys[Slot] != Key)
+			Slot = (Slot + 1) & TABLE_MASK;
+		// keep the first item on duplicate keys, same as the linear search
+		if(m_aTableIndices[Slot] == -1)
+		{
+			m_aTableKeys[Slot] = Key;
+			m_aTableIndices[Slot] = i;
+		}
+	}
+}
+
+void CSnapshotIndex::BuildSorted() const
+{
+	if(m_SortedValid)
+		return;
+
+	std::pair<int, short> aSorted[CSnapshot::MAX_ITEMS];
+	for(int i = 0; i < m_NumItems; i++)
+		aSorted[i] = {m_pSnapshot->GetItem(i)->Key(), (short)i};
+	std::sort(aSorted, aSorted + m_NumItems);
+	for(int i = 0; i < m_NumItems; i++)
+	{
+		m_aSortedKeys[i] = aSorted[i].first;
+		m_aSortedIndices[i] = aSorted[i].second;
+	}
+	m_SortedValid = true;
+}
+
+int CSnapshotIndex::GetItemIndex(int Key) const
+{
+	unsigned Slot = Hash(Key) & TABLE_MASK;
+	while(m_aTableIndices[Slot] != -1)
+	{
+		if(m_aTableKeys[Slot] == Key)
+			return m_aTableIndices[Slot];
+		Slot = (Slot + 1) & TABLE_MASK;
+	}
+	return -1;
+}
+
+int CSnapshotIndex::GetExternalItemType(int InternalType) const
+{
+	if(InternalType < CSnapshot::OFFSET_UUID_TYPE)
+	{
+		return InternalType;
+	}
+
+	int TypeItemIndex = GetItemIndex(InternalType); // NETOBJTYPE_EX
+	if(TypeItemIndex == -1 || m_pSnapshot->GetItemSize(TypeItemIndex) < (int)sizeof(CUuid))
+	{
+		return InternalType;
+	}
+	const CSnapshotItem *pTypeItem = m_pSnapshot->GetItem(TypeItemIndex);
+	CUuid Uuid;
+	for(size_t i = 0; i < sizeof(CUuid) / sizeof(int32_t); i++)
+		uint_to_bytes_be(&Uuid.m_aData[i * sizeof(int32_t)], pTypeItem->Data()[i]);
+
+	return g_UuidManager.LookupUuid(Uuid);
+}
+
+int CSnapshotIndex::LookupUuidType(int Type) const
+{
+	CUuid TypeUuid = g_UuidManager.GetUuid(Type);
+	int aTypeUuidItem[sizeof(CUuid) / sizeof(int32_t)];
+	for(size_t i = 0; i < sizeof(CUuid) / sizeof(int32_t); i++)
+		aTypeUuidItem[i] = bytes_be_to_uint(&TypeUuid.m_aData[i * sizeof(int32_t)]);
+
+	BuildSorted();
+	// the type items are the items of type 0 with an id of at least OFFSET_UUID_TYPE
+	const int *pKeys = m_aSortedKeys;
+	const int *pKeysEnd = pKeys + m_NumItems;
+	for(const int *pKey = std::lower_bound(pKeys, pKeysEnd, CSnapshot::OFFSET_UUID_TYPE); pKey < pKeysEnd && (*pKey >> 16) == 0; pKey++)
+	{
+		const CSnapshotItem *pItem = m_pSnapshot->GetItem(m_aSortedIndices[pKey - m_aSortedKeys]);
+		if(mem_comp(pItem->Data(), aTypeUuidItem, sizeof(CUuid)) == 0)
+			return pItem->Id();
+	}
+	return -1;
+}
+
+const void *CSnapshotIndex::FindItem(int Type, int Id) const
+{
+	int InternalType = Type;
+	if(Type >= OFFSET_UUID)
+	{
+		InternalType = LookupUuidType(Type);
+		if(InternalType == -1)
+			return nullptr;
+	}
+	int Index = GetItemIndex((InternalType << 16) | Id);
+	return Index < 0 ? nullptr : m_pSnapshot->GetItem(Index)->Data();
+}
+
+CSnapshotIndex::CTypeRange CSnapshotIndex::ItemsOfType(int Type) const
+{
+	int InternalType = Type;
+	if(Type >= OFFSET_UUID)
+	{
+		InternalType = LookupUuidType(Type);
+		if(InternalType == -1)
+			return CTypeRange(m_aSortedIndices, m_aSortedIndices);
+	}
+
+	BuildSorted();
+	const int *pKeys = m_aSortedKeys;
+	const int *pKeysEnd = pKeys + m_NumItems;
+	const int *pBegin = std::lower_bound(pKeys, pKeysEnd, InternalType, [](int Key, int T) { return (Key >> 16) < T; });
+	const int *pEnd = std::upper_bound(pBegin, pKeysEnd, InternalType, [](int T, int Key) { return T < (Key >> 16); });
+	return CTypeRange(m_aSortedIndices + (pBegin - m_aSortedKeys), m_aSortedIndices + (pEnd - m_aSortedKeys));
+}
+
 // CSnapshotDelta
 
 enum
@@ -291,7 +420,12 @@ const CSnapshotDelta::CData *CSnapshotDelta::EmptyDelta() const
 }
 
 // TODO: OPT: this should be made much faster
-int CSnapshotDelta::CreateDelta(const CSnapshot *pFrom, const CSnapshot *pTo, void *pDstData)
+int CSnapshotDelta::CreateDelta(const CSnapshot *pFrom, const CSnapshot *pTo, void *pDstData) const
+{
+	return CreateDelta(pFrom, pTo, pDstData, m_aItemSizes);
+}
+
+int CSnapshotDelta::CreateDelta(const CSnapshot *pFrom, const CSnapshot *pTo, void *pDstData, const short *pItemSizes)
 {
 	CData *pDelta = (CData *)pDstData;
 	int *pData = (int *)pDelta->m_aData;
@@ -334,7 +468,7 @@ int CSnapshotDelta::CreateDelta(const CSnapshot *pFrom, const CSnapshot *pTo, vo
 		const int ItemSize = pTo->GetItemSize(i); // O(1) .. O(n)
 		const CSnapshotItem *pCurItem = pTo->GetItem(i); // O(1) .. O(n)
 		const int PastIndex = aPastIndices[i];
-		const bool IncludeSize = pCurItem->Type() >= MAX_NETOBJSIZES || !m_aItemSizes[pCurItem->Type()];
+		const bool IncludeSize = pCurItem->Type() >= MAX_NETOBJSIZES || !pItemSizes[pCurItem->Type()];
 
 		if(PastIndex != -1)
 		{
@@ -515,6 +649,9 @@ int CSnapshotDelta::UnpackDelta(const CSnapshot *pFrom, CSnapshot *pTo, const vo
 	CSnapshotBuilder Builder;
 	Builder.Init();
 
+	CSnapshotIndex FromIndex;
+	FromIndex.Build(pFrom);
+
 	// unpack deleted stuff
 	int *pDeleted = pData;
 	if(pDelta->m_NumDeletedItems < 0)
@@ -589,11 +726,11 @@ int CSnapshotDelta::UnpackDelta(const CSnapshot *pFrom, CSnapshot *pTo, const vo
 		if(!pNewData)
 			return -302;
 
-		const int FromIndex = pFrom->GetItemIndex(Key);
-		if(FromIndex != -1)
+		const int FromItemIndex = FromIndex.GetItemIndex(Key);
+		if(FromItemIndex != -1)
 		{
 			// we got an update so we need to apply the diff
-			UndiffItem(pFrom->GetItem(FromIndex)->Data(), pData, pNewData, ItemSize / sizeof(int32_t), &m_aSnapshotDataRate[Type]);
+			UndiffItem(pFrom->GetItem(FromItemIndex)->Data(), pData, pNewData, ItemSize / sizeof(int32_t), &m_aSnapshotDataRate[Type]);
 		}
 		else // no previous, just copy the pData
 		{
@@ -615,6 +752,26 @@ void CSnapshotStorage::Init()
 {
 	m_pFirst = nullptr;
 	m_pLast = nullptr;
+	for(CHolder *&pHolder : m_apTickIndex)
+		pHolder = nullptr;
+}
+
+void CSnapshotStorage::Free(CHolder *pHolder)
+{
+	CHolder *&pIndexed = m_apTickIndex[pHolder->m_Tick & (TICK_INDEX_SIZE - 1)];
+	if(pIndexed == pHolder)
+		pIndexed = nullptr;
+
+	m_StoredSize -= sizeof(CHolder) + pHolder->m_SnapSize + pHolder->m_AltSnapSize;
+	if(pHolder->m_InArena)
+	{
+		dbg_assert(m_pArena->First() == pHolder, "snapshots must be freed in the order they were added");
+		m_pArena->PopFirst();
+	}
+	else
+	{
+		free(pHolder);
+	}
 }
 
 void CSnapshotStorage::PurgeAll()
@@ -622,12 +779,12 @@ void CSnapshotStorage::PurgeAll()
 	while(m_pFirst)
 	{
 		CHolder *pNext = m_pFirst->m_pNext;
-		free(m_pFirst->m_pSnap);
-		free(m_pFirst->m_pAltSnap);
-		free(m_pFirst);
+		Free(m_pFirst);
 		m_pFirst = pNext;
 	}
 	m_pLast = nullptr;
+	// release the memory of unused storages, the arena is recreated with the wanted size on the next snapshot
+	m_pArena = nullptr;
 }
 
 void CSnapshotStorage::PurgeUntil(int Tick)
@@ -639,9 +796,7 @@ void CSnapshotStorage::PurgeUntil(int Tick)
 		CHolder *pNext = pHolder->m_pNext;
 		if(pHolder->m_Tick >= Tick)
 			return; // no more to remove
-		free(pHolder->m_pSnap);
-		free(pHolder->m_pAltSnap);
-		free(pHolder);
+		Free(pHolder);
 
 		// did we come to the end of the list?
 		if(!pNext)
@@ -662,17 +817,41 @@ void CSnapshotStorage::Add(int Tick, int64_t Tagtime, size_t DataSize, const voi
 	dbg_assert(DataSize <= (size_t)CSnapshot::MAX_SIZE, "Snapshot data size invalid");
 	dbg_assert(AltDataSize <= (size_t)CSnapshot::MAX_SIZE, "Alt snapshot data size invalid");
 
-	CHolder *pHolder = static_cast<CHolder *>(malloc(sizeof(CHolder)));
+	// the holder and both snapshots are stored in one block, in the arena if
+	// there is space left and on the heap otherwise
+	const size_t TotalSize = sizeof(CHolder) + DataSize + AltDataSize;
+	m_StoredSize += TotalSize;
+	// the arena can only be resized while it holds no snapshots, so new
+	// snapshots go to the heap until the ones in the arena are purged
+	if(!m_pArena || (m_ArenaSize < m_WantedArenaSize && !m_pArena->First()))
+	{
+		m_ArenaSize = m_WantedArenaSize;
+		m_pArena = std::make_unique<CDynamicRingBuffer<CHolder>>(m_ArenaSize);
+	}
+	CHolder *pHolder = m_ArenaSize == m_WantedArenaSize ? m_pArena->Allocate(TotalSize) : nullptr;
+	if(pHolder)
+	{
+		pHolder->m_InArena = true;
+		m_NumArenaAllocations++;
+	}
+	else
+	{
+		pHolder = static_cast<CHolder *>(malloc(TotalSize));
+		pHolder->m_InArena = false;
+		m_NumHeapAllocations++;
+		while(m_WantedArenaSize < 2 * m_StoredSize && m_WantedArenaSize < (size_t)MAX_ARENA_SIZE)
+			m_WantedArenaSize *= 2;
+	}
 	pHolder->m_Tick = Tick;
 	pHolder->m_Tagtime = Tagtime;
 
-	pHolder->m_pSnap = static_cast<CSnapshot *>(malloc(DataSize));
+	pHolder->m_pSnap = reinterpret_cast<CSnapshot *>(pHolder + 1);
 	mem_copy(pHolder->m_pSnap, pData, DataSize);
 	pHolder->m_SnapSize = DataSize;
 
 	if(AltDataSize) // create alternative if wanted
 	{
-		pHolder->m_pAltSnap = static_cast<CSnapshot *>(malloc(AltDataSize));
+		pHolder->m_pAltSnap = reinterpret_cast<CSnapshot *>(reinterpret_cast<char *>(pHolder->m_pSnap) + DataSize);
 		mem_copy(pHolder->m_pAltSnap, pAltData, AltDataSize);
 		pHolder->m_AltSnapSize = AltDataSize;
 	}
@@ -690,29 +869,34 @@ void CSnapshotStorage::Add(int Tick, int64_t Tagtime, size_t DataSize, const voi
 	else
 		m_pFirst = pHolder;
 	m_pLast = pHolder;
+
+	m_apTickIndex[Tick & (TICK_INDEX_SIZE - 1)] = pHolder;
 }
 
 int CSnapshotStorage::Get(int Tick, int64_t *pTagtime, const CSnapshot **ppData, const CSnapshot **ppAltData) const
 {
-	CHolder *pHolder = m_pFirst;
+	CHolder *pHolder = m_apTickIndex[Tick & (TICK_INDEX_SIZE - 1)];
+	if(pHolder && pHolder->m_Tick != Tick)
+		pHolder = nullptr;
 
-	while(pHolder)
+	// the index can only miss stored snapshots if their ticks span more than its size
+	if(!pHolder && m_pFirst && m_pLast->m_Tick - m_pFirst->m_Tick >= TICK_INDEX_SIZE)
 	{
-		if(pHolder->m_Tick == Tick)
-		{
-			if(pTagtime)
-				*pTagtime = pHolder->m_Tagtime;
-			if(ppData)
-				*ppData = pHolder->m_pSnap;
-			if(ppAltData)
-				*ppAltData = pHolder->m_pAltSnap;
-			return pHolder->m_SnapSize;
-		}
-
-		pHolder = pHolder->m_pNext;
+		pHolder = m_pFirst;
+		while(pHolder && pHolder->m_Tick != Tick)
+			pHolder = pHolder->m_pNext;
 	}
 
-	return -1;
+	if(!pHolder)
+		return -1;
+
+	if(pTagtime)
+		*pTagtime = pHolder->m_Tagtime;
+	if(ppData)
+		*ppData = pHolder->m_pSnap;
+	if(ppAltData)
+		*ppAltData = pHolder->m_pAltSnap;
+	return pHolder->m_SnapSize;
 }
 
 // CSnapshotBuilder
@@ -5,6 +5,9 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
+
+#include <engine/shared/ringbuffer.h>
 
 #include <game/generated/protocol.h>
 #include <game/generated/protocol7.h>
@@ -68,6 +71,70 @@ public:
 	static const CSnapshot *EmptySnapshot() { return &ms_EmptySnapshot; }
 };
 
+// CSnapshotIndex
+
+/**
+ * Lookup table for the items of a single snapshot.
+ *
+ * Maps item keys to item indices with an open-addressing hash table. The item
+ * indices sorted by key, used to iterate all items of one type without
+ * scanning the whole snapshot, are only built on the first lookup that needs
+ * them. The snapshot itself is not modified, so the index must be rebuilt
+ * whenever its contents change.
+ */
+class CSnapshotIndex
+{
+	enum
+	{
+		TABLE_SIZE = 2 * CSnapshot::MAX_ITEMS, // must be a power of two
+		TABLE_MASK = TABLE_SIZE - 1,
+	};
+
+	const CSnapshot *m_pSnapshot = nullptr;
+	int m_NumItems = 0;
+
+	int m_aTableKeys[TABLE_SIZE];
+	short m_aTableIndices[TABLE_SIZE]; // -1 marks an empty slot
+
+	mutable bool m_SortedValid = false;
+	mutable int m_aSortedKeys[CSnapshot::MAX_ITEMS];
+	mutable short m_aSortedIndices[CSnapshot::MAX_ITEMS];
+
+	static unsigned Hash(int Key) { return ((unsigned)Key * 2654435761u) >> 16; }
+	void BuildSorted() const;
+	int LookupUuidType(int Type) const;
+
+public:
+	class CTypeRange
+	{
+		const short *m_pBegin;
+		const short *m_pEnd;
+
+	public:
+		CTypeRange(const short *pBegin, const short *pEnd) :
+			m_pBegin(pBegin), m_pEnd(pEnd) {}
+		const short *begin() const { return m_pBegin; }
+		const short *end() const { return m_pEnd; }
+		int Size() const { return m_pEnd - m_pBegin; }
+	};
+
+	void Build(const CSnapshot *pSnapshot);
+	void Reset() { m_pSnapshot = nullptr; }
+	const CSnapshot *Snapshot() const { return m_pSnapshot; }
+
+	int GetItemIndex(int Key) const;
+	int GetExternalItemType(int InternalType) const;
+	int GetItemType(int Index) const { return GetExternalItemType(m_pSnapshot->GetItem(Index)->Type()); }
+	const void *FindItem(int Type, int Id) const;
+
+	/**
+	 * Item indices of all items with the given type, in ascending order of their ids.
+	 *
+	 * @param Type Type of the items, may be an extended (UUID) type.
+	 */
+	CTypeRange ItemsOfType(int Type) const;
+};
+
 // CSnapshotDelta
 
 class CSnapshotDelta
@@ -82,11 +149,12 @@ public:
 		int m_aData[1];
 	};
 
-private:
 	enum
 	{
 		MAX_NETOBJSIZES = 64
 	};
+
+private:
 	short m_aItemSizes[MAX_NETOBJSIZES];
 	short m_aItemSizes7[MAX_NETOBJSIZES];
 	uint64_t m_aSnapshotDataRate[CSnapshot::MAX_TYPE + 1];
@@ -103,8 +171,16 @@ public:
 	uint64_t GetDataUpdates(int Index) const { return m_aSnapshotDataUpdates[Index]; }
 	void SetStaticsize(int ItemType, size_t Size);
 	void SetStaticsize7(int ItemType, size_t Size);
+	const short *Staticsizes() const { return m_aItemSizes; }
 	const CData *EmptyDelta() const;
-	int CreateDelta(const CSnapshot *pFrom, const CSnapshot *pTo, void *pDstData);
+	int CreateDelta(const CSnapshot *pFrom, const CSnapshot *pTo, void *pDstData) const;
+	/**
+	 * Creates a delta with the given static item sizes instead of the ones of
+	 * an instance. Touches no shared state, so it can run on several threads.
+	 *
+	 * @param pItemSizes Static sizes of the first `MAX_NETOBJSIZES` item types.
+	 */
+	static int CreateDelta(const CSnapshot *pFrom, const CSnapshot *pTo, void *pDstData, const short *pItemSizes);
 	int UnpackDelta(const CSnapshot *pFrom, CSnapshot *pTo, const void *pSrcData, int DataSize, bool Sixup);
 	int DebugDumpDelta(const void *pSrcData, int DataSize);
 };
@@ -128,6 +204,17 @@ public:
 
 		CSnapshot *m_pSnap;
 		CSnapshot *m_pAltSnap;
+
+		bool m_InArena;
+	};
+
+	enum
+	{
+		// the arena starts small and grows to twice the size of the retained
+		// snapshots, the maximum fits three seconds of full size snapshots
+		MIN_ARENA_SIZE = 64 * 1024,
+		MAX_ARENA_SIZE = 16 * 1024 * 1024,
+		TICK_INDEX_SIZE = 256, // must be a power of two
 	};
 
 	CHolder *m_pFirst;
@@ -135,11 +222,31 @@ public:
 
 	CSnapshotStorage() { Init(); }
 	~CSnapshotStorage() { PurgeAll(); }
+
 	void Init();
 	void PurgeAll();
 	void PurgeUntil(int Tick);
 	void Add(int Tick, int64_t Tagtime, size_t DataSize, const void *pData, size_t AltDataSize, const void *pAltData);
 	int Get(int Tick, int64_t *pTagtime, const CSnapshot **ppData, const CSnapshot **ppAltData) const;
+
+	// number of snapshots that were stored in the arena and on the heap respectively
+	uint64_t NumArenaAllocations() const { return m_NumArenaAllocations; }
+	uint64_t NumHeapAllocations() const { return m_NumHeapAllocations; }
+	// current size of the arena, 0 if it is not allocated
+	size_t ArenaSize() const { return m_pArena ? m_ArenaSize : 0; }
+
+private:
+	// all snapshots are added and purged in order, so a ring buffer is enough to store them
+	std::unique_ptr<CDynamicRingBuffer<CHolder>> m_pArena;
+	size_t m_ArenaSize = 0;
+	size_t m_WantedArenaSize = MIN_ARENA_SIZE;
+	size_t m_StoredSize = 0; // size of all stored snapshots including their holders
+	CHolder *m_apTickIndex[TICK_INDEX_SIZE];
+
+	uint64_t m_NumArenaAllocations = 0;
+	uint64_t m_NumHeapAllocations = 0;
+
+	void Free(CHolder *pHolder);
 };
 
 class CSnapshotBuilder
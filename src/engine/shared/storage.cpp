@@ -97,6 +97,7 @@ public:
 		Success &= CreateFolder("demos/auto/race", TYPE_SAVE);
 		Success &= CreateFolder("demos/auto/server", TYPE_SAVE);
 		Success &= CreateFolder("demos/replays", TYPE_SAVE);
+		Success &= CreateFolder("demos/index", TYPE_SAVE);
 		Success &= CreateFolder("editor", TYPE_SAVE);
 		Success &= CreateFolder("ghosts", TYPE_SAVE);
 		Success &= CreateFolder("teehistorian", TYPE_SAVE);
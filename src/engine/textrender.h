@@ -326,6 +326,8 @@ public:
 	virtual void SetCustomFace(const char *pFace) = 0; // TClient
 
 	virtual bool LoadFonts() = 0;
+	// Rasterizes the glyphs of text which is likely to be rendered soon in the background
+	virtual void PrewarmText(const char *pText) = 0;
 	virtual void SetFontPreset(EFontPreset FontPreset) = 0;
 	virtual void SetFontLanguageVariant(const char *pLanguageFile) = 0;
 
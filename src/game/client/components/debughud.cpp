@@ -1,5 +1,6 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <engine/engine.h>
 #include <engine/graphics.h>
 #include <engine/shared/config.h>
 #include <engine/textrender.h>
@@ -78,6 +79,14 @@ void CDebugHud::RenderNetCorrections()
 	str_format(aBuf, sizeof(aBuf), "%d", m_pClient->NetobjNumCorrections());
 	RenderRow("Netobj corrections", aBuf);
 	RenderRow(" on:", m_pClient->NetobjCorrectedOn());
+
+	const CEntityPoolStats &PoolStats = CEntity::PoolStats();
+	str_format(aBuf, sizeof(aBuf), "%d", m_pClient->m_PredictedWorld.m_NumCopiedEntities);
+	RenderRow("Predicted entities copied:", aBuf);
+	str_format(aBuf, sizeof(aBuf), "%" PRId64 " / %" PRId64, PoolStats.m_NumReused, PoolStats.m_NumHeapAllocs);
+	RenderRow("Entity pool reused / heap:", aBuf);
+	str_format(aBuf, sizeof(aBuf), "%d", PoolStats.m_NumFree);
+	RenderRow("Entity pool free:", aBuf);
 }
 
 void CDebugHud::RenderTuning()
@@ -243,6 +252,58 @@ void CDebugHud::RenderTuning()
 	m_ZoomedInGraph.Render(Graphics(), TextRender(), GraphX + GraphW + GraphSpacing, GraphY, GraphW, GraphH, aBuf);
 }
 
+void CDebugHud::RenderJobs()
+{
+	if(!g_Config.m_Debug || g_Config.m_DbgGraphs)
+		return;
+
+	const float Height = 300.0f;
+	const float Width = Height * Graphics()->ScreenAspect();
+	Graphics()->MapScreen(0.0f, 0.0f, Width, Height);
+
+	const float FontSize = 5.0f;
+	const float LineHeight = FontSize + 1.0f;
+
+	float y = 170.0f;
+	char aBuf[128];
+	const auto &&RenderRow = [&](const char *pLabel, const char *pValue) {
+		TextRender()->Text(Width - 100.0f, y, FontSize, pLabel);
+		TextRender()->Text(Width - 10.0f - TextRender()->TextWidth(FontSize, pValue), y, FontSize, pValue);
+		y += LineHeight;
+	};
+
+	TextRender()->TextColor(TextRender()->DefaultTextColor());
+
+	Engine()->GetJobStats(m_vJobStats);
+	for(int Priority = 0; Priority < IJob::NUM_PRIORITIES; Priority++)
+	{
+		size_t Depth = 0;
+		uint64_t NumTaken = 0;
+		uint64_t NumStolen = 0;
+		int64_t WaitTotal = 0;
+		int64_t WaitMax = 0;
+		for(const CJobQueueStats &Stats : m_vJobStats)
+		{
+			if(Stats.m_Priority != Priority)
+				continue;
+			Depth += Stats.m_Depth;
+			NumTaken += Stats.m_NumTaken;
+			NumStolen += Stats.m_NumStolen;
+			WaitTotal += Stats.m_WaitTotal;
+			WaitMax = std::max(WaitMax, Stats.m_WaitMax);
+		}
+
+		const char *pName = Priority == IJob::PRIORITY_HIGH ? "high" : "normal";
+		str_format(aBuf, sizeof(aBuf), "Jobs %s queued / run / stolen:", pName);
+		TextRender()->Text(Width - 100.0f, y, FontSize, aBuf);
+		y += LineHeight;
+		str_format(aBuf, sizeof(aBuf), "%d / %" PRIu64 " / %" PRIu64, (int)Depth, NumTaken, NumStolen);
+		RenderRow("", aBuf);
+		str_format(aBuf, sizeof(aBuf), "%.2fms / %.2fms", NumTaken == 0 ? 0.0 : WaitTotal / 1000.0 / NumTaken, WaitMax / 1000.0);
+		RenderRow(" wait avg / max:", aBuf);
+	}
+}
+
 void CDebugHud::RenderHint()
 {
 	if(!g_Config.m_Debug)
@@ -266,5 +327,6 @@ void CDebugHud::OnRender()
 
 	RenderTuning();
 	RenderNetCorrections();
+	RenderJobs();
 	RenderHint();
 }
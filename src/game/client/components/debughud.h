@@ -3,6 +3,7 @@
 #ifndef GAME_CLIENT_COMPONENTS_DEBUGHUD_H
 #define GAME_CLIENT_COMPONENTS_DEBUGHUD_H
 #include <engine/client/client.h>
+#include <engine/shared/jobs.h>
 
 #include <game/client/component.h>
 
@@ -10,6 +11,7 @@ class CDebugHud : public CComponent
 {
 	void RenderNetCorrections();
 	void RenderTuning();
+	void RenderJobs();
 	void RenderHint();
 
 	CGraph m_RampGraph;
@@ -20,6 +22,8 @@ class CDebugHud : public CComponent
 	float m_OldVelrampRange;
 	float m_OldVelrampCurvature;
 
+	std::vector<CJobQueueStats> m_vJobStats;
+
 public:
 	CDebugHud();
 	virtual int Sizeof() const override { return sizeof(*this); }
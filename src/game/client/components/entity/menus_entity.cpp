@@ -2346,10 +2346,8 @@ void CMenus::RenderSettingsWarList(CUIRect MainView)
 	{
 		if(pSelectedEntry && pSelectedType && (str_comp(s_aEntryName, "") != 0 || str_comp(s_aEntryClan, "") != 0))
 		{
-			str_copy(pSelectedEntry->m_aName, s_aEntryName);
-			str_copy(pSelectedEntry->m_aClan, s_aEntryClan);
-			str_copy(pSelectedEntry->m_aReason, s_aEntryReason);
-			pSelectedEntry->m_pWarType = pSelectedType;
+			const int Index = pSelectedEntry - GameClient()->m_WarList.m_WarEntries.data();
+			GameClient()->m_WarList.UpdateWarEntry(Index, s_aEntryName, s_aEntryClan, s_aEntryReason, pSelectedType);
 		}
 	}
 	if(DoButtonLineSize_Menu(&s_AddButton, Localize("Add Entry"), 0, &ButtonR, LineSize))
@@ -2477,6 +2475,7 @@ void CMenus::RenderSettingsWarList(CUIRect MainView)
 		{
 			str_copy(pSelectedType->m_aWarName, s_aTypeName);
 			pSelectedType->m_Color = s_GroupColor;
+			GameClient()->m_WarList.OnListChange();
 		}
 	}
 	bool AddDisabled = str_comp(GameClient()->m_WarList.FindWarType(s_aTypeName)->m_aWarName, "none") != 0 || str_comp(s_aTypeName, "none") == 0;
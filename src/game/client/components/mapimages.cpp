@@ -4,8 +4,10 @@
 
 #include <base/log.h>
 
+#include <engine/engine.h>
 #include <engine/graphics.h>
 #include <engine/map.h>
+#include <engine/shared/jobs.h>
 #include <engine/storage.h>
 #include <engine/textrender.h>
 
@@ -15,6 +17,8 @@
 #include <game/localization.h>
 #include <game/mapitems.h>
 
+#include <thread>
+
 CMapImages::CMapImages()
 {
 	m_Count = 0;
@@ -91,7 +95,20 @@ void CMapImages::OnMapLoadImpl(class CLayers *pLayers, IMap *pMap)
 
 	const int TextureLoadFlag = Graphics()->Uses2DTextureArrays() ? IGraphics::TEXLOAD_TO_2D_ARRAY_TEXTURE : IGraphics::TEXLOAD_TO_3D_TEXTURE;
 
-	// load new textures
+	// gather the images to load, the external ones are decoded on the job pool
+	class CImageLoad
+	{
+	public:
+		int m_Index;
+		int m_LoadFlag;
+		bool m_External;
+		int m_ImageData;
+		char m_aPath[IO_MAX_PATH_LENGTH];
+		CImageInfo m_Image;
+		bool m_Decoded = false;
+	};
+	std::vector<CImageLoad> vImageLoads;
+	std::vector<int> vEmbeddedData;
 	bool ShowWarning = false;
 	for(int i = 0; i < m_Count; i++)
 	{
@@ -123,9 +140,13 @@ void CMapImages::OnMapLoadImpl(class CLayers *pLayers, IMap *pMap)
 			continue;
 		}
 
+		CImageLoad &ImageLoad = vImageLoads.emplace_back();
+		ImageLoad.m_Index = i;
+		ImageLoad.m_LoadFlag = LoadFlag;
+		ImageLoad.m_External = pImg->m_External;
+		ImageLoad.m_ImageData = pImg->m_ImageData;
 		if(pImg->m_External)
 		{
-			char aPath[IO_MAX_PATH_LENGTH];
 			bool Translated = false;
 			if(Client()->IsSixup())
 			{
@@ -135,32 +156,66 @@ void CMapImages::OnMapLoadImpl(class CLayers *pLayers, IMap *pMap)
 					!str_comp(pName, "winter_main") ||
 					!str_comp(pName, "generic_unhookable");
 			}
-			str_format(aPath, sizeof(aPath), "mapres/%s%s.png", pName, Translated ? "_0.7" : "");
-			m_aTextures[i] = Graphics()->LoadTexture(aPath, IStorage::TYPE_ALL, LoadFlag);
+			str_format(ImageLoad.m_aPath, sizeof(ImageLoad.m_aPath), "mapres/%s%s.png", pName, Translated ? "_0.7" : "");
+		}
+		else
+		{
+			str_format(ImageLoad.m_aPath, sizeof(ImageLoad.m_aPath), "embedded: %s", pName);
+			ImageLoad.m_Image.m_Width = pImg->m_Width;
+			ImageLoad.m_Image.m_Height = pImg->m_Height;
+			ImageLoad.m_Image.m_Format = CImageInfo::FORMAT_RGBA;
+			vEmbeddedData.push_back(pImg->m_ImageData);
+		}
+		pMap->UnloadData(pImg->m_ImageName);
+	}
+
+	IGraphics *pGraphics = Graphics();
+	CWorkBatch DecodeBatch(vImageLoads.size(), [&](size_t Index) {
+		CImageLoad &ImageLoad = vImageLoads[Index];
+		if(ImageLoad.m_External)
+		{
+			ImageLoad.m_Decoded = pGraphics->LoadPng(ImageLoad.m_Image, ImageLoad.m_aPath, IStorage::TYPE_ALL);
+		}
+	});
+	DecodeBatch.Start([this](std::shared_ptr<IJob> pJob) { Engine()->AddJob(std::move(pJob)); }, std::thread::hardware_concurrency());
+
+	// decompress the embedded images meanwhile
+	pMap->PrefetchData(vEmbeddedData);
+
+	// upload the textures in order
+	for(size_t LoadIndex = 0; LoadIndex < vImageLoads.size(); LoadIndex++)
+	{
+		DecodeBatch.Wait(LoadIndex);
+		CImageLoad &ImageLoad = vImageLoads[LoadIndex];
+		const int i = ImageLoad.m_Index;
+		if(ImageLoad.m_External)
+		{
+			if(ImageLoad.m_Decoded)
+			{
+				m_aTextures[i] = Graphics()->LoadTextureRawMove(ImageLoad.m_Image, ImageLoad.m_LoadFlag, ImageLoad.m_aPath);
+			}
+			if(!ImageLoad.m_Decoded || !m_aTextures[i].IsValid())
+			{
+				// reports the error
+				m_aTextures[i] = Graphics()->LoadTexture(ImageLoad.m_aPath, IStorage::TYPE_ALL, ImageLoad.m_LoadFlag);
+			}
 		}
 		else
 		{
-			CImageInfo ImageInfo;
-			ImageInfo.m_Width = pImg->m_Width;
-			ImageInfo.m_Height = pImg->m_Height;
-			ImageInfo.m_Format = CImageInfo::FORMAT_RGBA;
-			ImageInfo.m_pData = static_cast<uint8_t *>(pMap->GetData(pImg->m_ImageData));
-			if(ImageInfo.m_pData && (size_t)pMap->GetDataSize(pImg->m_ImageData) >= ImageInfo.DataSize())
+			ImageLoad.m_Image.m_pData = static_cast<uint8_t *>(pMap->GetData(ImageLoad.m_ImageData));
+			if(ImageLoad.m_Image.m_pData && (size_t)pMap->GetDataSize(ImageLoad.m_ImageData) >= ImageLoad.m_Image.DataSize())
 			{
-				char aTexName[IO_MAX_PATH_LENGTH];
-				str_format(aTexName, sizeof(aTexName), "embedded: %s", pName);
-				m_aTextures[i] = Graphics()->LoadTextureRaw(ImageInfo, LoadFlag, aTexName);
-				pMap->UnloadData(pImg->m_ImageData);
+				m_aTextures[i] = Graphics()->LoadTextureRaw(ImageLoad.m_Image, ImageLoad.m_LoadFlag, ImageLoad.m_aPath);
+				pMap->UnloadData(ImageLoad.m_ImageData);
 			}
 			else
 			{
-				pMap->UnloadData(pImg->m_ImageData);
+				pMap->UnloadData(ImageLoad.m_ImageData);
 				log_error("mapimages", "Failed to load map image %d: failed to load data.", i);
 				ShowWarning = true;
 				continue;
 			}
 		}
-		pMap->UnloadData(pImg->m_ImageName);
 		ShowWarning = ShowWarning || m_aTextures[i].IsNullTexture();
 	}
 	if(ShowWarning)
@@ -1,10 +1,12 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
 #include <engine/demo.h>
+#include <engine/engine.h>
 #include <engine/graphics.h>
 #include <engine/keys.h>
 #include <engine/serverbrowser.h>
 #include <engine/shared/config.h>
+#include <engine/shared/jobs.h>
 #include <engine/storage.h>
 
 #include <game/client/gameclient.h>
@@ -21,6 +23,7 @@
 #include "maplayers.h"
 
 #include <chrono>
+#include <thread>
 
 using namespace std::chrono_literals;
 
@@ -94,84 +97,10 @@ void CMapLayers::EnvelopeEval(int TimeOffsetMillis, int Env, ColorRGBA &Result,
 	CRenderTools::RenderEvalEnvelope(&EnvelopePoints, s_Time + std::chrono::nanoseconds(std::chrono::milliseconds(TimeOffsetMillis)), Result, Channels);
 }
 
-static void FillTmpTile(SGraphicTile *pTmpTile, SGraphicTileTexureCoords *pTmpTex, unsigned char Flags, unsigned char Index, int x, int y, const ivec2 &Offset, int Scale)
-{
-	if(pTmpTex)
-	{
-		unsigned char x0 = 0;
-		unsigned char y0 = 0;
-		unsigned char x1 = x0 + 1;
-		unsigned char y1 = y0;
-		unsigned char x2 = x0 + 1;
-		unsigned char y2 = y0 + 1;
-		unsigned char x3 = x0;
-		unsigned char y3 = y0 + 1;
-
-		if(Flags & TILEFLAG_XFLIP)
-		{
-			x0 = x2;
-			x1 = x3;
-			x2 = x3;
-			x3 = x0;
-		}
-
-		if(Flags & TILEFLAG_YFLIP)
-		{
-			y0 = y3;
-			y2 = y1;
-			y3 = y1;
-			y1 = y0;
-		}
-
-		if(Flags & TILEFLAG_ROTATE)
-		{
-			unsigned char Tmp = x0;
-			x0 = x3;
-			x3 = x2;
-			x2 = x1;
-			x1 = Tmp;
-			Tmp = y0;
-			y0 = y3;
-			y3 = y2;
-			y2 = y1;
-			y1 = Tmp;
-		}
-
-		pTmpTex->m_TexCoordTopLeft.x = x0;
-		pTmpTex->m_TexCoordTopLeft.y = y0;
-		pTmpTex->m_TexCoordBottomLeft.x = x3;
-		pTmpTex->m_TexCoordBottomLeft.y = y3;
-		pTmpTex->m_TexCoordTopRight.x = x1;
-		pTmpTex->m_TexCoordTopRight.y = y1;
-		pTmpTex->m_TexCoordBottomRight.x = x2;
-		pTmpTex->m_TexCoordBottomRight.y = y2;
-
-		pTmpTex->m_TexCoordTopLeft.z = Index;
-		pTmpTex->m_TexCoordBottomLeft.z = Index;
-		pTmpTex->m_TexCoordTopRight.z = Index;
-		pTmpTex->m_TexCoordBottomRight.z = Index;
-
-		bool HasRotation = (Flags & TILEFLAG_ROTATE) != 0;
-		pTmpTex->m_TexCoordTopLeft.w = HasRotation;
-		pTmpTex->m_TexCoordBottomLeft.w = HasRotation;
-		pTmpTex->m_TexCoordTopRight.w = HasRotation;
-		pTmpTex->m_TexCoordBottomRight.w = HasRotation;
-	}
-
-	pTmpTile->m_TopLeft.x = x * Scale + Offset.x;
-	pTmpTile->m_TopLeft.y = y * Scale + Offset.y;
-	pTmpTile->m_BottomLeft.x = x * Scale + Offset.x;
-	pTmpTile->m_BottomLeft.y = y * Scale + Scale + Offset.y;
-	pTmpTile->m_TopRight.x = x * Scale + Scale + Offset.x;
-	pTmpTile->m_TopRight.y = y * Scale + Offset.y;
-	pTmpTile->m_BottomRight.x = x * Scale + Scale + Offset.x;
-	pTmpTile->m_BottomRight.y = y * Scale + Scale + Offset.y;
-}
-
 static void FillTmpTileSpeedup(SGraphicTile *pTmpTile, SGraphicTileTexureCoords *pTmpTex, unsigned char Flags, int x, int y, const ivec2 &Offset, int Scale, short AngleRotate)
 {
 	int Angle = AngleRotate % 360;
-	FillTmpTile(pTmpTile, pTmpTex, Angle >= 270 ? ROTATION_270 : (Angle >= 180 ? ROTATION_180 : (Angle >= 90 ? ROTATION_90 : 0)), AngleRotate % 90, x, y, Offset, Scale);
+	CRenderTools::FillTileQuad(pTmpTile, pTmpTex, Angle >= 270 ? ROTATION_270 : (Angle >= 180 ? ROTATION_180 : (Angle >= 90 ? ROTATION_90 : 0)), AngleRotate % 90, x, y, Offset, Scale);
 }
 
 bool CMapLayers::STileLayerVisuals::Init(unsigned int Width, unsigned int Height)
@@ -217,7 +146,7 @@ static bool AddTile(std::vector<SGraphicTile> &vTmpTiles, std::vector<SGraphicTi
 		if(FillSpeedup)
 			FillTmpTileSpeedup(&Tile, pTileTex, Flags, x, y, Offset, Scale, AngleRotate);
 		else
-			FillTmpTile(&Tile, pTileTex, Flags, Index, x, y, Offset, Scale);
+			CRenderTools::FillTileQuad(&Tile, pTileTex, Flags, Index, x, y, Offset, Scale);
 
 		return true;
 	}
@@ -278,6 +207,254 @@ CMapLayers::~CMapLayers()
 	}
 }
 
+void CMapLayers::BuildTileLayer(STileLayerBuild &Build)
+{
+	STileLayerVisuals &Visuals = *Build.m_pVisuals;
+	const CMapItemLayerTilemap *pTMap = Build.m_pTileMap;
+	const void *pTiles = Build.m_pTiles;
+	const int LayerType = Build.m_LayerType;
+	const int CurOverlay = Build.m_CurOverlay;
+	const bool IsEntityLayer = LayerType != LAYER_DEFAULT_TILESET;
+	const bool DoTextureCoords = Build.m_DoTextureCoords;
+
+	std::vector<SGraphicTile> vtmpTiles;
+	std::vector<SGraphicTileTexureCoords> vtmpTileTexCoords;
+	std::vector<SGraphicTile> vtmpBorderTopTiles;
+	std::vector<SGraphicTileTexureCoords> vtmpBorderTopTilesTexCoords;
+	std::vector<SGraphicTile> vtmpBorderLeftTiles;
+	std::vector<SGraphicTileTexureCoords> vtmpBorderLeftTilesTexCoords;
+	std::vector<SGraphicTile> vtmpBorderRightTiles;
+	std::vector<SGraphicTileTexureCoords> vtmpBorderRightTilesTexCoords;
+	std::vector<SGraphicTile> vtmpBorderBottomTiles;
+	std::vector<SGraphicTileTexureCoords> vtmpBorderBottomTilesTexCoords;
+	std::vector<SGraphicTile> vtmpBorderCorners;
+	std::vector<SGraphicTileTexureCoords> vtmpBorderCornersTexCoords;
+
+	if(!DoTextureCoords)
+	{
+		vtmpTiles.reserve((size_t)pTMap->m_Width * pTMap->m_Height);
+		vtmpBorderTopTiles.reserve((size_t)pTMap->m_Width);
+		vtmpBorderBottomTiles.reserve((size_t)pTMap->m_Width);
+		vtmpBorderLeftTiles.reserve((size_t)pTMap->m_Height);
+		vtmpBorderRightTiles.reserve((size_t)pTMap->m_Height);
+		vtmpBorderCorners.reserve((size_t)4);
+	}
+	else
+	{
+		vtmpTileTexCoords.reserve((size_t)pTMap->m_Width * pTMap->m_Height);
+		vtmpBorderTopTilesTexCoords.reserve((size_t)pTMap->m_Width);
+		vtmpBorderBottomTilesTexCoords.reserve((size_t)pTMap->m_Width);
+		vtmpBorderLeftTilesTexCoords.reserve((size_t)pTMap->m_Height);
+		vtmpBorderRightTilesTexCoords.reserve((size_t)pTMap->m_Height);
+		vtmpBorderCornersTexCoords.reserve((size_t)4);
+	}
+
+	int x = 0;
+	int y = 0;
+	for(y = 0; y < pTMap->m_Height; ++y)
+	{
+		for(x = 0; x < pTMap->m_Width; ++x)
+		{
+			unsigned char Index = 0;
+			unsigned char Flags = 0;
+			int AngleRotate = -1;
+
+			if(!IsEntityLayer || LayerType == LAYER_GAME || LayerType == LAYER_FRONT)
+			{
+				Index = ((CTile *)pTiles)[y * pTMap->m_Width + x].m_Index;
+				Flags = ((CTile *)pTiles)[y * pTMap->m_Width + x].m_Flags;
+			}
+			else if(LayerType == LAYER_SWITCH)
+			{
+				Flags = 0;
+				Index = ((CSwitchTile *)pTiles)[y * pTMap->m_Width + x].m_Type;
+				if(CurOverlay == 0)
+				{
+					Flags = ((CSwitchTile *)pTiles)[y * pTMap->m_Width + x].m_Flags;
+					if(Index == TILE_SWITCHTIMEDOPEN)
+						Index = 8;
+				}
+				else if(CurOverlay == 1)
+					Index = ((CSwitchTile *)pTiles)[y * pTMap->m_Width + x].m_Number;
+				else if(CurOverlay == 2)
+					Index = ((CSwitchTile *)pTiles)[y * pTMap->m_Width + x].m_Delay;
+			}
+			else if(LayerType == LAYER_TELE)
+			{
+				Index = ((CTeleTile *)pTiles)[y * pTMap->m_Width + x].m_Type;
+				Flags = 0;
+				if(CurOverlay == 1)
+				{
+					if(IsTeleTileNumberUsedAny(Index))
+						Index = ((CTeleTile *)pTiles)[y * pTMap->m_Width + x].m_Number;
+					else
+						Index = 0;
+				}
+			}
+			else if(LayerType == LAYER_SPEEDUP)
+			{
+				Index = ((CSpeedupTile *)pTiles)[y * pTMap->m_Width + x].m_Type;
+				unsigned char Force = ((CSpeedupTile *)pTiles)[y * pTMap->m_Width + x].m_Force;
+				unsigned char MaxSpeed = ((CSpeedupTile *)pTiles)[y * pTMap->m_Width + x].m_MaxSpeed;
+				Flags = 0;
+				AngleRotate = ((CSpeedupTile *)pTiles)[y * pTMap->m_Width + x].m_Angle;
+				if((Force == 0 && Index == TILE_SPEED_BOOST_OLD) || (Force == 0 && MaxSpeed == 0 && Index == TILE_SPEED_BOOST) || !IsValidSpeedupTile(Index))
+					Index = 0;
+				else if(CurOverlay == 1)
+					Index = Force;
+				else if(CurOverlay == 2)
+					Index = MaxSpeed;
+			}
+			else if(LayerType == LAYER_TUNE)
+			{
+				Index = ((CTuneTile *)pTiles)[y * pTMap->m_Width + x].m_Type;
+				Flags = 0;
+			}
+
+			// the amount of tiles handled before this tile
+			int TilesHandledCount = vtmpTiles.size();
+			Visuals.m_pTilesOfLayer[y * pTMap->m_Width + x].SetIndexBufferByteOffset((offset_ptr32)(TilesHandledCount));
+
+			bool AddAsSpeedup = false;
+			if(LayerType == LAYER_SPEEDUP && CurOverlay == 0)
+				AddAsSpeedup = true;
+
+			if(AddTile(vtmpTiles, vtmpTileTexCoords, Index, Flags, x, y, DoTextureCoords, AddAsSpeedup, AngleRotate))
+				Visuals.m_pTilesOfLayer[y * pTMap->m_Width + x].Draw(true);
+
+			// do the border tiles
+			if(x == 0)
+			{
+				if(y == 0)
+				{
+					Visuals.m_BorderTopLeft.SetIndexBufferByteOffset((offset_ptr32)(vtmpBorderCorners.size()));
+					if(AddTile(vtmpBorderCorners, vtmpBorderCornersTexCoords, Index, Flags, 0, 0, DoTextureCoords, AddAsSpeedup, AngleRotate, ivec2{-32, -32}))
+						Visuals.m_BorderTopLeft.Draw(true);
+				}
+				else if(y == pTMap->m_Height - 1)
+				{
+					Visuals.m_BorderBottomLeft.SetIndexBufferByteOffset((offset_ptr32)(vtmpBorderCorners.size()));
+					if(AddTile(vtmpBorderCorners, vtmpBorderCornersTexCoords, Index, Flags, 0, 0, DoTextureCoords, AddAsSpeedup, AngleRotate, ivec2{-32, 0}))
+						Visuals.m_BorderBottomLeft.Draw(true);
+				}
+				Visuals.m_vBorderLeft[y].SetIndexBufferByteOffset((offset_ptr32)(vtmpBorderLeftTiles.size()));
+				if(AddTile(vtmpBorderLeftTiles, vtmpBorderLeftTilesTexCoords, Index, Flags, 0, y, DoTextureCoords, AddAsSpeedup, AngleRotate, ivec2{-32, 0}))
+					Visuals.m_vBorderLeft[y].Draw(true);
+			}
+			else if(x == pTMap->m_Width - 1)
+			{
+				if(y == 0)
+				{
+					Visuals.m_BorderTopRight.SetIndexBufferByteOffset((offset_ptr32)(vtmpBorderCorners.size()));
+					if(AddTile(vtmpBorderCorners, vtmpBorderCornersTexCoords, Index, Flags, 0, 0, DoTextureCoords, AddAsSpeedup, AngleRotate, ivec2{0, -32}))
+						Visuals.m_BorderTopRight.Draw(true);
+				}
+				else if(y == pTMap->m_Height - 1)
+				{
+					Visuals.m_BorderBottomRight.SetIndexBufferByteOffset((offset_ptr32)(vtmpBorderCorners.size()));
+					if(AddTile(vtmpBorderCorners, vtmpBorderCornersTexCoords, Index, Flags, 0, 0, DoTextureCoords, AddAsSpeedup, AngleRotate, ivec2{0, 0}))
+						Visuals.m_BorderBottomRight.Draw(true);
+				}
+				Visuals.m_vBorderRight[y].SetIndexBufferByteOffset((offset_ptr32)(vtmpBorderRightTiles.size()));
+				if(AddTile(vtmpBorderRightTiles, vtmpBorderRightTilesTexCoords, Index, Flags, 0, y, DoTextureCoords, AddAsSpeedup, AngleRotate, ivec2{0, 0}))
+					Visuals.m_vBorderRight[y].Draw(true);
+			}
+			if(y == 0)
+			{
+				Visuals.m_vBorderTop[x].SetIndexBufferByteOffset((offset_ptr32)(vtmpBorderTopTiles.size()));
+				if(AddTile(vtmpBorderTopTiles, vtmpBorderTopTilesTexCoords, Index, Flags, x, 0, DoTextureCoords, AddAsSpeedup, AngleRotate, ivec2{0, -32}))
+					Visuals.m_vBorderTop[x].Draw(true);
+			}
+			else if(y == pTMap->m_Height - 1)
+			{
+				Visuals.m_vBorderBottom[x].SetIndexBufferByteOffset((offset_ptr32)(vtmpBorderBottomTiles.size()));
+				if(AddTile(vtmpBorderBottomTiles, vtmpBorderBottomTilesTexCoords, Index, Flags, x, 0, DoTextureCoords, AddAsSpeedup, AngleRotate, ivec2{0, 0}))
+					Visuals.m_vBorderBottom[x].Draw(true);
+			}
+		}
+	}
+
+	// append one kill tile to the gamelayer
+	if(LayerType == LAYER_GAME)
+	{
+		Visuals.m_BorderKillTile.SetIndexBufferByteOffset((offset_ptr32)(vtmpTiles.size()));
+		if(AddTile(vtmpTiles, vtmpTileTexCoords, TILE_DEATH, 0, 0, 0, DoTextureCoords))
+			Visuals.m_BorderKillTile.Draw(true);
+	}
+
+	// add the border corners, then the borders and fix their byte offsets
+	int TilesHandledCount = vtmpTiles.size();
+	Visuals.m_BorderTopLeft.AddIndexBufferByteOffset(TilesHandledCount);
+	Visuals.m_BorderTopRight.AddIndexBufferByteOffset(TilesHandledCount);
+	Visuals.m_BorderBottomLeft.AddIndexBufferByteOffset(TilesHandledCount);
+	Visuals.m_BorderBottomRight.AddIndexBufferByteOffset(TilesHandledCount);
+	// add the Corners to the tiles
+	vtmpTiles.insert(vtmpTiles.end(), vtmpBorderCorners.begin(), vtmpBorderCorners.end());
+	vtmpTileTexCoords.insert(vtmpTileTexCoords.end(), vtmpBorderCornersTexCoords.begin(), vtmpBorderCornersTexCoords.end());
+
+	// now the borders
+	TilesHandledCount = vtmpTiles.size();
+	if(pTMap->m_Width > 0)
+	{
+		for(int i = 0; i < pTMap->m_Width; ++i)
+		{
+			Visuals.m_vBorderTop[i].AddIndexBufferByteOffset(TilesHandledCount);
+		}
+	}
+	vtmpTiles.insert(vtmpTiles.end(), vtmpBorderTopTiles.begin(), vtmpBorderTopTiles.end());
+	vtmpTileTexCoords.insert(vtmpTileTexCoords.end(), vtmpBorderTopTilesTexCoords.begin(), vtmpBorderTopTilesTexCoords.end());
+
+	TilesHandledCount = vtmpTiles.size();
+	if(pTMap->m_Width > 0)
+	{
+		for(int i = 0; i < pTMap->m_Width; ++i)
+		{
+			Visuals.m_vBorderBottom[i].AddIndexBufferByteOffset(TilesHandledCount);
+		}
+	}
+	vtmpTiles.insert(vtmpTiles.end(), vtmpBorderBottomTiles.begin(), vtmpBorderBottomTiles.end());
+	vtmpTileTexCoords.insert(vtmpTileTexCoords.end(), vtmpBorderBottomTilesTexCoords.begin(), vtmpBorderBottomTilesTexCoords.end());
+
+	TilesHandledCount = vtmpTiles.size();
+	if(pTMap->m_Height > 0)
+	{
+		for(int i = 0; i < pTMap->m_Height; ++i)
+		{
+			Visuals.m_vBorderLeft[i].AddIndexBufferByteOffset(TilesHandledCount);
+		}
+	}
+	vtmpTiles.insert(vtmpTiles.end(), vtmpBorderLeftTiles.begin(), vtmpBorderLeftTiles.end());
+	vtmpTileTexCoords.insert(vtmpTileTexCoords.end(), vtmpBorderLeftTilesTexCoords.begin(), vtmpBorderLeftTilesTexCoords.end());
+
+	TilesHandledCount = vtmpTiles.size();
+	if(pTMap->m_Height > 0)
+	{
+		for(int i = 0; i < pTMap->m_Height; ++i)
+		{
+			Visuals.m_vBorderRight[i].AddIndexBufferByteOffset(TilesHandledCount);
+		}
+	}
+	vtmpTiles.insert(vtmpTiles.end(), vtmpBorderRightTiles.begin(), vtmpBorderRightTiles.end());
+	vtmpTileTexCoords.insert(vtmpTileTexCoords.end(), vtmpBorderRightTilesTexCoords.begin(), vtmpBorderRightTilesTexCoords.end());
+
+	// setup params
+	float *pTmpTiles = vtmpTiles.empty() ? nullptr : (float *)vtmpTiles.data();
+	unsigned char *pTmpTileTexCoords = vtmpTileTexCoords.empty() ? nullptr : (unsigned char *)vtmpTileTexCoords.data();
+
+	Build.m_NumTiles = vtmpTiles.size();
+	Build.m_UploadDataSize = vtmpTileTexCoords.size() * sizeof(SGraphicTileTexureCoords) + vtmpTiles.size() * sizeof(SGraphicTile);
+	if(Build.m_UploadDataSize > 0)
+	{
+		Build.m_pUploadData = (char *)malloc(sizeof(char) * Build.m_UploadDataSize);
+
+		mem_copy_special(Build.m_pUploadData, pTmpTiles, sizeof(vec2), vtmpTiles.size() * 4, (DoTextureCoords ? sizeof(ubvec4) : 0));
+		if(DoTextureCoords)
+		{
+			mem_copy_special(Build.m_pUploadData + sizeof(vec2), pTmpTileTexCoords, sizeof(ubvec4), vtmpTiles.size() * 4, sizeof(vec2));
+		}
+	}
+}
+
 void CMapLayers::OnMapLoad()
 {
 	if(!Graphics()->IsTileBufferingEnabled() && !Graphics()->IsQuadBufferingEnabled())
@@ -340,19 +517,9 @@ void CMapLayers::OnMapLoad()
 	}
 
 	bool PassedGameLayer = false;
-	// prepare all visuals for all tile layers
-	std::vector<SGraphicTile> vtmpTiles;
-	std::vector<SGraphicTileTexureCoords> vtmpTileTexCoords;
-	std::vector<SGraphicTile> vtmpBorderTopTiles;
-	std::vector<SGraphicTileTexureCoords> vtmpBorderTopTilesTexCoords;
-	std::vector<SGraphicTile> vtmpBorderLeftTiles;
-	std::vector<SGraphicTileTexureCoords> vtmpBorderLeftTilesTexCoords;
-	std::vector<SGraphicTile> vtmpBorderRightTiles;
-	std::vector<SGraphicTileTexureCoords> vtmpBorderRightTilesTexCoords;
-	std::vector<SGraphicTile> vtmpBorderBottomTiles;
-	std::vector<SGraphicTileTexureCoords> vtmpBorderBottomTilesTexCoords;
-	std::vector<SGraphicTile> vtmpBorderCorners;
-	std::vector<SGraphicTileTexureCoords> vtmpBorderCornersTexCoords;
+	bool PassedLastLayer = false;
+	// prepare all visuals for all tile layers, the tile data is built afterwards
+	std::vector<STileLayerBuild> vTileLayerBuilds;
 
 	std::vector<STmpQuad> vtmpQuads;
 	std::vector<STmpQuadTextured> vtmpQuadsTextured;
@@ -389,8 +556,8 @@ void CMapLayers::OnMapLoad()
 			{
 				if(PassedGameLayer)
 				{
-					m_vvLayerCount[g] = vLayerCounter;
-					return;
+					PassedLastLayer = true;
+					break;
 				}
 			}
 			else if(m_Type == TYPE_FOREGROUND)
@@ -425,274 +592,7 @@ void CMapLayers::OnMapLoad()
 						}
 						Visuals.m_IsTextured = DoTextureCoords;
 
-						vtmpTiles.clear();
-						vtmpTileTexCoords.clear();
-
-						vtmpBorderTopTiles.clear();
-						vtmpBorderLeftTiles.clear();
-						vtmpBorderRightTiles.clear();
-						vtmpBorderBottomTiles.clear();
-						vtmpBorderCorners.clear();
-						vtmpBorderTopTilesTexCoords.clear();
-						vtmpBorderLeftTilesTexCoords.clear();
-						vtmpBorderRightTilesTexCoords.clear();
-						vtmpBorderBottomTilesTexCoords.clear();
-						vtmpBorderCornersTexCoords.clear();
-
-						if(!DoTextureCoords)
-						{
-							vtmpTiles.reserve((size_t)pTMap->m_Width * pTMap->m_Height);
-							vtmpBorderTopTiles.reserve((size_t)pTMap->m_Width);
-							vtmpBorderBottomTiles.reserve((size_t)pTMap->m_Width);
-							vtmpBorderLeftTiles.reserve((size_t)pTMap->m_Height);
-							vtmpBorderRightTiles.reserve((size_t)pTMap->m_Height);
-							vtmpBorderCorners.reserve((size_t)4);
-						}
-						else
-						{
-							vtmpTileTexCoords.reserve((size_t)pTMap->m_Width * pTMap->m_Height);
-							vtmpBorderTopTilesTexCoords.reserve((size_t)pTMap->m_Width);
-							vtmpBorderBottomTilesTexCoords.reserve((size_t)pTMap->m_Width);
-							vtmpBorderLeftTilesTexCoords.reserve((size_t)pTMap->m_Height);
-							vtmpBorderRightTilesTexCoords.reserve((size_t)pTMap->m_Height);
-							vtmpBorderCornersTexCoords.reserve((size_t)4);
-						}
-
-						int x = 0;
-						int y = 0;
-						for(y = 0; y < pTMap->m_Height; ++y)
-						{
-							for(x = 0; x < pTMap->m_Width; ++x)
-							{
-								unsigned char Index = 0;
-								unsigned char Flags = 0;
-								int AngleRotate = -1;
-
-								if(!IsEntityLayer || LayerType == LAYER_GAME || LayerType == LAYER_FRONT)
-								{
-									Index = ((CTile *)pTiles)[y * pTMap->m_Width + x].m_Index;
-									Flags = ((CTile *)pTiles)[y * pTMap->m_Width + x].m_Flags;
-								}
-								else if(LayerType == LAYER_SWITCH)
-								{
-									Flags = 0;
-									Index = ((CSwitchTile *)pTiles)[y * pTMap->m_Width + x].m_Type;
-									if(CurOverlay == 0)
-									{
-										Flags = ((CSwitchTile *)pTiles)[y * pTMap->m_Width + x].m_Flags;
-										if(Index == TILE_SWITCHTIMEDOPEN)
-											Index = 8;
-									}
-									else if(CurOverlay == 1)
-										Index = ((CSwitchTile *)pTiles)[y * pTMap->m_Width + x].m_Number;
-									else if(CurOverlay == 2)
-										Index = ((CSwitchTile *)pTiles)[y * pTMap->m_Width + x].m_Delay;
-								}
-								else if(LayerType == LAYER_TELE)
-								{
-									Index = ((CTeleTile *)pTiles)[y * pTMap->m_Width + x].m_Type;
-									Flags = 0;
-									if(CurOverlay == 1)
-									{
-										if(IsTeleTileNumberUsedAny(Index))
-											Index = ((CTeleTile *)pTiles)[y * pTMap->m_Width + x].m_Number;
-										else
-											Index = 0;
-									}
-								}
-								else if(LayerType == LAYER_SPEEDUP)
-								{
-									Index = ((CSpeedupTile *)pTiles)[y * pTMap->m_Width + x].m_Type;
-									unsigned char Force = ((CSpeedupTile *)pTiles)[y * pTMap->m_Width + x].m_Force;
-									unsigned char MaxSpeed = ((CSpeedupTile *)pTiles)[y * pTMap->m_Width + x].m_MaxSpeed;
-									Flags = 0;
-									AngleRotate = ((CSpeedupTile *)pTiles)[y * pTMap->m_Width + x].m_Angle;
-									if((Force == 0 && Index == TILE_SPEED_BOOST_OLD) || (Force == 0 && MaxSpeed == 0 && Index == TILE_SPEED_BOOST) || !IsValidSpeedupTile(Index))
-										Index = 0;
-									else if(CurOverlay == 1)
-										Index = Force;
-									else if(CurOverlay == 2)
-										Index = MaxSpeed;
-								}
-								else if(LayerType == LAYER_TUNE)
-								{
-									Index = ((CTuneTile *)pTiles)[y * pTMap->m_Width + x].m_Type;
-									Flags = 0;
-								}
-
-								// the amount of tiles handled before this tile
-								int TilesHandledCount = vtmpTiles.size();
-								Visuals.m_pTilesOfLayer[y * pTMap->m_Width + x].SetIndexBufferByteOffset((offset_ptr32)(TilesHandledCount));
-
-								bool AddAsSpeedup = false;
-								if(LayerType == LAYER_SPEEDUP && CurOverlay == 0)
-									AddAsSpeedup = true;
-
-								if(AddTile(vtmpTiles, vtmpTileTexCoords, Index, Flags, x, y, DoTextureCoords, AddAsSpeedup, AngleRotate))
-									Visuals.m_pTilesOfLayer[y * pTMap->m_Width + x].Draw(true);
-
-								// do the border tiles
-								if(x == 0)
-								{
-									if(y == 0)
-									{
-										Visuals.m_BorderTopLeft.SetIndexBufferByteOffset((offset_ptr32)(vtmpBorderCorners.size()));
-										if(AddTile(vtmpBorderCorners, vtmpBorderCornersTexCoords, Index, Flags, 0, 0, DoTextureCoords, AddAsSpeedup, AngleRotate, ivec2{-32, -32}))
-											Visuals.m_BorderTopLeft.Draw(true);
-									}
-									else if(y == pTMap->m_Height - 1)
-									{
-										Visuals.m_BorderBottomLeft.SetIndexBufferByteOffset((offset_ptr32)(vtmpBorderCorners.size()));
-										if(AddTile(vtmpBorderCorners, vtmpBorderCornersTexCoords, Index, Flags, 0, 0, DoTextureCoords, AddAsSpeedup, AngleRotate, ivec2{-32, 0}))
-											Visuals.m_BorderBottomLeft.Draw(true);
-									}
-									Visuals.m_vBorderLeft[y].SetIndexBufferByteOffset((offset_ptr32)(vtmpBorderLeftTiles.size()));
-									if(AddTile(vtmpBorderLeftTiles, vtmpBorderLeftTilesTexCoords, Index, Flags, 0, y, DoTextureCoords, AddAsSpeedup, AngleRotate, ivec2{-32, 0}))
-										Visuals.m_vBorderLeft[y].Draw(true);
-								}
-								else if(x == pTMap->m_Width - 1)
-								{
-									if(y == 0)
-									{
-										Visuals.m_BorderTopRight.SetIndexBufferByteOffset((offset_ptr32)(vtmpBorderCorners.size()));
-										if(AddTile(vtmpBorderCorners, vtmpBorderCornersTexCoords, Index, Flags, 0, 0, DoTextureCoords, AddAsSpeedup, AngleRotate, ivec2{0, -32}))
-											Visuals.m_BorderTopRight.Draw(true);
-									}
-									else if(y == pTMap->m_Height - 1)
-									{
-										Visuals.m_BorderBottomRight.SetIndexBufferByteOffset((offset_ptr32)(vtmpBorderCorners.size()));
-										if(AddTile(vtmpBorderCorners, vtmpBorderCornersTexCoords, Index, Flags, 0, 0, DoTextureCoords, AddAsSpeedup, AngleRotate, ivec2{0, 0}))
-											Visuals.m_BorderBottomRight.Draw(true);
-									}
-									Visuals.m_vBorderRight[y].SetIndexBufferByteOffset((offset_ptr32)(vtmpBorderRightTiles.size()));
-									if(AddTile(vtmpBorderRightTiles, vtmpBorderRightTilesTexCoords, Index, Flags, 0, y, DoTextureCoords, AddAsSpeedup, AngleRotate, ivec2{0, 0}))
-										Visuals.m_vBorderRight[y].Draw(true);
-								}
-								if(y == 0)
-								{
-									Visuals.m_vBorderTop[x].SetIndexBufferByteOffset((offset_ptr32)(vtmpBorderTopTiles.size()));
-									if(AddTile(vtmpBorderTopTiles, vtmpBorderTopTilesTexCoords, Index, Flags, x, 0, DoTextureCoords, AddAsSpeedup, AngleRotate, ivec2{0, -32}))
-										Visuals.m_vBorderTop[x].Draw(true);
-								}
-								else if(y == pTMap->m_Height - 1)
-								{
-									Visuals.m_vBorderBottom[x].SetIndexBufferByteOffset((offset_ptr32)(vtmpBorderBottomTiles.size()));
-									if(AddTile(vtmpBorderBottomTiles, vtmpBorderBottomTilesTexCoords, Index, Flags, x, 0, DoTextureCoords, AddAsSpeedup, AngleRotate, ivec2{0, 0}))
-										Visuals.m_vBorderBottom[x].Draw(true);
-								}
-							}
-						}
-
-						// append one kill tile to the gamelayer
-						if(LayerType == LAYER_GAME)
-						{
-							Visuals.m_BorderKillTile.SetIndexBufferByteOffset((offset_ptr32)(vtmpTiles.size()));
-							if(AddTile(vtmpTiles, vtmpTileTexCoords, TILE_DEATH, 0, 0, 0, DoTextureCoords))
-								Visuals.m_BorderKillTile.Draw(true);
-						}
-
-						// add the border corners, then the borders and fix their byte offsets
-						int TilesHandledCount = vtmpTiles.size();
-						Visuals.m_BorderTopLeft.AddIndexBufferByteOffset(TilesHandledCount);
-						Visuals.m_BorderTopRight.AddIndexBufferByteOffset(TilesHandledCount);
-						Visuals.m_BorderBottomLeft.AddIndexBufferByteOffset(TilesHandledCount);
-						Visuals.m_BorderBottomRight.AddIndexBufferByteOffset(TilesHandledCount);
-						// add the Corners to the tiles
-						vtmpTiles.insert(vtmpTiles.end(), vtmpBorderCorners.begin(), vtmpBorderCorners.end());
-						vtmpTileTexCoords.insert(vtmpTileTexCoords.end(), vtmpBorderCornersTexCoords.begin(), vtmpBorderCornersTexCoords.end());
-
-						// now the borders
-						TilesHandledCount = vtmpTiles.size();
-						if(pTMap->m_Width > 0)
-						{
-							for(int i = 0; i < pTMap->m_Width; ++i)
-							{
-								Visuals.m_vBorderTop[i].AddIndexBufferByteOffset(TilesHandledCount);
-							}
-						}
-						vtmpTiles.insert(vtmpTiles.end(), vtmpBorderTopTiles.begin(), vtmpBorderTopTiles.end());
-						vtmpTileTexCoords.insert(vtmpTileTexCoords.end(), vtmpBorderTopTilesTexCoords.begin(), vtmpBorderTopTilesTexCoords.end());
-
-						TilesHandledCount = vtmpTiles.size();
-						if(pTMap->m_Width > 0)
-						{
-							for(int i = 0; i < pTMap->m_Width; ++i)
-							{
-								Visuals.m_vBorderBottom[i].AddIndexBufferByteOffset(TilesHandledCount);
-							}
-						}
-						vtmpTiles.insert(vtmpTiles.end(), vtmpBorderBottomTiles.begin(), vtmpBorderBottomTiles.end());
-						vtmpTileTexCoords.insert(vtmpTileTexCoords.end(), vtmpBorderBottomTilesTexCoords.begin(), vtmpBorderBottomTilesTexCoords.end());
-
-						TilesHandledCount = vtmpTiles.size();
-						if(pTMap->m_Height > 0)
-						{
-							for(int i = 0; i < pTMap->m_Height; ++i)
-							{
-								Visuals.m_vBorderLeft[i].AddIndexBufferByteOffset(TilesHandledCount);
-							}
-						}
-						vtmpTiles.insert(vtmpTiles.end(), vtmpBorderLeftTiles.begin(), vtmpBorderLeftTiles.end());
-						vtmpTileTexCoords.insert(vtmpTileTexCoords.end(), vtmpBorderLeftTilesTexCoords.begin(), vtmpBorderLeftTilesTexCoords.end());
-
-						TilesHandledCount = vtmpTiles.size();
-						if(pTMap->m_Height > 0)
-						{
-							for(int i = 0; i < pTMap->m_Height; ++i)
-							{
-								Visuals.m_vBorderRight[i].AddIndexBufferByteOffset(TilesHandledCount);
-							}
-						}
-						vtmpTiles.insert(vtmpTiles.end(), vtmpBorderRightTiles.begin(), vtmpBorderRightTiles.end());
-						vtmpTileTexCoords.insert(vtmpTileTexCoords.end(), vtmpBorderRightTilesTexCoords.begin(), vtmpBorderRightTilesTexCoords.end());
-
-						// setup params
-						float *pTmpTiles = vtmpTiles.empty() ? nullptr : (float *)vtmpTiles.data();
-						unsigned char *pTmpTileTexCoords = vtmpTileTexCoords.empty() ? nullptr : (unsigned char *)vtmpTileTexCoords.data();
-
-						Visuals.m_BufferContainerIndex = -1;
-						size_t UploadDataSize = vtmpTileTexCoords.size() * sizeof(SGraphicTileTexureCoords) + vtmpTiles.size() * sizeof(SGraphicTile);
-						if(UploadDataSize > 0)
-						{
-							char *pUploadData = (char *)malloc(sizeof(char) * UploadDataSize);
-
-							mem_copy_special(pUploadData, pTmpTiles, sizeof(vec2), vtmpTiles.size() * 4, (DoTextureCoords ? sizeof(ubvec4) : 0));
-							if(DoTextureCoords)
-							{
-								mem_copy_special(pUploadData + sizeof(vec2), pTmpTileTexCoords, sizeof(ubvec4), vtmpTiles.size() * 4, sizeof(vec2));
-							}
-
-							// first create the buffer object
-							int BufferObjectIndex = Graphics()->CreateBufferObject(UploadDataSize, pUploadData, 0, true);
-
-							// then create the buffer container
-							SBufferContainerInfo ContainerInfo;
-							ContainerInfo.m_Stride = (DoTextureCoords ? (sizeof(float) * 2 + sizeof(ubvec4)) : 0);
-							ContainerInfo.m_VertBufferBindingIndex = BufferObjectIndex;
-							ContainerInfo.m_vAttributes.emplace_back();
-							SBufferContainerInfo::SAttribute *pAttr = &ContainerInfo.m_vAttributes.back();
-							pAttr->m_DataTypeCount = 2;
-							pAttr->m_Type = GRAPHICS_TYPE_FLOAT;
-							pAttr->m_Normalized = false;
-							pAttr->m_pOffset = nullptr;
-							pAttr->m_FuncType = 0;
-							if(DoTextureCoords)
-							{
-								ContainerInfo.m_vAttributes.emplace_back();
-								pAttr = &ContainerInfo.m_vAttributes.back();
-								pAttr->m_DataTypeCount = 4;
-								pAttr->m_Type = GRAPHICS_TYPE_UNSIGNED_BYTE;
-								pAttr->m_Normalized = false;
-								pAttr->m_pOffset = (void *)(sizeof(vec2));
-								pAttr->m_FuncType = 1;
-							}
-
-							Visuals.m_BufferContainerIndex = Graphics()->CreateBufferContainer(&ContainerInfo);
-							// and finally inform the backend how many indices are required
-							Graphics()->IndicesNumRequiredNotify(vtmpTiles.size() * 6);
-
-							RenderLoading();
-						}
+						vTileLayerBuilds.push_back({&Visuals, pTMap, pTiles, LayerType, CurOverlay, DoTextureCoords});
 
 						++CurOverlay;
 					}
@@ -811,6 +711,53 @@ void CMapLayers::OnMapLoad()
 			}
 		}
 		m_vvLayerCount[g] = vLayerCounter;
+		if(PassedLastLayer)
+			break;
+	}
+
+	// build the tile data of all layers on the job pool and upload it in order
+	CWorkBatch BuildBatch(vTileLayerBuilds.size(), [&](size_t Index) {
+		BuildTileLayer(vTileLayerBuilds[Index]);
+	});
+	BuildBatch.Start([this](std::shared_ptr<IJob> pJob) { Engine()->AddJob(std::move(pJob)); }, std::thread::hardware_concurrency());
+	for(size_t BuildIndex = 0; BuildIndex < vTileLayerBuilds.size(); BuildIndex++)
+	{
+		BuildBatch.Wait(BuildIndex);
+		STileLayerBuild &Build = vTileLayerBuilds[BuildIndex];
+		if(Build.m_UploadDataSize == 0)
+			continue;
+
+		// first create the buffer object
+		int BufferObjectIndex = Graphics()->CreateBufferObject(Build.m_UploadDataSize, Build.m_pUploadData, 0, true);
+		Build.m_pUploadData = nullptr;
+
+		// then create the buffer container
+		SBufferContainerInfo ContainerInfo;
+		ContainerInfo.m_Stride = (Build.m_DoTextureCoords ? (sizeof(float) * 2 + sizeof(ubvec4)) : 0);
+		ContainerInfo.m_VertBufferBindingIndex = BufferObjectIndex;
+		ContainerInfo.m_vAttributes.emplace_back();
+		SBufferContainerInfo::SAttribute *pAttr = &ContainerInfo.m_vAttributes.back();
+		pAttr->m_DataTypeCount = 2;
+		pAttr->m_Type = GRAPHICS_TYPE_FLOAT;
+		pAttr->m_Normalized = false;
+		pAttr->m_pOffset = nullptr;
+		pAttr->m_FuncType = 0;
+		if(Build.m_DoTextureCoords)
+		{
+			ContainerInfo.m_vAttributes.emplace_back();
+			pAttr = &ContainerInfo.m_vAttributes.back();
+			pAttr->m_DataTypeCount = 4;
+			pAttr->m_Type = GRAPHICS_TYPE_UNSIGNED_BYTE;
+			pAttr->m_Normalized = false;
+			pAttr->m_pOffset = (void *)(sizeof(vec2));
+			pAttr->m_FuncType = 1;
+		}
+
+		Build.m_pVisuals->m_BufferContainerIndex = Graphics()->CreateBufferContainer(&ContainerInfo);
+		// and finally inform the backend how many indices are required
+		Graphics()->IndicesNumRequiredNotify(Build.m_NumTiles * 6);
+
+		RenderLoading();
 	}
 }
 
@@ -104,6 +104,22 @@ class CMapLayers : public CComponent
 	};
 	std::vector<STileLayerVisuals *> m_vpTileLayerVisuals;
 
+	// the tile data of one tile layer or overlay, built on the job pool before uploading
+	struct STileLayerBuild
+	{
+		STileLayerVisuals *m_pVisuals;
+		const CMapItemLayerTilemap *m_pTileMap;
+		const void *m_pTiles;
+		int m_LayerType;
+		int m_CurOverlay;
+		bool m_DoTextureCoords;
+
+		char *m_pUploadData = nullptr;
+		size_t m_UploadDataSize = 0;
+		size_t m_NumTiles = 0;
+	};
+	static void BuildTileLayer(STileLayerBuild &Build);
+
 	struct SQuadLayerVisuals
 	{
 		SQuadLayerVisuals() :
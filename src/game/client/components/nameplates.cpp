@@ -20,18 +20,40 @@ static constexpr float DEFAULT_PADDING = 5.0f;
 
 class CNamePlatePart
 {
+public:
+	// Parts of the same batch are drawn together for all name plates
+	enum EBatch
+	{
+		BATCH_NONE = -1,
+		BATCH_CIRCLE,
+		BATCH_ARROW,
+		BATCH_MUTED_ICON,
+		BATCH_HOOK_STRONG_WEAK,
+		BATCH_TEXT,
+		NUM_BATCHES,
+	};
+
 protected:
 	vec2 m_Size = vec2(0.0f, 0.0f);
 	vec2 m_Padding = vec2(DEFAULT_PADDING, DEFAULT_PADDING);
+	vec2 m_RenderPos = vec2(0.0f, 0.0f); // Center of this part, set by the layout of the name plate
 	bool m_NewLine = false; // Whether this part is a new line (doesn't do anything else)
 	bool m_Visible = true; // Whether this part is visible
 	bool m_ShiftOnInvis = false; // Whether when not visible will still take up space
+	EBatch m_Batch = BATCH_NONE;
 	CNamePlatePart(CGameClient &This) {}
 
 public:
 	virtual void Update(CGameClient &This, const CNamePlateData &Data) {}
 	virtual void Reset(CGameClient &This) {}
+	// Sets up the graphics state shared by all parts of this batch
+	virtual void BeginBatch(CGameClient &This) const {}
+	virtual void EndBatch(CGameClient &This) const {}
+	// Called between BeginBatch and EndBatch
 	virtual void Render(CGameClient &This, vec2 Pos) const {}
+	void SetRenderPos(vec2 Pos) { m_RenderPos = Pos; }
+	vec2 RenderPos() const { return m_RenderPos; }
+	EBatch Batch() const { return m_Batch; }
 	vec2 Size() const { return m_Size; }
 	vec2 Padding() const { return m_Padding; }
 	bool NewLine() const { return m_NewLine; }
@@ -49,20 +71,30 @@ class CNamePlatePartText : public CNamePlatePart
 {
 protected:
 	STextContainerIndex m_TextContainerIndex;
+	bool m_TextCreated = false; // Whether the text container matches the last text, even if it is empty
+	// Updates visibility and color, returns whether the text or its font size changed
 	virtual bool UpdateNeeded(CGameClient &This, const CNamePlateData &Data) = 0;
 	virtual void UpdateText(CGameClient &This, const CNamePlateData &Data) = 0;
 	ColorRGBA m_Color = ColorRGBA(1.0f, 1.0f, 1.0f, 1.0f);
 	CNamePlatePartText(CGameClient &This) :
 		CNamePlatePart(This)
 	{
+		m_Batch = BATCH_TEXT;
 		Reset(This);
 	}
 
 public:
 	void Update(CGameClient &This, const CNamePlateData &Data) override
 	{
-		if(!UpdateNeeded(This, Data) && m_TextContainerIndex.Valid())
+		// Hidden parts and color changes do not need a new text layout
+		const bool Changed = UpdateNeeded(This, Data);
+		if(!m_Visible)
 			return;
+		if(!Changed && m_TextCreated)
+		{
+			m_Visible = m_TextContainerIndex.Valid();
+			return;
+		}
 
 		// Set flags
 		unsigned int Flags = ETextRenderFlags::TEXT_RENDER_FLAG_NO_FIRST_CHARACTER_X_BEARING | ETextRenderFlags::TEXT_RENDER_FLAG_NO_LAST_CHARACTER_ADVANCE;
@@ -86,6 +118,7 @@ public:
 		}
 
 		This.TextRender()->SetRenderFlags(0);
+		m_TextCreated = true;
 
 		if(!m_TextContainerIndex.Valid())
 		{
@@ -99,6 +132,7 @@ public:
 	void Reset(CGameClient &This) override
 	{
 		This.TextRender()->DeleteTextContainer(m_TextContainerIndex);
+		m_TextCreated = false;
 	}
 	void Render(CGameClient &This, vec2 Pos) const override
 	{
@@ -124,16 +158,22 @@ protected:
 		CNamePlatePart(This) {}
 
 public:
-	void Render(CGameClient &This, vec2 Pos) const override
+	void BeginBatch(CGameClient &This) const override
 	{
-		IGraphics::CQuadItem QuadItem(Pos.x - Size().x / 2.0f, Pos.y - Size().y / 2.0f, Size().x, Size().y);
 		This.Graphics()->TextureSet(m_Texture);
 		This.Graphics()->QuadsBegin();
+	}
+	void EndBatch(CGameClient &This) const override
+	{
+		This.Graphics()->QuadsEnd();
+		This.Graphics()->QuadsSetRotation(0.0f);
+	}
+	void Render(CGameClient &This, vec2 Pos) const override
+	{
+		IGraphics::CQuadItem QuadItem(Pos.x - Size().x / 2.0f, Pos.y - Size().y / 2.0f, Size().x, Size().y);
 		This.Graphics()->SetColor(m_Color);
 		This.Graphics()->QuadsSetRotation(m_Rotation);
 		This.Graphics()->QuadsDrawTL(&QuadItem, 1);
-		This.Graphics()->QuadsEnd();
-		This.Graphics()->QuadsSetRotation(0.0f);
 	}
 };
 
@@ -144,18 +184,27 @@ protected:
 	float m_Rotation = 0.0f;
 	ColorRGBA m_Color = ColorRGBA(1.0f, 1.0f, 1.0f, 1.0f);
 	CNamePlatePartCircle(CGameClient &This) :
-		CNamePlatePart(This) {}
+		CNamePlatePart(This)
+	{
+		m_Batch = BATCH_CIRCLE;
+	}
 
 public:
-	void Render(CGameClient &This, vec2 Pos) const override
+	void BeginBatch(CGameClient &This) const override
 	{
 		This.Graphics()->TextureClear();
 		This.Graphics()->QuadsBegin();
+	}
+	void EndBatch(CGameClient &This) const override
+	{
+		This.Graphics()->QuadsEnd();
+		This.Graphics()->QuadsSetRotation(0.0f);
+	}
+	void Render(CGameClient &This, vec2 Pos) const override
+	{
 		This.Graphics()->SetColor(m_Color);
 		This.Graphics()->QuadsSetRotation(m_Rotation);
 		This.Graphics()->DrawCircle(Pos.x, Pos.y + 2.0f, m_Size.x, m_Size.y);
-		This.Graphics()->QuadsEnd();
-		This.Graphics()->QuadsSetRotation(0.0f);
 	}
 };
 
@@ -171,16 +220,22 @@ protected:
 		CNamePlatePart(This) {}
 
 public:
-	void Render(CGameClient &This, vec2 Pos) const override
+	void BeginBatch(CGameClient &This) const override
 	{
 		This.Graphics()->TextureSet(m_Texture);
-		This.Graphics()->QuadsSetRotation(m_Rotation);
 		This.Graphics()->QuadsBegin();
+	}
+	void EndBatch(CGameClient &This) const override
+	{
+		This.Graphics()->QuadsEnd();
+		This.Graphics()->QuadsSetRotation(0.0f);
+	}
+	void Render(CGameClient &This, vec2 Pos) const override
+	{
+		This.Graphics()->QuadsSetRotation(m_Rotation);
 		This.Graphics()->SetColor(m_Color);
 		This.RenderTools()->SelectSprite(m_Sprite, m_SpriteFlags);
 		This.RenderTools()->DrawSprite(Pos.x, Pos.y, Size().x, Size().y);
-		This.Graphics()->QuadsEnd();
-		This.Graphics()->QuadsSetRotation(0.0f);
 	}
 };
 
@@ -213,6 +268,7 @@ public:
 		CNamePlatePartIcon(This)
 	{
 		m_Texture = g_pData->m_aImages[IMAGE_ARROW].m_Id;
+		m_Batch = BATCH_ARROW;
 		m_Direction = Dir;
 		switch(m_Direction)
 		{
@@ -511,6 +567,7 @@ public:
 		CNamePlatePartSprite(This)
 	{
 		m_Texture = g_pData->m_aImages[IMAGE_MUTED_ICON].m_Id;
+		m_Batch = BATCH_MUTED_ICON;
 	}
 };
 
@@ -546,6 +603,7 @@ public:
 		CNamePlatePartSprite(This)
 	{
 		m_Texture = g_pData->m_aImages[IMAGE_STRONGWEAK].m_Id;
+		m_Batch = BATCH_HOOK_STRONG_WEAK;
 		m_Padding = vec2(0.0f, 0.0f);
 	}
 };
@@ -602,19 +660,18 @@ private:
 	bool m_Inited = false;
 	bool m_InGame = false;
 	PartsVector m_vpParts;
-	void RenderLine(CGameClient &This,
-		vec2 Pos, vec2 Size,
+	void LayoutLine(vec2 Pos, vec2 Size,
 		PartsVector::iterator Start, PartsVector::iterator End)
 	{
 		Pos.x -= Size.x / 2.0f;
 		for(auto PartIt = Start; PartIt != End; ++PartIt)
 		{
-			const CNamePlatePart &Part = **PartIt;
+			CNamePlatePart &Part = **PartIt;
 			if(Part.Visible())
 			{
-				Part.Render(This, vec2(
-							  Pos.x + (Part.Padding().x + Part.Size().x) / 2.0f,
-							  Pos.y - std::max(Size.y, Part.Padding().y + Part.Size().y) / 2.0f));
+				Part.SetRenderPos(vec2(
+					Pos.x + (Part.Padding().x + Part.Size().x) / 2.0f,
+					Pos.y - std::max(Size.y, Part.Padding().y + Part.Size().y) / 2.0f));
 			}
 			if(Part.Visible() || Part.ShiftOnInvis())
 				Pos.x += Part.Size().x + Part.Padding().x;
@@ -675,9 +732,10 @@ public:
 		for(auto &Part : m_vpParts)
 			Part->Update(This, Data);
 	}
-	void Render(CGameClient &This, const vec2 &PositionBottomMiddle)
+	// Positions all visible parts, must be called after Update and before RenderBatch
+	void Layout(const vec2 &PositionBottomMiddle)
 	{
-		dbg_assert(m_Inited, "Tried to render uninited nameplate");
+		dbg_assert(m_Inited, "Tried to layout uninited nameplate");
 		vec2 Position = PositionBottomMiddle;
 		// X: Total width including padding of line, Y: Max height of line parts
 		vec2 LineSize = vec2(0.0f, 0.0f);
@@ -690,7 +748,7 @@ public:
 			{
 				if(!Empty)
 				{
-					RenderLine(This, Position, LineSize, Start, std::next(PartIt));
+					LayoutLine(Position, LineSize, Start, std::next(PartIt));
 					Position.y -= LineSize.y;
 				}
 				Start = std::next(PartIt);
@@ -703,7 +761,40 @@ public:
 				LineSize.y = std::max(LineSize.y, Part.Size().y + Part.Padding().y);
 			}
 		}
-		RenderLine(This, Position, LineSize, Start, m_vpParts.end());
+		LayoutLine(Position, LineSize, Start, m_vpParts.end());
+	}
+	// Renders the visible parts of one batch, begins the batch with the first such part if none is running yet
+	void RenderBatch(CGameClient &This, CNamePlatePart::EBatch Batch, const CNamePlatePart *&pBatchPart) const
+	{
+		for(const auto &pPart : m_vpParts)
+		{
+			if(pPart->Batch() != Batch || !pPart->Visible())
+				continue;
+			if(!pBatchPart)
+			{
+				pBatchPart = pPart.get();
+				pBatchPart->BeginBatch(This);
+			}
+			pPart->Render(This, pPart->RenderPos());
+		}
+	}
+	void Render(CGameClient &This, const vec2 &PositionBottomMiddle)
+	{
+		Layout(PositionBottomMiddle);
+		const CNamePlate *pThis = this;
+		RenderNamePlates(This, &pThis, 1);
+	}
+	// Draws every part type of all given name plates at once, so each texture is only bound once per frame
+	static void RenderNamePlates(CGameClient &This, const CNamePlate *const *ppNamePlates, size_t NumNamePlates)
+	{
+		for(int Batch = 0; Batch < CNamePlatePart::NUM_BATCHES; Batch++)
+		{
+			const CNamePlatePart *pBatchPart = nullptr;
+			for(size_t i = 0; i < NumNamePlates; i++)
+				ppNamePlates[i]->RenderBatch(This, (CNamePlatePart::EBatch)Batch, pBatchPart);
+			if(pBatchPart)
+				pBatchPart->EndBatch(This);
+		}
 		This.Graphics()->SetColor(1.0f, 1.0f, 1.0f, 1.0f);
 	}
 	vec2 Size() const
@@ -744,10 +835,14 @@ public:
 class CNamePlates::CNamePlatesData
 {
 public:
+	// Name plates keep their text containers between frames and only rebuild them when the shown data changes
 	CNamePlate m_aNamePlates[MAX_CLIENTS];
+	CNamePlate m_aSpecCharNamePlates[MAX_CLIENTS];
+	// Name plates laid out this frame, in the order they were queued
+	std::vector<const CNamePlate *> m_vpQueuedNamePlates;
 };
 
-void CNamePlates::RenderNamePlateGame(vec2 Position, const CNetObj_PlayerInfo *pPlayerInfo, float Alpha)
+void CNamePlates::QueueNamePlateGame(vec2 Position, const CNetObj_PlayerInfo *pPlayerInfo, float Alpha, bool SpecChar)
 {
 	// Get screen edges to avoid rendering offscreen
 	float ScreenX0, ScreenY0, ScreenX1, ScreenY1;
@@ -787,7 +882,7 @@ void CNamePlates::RenderNamePlateGame(vec2 Position, const CNetObj_PlayerInfo *p
 		Data.m_pReason = GameClient()->m_WarList.GetWarData(pPlayerInfo->m_ClientId).m_aReason;
 		Data.m_ShowReason = Data.m_ShowName && g_Config.m_ClWarListReason;
 
-		CTempData TempData = GameClient()->m_EClient.m_TempPlayers[pPlayerInfo->m_ClientId];
+		const CTempData &TempData = GameClient()->m_EClient.m_TempPlayers[pPlayerInfo->m_ClientId];
 
 		if((TempData.IsTempWar || TempData.IsTempHelper))
 			Data.m_pReason = TempData.m_aReason;
@@ -912,10 +1007,10 @@ void CNamePlates::RenderNamePlateGame(vec2 Position, const CNetObj_PlayerInfo *p
 		}
 	}
 
-	// Check if the nameplate is actually on screen
-	CNamePlate &NamePlate = m_pData->m_aNamePlates[pPlayerInfo->m_ClientId];
+	CNamePlate &NamePlate = SpecChar ? m_pData->m_aSpecCharNamePlates[pPlayerInfo->m_ClientId] : m_pData->m_aNamePlates[pPlayerInfo->m_ClientId];
 	NamePlate.Update(*GameClient(), Data);
-	NamePlate.Render(*GameClient(), Position - vec2(0.0f, (float)g_Config.m_ClNamePlatesOffset));
+	NamePlate.Layout(Position - vec2(0.0f, (float)g_Config.m_ClNamePlatesOffset));
+	m_pData->m_vpQueuedNamePlates.push_back(&NamePlate);
 }
 
 void CNamePlates::RenderNamePlatePreview(vec2 Position, int Dummy)
@@ -1047,6 +1142,8 @@ void CNamePlates::ResetNamePlates()
 {
 	for(CNamePlate &NamePlate : m_pData->m_aNamePlates)
 		NamePlate.Reset(*GameClient());
+	for(CNamePlate &NamePlate : m_pData->m_aSpecCharNamePlates)
+		NamePlate.Reset(*GameClient());
 }
 
 void CNamePlates::OnRender()
@@ -1062,6 +1159,7 @@ void CNamePlates::OnRender()
 	if(!g_Config.m_ClNamePlates && ShowDirection == 0)
 		return;
 
+	m_pData->m_vpQueuedNamePlates.clear();
 	for(int i = 0; i < MAX_CLIENTS; i++)
 	{
 		const CNetObj_PlayerInfo *pInfo = GameClient()->m_Snap.m_apPlayerInfos[i];
@@ -1072,15 +1170,16 @@ void CNamePlates::OnRender()
 		if(GameClient()->m_aClients[i].m_SpecCharPresent)
 		{
 			const vec2 RenderPos = GameClient()->m_aClients[i].m_SpecChar;
-			RenderNamePlateGame(RenderPos, pInfo, 0.4f);
+			QueueNamePlateGame(RenderPos, pInfo, 0.4f, true);
 		}
 		// Only render name plates for active characters
 		if(GameClient()->m_Snap.m_aCharacters[i].m_Active)
 		{
 			const vec2 RenderPos = GameClient()->m_aClients[i].m_RenderPos;
-			RenderNamePlateGame(RenderPos, pInfo, 1.0f);
+			QueueNamePlateGame(RenderPos, pInfo, 1.0f, false);
 		}
 	}
+	CNamePlate::RenderNamePlates(*GameClient(), m_pData->m_vpQueuedNamePlates.data(), m_pData->m_vpQueuedNamePlates.size());
 }
 
 void CNamePlates::OnWindowResize()
@@ -58,7 +58,8 @@ private:
 	CNamePlatesData *m_pData;
 
 public:
-	void RenderNamePlateGame(vec2 Position, const CNetObj_PlayerInfo *pPlayerInfo, float Alpha);
+	// Updates the name plate of a player and queues it for the batched rendering in OnRender
+	void QueueNamePlateGame(vec2 Position, const CNetObj_PlayerInfo *pPlayerInfo, float Alpha, bool SpecChar);
 	void RenderNamePlatePreview(vec2 Position, int Dummy);
 	void ResetNamePlates();
 	int Sizeof() const override { return sizeof(*this); }
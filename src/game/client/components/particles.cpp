@@ -3,6 +3,7 @@
 #include <base/math.h>
 #include <engine/demo.h>
 #include <engine/graphics.h>
+#include <engine/shared/config.h>
 
 #include "particles.h"
 #include <game/client/render.h>
@@ -20,21 +21,88 @@ CParticles::CParticles()
 	m_RenderGeneral.m_pParts = this;
 }
 
-void CParticles::OnReset()
+template<typename F>
+void CParticles::CGroup::ForEachArray(F &&Func)
 {
-	// reset particles
-	for(int i = 0; i < MAX_PARTICLES; i++)
-	{
-		m_aParticles[i].m_PrevPart = i - 1;
-		m_aParticles[i].m_NextPart = i + 1;
-	}
+	Func(m_vPosX);
+	Func(m_vPosY);
+	Func(m_vVelX);
+	Func(m_vVelY);
+	Func(m_vLife);
+	Func(m_vLifeSpan);
+	Func(m_vRot);
+	Func(m_vRotspeed);
+	Func(m_vGravity);
+	Func(m_vFriction);
+	Func(m_vStartSize);
+	Func(m_vEndSize);
+	Func(m_vStartAlpha);
+	Func(m_vEndAlpha);
+	Func(m_vColor);
+	Func(m_vSpr);
+	Func(m_vUseAlphaFading);
+	Func(m_vCollides);
+}
+
+void CParticles::CGroup::Clear()
+{
+	ForEachArray([](auto &vArray) { vArray.clear(); });
+}
 
-	m_aParticles[0].m_PrevPart = 0;
-	m_aParticles[MAX_PARTICLES - 1].m_NextPart = -1;
-	m_FirstFree = 0;
+void CParticles::CGroup::Push(const CParticle &Part, float Life)
+{
+	m_vPosX.push_back(Part.m_Pos.x);
+	m_vPosY.push_back(Part.m_Pos.y);
+	m_vVelX.push_back(Part.m_Vel.x);
+	m_vVelY.push_back(Part.m_Vel.y);
+	m_vLife.push_back(Life);
+	m_vLifeSpan.push_back(Part.m_LifeSpan);
+	m_vRot.push_back(Part.m_Rot);
+	m_vRotspeed.push_back(Part.m_Rotspeed);
+	m_vGravity.push_back(Part.m_Gravity);
+	m_vFriction.push_back(Part.m_Friction);
+	m_vStartSize.push_back(Part.m_StartSize);
+	m_vEndSize.push_back(Part.m_EndSize);
+	m_vStartAlpha.push_back(Part.m_StartAlpha);
+	m_vEndAlpha.push_back(Part.m_EndAlpha);
+	m_vColor.push_back(Part.m_Color);
+	m_vSpr.push_back(Part.m_Spr);
+	m_vUseAlphaFading.push_back(Part.m_UseAlphaFading);
+	m_vCollides.push_back(Part.m_Collides);
+}
 
-	for(int &FirstPart : m_aFirstPart)
-		FirstPart = -1;
+size_t CParticles::CGroup::RemoveDead()
+{
+	const size_t Num = Size();
+	size_t FirstDead = 0;
+	while(FirstDead < Num && m_vLife[FirstDead] <= m_vLifeSpan[FirstDead])
+		FirstDead++;
+	if(FirstDead == Num)
+		return 0;
+
+	m_vAlive.resize(Num);
+	for(size_t i = FirstDead; i < Num; i++)
+		m_vAlive[i] = m_vLife[i] <= m_vLifeSpan[i];
+
+	size_t NumAlive = FirstDead;
+	ForEachArray([&](auto &vArray) {
+		size_t Write = FirstDead;
+		for(size_t i = FirstDead; i < Num; i++)
+		{
+			if(m_vAlive[i])
+				vArray[Write++] = vArray[i];
+		}
+		vArray.resize(Write);
+		NumAlive = Write;
+	});
+	return Num - NumAlive;
+}
+
+void CParticles::OnReset()
+{
+	for(CGroup &Group : m_aGroups)
+		Group.Clear();
+	m_NumParticles = 0;
 }
 
 void CParticles::Add(int Group, CParticle *pPart, float TimePassed)
@@ -51,27 +119,11 @@ void CParticles::Add(int Group, CParticle *pPart, float TimePassed)
 			return;
 	}
 
-	if(m_FirstFree == -1)
+	if(m_NumParticles >= (size_t)g_Config.m_ClParticlesMax)
 		return;
 
-	// remove from the free list
-	int Id = m_FirstFree;
-	m_FirstFree = m_aParticles[Id].m_NextPart;
-	if(m_FirstFree != -1)
-		m_aParticles[m_FirstFree].m_PrevPart = -1;
-
-	// copy data
-	m_aParticles[Id] = *pPart;
-
-	// insert to the group list
-	m_aParticles[Id].m_PrevPart = -1;
-	m_aParticles[Id].m_NextPart = m_aFirstPart[Group];
-	if(m_aFirstPart[Group] != -1)
-		m_aParticles[m_aFirstPart[Group]].m_PrevPart = Id;
-	m_aFirstPart[Group] = Id;
-
-	// set some parameters
-	m_aParticles[Id].m_Life = TimePassed;
+	m_aGroups[Group].Push(*pPart, TimePassed);
+	m_NumParticles++;
 }
 
 void CParticles::Update(float TimePassed)
@@ -91,55 +143,71 @@ void CParticles::Update(float TimePassed)
 		m_FrictionFraction -= 0.05f;
 	}
 
-	for(int &FirstPart : m_aFirstPart)
+	const float InvTimePassed = 1.0f / TimePassed;
+	for(CGroup &Group : m_aGroups)
 	{
-		int i = FirstPart;
-		while(i != -1)
+		const size_t Num = Group.Size();
+		if(Num == 0)
+			continue;
+
+		float *pPosX = Group.m_vPosX.data();
+		float *pPosY = Group.m_vPosY.data();
+		float *pVelX = Group.m_vVelX.data();
+		float *pVelY = Group.m_vVelY.data();
+		const float *pGravity = Group.m_vGravity.data();
+		const float *pFriction = Group.m_vFriction.data();
+
+		// the plain loops below have no dependencies between particles and get vectorised
+		for(size_t i = 0; i < Num; i++)
+			pVelY[i] += pGravity[i] * TimePassed;
+
+		for(int f = 0; f < FrictionCount; f++) // apply friction
 		{
-			int Next = m_aParticles[i].m_NextPart;
-			//m_aParticles[i].vel += flow_get(m_aParticles[i].pos)*time_passed * m_aParticles[i].flow_affected;
-			m_aParticles[i].m_Vel.y += m_aParticles[i].m_Gravity * TimePassed;
-
-			for(int f = 0; f < FrictionCount; f++) // apply friction
-				m_aParticles[i].m_Vel *= m_aParticles[i].m_Friction;
-
-			// move the point
-			vec2 Vel = m_aParticles[i].m_Vel * TimePassed;
-			if(m_aParticles[i].m_Collides)
-			{
-				Collision()->MovePoint(&m_aParticles[i].m_Pos, &Vel, random_float(0.1f, 1.0f), nullptr);
-			}
-			else
+			for(size_t i = 0; i < Num; i++)
 			{
-				m_aParticles[i].m_Pos += Vel;
+				pVelX[i] *= pFriction[i];
+				pVelY[i] *= pFriction[i];
 			}
-			m_aParticles[i].m_Vel = Vel * (1.0f / TimePassed);
+		}
 
-			m_aParticles[i].m_Life += TimePassed;
-			m_aParticles[i].m_Rot += TimePassed * m_aParticles[i].m_Rotspeed;
+		// velocity becomes the movement of this frame
+		for(size_t i = 0; i < Num; i++)
+		{
+			pVelX[i] *= TimePassed;
+			pVelY[i] *= TimePassed;
+		}
 
-			// check particle death
-			if(m_aParticles[i].m_Life > m_aParticles[i].m_LifeSpan)
-			{
-				// remove it from the group list
-				if(m_aParticles[i].m_PrevPart != -1)
-					m_aParticles[m_aParticles[i].m_PrevPart].m_NextPart = m_aParticles[i].m_NextPart;
-				else
-					FirstPart = m_aParticles[i].m_NextPart;
-
-				if(m_aParticles[i].m_NextPart != -1)
-					m_aParticles[m_aParticles[i].m_NextPart].m_PrevPart = m_aParticles[i].m_PrevPart;
-
-				// insert to the free list
-				if(m_FirstFree != -1)
-					m_aParticles[m_FirstFree].m_PrevPart = i;
-				m_aParticles[i].m_PrevPart = -1;
-				m_aParticles[i].m_NextPart = m_FirstFree;
-				m_FirstFree = i;
-			}
+		// only particles that would end up inside a solid tile need MovePoint, which
+		// bounces them off and keeps them in place, the rest just move freely below
+		m_vMoveScale.assign(Num, 1.0f);
+		const uint8_t *pCollides = Group.m_vCollides.data();
+		for(size_t i = 0; i < Num; i++)
+		{
+			if(!pCollides[i] || !Collision()->CheckPoint(pPosX[i] + pVelX[i], pPosY[i] + pVelY[i]))
+				continue;
+			vec2 Pos(pPosX[i], pPosY[i]);
+			vec2 Vel(pVelX[i], pVelY[i]);
+			Collision()->MovePoint(&Pos, &Vel, random_float(0.1f, 1.0f), nullptr);
+			pVelX[i] = Vel.x;
+			pVelY[i] = Vel.y;
+			m_vMoveScale[i] = 0.0f;
+		}
 
-			i = Next;
+		const float *pMoveScale = m_vMoveScale.data();
+		float *pLife = Group.m_vLife.data();
+		float *pRot = Group.m_vRot.data();
+		const float *pRotspeed = Group.m_vRotspeed.data();
+		for(size_t i = 0; i < Num; i++)
+		{
+			pPosX[i] += pVelX[i] * pMoveScale[i];
+			pPosY[i] += pVelY[i] * pMoveScale[i];
+			pVelX[i] *= InvTimePassed;
+			pVelY[i] *= InvTimePassed;
+			pLife[i] += TimePassed;
+			pRot[i] += TimePassed * pRotspeed[i];
 		}
+
+		m_NumParticles -= Group.RemoveDead();
 	}
 }
 
@@ -218,12 +286,20 @@ void CParticles::RenderGroup(int Group)
 		ParticleQuadContainerIndex = m_ExtraParticleQuadContainerIndex;
 	}
 
+	const CGroup &Parts = m_aGroups[Group];
+	const int Num = Parts.Size();
+
+	// newest particles are drawn first, like they always were
+	const auto &&GetAlpha = [&](int i, float a) {
+		if(Parts.m_vUseAlphaFading[i])
+			return mix(Parts.m_vStartAlpha[i], Parts.m_vEndAlpha[i], a);
+		return Parts.m_vColor[i].a;
+	};
+
 	// don't use the buffer methods here, else the old renderer gets many draw calls
 	if(Graphics()->IsQuadContainerBufferingEnabled())
 	{
-		int i = m_aFirstPart[Group];
-
-		static IGraphics::SRenderSpriteInfo s_aParticleRenderInfo[MAX_PARTICLES];
+		static IGraphics::SRenderSpriteInfo s_aParticleRenderInfo[gs_GraphicsMaxParticlesRenderCount];
 
 		int CurParticleRenderCount = 0;
 
@@ -231,71 +307,45 @@ void CParticles::RenderGroup(int Group)
 		ColorRGBA LastColor;
 		int LastQuadOffset = 0;
 
-		if(i != -1)
+		if(Num > 0)
 		{
-			float Alpha = m_aParticles[i].m_Color.a;
-			if(m_aParticles[i].m_UseAlphaFading)
-			{
-				float a = m_aParticles[i].m_Life / m_aParticles[i].m_LifeSpan;
-				Alpha = mix(m_aParticles[i].m_StartAlpha, m_aParticles[i].m_EndAlpha, a);
-			}
-			LastColor.r = m_aParticles[i].m_Color.r;
-			LastColor.g = m_aParticles[i].m_Color.g;
-			LastColor.b = m_aParticles[i].m_Color.b;
-			LastColor.a = Alpha;
-
-			Graphics()->SetColor(
-				m_aParticles[i].m_Color.r,
-				m_aParticles[i].m_Color.g,
-				m_aParticles[i].m_Color.b,
-				Alpha);
-
-			LastQuadOffset = m_aParticles[i].m_Spr;
+			const int i = Num - 1;
+			const ColorRGBA &Color = Parts.m_vColor[i];
+			LastColor = ColorRGBA(Color.r, Color.g, Color.b, GetAlpha(i, Parts.m_vLife[i] / Parts.m_vLifeSpan[i]));
+			Graphics()->SetColor(LastColor);
+			LastQuadOffset = Parts.m_vSpr[i];
 		}
 
-		while(i != -1)
+		for(int i = Num - 1; i >= 0; i--)
 		{
-			int QuadOffset = m_aParticles[i].m_Spr;
-			float a = m_aParticles[i].m_Life / m_aParticles[i].m_LifeSpan;
-			vec2 p = m_aParticles[i].m_Pos;
-			float Size = mix(m_aParticles[i].m_StartSize, m_aParticles[i].m_EndSize, a);
-			float Alpha = m_aParticles[i].m_Color.a;
-			if(m_aParticles[i].m_UseAlphaFading)
-			{
-				Alpha = mix(m_aParticles[i].m_StartAlpha, m_aParticles[i].m_EndAlpha, a);
-			}
+			int QuadOffset = Parts.m_vSpr[i];
+			float a = Parts.m_vLife[i] / Parts.m_vLifeSpan[i];
+			vec2 p = vec2(Parts.m_vPosX[i], Parts.m_vPosY[i]);
+			float Size = mix(Parts.m_vStartSize[i], Parts.m_vEndSize[i], a);
+			float Alpha = GetAlpha(i, a);
+			const ColorRGBA &Color = Parts.m_vColor[i];
 
 			// the current position, respecting the size, is inside the viewport, render it, else ignore
 			if(ParticleIsVisibleOnScreen(p, Size))
 			{
-				if((size_t)CurParticleRenderCount == gs_GraphicsMaxParticlesRenderCount || LastColor.r != m_aParticles[i].m_Color.r || LastColor.g != m_aParticles[i].m_Color.g || LastColor.b != m_aParticles[i].m_Color.b || LastColor.a != Alpha || LastQuadOffset != QuadOffset)
+				if((size_t)CurParticleRenderCount == gs_GraphicsMaxParticlesRenderCount || LastColor.r != Color.r || LastColor.g != Color.g || LastColor.b != Color.b || LastColor.a != Alpha || LastQuadOffset != QuadOffset)
 				{
 					Graphics()->TextureSet(aParticles[LastQuadOffset - FirstParticleOffset]);
 					Graphics()->RenderQuadContainerAsSpriteMultiple(ParticleQuadContainerIndex, LastQuadOffset - FirstParticleOffset, CurParticleRenderCount, s_aParticleRenderInfo);
 					CurParticleRenderCount = 0;
 					LastQuadOffset = QuadOffset;
 
-					Graphics()->SetColor(
-						m_aParticles[i].m_Color.r,
-						m_aParticles[i].m_Color.g,
-						m_aParticles[i].m_Color.b,
-						Alpha);
-
-					LastColor.r = m_aParticles[i].m_Color.r;
-					LastColor.g = m_aParticles[i].m_Color.g;
-					LastColor.b = m_aParticles[i].m_Color.b;
-					LastColor.a = Alpha;
+					LastColor = ColorRGBA(Color.r, Color.g, Color.b, Alpha);
+					Graphics()->SetColor(LastColor);
 				}
 
 				s_aParticleRenderInfo[CurParticleRenderCount].m_Pos[0] = p.x;
 				s_aParticleRenderInfo[CurParticleRenderCount].m_Pos[1] = p.y;
 				s_aParticleRenderInfo[CurParticleRenderCount].m_Scale = Size;
-				s_aParticleRenderInfo[CurParticleRenderCount].m_Rotation = m_aParticles[i].m_Rot;
+				s_aParticleRenderInfo[CurParticleRenderCount].m_Rotation = Parts.m_vRot[i];
 
 				++CurParticleRenderCount;
 			}
-
-			i = m_aParticles[i].m_NextPart;
 		}
 
 		Graphics()->TextureSet(aParticles[LastQuadOffset - FirstParticleOffset]);
@@ -303,42 +353,31 @@ void CParticles::RenderGroup(int Group)
 	}
 	else
 	{
-		int i = m_aFirstPart[Group];
-
 		Graphics()->BlendNormal();
 		Graphics()->WrapClamp();
 
-		while(i != -1)
+		for(int i = Num - 1; i >= 0; i--)
 		{
-			float a = m_aParticles[i].m_Life / m_aParticles[i].m_LifeSpan;
-			vec2 p = m_aParticles[i].m_Pos;
-			float Size = mix(m_aParticles[i].m_StartSize, m_aParticles[i].m_EndSize, a);
-			float Alpha = m_aParticles[i].m_Color.a;
-			if(m_aParticles[i].m_UseAlphaFading)
-			{
-				Alpha = mix(m_aParticles[i].m_StartAlpha, m_aParticles[i].m_EndAlpha, a);
-			}
+			float a = Parts.m_vLife[i] / Parts.m_vLifeSpan[i];
+			vec2 p = vec2(Parts.m_vPosX[i], Parts.m_vPosY[i]);
+			float Size = mix(Parts.m_vStartSize[i], Parts.m_vEndSize[i], a);
+			float Alpha = GetAlpha(i, a);
 
 			// the current position, respecting the size, is inside the viewport, render it, else ignore
 			if(ParticleIsVisibleOnScreen(p, Size))
 			{
-				Graphics()->TextureSet(aParticles[m_aParticles[i].m_Spr - FirstParticleOffset]);
+				Graphics()->TextureSet(aParticles[Parts.m_vSpr[i] - FirstParticleOffset]);
 				Graphics()->QuadsBegin();
 
-				Graphics()->QuadsSetRotation(m_aParticles[i].m_Rot);
+				Graphics()->QuadsSetRotation(Parts.m_vRot[i]);
 
-				Graphics()->SetColor(
-					m_aParticles[i].m_Color.r,
-					m_aParticles[i].m_Color.g,
-					m_aParticles[i].m_Color.b,
-					Alpha);
+				const ColorRGBA &Color = Parts.m_vColor[i];
+				Graphics()->SetColor(Color.r, Color.g, Color.b, Alpha);
 
 				IGraphics::CQuadItem QuadItem(p.x, p.y, Size, Size);
 				Graphics()->QuadsDraw(&QuadItem, 1);
 				Graphics()->QuadsEnd();
 			}
-
-			i = m_aParticles[i].m_NextPart;
 		}
 		Graphics()->WrapNormal();
 		Graphics()->BlendNormal();
@@ -6,6 +6,9 @@
 #include <base/vmath.h>
 #include <game/client/component.h>
 
+#include <cstdint>
+#include <vector>
+
 // particles
 struct CParticle
 {
@@ -53,11 +56,6 @@ struct CParticle
 	ColorRGBA m_Color;
 
 	bool m_Collides;
-
-	// set by the particle system
-	float m_Life;
-	int m_PrevPart;
-	int m_NextPart;
 };
 
 class CParticles : public CComponent
@@ -88,14 +86,47 @@ private:
 	int m_ParticleQuadContainerIndex;
 	int m_ExtraParticleQuadContainerIndex;
 
-	enum
+	// The particles of one group as parallel arrays in spawn order, so the
+	// per frame integration runs over contiguous floats instead of chasing
+	// list links through whole CParticle structs.
+	class CGroup
 	{
-		MAX_PARTICLES = 1024 * 8,
+	public:
+		std::vector<float> m_vPosX;
+		std::vector<float> m_vPosY;
+		std::vector<float> m_vVelX;
+		std::vector<float> m_vVelY;
+		std::vector<float> m_vLife;
+		std::vector<float> m_vLifeSpan;
+		std::vector<float> m_vRot;
+		std::vector<float> m_vRotspeed;
+		std::vector<float> m_vGravity;
+		std::vector<float> m_vFriction;
+		std::vector<float> m_vStartSize;
+		std::vector<float> m_vEndSize;
+		std::vector<float> m_vStartAlpha;
+		std::vector<float> m_vEndAlpha;
+		std::vector<ColorRGBA> m_vColor;
+		std::vector<int> m_vSpr;
+		std::vector<uint8_t> m_vUseAlphaFading;
+		std::vector<uint8_t> m_vCollides;
+
+		size_t Size() const { return m_vPosX.size(); }
+		void Clear();
+		void Push(const CParticle &Part, float Life);
+		// removes all particles whose lifespan is over, keeping the order of the rest
+		size_t RemoveDead();
+
+	private:
+		std::vector<uint8_t> m_vAlive;
+
+		template<typename F>
+		void ForEachArray(F &&Func);
 	};
 
-	CParticle m_aParticles[MAX_PARTICLES];
-	int m_FirstFree;
-	int m_aFirstPart[NUM_GROUPS];
+	CGroup m_aGroups[NUM_GROUPS];
+	size_t m_NumParticles = 0;
+	std::vector<float> m_vMoveScale;
 
 	float m_FrictionFraction = 0.0f;
 	int64_t m_LastRenderTime = 0;
@@ -97,13 +97,13 @@ void CPlayers::RenderHand6(const CTeeRenderInfo *pInfo, vec2 CenterPos, vec2 Dir
 	const CSkin::CSkinTextures *pSkinTextures = pInfo->m_CustomColoredSkin ? &pInfo->m_ColorableRenderSkin : &pInfo->m_OriginalRenderSkin;
 
 	Graphics()->SetColor(pInfo->m_ColorBody.r, pInfo->m_ColorBody.g, pInfo->m_ColorBody.b, Alpha);
+	Graphics()->TextureSet(pSkinTextures->m_Atlas);
 
 	// two passes
 	for(int i = 0; i < 2; i++)
 	{
 		int QuadOffset = NUM_WEAPONS * 2 + i;
 		Graphics()->QuadsSetRotation(Angle);
-		Graphics()->TextureSet(i == 0 ? pSkinTextures->m_HandsOutline : pSkinTextures->m_Hands);
 		Graphics()->RenderQuadContainerAsSprite(m_WeaponEmoteQuadContainerIndex, QuadOffset, HandPos.x, HandPos.y);
 	}
 }
@@ -1088,10 +1088,10 @@ void CPlayers::OnInit()
 	}
 	float ScaleX, ScaleY;
 
-	// at the end the hand
-	Graphics()->QuadsSetSubset(0, 0, 1, 1);
+	// at the end the hand, from the skin atlas
+	RenderTools()->SelectSkinAtlasPart(CSkin::ATLAS_HANDS_OUTLINE);
 	RenderTools()->QuadContainerAddSprite(m_WeaponEmoteQuadContainerIndex, 20.f);
-	Graphics()->QuadsSetSubset(0, 0, 1, 1);
+	RenderTools()->SelectSkinAtlasPart(CSkin::ATLAS_HANDS);
 	RenderTools()->QuadContainerAddSprite(m_WeaponEmoteQuadContainerIndex, 20.f);
 
 	Graphics()->QuadsSetSubset(0, 0, 1, 1);
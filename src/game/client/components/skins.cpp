@@ -18,8 +18,76 @@
 #include <game/generated/client_data.h>
 #include <game/localization.h>
 
+#include <algorithm>
+#include <cmath>
+
 using namespace std::chrono_literals;
 
+static const char *const SKIN_METADATA_CACHE_FILE = "skin_metadata_cache.bin";
+static constexpr size_t MAX_CACHED_SKIN_METADATA = 65536;
+
+struct SSkinMetadataCacheHeader
+{
+	static constexpr const char MAGIC[8] = "DDSKINM";
+	static constexpr int VERSION = 1;
+
+	char m_aMagic[8];
+	int32_t m_Version;
+	int32_t m_NumEntries;
+};
+
+struct SSkinMetadataCacheEntry
+{
+	SHA256_DIGEST m_PngHash;
+	uint32_t m_PngSize;
+	uint32_t m_Width;
+	uint32_t m_Height;
+	// width, height, offset x, offset y, max width, max height
+	int32_t m_aBodyMetrics[6];
+	int32_t m_aFeetMetrics[6];
+	float m_aBloodColor[3];
+	uint8_t m_GrayscaleWeight;
+	uint8_t m_aPadding[3];
+};
+
+static void StoreMetrics(int32_t *pOut, const CSkin::CSkinMetricVariable &Metrics)
+{
+	pOut[0] = Metrics.m_Width.m_Value;
+	pOut[1] = Metrics.m_Height.m_Value;
+	pOut[2] = Metrics.m_OffsetX.m_Value;
+	pOut[3] = Metrics.m_OffsetY.m_Value;
+	pOut[4] = Metrics.m_MaxWidth.m_Value;
+	pOut[5] = Metrics.m_MaxHeight.m_Value;
+}
+
+// same ranges as CheckMetrics produces for an image of the given size
+static bool ValidMetrics(const int32_t *pIn, uint32_t Width, uint32_t Height)
+{
+	return pIn[0] >= 1 && (uint32_t)pIn[0] <= Width &&
+	       pIn[1] >= 1 && (uint32_t)pIn[1] <= Height &&
+	       pIn[2] >= 0 && (uint32_t)pIn[2] < Width &&
+	       pIn[3] >= 0 && (uint32_t)pIn[3] < Height &&
+	       pIn[4] >= 1 && (uint32_t)pIn[4] <= Width &&
+	       pIn[5] >= 1 && (uint32_t)pIn[5] <= Height;
+}
+
+static void RestoreMetrics(CSkin::CSkinMetricVariable &Metrics, const int32_t *pIn)
+{
+	Metrics.m_Width.m_Value = pIn[0];
+	Metrics.m_Height.m_Value = pIn[1];
+	Metrics.m_OffsetX.m_Value = pIn[2];
+	Metrics.m_OffsetY.m_Value = pIn[3];
+	Metrics.m_MaxWidth.m_Value = pIn[4];
+	Metrics.m_MaxHeight.m_Value = pIn[5];
+}
+
+size_t CSkins::CSha256Hasher::operator()(const SHA256_DIGEST &Digest) const
+{
+	size_t Hash;
+	mem_copy(&Hash, Digest.data, sizeof(Hash));
+	return Hash;
+}
+
 CSkins::CAbstractSkinLoadJob::CAbstractSkinLoadJob(CSkins *pSkins, const char *pName) :
 	m_pSkins(pSkins)
 {
@@ -290,7 +358,59 @@ static void CheckMetrics(CSkin::CSkinMetricVariable &Metrics, const uint8_t *pIm
 	Metrics.m_MaxHeight = CheckHeight;
 }
 
-bool CSkins::LoadSkinData(const char *pName, CSkinLoadData &Data) const
+static void ReorderGrayscaleBody(const CImageInfo &Image, size_t BodyWidth, size_t BodyHeight, uint8_t OrgWeight)
+{
+	const uint8_t NewWeight = 192;
+	const size_t PixelStep = Image.PixelSize();
+	const size_t Pitch = Image.m_Width * PixelStep;
+	for(size_t y = 0; y < BodyHeight; y++)
+	{
+		for(size_t x = 0; x < BodyWidth; x++)
+		{
+			const size_t Offset = y * Pitch + x * PixelStep;
+			uint8_t v = Image.m_pData[Offset];
+			if(v <= OrgWeight)
+			{
+				v = (uint8_t)((v / (float)OrgWeight) * NewWeight);
+			}
+			else
+			{
+				v = (uint8_t)(((v - OrgWeight) / (float)(255 - OrgWeight)) * (255 - NewWeight) + NewWeight);
+			}
+			Image.m_pData[Offset] = v;
+			Image.m_pData[Offset + 1] = v;
+			Image.m_pData[Offset + 2] = v;
+		}
+	}
+}
+
+// Replaces the skin image with the atlas of its parts, see CSkin::AtlasPartRect
+static void PackSkinAtlas(CImageInfo &Image)
+{
+	const int CellWidth = Image.m_Width / g_pData->m_aSprites[SPRITE_TEE_BODY].m_pSet->m_Gridx;
+	const int CellHeight = Image.m_Height / g_pData->m_aSprites[SPRITE_TEE_BODY].m_pSet->m_Gridy;
+
+	int AtlasWidth, AtlasHeight;
+	CSkin::AtlasSize(CellWidth, CellHeight, AtlasWidth, AtlasHeight);
+	CImageInfo Atlas;
+	Atlas.m_Width = AtlasWidth;
+	Atlas.m_Height = AtlasHeight;
+	Atlas.m_Format = Image.m_Format;
+	Atlas.m_pData = static_cast<uint8_t *>(calloc(Atlas.DataSize(), 1));
+
+	for(int Part = 0; Part < CSkin::NUM_ATLAS_PARTS; Part++)
+	{
+		const CDataSprite &Sprite = g_pData->m_aSprites[CSkin::AtlasPartSprite(Part)];
+		int X, Y, Width, Height;
+		CSkin::AtlasPartRect(Part, CellWidth, CellHeight, X, Y, Width, Height);
+		Atlas.CopyRectFrom(Image, Sprite.m_X * CellWidth, Sprite.m_Y * CellHeight, Width, Height, X, Y);
+	}
+
+	Image.Free();
+	Image = std::move(Atlas);
+}
+
+bool CSkins::LoadSkinData(const char *pName, const uint8_t *pPngData, size_t PngSize, CSkinLoadData &Data)
 {
 	if(!Graphics()->CheckImageDivisibility(pName, Data.m_Info, g_pData->m_aSprites[SPRITE_TEE_BODY].m_pSet->m_Gridx, g_pData->m_aSprites[SPRITE_TEE_BODY].m_pSet->m_Gridy, true))
 	{
@@ -304,6 +424,17 @@ bool CSkins::LoadSkinData(const char *pName, CSkinLoadData &Data) const
 		Data.m_Info.Free();
 		return false;
 	}
+	{
+		// the borders in the skin atlas are an eighth of a grid cell
+		const size_t GridX = g_pData->m_aSprites[SPRITE_TEE_BODY].m_pSet->m_Gridx;
+		const size_t GridY = g_pData->m_aSprites[SPRITE_TEE_BODY].m_pSet->m_Gridy;
+		const size_t CellWidth = Data.m_Info.m_Width / GridX;
+		const size_t CellHeight = Data.m_Info.m_Height / GridY;
+		if(CellWidth % 8 != 0 || CellHeight % 8 != 0)
+		{
+			ResizeImage(Data.m_Info, (CellWidth + 7) / 8 * 8 * GridX, (CellHeight + 7) / 8 * 8 * GridY);
+		}
+	}
 	const size_t BodyWidth = g_pData->m_aSprites[SPRITE_TEE_BODY].m_W * (Data.m_Info.m_Width / g_pData->m_aSprites[SPRITE_TEE_BODY].m_pSet->m_Gridx);
 	const size_t BodyHeight = g_pData->m_aSprites[SPRITE_TEE_BODY].m_H * (Data.m_Info.m_Height / g_pData->m_aSprites[SPRITE_TEE_BODY].m_pSet->m_Gridy);
 	if(BodyWidth > Data.m_Info.m_Width || BodyHeight > Data.m_Info.m_Height)
@@ -313,6 +444,22 @@ bool CSkins::LoadSkinData(const char *pName, CSkinLoadData &Data) const
 		return false;
 	}
 
+	// skip the analysis if the same PNG file was seen before
+	const bool UseCache = g_Config.m_ClSkinMetadataCache;
+	const SHA256_DIGEST PngHash = UseCache ? sha256(pPngData, PngSize) : SHA256_ZEROED;
+	CSkinMetadata Metadata;
+	if(UseCache && FindCachedMetadata(PngHash, PngSize, Data.m_Info, Metadata))
+	{
+		Data.m_Metrics = Metadata.m_Metrics;
+		Data.m_BloodColor = Metadata.m_BloodColor;
+		Data.m_InfoGrayscale = Data.m_Info.DeepCopy();
+		ConvertToGrayscale(Data.m_InfoGrayscale);
+		ReorderGrayscaleBody(Data.m_InfoGrayscale, BodyWidth, BodyHeight, Metadata.m_GrayscaleWeight);
+		PackSkinAtlas(Data.m_Info);
+		PackSkinAtlas(Data.m_InfoGrayscale);
+		return true;
+	}
+
 	int FeetGridPixelsWidth = Data.m_Info.m_Width / g_pData->m_aSprites[SPRITE_TEE_FOOT].m_pSet->m_Gridx;
 	int FeetGridPixelsHeight = Data.m_Info.m_Height / g_pData->m_aSprites[SPRITE_TEE_FOOT].m_pSet->m_Gridy;
 	int FeetWidth = g_pData->m_aSprites[SPRITE_TEE_FOOT].m_W * FeetGridPixelsWidth;
@@ -367,7 +514,6 @@ bool CSkins::LoadSkinData(const char *pName, CSkinLoadData &Data) const
 
 	int aFreq[256] = {0};
 	uint8_t OrgWeight = 1;
-	uint8_t NewWeight = 192;
 
 	// find most common non-zero frequency
 	for(size_t y = 0; y < BodyHeight; y++)
@@ -390,56 +536,187 @@ bool CSkins::LoadSkinData(const char *pName, CSkinLoadData &Data) const
 		}
 	}
 
-	// reorder
-	for(size_t y = 0; y < BodyHeight; y++)
+	ReorderGrayscaleBody(Data.m_InfoGrayscale, BodyWidth, BodyHeight, OrgWeight);
+
+	if(UseCache)
 	{
-		for(size_t x = 0; x < BodyWidth; x++)
+		Metadata.m_PngSize = PngSize;
+		Metadata.m_Width = Data.m_Info.m_Width;
+		Metadata.m_Height = Data.m_Info.m_Height;
+		Metadata.m_Metrics = Data.m_Metrics;
+		Metadata.m_BloodColor = Data.m_BloodColor;
+		Metadata.m_GrayscaleWeight = OrgWeight;
+		AddCachedMetadata(PngHash, Metadata);
+	}
+
+	PackSkinAtlas(Data.m_Info);
+	PackSkinAtlas(Data.m_InfoGrayscale);
+	return true;
+}
+
+bool CSkins::FindCachedMetadata(const SHA256_DIGEST &PngHash, size_t PngSize, const CImageInfo &Info, CSkinMetadata &Metadata)
+{
+	const CLockScope LockScope(m_MetadataCacheLock);
+	auto It = m_MetadataCache.find(PngHash);
+	if(It == m_MetadataCache.end() || It->second.m_PngSize != PngSize || It->second.m_Width != Info.m_Width || It->second.m_Height != Info.m_Height)
+	{
+		return false;
+	}
+	It->second.m_Used = true;
+	Metadata = It->second;
+	return true;
+}
+
+void CSkins::AddCachedMetadata(const SHA256_DIGEST &PngHash, const CSkinMetadata &Metadata)
+{
+	const CLockScope LockScope(m_MetadataCacheLock);
+	CSkinMetadata &Entry = m_MetadataCache[PngHash];
+	Entry = Metadata;
+	Entry.m_Used = true;
+	m_MetadataCacheDirty = true;
+}
+
+void CSkins::LoadMetadataCache()
+{
+	void *pData;
+	unsigned DataSize;
+	if(!Storage()->ReadFile(SKIN_METADATA_CACHE_FILE, IStorage::TYPE_SAVE, &pData, &DataSize))
+	{
+		return;
+	}
+
+	SSkinMetadataCacheHeader Header;
+	if(DataSize < sizeof(Header))
+	{
+		free(pData);
+		return;
+	}
+	mem_copy(&Header, pData, sizeof(Header));
+	if(mem_comp(Header.m_aMagic, SSkinMetadataCacheHeader::MAGIC, sizeof(Header.m_aMagic)) != 0 ||
+		Header.m_Version != SSkinMetadataCacheHeader::VERSION ||
+		Header.m_NumEntries < 0 ||
+		(size_t)Header.m_NumEntries > (DataSize - sizeof(Header)) / sizeof(SSkinMetadataCacheEntry))
+	{
+		log_warn("skins", "Ignoring invalid skin metadata cache '%s'", SKIN_METADATA_CACHE_FILE);
+		free(pData);
+		return;
+	}
+
+	const CLockScope LockScope(m_MetadataCacheLock);
+	const uint8_t *pEntries = static_cast<const uint8_t *>(pData) + sizeof(Header);
+	int NumInvalid = 0;
+	for(int i = 0; i < Header.m_NumEntries; i++)
+	{
+		SSkinMetadataCacheEntry Entry;
+		mem_copy(&Entry, pEntries + i * sizeof(Entry), sizeof(Entry));
+		// the skin is analyzed again if its entry is rejected
+		if(Entry.m_GrayscaleWeight == 0 ||
+			!ValidMetrics(Entry.m_aBodyMetrics, Entry.m_Width, Entry.m_Height) ||
+			!ValidMetrics(Entry.m_aFeetMetrics, Entry.m_Width, Entry.m_Height) ||
+			!std::isfinite(Entry.m_aBloodColor[0]) || !std::isfinite(Entry.m_aBloodColor[1]) || !std::isfinite(Entry.m_aBloodColor[2]))
 		{
-			const size_t Offset = y * Pitch + x * PixelStep;
-			uint8_t v = Data.m_InfoGrayscale.m_pData[Offset];
-			if(v <= OrgWeight)
-			{
-				v = (uint8_t)((v / (float)OrgWeight) * NewWeight);
-			}
-			else
-			{
-				v = (uint8_t)(((v - OrgWeight) / (float)(255 - OrgWeight)) * (255 - NewWeight) + NewWeight);
-			}
-			Data.m_InfoGrayscale.m_pData[Offset] = v;
-			Data.m_InfoGrayscale.m_pData[Offset + 1] = v;
-			Data.m_InfoGrayscale.m_pData[Offset + 2] = v;
+			NumInvalid++;
+			continue;
 		}
+
+		CSkinMetadata Metadata;
+		Metadata.m_PngSize = Entry.m_PngSize;
+		Metadata.m_Width = Entry.m_Width;
+		Metadata.m_Height = Entry.m_Height;
+		RestoreMetrics(Metadata.m_Metrics.m_Body, Entry.m_aBodyMetrics);
+		RestoreMetrics(Metadata.m_Metrics.m_Feet, Entry.m_aFeetMetrics);
+		Metadata.m_BloodColor = ColorRGBA(Entry.m_aBloodColor[0], Entry.m_aBloodColor[1], Entry.m_aBloodColor[2], 1.0f);
+		Metadata.m_GrayscaleWeight = Entry.m_GrayscaleWeight;
+		Metadata.m_Used = false;
+		m_MetadataCache.emplace(Entry.m_PngHash, Metadata);
 	}
+	m_MetadataCacheDirty = NumInvalid > 0;
+	free(pData);
 
-	return true;
+	if(NumInvalid > 0)
+	{
+		log_warn("skins", "Ignored %d invalid entries in skin metadata cache '%s'", NumInvalid, SKIN_METADATA_CACHE_FILE);
+	}
+	if(g_Config.m_Debug)
+	{
+		log_trace("skins", "Loaded metadata of %" PRIzu " skins from cache", m_MetadataCache.size());
+	}
 }
 
-void CSkins::LoadSkinFinish(CSkinContainer *pSkinContainer, const CSkinLoadData &Data)
+void CSkins::SaveMetadataCache()
 {
-	CSkin Skin{pSkinContainer->Name()};
+	const CLockScope LockScope(m_MetadataCacheLock);
+	if(!m_MetadataCacheDirty)
+	{
+		return;
+	}
 
-	Skin.m_OriginalSkin.m_Body = Graphics()->LoadSpriteTexture(Data.m_Info, &g_pData->m_aSprites[SPRITE_TEE_BODY]);
-	Skin.m_OriginalSkin.m_BodyOutline = Graphics()->LoadSpriteTexture(Data.m_Info, &g_pData->m_aSprites[SPRITE_TEE_BODY_OUTLINE]);
-	Skin.m_OriginalSkin.m_Feet = Graphics()->LoadSpriteTexture(Data.m_Info, &g_pData->m_aSprites[SPRITE_TEE_FOOT]);
-	Skin.m_OriginalSkin.m_FeetOutline = Graphics()->LoadSpriteTexture(Data.m_Info, &g_pData->m_aSprites[SPRITE_TEE_FOOT_OUTLINE]);
-	Skin.m_OriginalSkin.m_Hands = Graphics()->LoadSpriteTexture(Data.m_Info, &g_pData->m_aSprites[SPRITE_TEE_HAND]);
-	Skin.m_OriginalSkin.m_HandsOutline = Graphics()->LoadSpriteTexture(Data.m_Info, &g_pData->m_aSprites[SPRITE_TEE_HAND_OUTLINE]);
-	for(size_t i = 0; i < std::size(Skin.m_OriginalSkin.m_aEyes); ++i)
+	// entries of skins used in this session come first, so they are kept when the cache is full
+	std::vector<std::pair<const SHA256_DIGEST *, const CSkinMetadata *>> vpEntries;
+	vpEntries.reserve(m_MetadataCache.size());
+	for(const auto &[PngHash, Metadata] : m_MetadataCache)
+	{
+		vpEntries.emplace_back(&PngHash, &Metadata);
+	}
+	std::stable_partition(vpEntries.begin(), vpEntries.end(), [](const auto &Entry) { return Entry.second->m_Used; });
+	if(vpEntries.size() > MAX_CACHED_SKIN_METADATA)
 	{
-		Skin.m_OriginalSkin.m_aEyes[i] = Graphics()->LoadSpriteTexture(Data.m_Info, &g_pData->m_aSprites[SPRITE_TEE_EYE_NORMAL + i]);
+		vpEntries.resize(MAX_CACHED_SKIN_METADATA);
 	}
 
-	Skin.m_ColorableSkin.m_Body = Graphics()->LoadSpriteTexture(Data.m_InfoGrayscale, &g_pData->m_aSprites[SPRITE_TEE_BODY]);
-	Skin.m_ColorableSkin.m_BodyOutline = Graphics()->LoadSpriteTexture(Data.m_InfoGrayscale, &g_pData->m_aSprites[SPRITE_TEE_BODY_OUTLINE]);
-	Skin.m_ColorableSkin.m_Feet = Graphics()->LoadSpriteTexture(Data.m_InfoGrayscale, &g_pData->m_aSprites[SPRITE_TEE_FOOT]);
-	Skin.m_ColorableSkin.m_FeetOutline = Graphics()->LoadSpriteTexture(Data.m_InfoGrayscale, &g_pData->m_aSprites[SPRITE_TEE_FOOT_OUTLINE]);
-	Skin.m_ColorableSkin.m_Hands = Graphics()->LoadSpriteTexture(Data.m_InfoGrayscale, &g_pData->m_aSprites[SPRITE_TEE_HAND]);
-	Skin.m_ColorableSkin.m_HandsOutline = Graphics()->LoadSpriteTexture(Data.m_InfoGrayscale, &g_pData->m_aSprites[SPRITE_TEE_HAND_OUTLINE]);
-	for(size_t i = 0; i < std::size(Skin.m_ColorableSkin.m_aEyes); ++i)
+	// write to a temporary file first, so a crash can't leave a partial cache behind
+	char aCacheFileTmp[IO_MAX_PATH_LENGTH];
+	IOHANDLE File = Storage()->OpenFile(IStorage::FormatTmpPath(aCacheFileTmp, sizeof(aCacheFileTmp), SKIN_METADATA_CACHE_FILE), IOFLAG_WRITE, IStorage::TYPE_SAVE);
+	if(!File)
 	{
-		Skin.m_ColorableSkin.m_aEyes[i] = Graphics()->LoadSpriteTexture(Data.m_InfoGrayscale, &g_pData->m_aSprites[SPRITE_TEE_EYE_NORMAL + i]);
+		log_error("skins", "Failed to open skin metadata cache '%s' for writing", aCacheFileTmp);
+		return;
 	}
 
+	SSkinMetadataCacheHeader Header;
+	mem_copy(Header.m_aMagic, SSkinMetadataCacheHeader::MAGIC, sizeof(Header.m_aMagic));
+	Header.m_Version = SSkinMetadataCacheHeader::VERSION;
+	Header.m_NumEntries = vpEntries.size();
+	io_write(File, &Header, sizeof(Header));
+
+	for(const auto &[pPngHash, pMetadata] : vpEntries)
+	{
+		SSkinMetadataCacheEntry Entry;
+		mem_zero(&Entry, sizeof(Entry));
+		Entry.m_PngHash = *pPngHash;
+		Entry.m_PngSize = pMetadata->m_PngSize;
+		Entry.m_Width = pMetadata->m_Width;
+		Entry.m_Height = pMetadata->m_Height;
+		StoreMetrics(Entry.m_aBodyMetrics, pMetadata->m_Metrics.m_Body);
+		StoreMetrics(Entry.m_aFeetMetrics, pMetadata->m_Metrics.m_Feet);
+		Entry.m_aBloodColor[0] = pMetadata->m_BloodColor.r;
+		Entry.m_aBloodColor[1] = pMetadata->m_BloodColor.g;
+		Entry.m_aBloodColor[2] = pMetadata->m_BloodColor.b;
+		Entry.m_GrayscaleWeight = pMetadata->m_GrayscaleWeight;
+		io_write(File, &Entry, sizeof(Entry));
+	}
+	const bool Failed = io_error(File) != 0;
+	if(io_close(File) != 0 || Failed)
+	{
+		log_error("skins", "Failed to write skin metadata cache '%s'", aCacheFileTmp);
+		Storage()->RemoveFile(aCacheFileTmp, IStorage::TYPE_SAVE);
+		return;
+	}
+	if(!Storage()->RenameFile(aCacheFileTmp, SKIN_METADATA_CACHE_FILE, IStorage::TYPE_SAVE))
+	{
+		log_error("skins", "Failed to rename '%s' to skin metadata cache '%s'", aCacheFileTmp, SKIN_METADATA_CACHE_FILE);
+		return;
+	}
+	m_MetadataCacheDirty = false;
+}
+
+void CSkins::LoadSkinFinish(CSkinContainer *pSkinContainer, const CSkinLoadData &Data)
+{
+	CSkin Skin{pSkinContainer->Name()};
+
+	Skin.m_OriginalSkin.m_Atlas = Graphics()->LoadTextureRaw(Data.m_Info, 0, pSkinContainer->Name());
+	Skin.m_ColorableSkin.m_Atlas = Graphics()->LoadTextureRaw(Data.m_InfoGrayscale, 0, pSkinContainer->Name());
+
 	Skin.m_Metrics = Data.m_Metrics;
 	Skin.m_BloodColor = Data.m_BloodColor;
 
@@ -466,12 +743,15 @@ void CSkins::LoadSkinDirect(const char *pName)
 	str_format(aPath, sizeof(aPath), "skins/%s.png", pName);
 	CSkinLoadData DefaultSkinData;
 	SkinIt->second->SetState(CSkinContainer::EState::LOADING);
-	if(!Graphics()->LoadPng(DefaultSkinData.m_Info, aPath, SkinIt->second->StorageType()))
+	void *pPngData = nullptr;
+	unsigned PngSize = 0;
+	if(!Storage()->ReadFile(aPath, SkinIt->second->StorageType(), &pPngData, &PngSize) ||
+		!Graphics()->LoadPng(DefaultSkinData.m_Info, static_cast<uint8_t *>(pPngData), PngSize, aPath))
 	{
 		log_error("skins", "Failed to load PNG of skin '%s' from '%s'", pName, aPath);
 		SkinIt->second->SetState(CSkinContainer::EState::ERROR);
 	}
-	else if(LoadSkinData(pName, DefaultSkinData))
+	else if(LoadSkinData(pName, static_cast<uint8_t *>(pPngData), PngSize, DefaultSkinData))
 	{
 		LoadSkinFinish(SkinIt->second.get(), DefaultSkinData);
 	}
@@ -479,6 +759,7 @@ void CSkins::LoadSkinDirect(const char *pName)
 	{
 		SkinIt->second->SetState(CSkinContainer::EState::ERROR);
 	}
+	free(pPngData);
 	DefaultSkinData.m_Info.Free();
 	DefaultSkinData.m_InfoGrayscale.Free();
 }
@@ -506,6 +787,11 @@ void CSkins::OnInit()
 	}
 
 
+	if(g_Config.m_ClSkinMetadataCache)
+	{
+		LoadMetadataCache();
+	}
+
 	// load skins
 	Refresh([this]() {
 		GameClient()->m_Menus.RenderLoading(Localize("Loading E-Client"), Localize("Loading skins"), 0);
@@ -522,6 +808,11 @@ void CSkins::OnShutdown()
 		}
 	}
 	m_Skins.clear();
+
+	if(g_Config.m_ClSkinMetadataCache)
+	{
+		SaveMetadataCache();
+	}
 }
 
 void CSkins::OnUpdate()
@@ -941,18 +1232,22 @@ void CSkins::CSkinLoadJob::Run()
 {
 	char aPath[IO_MAX_PATH_LENGTH];
 	str_format(aPath, sizeof(aPath), "skins/%s.png", m_aName);
-	if(m_pSkins->Graphics()->LoadPng(m_Data.m_Info, aPath, m_StorageType))
+	void *pPngData;
+	unsigned PngSize;
+	if(m_pSkins->Storage()->ReadFile(aPath, m_StorageType, &pPngData, &PngSize))
 	{
-		if(State() == IJob::STATE_ABORTED)
+		if(m_pSkins->Graphics()->LoadPng(m_Data.m_Info, static_cast<uint8_t *>(pPngData), PngSize, aPath))
 		{
+			if(State() != IJob::STATE_ABORTED)
+			{
+				m_pSkins->LoadSkinData(m_aName, static_cast<uint8_t *>(pPngData), PngSize, m_Data);
+			}
+			free(pPngData);
 			return;
 		}
-		m_pSkins->LoadSkinData(m_aName, m_Data);
-	}
-	else
-	{
-		log_error("skins", "Failed to load PNG of skin '%s' from '%s'", m_aName, aPath);
+		free(pPngData);
 	}
+	log_error("skins", "Failed to load PNG of skin '%s' from '%s'", m_aName, aPath);
 }
 
 CSkins::CSkinDownloadJob::CSkinDownloadJob(CSkins *pSkins, const char *pName) :
@@ -1014,9 +1309,10 @@ void CSkins::CSkinDownloadJob::Run()
 			{
 				if(State() == IJob::STATE_ABORTED)
 				{
+					free(pPngData);
 					return;
 				}
-				m_pSkins->LoadSkinData(m_aName, m_Data);
+				m_pSkins->LoadSkinData(m_aName, static_cast<uint8_t *>(pPngData), PngSize, m_Data);
 			}
 			free(pPngData);
 		}
@@ -1079,7 +1375,7 @@ void CSkins::CSkinDownloadJob::Run()
 		{
 			return;
 		}
-		m_pSkins->LoadSkinData(m_aName, m_Data);
+		m_pSkins->LoadSkinData(m_aName, pResult, ResultSize, m_Data);
 	}
 	else
 	{
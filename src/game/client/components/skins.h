@@ -3,6 +3,7 @@
 #ifndef GAME_CLIENT_COMPONENTS_SKINS_H
 #define GAME_CLIENT_COMPONENTS_SKINS_H
 
+#include <base/hash.h>
 #include <base/lock.h>
 
 #include <engine/shared/config.h>
@@ -305,9 +306,48 @@ private:
 	CSkin m_PlaceholderSkin;
 	char m_aEventSkinPrefix[MAX_SKIN_LENGTH];
 
-	bool LoadSkinData(const char *pName, CSkinLoadData &Data) const;
+	/**
+	 * Results of analyzing a skin image, which do not have to be computed again as long as the PNG file is unchanged.
+	 */
+	class CSkinMetadata
+	{
+	public:
+		size_t m_PngSize;
+		size_t m_Width;
+		size_t m_Height;
+		CSkin::CSkinMetrics m_Metrics;
+		ColorRGBA m_BloodColor;
+		/**
+		 * Most common shade of the grayscale body, which is mapped to a fixed shade in the colorable textures.
+		 */
+		uint8_t m_GrayscaleWeight;
+		/**
+		 * Whether this entry was used since the cache was loaded. Used entries are preferred when saving the cache.
+		 */
+		bool m_Used;
+	};
+
+	class CSha256Hasher
+	{
+	public:
+		size_t operator()(const SHA256_DIGEST &Digest) const;
+	};
+
+	/**
+	 * Skin metadata by the SHA256 of the PNG file, saved on exit and loaded on startup.
+	 */
+	CLock m_MetadataCacheLock;
+	std::unordered_map<SHA256_DIGEST, CSkinMetadata, CSha256Hasher> m_MetadataCache GUARDED_BY(m_MetadataCacheLock);
+	bool m_MetadataCacheDirty GUARDED_BY(m_MetadataCacheLock) = false;
+
+	void LoadMetadataCache() REQUIRES(!m_MetadataCacheLock);
+	void SaveMetadataCache() REQUIRES(!m_MetadataCacheLock);
+	bool FindCachedMetadata(const SHA256_DIGEST &PngHash, size_t PngSize, const CImageInfo &Info, CSkinMetadata &Metadata) REQUIRES(!m_MetadataCacheLock);
+	void AddCachedMetadata(const SHA256_DIGEST &PngHash, const CSkinMetadata &Metadata) REQUIRES(!m_MetadataCacheLock);
+
+	bool LoadSkinData(const char *pName, const uint8_t *pPngData, size_t PngSize, CSkinLoadData &Data) REQUIRES(!m_MetadataCacheLock);
 	void LoadSkinFinish(CSkinContainer *pSkinContainer, const CSkinLoadData &Data);
-	void LoadSkinDirect(const char *pName);
+	void LoadSkinDirect(const char *pName) REQUIRES(!m_MetadataCacheLock);
 	const CSkin *FindImpl(const char *pName);
 	static int SkinScan(const char *pName, int IsDir, int StorageType, void *pUser);
 
@@ -1,92 +1,145 @@
+#include <base/math.h>
+
 #include <engine/graphics.h>
 #include <engine/shared/config.h>
 
-#include <game/client/animstate.h>
 #include <game/client/gameclient.h>
 #include <game/client/render.h>
-#include <game/generated/client_data.h>
-#include <game/generated/protocol.h>
+#include <game/layers.h>
 #include <game/mapitems.h>
 
 #include "outlines.h"
 
-void COutlines::OnRender()
+#include <algorithm>
+
+static const int gs_aOutlineTileTypes[] = {TILE_UNFREEZE, TILE_FREEZE, TILE_SOLID, TILE_DEATH, TILE_TELEIN};
+
+void COutlines::OnMapLoad()
 {
-	if(GameClient()->m_MapLayersBackground.m_OnlineOnly && Client()->State() != IClient::STATE_ONLINE && Client()->State() != IClient::STATE_DEMOPLAYBACK)
-		return;
-	if(!g_Config.m_ClOverlayEntities && g_Config.m_ClOutlineEntities)
-		return;
-	if(!g_Config.m_ClOutline)
-		return;
+	for(COutlineBuffer &Buffer : m_aOutlineBuffers)
+	{
+		Graphics()->DeleteQuadContainer(Buffer.m_QuadContainerIndex);
+		Buffer.m_Width = -1;
+		Buffer.m_vRowOffsets.clear();
+	}
 
-	for(int g = 0; g < GameClient()->Layers()->NumGroups(); g++)
+	// other outlines are created once they get enabled
+	if(g_Config.m_ClOutline)
 	{
-		CMapItemGroup *pGroup = GameClient()->Layers()->GetGroup(g);
+		const int aEnabled[NUM_OUTLINES] = {g_Config.m_ClOutlineUnFreeze, g_Config.m_ClOutlineFreeze, g_Config.m_ClOutlineSolid, g_Config.m_ClOutlineKill, g_Config.m_ClOutlineTele};
+		for(int Outline = 0; Outline < NUM_OUTLINES; Outline++)
+		{
+			if(aEnabled[Outline])
+				CreateOutlineBuffer(Outline);
+		}
+	}
+}
 
-		if(!pGroup)
+void COutlines::CreateOutlineBuffer(int Outline)
+{
+	COutlineBuffer &Buffer = m_aOutlineBuffers[Outline];
+	Graphics()->DeleteQuadContainer(Buffer.m_QuadContainerIndex);
+	Buffer.m_vRowOffsets.clear();
+	Buffer.m_Width = g_Config.m_ClOutlineWidth;
 
-			continue;
+	CMapItemLayerTilemap *pGameLayer = Layers()->GameLayer();
+	if(!pGameLayer)
+		return;
+	const int Width = pGameLayer->m_Width;
+	const int Height = pGameLayer->m_Height;
+	const CTile *pTiles = (CTile *)Layers()->Map()->GetData(pGameLayer->m_Data);
+	if(!pTiles || (size_t)Layers()->Map()->GetDataSize(pGameLayer->m_Data) < (size_t)Width * Height * sizeof(CTile))
+		return;
 
-		CTile *pGameTiles = NULL;
+	const CTeleTile *pTeleTiles = nullptr;
+	if(Outline == OUTLINE_TELE)
+	{
+		CMapItemLayerTilemap *pTeleLayer = Layers()->TeleLayer();
+		if(!pTeleLayer || pTeleLayer->m_Width != Width || pTeleLayer->m_Height != Height)
+			return;
+		pTeleTiles = (CTeleTile *)Layers()->Map()->GetData(pTeleLayer->m_Tele);
+		if(!pTeleTiles || (size_t)Layers()->Map()->GetDataSize(pTeleLayer->m_Tele) < (size_t)Width * Height * sizeof(CTeleTile))
+			return;
+	}
 
-		for(int l = 0; l < pGroup->m_NumLayers; l++)
+	const float Scale = 32.0f;
+	const float Size = (float)Buffer.m_Width;
+	std::vector<IGraphics::CQuadItem> vQuads;
+	Buffer.m_vRowOffsets.reserve(Height + 1);
+	for(int y = 0; y < Height; y++)
+	{
+		Buffer.m_vRowOffsets.push_back(vQuads.size());
+		for(int x = 0; x < Width; x++)
 		{
-			CMapItemLayer *pLayer = GameClient()->Layers()->GetLayer(pGroup->m_StartLayer + l);
-			if(!pLayer)
-				return;
-			bool IsGameLayer = false;
-			bool IsTeleLayer = false;
-
-			if(pLayer == (CMapItemLayer *)GameClient()->Layers()->TeleLayer())
-				IsTeleLayer = true;
-			if(pLayer == (CMapItemLayer *)GameClient()->Layers()->GameLayer())
-			{
-				IsGameLayer = true;
-			}
-
-			if(g_Config.m_ClOutline && IsGameLayer)
-			{
-				CMapItemLayerTilemap *pTMap = (CMapItemLayerTilemap *)pLayer;
-				if(!pTMap)
-					return;
-				CTile *pTiles = (CTile *)GameClient()->Layers()->Map()->GetData(pTMap->m_Data);
-				if(!pTiles)
-					return;
-				unsigned int Size = GameClient()->Layers()->Map()->GetDataSize(pTMap->m_Data);
-				pGameTiles = pTiles;
-				if((g_Config.m_ClOutlineFreeze || g_Config.m_ClOutlineSolid || g_Config.m_ClOutlineUnFreeze || g_Config.m_ClOutlineKill) && IsGameLayer && Size >= (size_t)pTMap->m_Width * pTMap->m_Height * sizeof(CTile))
-				{
-					if(g_Config.m_ClOutlineUnFreeze)
-						RenderTools()->RenderGameTileOutlines(pTiles, pTMap->m_Width, pTMap->m_Height, 32.0f, TILE_UNFREEZE, (float)g_Config.m_ClOutlineAlpha / 100.0f);
-					if(g_Config.m_ClOutlineFreeze)
-						RenderTools()->RenderGameTileOutlines(pTiles, pTMap->m_Width, pTMap->m_Height, 32.0f, TILE_FREEZE, (float)g_Config.m_ClOutlineAlpha / 100.0f);
-					if(g_Config.m_ClOutlineSolid)
-						RenderTools()->RenderGameTileOutlines(pTiles, pTMap->m_Width, pTMap->m_Height, 32.0f, TILE_SOLID, (float)g_Config.m_ClOutlineAlphaSolid / 100.0f);
-					if(g_Config.m_ClOutlineKill)
-						RenderTools()->RenderGameTileOutlines(pTiles, pTMap->m_Width, pTMap->m_Height, 32.0f, TILE_DEATH, (float)g_Config.m_ClOutlineAlpha / 100.0f);
-				}
-			}
-			if(g_Config.m_ClOutline && IsTeleLayer)
-			{
-				CMapItemLayerTilemap *pTMap = (CMapItemLayerTilemap *)pLayer;
-				if(!pTMap)
-					return;
-				CTile *pTiles = (CTile *)GameClient()->Layers()->Map()->GetData(pTMap->m_Data);
-				if(!pTiles)
-					return;
-				if(IsGameLayer)
-					pGameTiles = pTiles;
-				if(g_Config.m_ClOutlineTele)
-				{
-					CTeleTile *pTeleTiles = (CTeleTile *)GameClient()->Layers()->Map()->GetData(pTMap->m_Tele);
-					unsigned int TeleSize = GameClient()->Layers()->Map()->GetDataSize(pTMap->m_Tele);
-					if(TeleSize >= (size_t)pTMap->m_Width * pTMap->m_Height * sizeof(CTeleTile))
-					{
-						if(pGameTiles != NULL)
-							RenderTools()->RenderTeleOutlines(pGameTiles, pTeleTiles, pTMap->m_Width, pTMap->m_Height, 32.0f, (float)g_Config.m_ClOutlineAlpha / 100.0f);
-					}
-				}
-			}
+			IGraphics::CQuadItem aQuads[8];
+			const int NumQuads = Outline == OUTLINE_TELE ?
+						     RenderTools()->TeleOutlineQuads(pTiles, pTeleTiles, Width, Height, x, y, Scale, Size, aQuads) :
+						     RenderTools()->GameTileOutlineQuads(pTiles, Width, Height, x, y, Scale, Size, gs_aOutlineTileTypes[Outline], aQuads);
+			vQuads.insert(vQuads.end(), aQuads, aQuads + NumQuads);
 		}
 	}
-}
\ No newline at end of file
+	Buffer.m_vRowOffsets.push_back(vQuads.size());
+
+	if(vQuads.empty())
+		return;
+
+	// colored when rendering
+	Buffer.m_QuadContainerIndex = Graphics()->CreateQuadContainer(false);
+	Graphics()->TextureClear();
+	Graphics()->SetColor(1.0f, 1.0f, 1.0f, 1.0f);
+	Graphics()->QuadContainerAddQuads(Buffer.m_QuadContainerIndex, vQuads.data(), vQuads.size());
+	Graphics()->QuadContainerUpload(Buffer.m_QuadContainerIndex);
+	Graphics()->IndicesNumRequiredNotify(vQuads.size() * 6);
+}
+
+void COutlines::RenderOutlineBuffer(int Outline, ColorRGBA Color)
+{
+	COutlineBuffer &Buffer = m_aOutlineBuffers[Outline];
+	if(Buffer.m_Width != g_Config.m_ClOutlineWidth)
+		CreateOutlineBuffer(Outline);
+	if(Buffer.m_QuadContainerIndex == -1)
+		return;
+
+	float ScreenX0, ScreenY0, ScreenX1, ScreenY1;
+	Graphics()->GetScreen(&ScreenX0, &ScreenY0, &ScreenX1, &ScreenY1);
+	const int NumRows = Buffer.m_vRowOffsets.size() - 1;
+	const int StartY = std::clamp((int)(ScreenY0 / 32.0f) - 1, 0, NumRows);
+	const int EndY = std::clamp((int)(ScreenY1 / 32.0f) + 1, StartY, NumRows);
+	int QuadOffset = Buffer.m_vRowOffsets[StartY];
+	int NumQuads = Buffer.m_vRowOffsets[EndY] - QuadOffset;
+
+	Graphics()->TextureClear();
+	Graphics()->QuadsSetRotation(0.0f);
+	Graphics()->SetColor(Color);
+	// without buffering, the quads are copied into the vertex array which holds a limited number
+	const int MaxQuadsPerCall = Graphics()->IsQuadContainerBufferingEnabled() ? NumQuads : 4096;
+	while(NumQuads > 0)
+	{
+		const int Num = minimum(NumQuads, MaxQuadsPerCall);
+		Graphics()->RenderQuadContainerEx(Buffer.m_QuadContainerIndex, QuadOffset, Num, 0.0f, 0.0f);
+		QuadOffset += Num;
+		NumQuads -= Num;
+	}
+}
+
+void COutlines::OnRender()
+{
+	if(GameClient()->m_MapLayersBackground.m_OnlineOnly && Client()->State() != IClient::STATE_ONLINE && Client()->State() != IClient::STATE_DEMOPLAYBACK)
+		return;
+	if(!g_Config.m_ClOverlayEntities && g_Config.m_ClOutlineEntities)
+		return;
+	if(!g_Config.m_ClOutline)
+		return;
+
+	const float Alpha = g_Config.m_ClOutlineAlpha / 100.0f;
+	if(g_Config.m_ClOutlineUnFreeze)
+		RenderOutlineBuffer(OUTLINE_UNFREEZE, color_cast<ColorRGBA>(ColorHSLA(g_Config.m_ClOutlineColorUnfreeze)).WithAlpha(Alpha));
+	if(g_Config.m_ClOutlineFreeze)
+		RenderOutlineBuffer(OUTLINE_FREEZE, color_cast<ColorRGBA>(ColorHSLA(g_Config.m_ClOutlineColorFreeze)).WithAlpha(Alpha));
+	if(g_Config.m_ClOutlineSolid)
+		RenderOutlineBuffer(OUTLINE_SOLID, color_cast<ColorRGBA>(ColorHSLA(g_Config.m_ClOutlineColorSolid)).WithAlpha(g_Config.m_ClOutlineAlphaSolid / 100.0f));
+	if(g_Config.m_ClOutlineKill)
+		RenderOutlineBuffer(OUTLINE_KILL, color_cast<ColorRGBA>(ColorHSLA(g_Config.m_ClOutlineColorKill)).WithAlpha(Alpha));
+	if(g_Config.m_ClOutlineTele)
+		RenderOutlineBuffer(OUTLINE_TELE, color_cast<ColorRGBA>(ColorHSLA(g_Config.m_ClOutlineColorTele)).WithAlpha(Alpha));
+}
@@ -1,12 +1,40 @@
-
 #ifndef GAME_CLIENT_COMPONENTS_TCLIENT_OUTLINES_H
 #define GAME_CLIENT_COMPONENTS_TCLIENT_OUTLINES_H
+#include <base/color.h>
+
 #include <game/client/component.h>
 
+#include <vector>
+
 class COutlines : public CComponent
 {
+	enum
+	{
+		OUTLINE_UNFREEZE = 0,
+		OUTLINE_FREEZE,
+		OUTLINE_SOLID,
+		OUTLINE_KILL,
+		OUTLINE_TELE,
+		NUM_OUTLINES,
+	};
+
+	// Quads of one outline type for the whole map, sorted by tile row so
+	// the visible rows can be drawn with a single call.
+	class COutlineBuffer
+	{
+	public:
+		int m_QuadContainerIndex = -1;
+		int m_Width = -1; // outline width the quads were created with, -1 if not created yet
+		std::vector<int> m_vRowOffsets; // first quad of every tile row, plus the total number of quads
+	};
+	COutlineBuffer m_aOutlineBuffers[NUM_OUTLINES];
+
+	void CreateOutlineBuffer(int Outline);
+	void RenderOutlineBuffer(int Outline, ColorRGBA Color);
+
 public:
 	virtual int Sizeof() const override { return sizeof(*this); }
+	virtual void OnMapLoad() override;
 	virtual void OnRender() override;
 };
 
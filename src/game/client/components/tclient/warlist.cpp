@@ -268,6 +268,7 @@ void CWarList::AddMuteEntry(const char *pName)
 	str_copy(Entry.m_aMutedName, pName);
 
 	m_MuteEntries.push_back(Entry);
+	OnListChange();
 }
 
 void CWarList::AddMute(const char *pName)
@@ -284,6 +285,7 @@ void CWarList::AddMute(const char *pName)
 	DelMute(pName, true);
 
 	m_MuteEntries.push_back(Entry);
+	OnListChange();
 
 	GameClient()->m_EClient.UnTempMute(pName, true);
 }
@@ -315,6 +317,7 @@ void CWarList::DelMute(const char *pName, bool Silent)
 					str_format(aBuf, sizeof(aBuf), "Removed \"%s\" from the Mute List", pName);
 			}
 		}
+		OnListChange();
 	}
 	if(GameClient()->m_EClient.UnTempMute(pName, true))
 		str_format(aBuf, sizeof(aBuf), "Removed \"%s\" from the Mute List", pName);
@@ -331,6 +334,7 @@ void CWarList::UpdateWarEntry(int Index, const char *pName, const char *pClan, c
 		str_copy(m_WarEntries[Index].m_aClan, pClan);
 		str_copy(m_WarEntries[Index].m_aReason, pReason);
 		m_WarEntries[Index].m_pWarType = pType;
+		OnListChange();
 	}
 }
 
@@ -343,6 +347,7 @@ void CWarList::UpsertWarType(int Index, const char *pType, ColorRGBA Color)
 	{
 		str_copy(m_WarTypes[Index]->m_aWarName, pType);
 		m_WarTypes[Index]->m_Color = Color;
+		OnListChange();
 	}
 	else
 	{
@@ -373,6 +378,7 @@ void CWarList::AddWarEntry(const char *pName, const char *pClan, const char *pRe
 	if(!g_Config.m_ClWarListAllowDuplicates)
 		RemoveWarEntryDuplicates(pName, pClan);
 	m_WarEntries.push_back(Entry);
+	OnListChange();
 }
 
 void CWarList::RemoveWarEntryDuplicates(const char *pName, const char *pClan)
@@ -387,7 +393,10 @@ void CWarList::RemoveWarEntryDuplicates(const char *pName, const char *pClan)
 			(str_comp(it->m_aClan, pClan) == 0);
 
 		if(IsDuplicate)
+		{
 			it = m_WarEntries.erase(it);
+			OnListChange();
+		}
 		else
 			++it;
 	}
@@ -403,6 +412,7 @@ void CWarList::AddWarType(const char *pType, ColorRGBA Color)
 	{
 		CWarType *NewType = new CWarType(pType, Color);
 		m_WarTypes.push_back(NewType);
+		OnListChange();
 	}
 	else
 	{
@@ -416,7 +426,10 @@ void CWarList::RemoveWarEntry(const char *pName, const char *pClan, const char *
 	CWarEntry Entry(WarType, pName, pClan, "");
 	auto it = std::find(m_WarEntries.begin(), m_WarEntries.end(), Entry);
 	if(it != m_WarEntries.end())
+	{
 		m_WarEntries.erase(it);
+		OnListChange();
+	}
 }
 
 void CWarList::RemoveWarEntry(CWarEntry *Entry)
@@ -424,7 +437,10 @@ void CWarList::RemoveWarEntry(CWarEntry *Entry)
 	auto it = std::find_if(m_WarEntries.begin(), m_WarEntries.end(),
 		[Entry](const CWarEntry &WarEntry) { return &WarEntry == Entry; });
 	if(it != m_WarEntries.end())
+	{
 		m_WarEntries.erase(it);
+		OnListChange();
+	}
 }
 
 void CWarList::RemoveWarType(const char *pType)
@@ -448,47 +464,46 @@ void CWarList::RemoveWarType(const char *pType)
 			}
 		}
 		m_WarTypes.erase(it);
+		OnListChange();
 	}
 }
 
 int CWarList::FindWarTypeWithName(const char *pName)
 {
-	for(CWarEntry &Entry : m_WarEntries)
-	{
-		if(str_comp(pName, Entry.m_aName) == 0 && str_comp(Entry.m_aName, "") != 0)
-		{
-			return Entry.m_pWarType->m_Index;
-		}
-	}
-	return 0;
+	if(pName[0] == '\0')
+		return 0;
+	RebuildIndex();
+	auto It = m_NameIndex.find(pName);
+	if(It == m_NameIndex.end())
+		return 0;
+	return m_WarEntries[It->second.front()].m_pWarType->m_Index;
 }
 
 int CWarList::FindWarTypeWithClan(const char *pClan)
 {
-	for(CWarEntry &Entry : m_WarEntries)
-	{
-		if(str_comp(pClan, Entry.m_aClan) == 0 && str_comp(Entry.m_aClan, "") != 0)
-		{
-			return Entry.m_pWarType->m_Index;
-		}
-	}
-	return 0;
+	if(pClan[0] == '\0')
+		return 0;
+	RebuildIndex();
+	auto It = m_ClanIndex.find(pClan);
+	if(It == m_ClanIndex.end())
+		return 0;
+	return m_WarEntries[It->second.front()].m_pWarType->m_Index;
 }
 
 char *CWarList::GetWarTypeName(int ClientId)
 {
-	for(CWarEntry &Entry : m_WarEntries)
-	{
-		if(!str_comp(GameClient()->m_aClients[ClientId].m_aName, Entry.m_aName) && str_comp(Entry.m_aName, "") != 0)
-		{
-			return Entry.m_pWarType->m_aWarName;
-		}
-		else if(!str_comp(GameClient()->m_aClients[ClientId].m_aClan, Entry.m_aClan) && str_comp(Entry.m_aClan, "") != 0)
-		{
-			return Entry.m_pWarType->m_aWarName;
-		}
-	}
-	return nullptr;
+	RebuildIndex();
+	// first entry in list order that matches either the name or the clan
+	int First = -1;
+	auto NameIt = m_NameIndex.find(GameClient()->m_aClients[ClientId].m_aName);
+	if(NameIt != m_NameIndex.end())
+		First = NameIt->second.front();
+	auto ClanIt = m_ClanIndex.find(GameClient()->m_aClients[ClientId].m_aClan);
+	if(ClanIt != m_ClanIndex.end() && (First < 0 || ClanIt->second.front() < First))
+		First = ClanIt->second.front();
+	if(First < 0)
+		return nullptr;
+	return m_WarEntries[First].m_pWarType->m_aWarName;
 }
 
 CWarType *CWarList::FindWarType(const char *pType)
@@ -567,57 +582,110 @@ void CWarList::SortWarEntries()
 	// TODO
 }
 
-void CWarList::UpdateWarPlayers()
+void CWarList::OnListChange()
 {
+	m_IndexDirty = true;
+	++m_Generation;
+}
+
+void CWarList::RebuildIndex()
+{
+	if(!m_IndexDirty)
+		return;
+	m_IndexDirty = false;
+
 	for(int i = 0; i < (int)m_WarTypes.size(); ++i)
 		m_WarTypes[i]->m_Index = i;
 
-	for(int i = 0; i < MAX_CLIENTS; ++i)
+	m_NameIndex.clear();
+	m_ClanIndex.clear();
+	for(int i = 0; i < (int)m_WarEntries.size(); ++i)
 	{
-		if(!GameClient()->m_aClients[i].m_Active)
-			continue;
+		const CWarEntry &Entry = m_WarEntries[i];
+		if(Entry.m_aName[0] != '\0')
+			m_NameIndex[Entry.m_aName].push_back(i);
+		if(Entry.m_aClan[0] != '\0')
+			m_ClanIndex[Entry.m_aClan].push_back(i);
+	}
 
-		m_WarPlayers[i].IsMuted = false; // E-Client [Mutes]
+	m_MuteIndex.clear();
+	for(const CMuteEntry &Entry : m_MuteEntries)
+	{
+		if(Entry.m_aMutedName[0] != '\0')
+			m_MuteIndex.insert(Entry.m_aMutedName);
+	}
+}
 
-		m_WarPlayers[i].IsWarName = false;
-		m_WarPlayers[i].IsWarClan = false;
-		memset(m_WarPlayers[i].m_aReason, 0, sizeof(m_WarPlayers[i].m_aReason));
-		m_WarPlayers[i].m_NameColor = ColorRGBA(1, 1, 1, 1);
-		m_WarPlayers[i].m_ClanColor = ColorRGBA(1, 1, 1, 1);
-		m_WarPlayers[i].m_WarGroupMatches.clear();
-		m_WarPlayers[i].m_WarGroupMatches.resize((int)m_WarTypes.size(), false);
+void CWarList::UpdateWarPlayer(int ClientId)
+{
+	const CGameClient::CClientData &Client = GameClient()->m_aClients[ClientId];
+	CWarDataCache &Data = m_WarPlayers[ClientId];
 
-		for(CWarEntry &Entry : m_WarEntries)
-		{
-			if(str_comp(GameClient()->m_aClients[i].m_aName, Entry.m_aName) == 0 && str_comp(Entry.m_aName, "") != 0)
-			{
-				str_copy(m_WarPlayers[i].m_aReason, Entry.m_aReason);
-				m_WarPlayers[i].IsWarName = true;
-				m_WarPlayers[i].m_NameColor = Entry.m_pWarType->m_Color;
-				m_WarPlayers[i].m_WarGroupMatches[Entry.m_pWarType->m_Index] = true;
-			}
-			else if(str_comp(GameClient()->m_aClients[i].m_aClan, Entry.m_aClan) == 0 && str_comp(Entry.m_aClan, "") != 0)
-			{
-				// Name war reason has priority over clan war reason
-				if(!m_WarPlayers[i].IsWarName)
-					str_copy(m_WarPlayers[i].m_aReason, Entry.m_aReason);
+	str_copy(Data.m_aCachedName, Client.m_aName);
+	str_copy(Data.m_aCachedClan, Client.m_aClan);
+	Data.m_Generation = m_Generation;
 
-				m_WarPlayers[i].IsWarClan = true;
-				m_WarPlayers[i].m_ClanColor = Entry.m_pWarType->m_Color;
-				m_WarPlayers[i].m_WarGroupMatches[Entry.m_pWarType->m_Index] = true;
-			}
+	Data.IsMuted = m_MuteIndex.count(Client.m_aName) > 0; // E-Client [Mutes]
+
+	Data.IsWarName = false;
+	Data.IsWarClan = false;
+	Data.m_aReason[0] = '\0';
+	Data.m_pNameType = nullptr;
+	Data.m_pClanType = nullptr;
+	Data.m_WarGroupMatches.assign(m_WarTypes.size(), false);
+
+	// The last matching entry wins, name war reason has priority over clan war reason
+	auto NameIt = m_NameIndex.find(Client.m_aName);
+	if(NameIt != m_NameIndex.end())
+	{
+		for(int Index : NameIt->second)
+		{
+			const CWarEntry &Entry = m_WarEntries[Index];
+			str_copy(Data.m_aReason, Entry.m_aReason);
+			Data.IsWarName = true;
+			Data.m_pNameType = Entry.m_pWarType;
+			Data.m_WarGroupMatches[Entry.m_pWarType->m_Index] = true;
 		}
+	}
 
-		for(CMuteEntry &Entry : m_MuteEntries) // E-Client [Mutes]
+	auto ClanIt = m_ClanIndex.find(Client.m_aClan);
+	if(ClanIt != m_ClanIndex.end())
+	{
+		for(int Index : ClanIt->second)
 		{
-			if(str_comp(GameClient()->m_aClients[i].m_aName, Entry.m_aMutedName) == 0 && str_comp(Entry.m_aMutedName, "") != 0)
-			{
-				m_WarPlayers[i].IsMuted = true;
-			}
+			const CWarEntry &Entry = m_WarEntries[Index];
+			// Entries matching both name and clan count as name wars
+			if(Entry.m_aName[0] != '\0' && str_comp(Entry.m_aName, Client.m_aName) == 0)
+				continue;
+			if(!Data.IsWarName)
+				str_copy(Data.m_aReason, Entry.m_aReason);
+			Data.IsWarClan = true;
+			Data.m_pClanType = Entry.m_pWarType;
+			Data.m_WarGroupMatches[Entry.m_pWarType->m_Index] = true;
 		}
 	}
 }
 
+void CWarList::UpdateWarPlayers()
+{
+	RebuildIndex();
+
+	for(int i = 0; i < MAX_CLIENTS; ++i)
+	{
+		const CGameClient::CClientData &Client = GameClient()->m_aClients[i];
+		if(!Client.m_Active)
+			continue;
+
+		CWarDataCache &Data = m_WarPlayers[i];
+		if(Data.m_Generation != m_Generation || str_comp(Data.m_aCachedName, Client.m_aName) != 0 || str_comp(Data.m_aCachedClan, Client.m_aClan) != 0)
+			UpdateWarPlayer(i);
+
+		// Group colors can be edited in place, so always take them from the matched type
+		Data.m_NameColor = Data.m_pNameType ? Data.m_pNameType->m_Color : ColorRGBA(1, 1, 1, 1);
+		Data.m_ClanColor = Data.m_pClanType ? Data.m_pClanType->m_Color : ColorRGBA(1, 1, 1, 1);
+	}
+}
+
 CWarList::~CWarList()
 {
 	for(CWarType *WarType : m_WarTypes)
@@ -5,6 +5,11 @@
 #include <engine/shared/protocol.h>
 #include <game/client/component.h>
 
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #define WARLIST_FILE "tclient_warlist.cfg"
 
 enum
@@ -100,9 +105,17 @@ public:
 
 	bool IsMuted = false; // E-Client [Mutes]
 
+	// indexed by CWarType::m_Index, sized to the number of war types
 	std::vector<char> m_WarGroupMatches = {false, false, false, false};
 
 	char m_aReason[MAX_WARLIST_REASON_LENGTH] = "";
+
+	// state the cache was computed from, see CWarList::UpdateWarPlayers
+	char m_aCachedName[MAX_NAME_LENGTH] = "";
+	char m_aCachedClan[MAX_CLAN_LENGTH] = "";
+	unsigned m_Generation = 0;
+	CWarType *m_pNameType = nullptr;
+	CWarType *m_pClanType = nullptr;
 };
 
 class CWarList : public CComponent
@@ -165,6 +178,17 @@ class CWarList : public CComponent
 	class IStorage *m_pStorage = nullptr;
 	IOHANDLE m_WarlistFile = nullptr;
 
+	// indices into m_WarEntries by name and by clan, in ascending order
+	std::unordered_map<std::string, std::vector<int>> m_NameIndex;
+	std::unordered_map<std::string, std::vector<int>> m_ClanIndex;
+	std::unordered_set<std::string> m_MuteIndex;
+	bool m_IndexDirty = true;
+	// bumped on every list change, player caches with an older generation get recomputed
+	unsigned m_Generation = 1;
+
+	void RebuildIndex();
+	void UpdateWarPlayer(int ClientId);
+
 public:
 	CWarList();
 	~CWarList();
@@ -191,8 +215,6 @@ public:
 
 	// Duplicate war entries ARE allowed
 	std::vector<CWarEntry> m_WarEntries;
-	// TODO: create an unordered map for war clans and war names, to speed up updating the WarPlayers cache
-	// It should be updated when m_WarList changes
 
 	CWarDataCache m_WarPlayers[MAX_CLIENTS];
 
@@ -201,6 +223,8 @@ public:
 	virtual void OnConsoleInit() override;
 
 	void UpdateWarPlayers();
+	// Call after modifying m_WarEntries, m_WarTypes or m_MuteEntries directly
+	void OnListChange();
 
 	void UpdateWarEntry(int Index, const char *pName, const char *pClan, const char *pReason, CWarType *pType);
 
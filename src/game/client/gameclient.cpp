@@ -16,6 +16,7 @@
 #include <engine/map.h>
 #include <engine/serverbrowser.h>
 #include <engine/shared/config.h>
+#include <engine/shared/jobs.h>
 #include <engine/sound.h>
 #include <engine/storage.h>
 #include <engine/textrender.h>
@@ -584,18 +585,66 @@ void CGameClient::OnConnected()
 	const char *pLoadMapContent = Localize("Initializing map logic");
 	// render loading before skip is calculated
 	m_Menus.RenderLoading(pConnectCaption, pLoadMapContent, 0);
-	m_Layers.Init(Kernel()->RequestInterface<IMap>(), false);
-	m_Collision.Init(Layers());
-	m_GameWorld.m_Core.InitSwitchers(m_Collision.m_HighestSwitchNumber);
-	m_RaceHelper.Init(this);
+	const int64_t LoadStartTime = time_get();
+	IMap *pMap = Kernel()->RequestInterface<IMap>();
+	m_Layers.Init(pMap, false);
+
+	// collision is built on the job pool, so all data it reads must be loaded already
+	std::vector<int> vEntityData;
+	if(m_Layers.TeleLayer())
+		vEntityData.push_back(m_Layers.TeleLayer()->m_Tele);
+	if(m_Layers.SpeedupLayer())
+		vEntityData.push_back(m_Layers.SpeedupLayer()->m_Speedup);
+	if(m_Layers.FrontLayer())
+		vEntityData.push_back(m_Layers.FrontLayer()->m_Front);
+	if(m_Layers.SwitchLayer())
+		vEntityData.push_back(m_Layers.SwitchLayer()->m_Switch);
+	if(m_Layers.TuneLayer())
+		vEntityData.push_back(m_Layers.TuneLayer()->m_Tune);
+	pMap->PrefetchData(vEntityData);
+	const int64_t LayersTime = time_get() - LoadStartTime;
+
+	// collision init rewrites switch types in the map data, the tile visuals below read them
+	CCollision::SanitizeSwitchLayer(Layers());
+
+	int64_t CollisionTime = 0;
+	CWorkBatch CollisionBatch(1, [&](size_t) {
+		const int64_t StartTime = time_get();
+		m_Collision.Init(Layers());
+		CollisionTime = time_get() - StartTime;
+	});
+	CollisionBatch.Start([this](std::shared_ptr<IJob> pJob) { Engine()->AddJob(std::move(pJob)); }, 1);
 
 	// render loading before going through all components
 	m_Menus.RenderLoading(pConnectCaption, pLoadMapContent, 0);
+
+	// the map visuals do not depend on collision, prepare them while it is being built
+	int64_t StartTime = time_get();
+	m_MapImages.OnMapLoad();
+	const int64_t ImagesTime = time_get() - StartTime;
+	StartTime = time_get();
+	m_MapLayersBackground.OnMapLoad();
+	m_MapLayersForeground.OnMapLoad();
+	const int64_t VisualsTime = time_get() - StartTime;
+
+	StartTime = time_get();
+	CollisionBatch.Wait();
+	const int64_t CollisionWaitTime = time_get() - StartTime;
+	m_GameWorld.m_Core.InitSwitchers(m_Collision.m_HighestSwitchNumber);
+	m_RaceHelper.Init(this);
+
+	StartTime = time_get();
 	for(auto &pComponent : m_vpAll)
 	{
-		pComponent->OnMapLoad();
+		if(pComponent != &m_MapImages && pComponent != &m_MapLayersBackground && pComponent != &m_MapLayersForeground)
+			pComponent->OnMapLoad();
 		pComponent->OnReset();
 	}
+	const int64_t ComponentsTime = time_get() - StartTime;
+
+	const auto &&Ms = [](int64_t Time) { return Time * 1000.0 / time_freq(); };
+	log_info("gameclient", "map loaded in %.2fms: layers %.2fms, images %.2fms, tile visuals %.2fms, collision %.2fms (waited %.2fms), components %.2fms",
+		Ms(time_get() - LoadStartTime), Ms(LayersTime), Ms(ImagesTime), Ms(VisualsTime), Ms(CollisionTime), Ms(CollisionWaitTime), Ms(ComponentsTime));
 
 	ConfigManager()->ResetGameSettings();
 	LoadMapSettings();
@@ -1225,6 +1274,13 @@ void CGameClient::OnShutdown()
 {
 	for(auto &pComponent : m_vpAll)
 		pComponent->OnShutdown();
+
+	m_GameWorld.Clear();
+	m_PredictedWorld.Clear();
+	m_PrevPredictedWorld.Clear();
+	m_ExtraPredictedWorld.Clear();
+	m_PredSmoothingWorld.Clear();
+	CEntity::ReleasePool();
 }
 
 void CGameClient::OnEnterGame()
@@ -1645,11 +1701,20 @@ void CGameClient::OnNewSnapshot()
 				{
 					CClientData *pClient = &m_aClients[ClientId];
 
+					char aPrevName[MAX_NAME_LENGTH];
+					char aPrevClan[MAX_CLAN_LENGTH];
+					str_copy(aPrevName, pClient->m_aName);
+					str_copy(aPrevClan, pClient->m_aClan);
 					if(!IntsToStr(&pInfo->m_Name0, 4, pClient->m_aName, std::size(pClient->m_aName)))
 					{
 						str_copy(pClient->m_aName, "nameless tee");
 					}
 					IntsToStr(&pInfo->m_Clan0, 3, pClient->m_aClan, std::size(pClient->m_aClan));
+					// rasterize new glyphs before the scoreboard or name plates need them
+					if(str_comp(aPrevName, pClient->m_aName) != 0)
+						TextRender()->PrewarmText(pClient->m_aName);
+					if(str_comp(aPrevClan, pClient->m_aClan) != 0)
+						TextRender()->PrewarmText(pClient->m_aClan);
 					pClient->m_Country = pInfo->m_Country;
 
 					IntsToStr(&pInfo->m_Skin0, 6, pClient->m_aSkinName, std::size(pClient->m_aSkinName));
@@ -5,6 +5,33 @@
 
 #include <game/collision.h>
 
+// only the client's main thread creates prediction entities
+static CEntityPool &EntityPool()
+{
+	static CEntityPool s_EntityPool;
+	return s_EntityPool;
+}
+
+void *CEntity::operator new(size_t Size)
+{
+	return EntityPool().Allocate(Size);
+}
+
+void CEntity::operator delete(void *pPtr, size_t Size)
+{
+	EntityPool().Free(pPtr, Size);
+}
+
+const CEntityPoolStats &CEntity::PoolStats()
+{
+	return EntityPool().Stats();
+}
+
+void CEntity::ReleasePool()
+{
+	EntityPool().Release();
+}
+
 //////////////////////////////////////////////////
 // Entity
 //////////////////////////////////////////////////
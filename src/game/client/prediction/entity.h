@@ -7,11 +7,18 @@
 
 #include <game/alloc.h>
 
+#include "entity_pool.h"
 #include "gameworld.h"
 
 class CEntity
 {
-	MACRO_ALLOC_HEAP()
+public:
+	// Prediction worlds are rebuilt every frame, so freed entity storage is kept
+	// in a CEntityPool and handed out again instead of going to the heap.
+	void *operator new(size_t Size);
+	void operator delete(void *pPtr, size_t Size);
+	static const CEntityPoolStats &PoolStats();
+	static void ReleasePool();
 
 private:
 	friend CGameWorld; // entity list handling
@@ -0,0 +1,59 @@
+#include "entity_pool.h"
+
+#include <base/system.h>
+
+#include <cstdlib>
+
+CEntityPool::~CEntityPool()
+{
+	Release();
+}
+
+CEntityPool::CBucket &CEntityPool::Bucket(size_t Size)
+{
+	for(CBucket &Bucket : m_vBuckets)
+		if(Bucket.m_Size == Size)
+			return Bucket;
+	m_vBuckets.push_back({Size, {}});
+	return m_vBuckets.back();
+}
+
+void *CEntityPool::Allocate(size_t Size)
+{
+	CBucket &SizeBucket = Bucket(Size);
+	void *pObj;
+	if(SizeBucket.m_vpFree.empty())
+	{
+		pObj = malloc(Size);
+		m_Stats.m_NumHeapAllocs++;
+	}
+	else
+	{
+		pObj = SizeBucket.m_vpFree.back();
+		SizeBucket.m_vpFree.pop_back();
+		m_Stats.m_NumReused++;
+		m_Stats.m_NumFree--;
+	}
+	m_Stats.m_NumLive++;
+	mem_zero(pObj, Size);
+	return pObj;
+}
+
+void CEntityPool::Free(void *pPtr, size_t Size)
+{
+	if(!pPtr)
+		return;
+	Bucket(Size).m_vpFree.push_back(pPtr);
+	m_Stats.m_NumFree++;
+	m_Stats.m_NumLive--;
+}
+
+void CEntityPool::Release()
+{
+	for(CBucket &SizeBucket : m_vBuckets)
+		for(void *pFree : SizeBucket.m_vpFree)
+			free(pFree);
+	m_vBuckets.clear();
+	m_vBuckets.shrink_to_fit();
+	m_Stats.m_NumFree = 0;
+}
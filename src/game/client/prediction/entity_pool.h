@@ -0,0 +1,48 @@
+#ifndef GAME_CLIENT_PREDICTION_ENTITY_POOL_H
+#define GAME_CLIENT_PREDICTION_ENTITY_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class CEntityPoolStats
+{
+public:
+	int64_t m_NumHeapAllocs = 0;
+	int64_t m_NumReused = 0;
+	int m_NumFree = 0;
+	int m_NumLive = 0;
+};
+
+// Per-size free lists for prediction entities. Storage given back with Free
+// is kept for the next Allocate of the same size until Release is called.
+// Like MACRO_ALLOC_HEAP, the returned memory is zeroed.
+class CEntityPool
+{
+	class CBucket
+	{
+	public:
+		size_t m_Size;
+		std::vector<void *> m_vpFree;
+	};
+
+	std::vector<CBucket> m_vBuckets;
+	CEntityPoolStats m_Stats;
+
+	CBucket &Bucket(size_t Size);
+
+public:
+	CEntityPool() = default;
+	CEntityPool(const CEntityPool &) = delete;
+	CEntityPool &operator=(const CEntityPool &) = delete;
+	~CEntityPool();
+
+	void *Allocate(size_t Size);
+	void Free(void *pPtr, size_t Size);
+	// hands all pooled storage back to the heap, live entities are unaffected
+	void Release();
+
+	const CEntityPoolStats &Stats() const { return m_Stats; }
+};
+
+#endif
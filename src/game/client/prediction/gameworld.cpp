@@ -37,6 +37,9 @@ CGameWorld::CGameWorld()
 CGameWorld::~CGameWorld()
 {
 	Clear();
+	// the last world is gone, don't keep its entity storage around until exit
+	if(CEntity::PoolStats().m_NumLive == 0)
+		CEntity::ReleasePool();
 	if(m_pChild && m_pChild->m_pParent == this)
 	{
 		OnModified();
@@ -677,6 +680,7 @@ void CGameWorld::CopyWorld(CGameWorld *pFrom)
 		m_Core.m_apCharacters[i] = nullptr;
 	}
 	// copy and add the new entities
+	m_NumCopiedEntities = 0;
 	for(int Type = 0; Type < NUM_ENTTYPES; Type++)
 	{
 		for(CEntity *pEnt = pFrom->FindLast(Type); pEnt; pEnt = pEnt->TypePrev())
@@ -697,6 +701,7 @@ void CGameWorld::CopyWorld(CGameWorld *pFrom)
 				pCopy->m_pParent = pEnt;
 				pEnt->m_pChild = pCopy;
 				this->InsertEntity(pCopy);
+				m_NumCopiedEntities++;
 			}
 		}
 	}
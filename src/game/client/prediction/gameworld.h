@@ -86,6 +86,7 @@ public:
 	} m_WorldConfig;
 
 	bool m_IsValidCopy;
+	int m_NumCopiedEntities = 0; // by the last CopyWorld
 	CGameWorld *m_pParent;
 	CGameWorld *m_pChild;
 
@@ -96,32 +96,34 @@ void CRenderTools::Init(IGraphics *pGraphics, ITextRender *pTextRender)
 	m_TeeQuadContainerIndex = Graphics()->CreateQuadContainer(false);
 	Graphics()->SetColor(1.f, 1.f, 1.f, 1.f);
 
-	Graphics()->QuadsSetSubset(0, 0, 1, 1);
+	// all parts are taken from the skin atlas
+	SelectSkinAtlasPart(CSkin::ATLAS_BODY);
 	QuadContainerAddSprite(m_TeeQuadContainerIndex, 64.f);
-	Graphics()->QuadsSetSubset(0, 0, 1, 1);
+	SelectSkinAtlasPart(CSkin::ATLAS_BODY_OUTLINE);
 	QuadContainerAddSprite(m_TeeQuadContainerIndex, 64.f);
 
-	Graphics()->QuadsSetSubset(0, 0, 1, 1);
+	// Eyes, in the order of the emotes in RenderTee6
+	SelectSkinAtlasPart(CSkin::ATLAS_EYES + SPRITE_TEE_EYE_PAIN - SPRITE_TEE_EYE_NORMAL);
 	QuadContainerAddSprite(m_TeeQuadContainerIndex, 64.f * 0.4f);
-	Graphics()->QuadsSetSubset(0, 0, 1, 1);
+	SelectSkinAtlasPart(CSkin::ATLAS_EYES + SPRITE_TEE_EYE_HAPPY - SPRITE_TEE_EYE_NORMAL);
 	QuadContainerAddSprite(m_TeeQuadContainerIndex, 64.f * 0.4f);
-	Graphics()->QuadsSetSubset(0, 0, 1, 1);
+	SelectSkinAtlasPart(CSkin::ATLAS_EYES + SPRITE_TEE_EYE_SURPRISE - SPRITE_TEE_EYE_NORMAL);
 	QuadContainerAddSprite(m_TeeQuadContainerIndex, 64.f * 0.4f);
-	Graphics()->QuadsSetSubset(0, 0, 1, 1);
+	SelectSkinAtlasPart(CSkin::ATLAS_EYES + SPRITE_TEE_EYE_ANGRY - SPRITE_TEE_EYE_NORMAL);
 	QuadContainerAddSprite(m_TeeQuadContainerIndex, 64.f * 0.4f);
-	Graphics()->QuadsSetSubset(0, 0, 1, 1);
+	SelectSkinAtlasPart(CSkin::ATLAS_EYES);
 	QuadContainerAddSprite(m_TeeQuadContainerIndex, 64.f * 0.4f);
 
 	// Feet
-	Graphics()->QuadsSetSubset(0, 0, 1, 1);
+	SelectSkinAtlasPart(CSkin::ATLAS_FEET_OUTLINE);
 	QuadContainerAddSprite(m_TeeQuadContainerIndex, -32.f, -16.f, 64.f, 32.f);
-	Graphics()->QuadsSetSubset(0, 0, 1, 1);
+	SelectSkinAtlasPart(CSkin::ATLAS_FEET);
 	QuadContainerAddSprite(m_TeeQuadContainerIndex, -32.f, -16.f, 64.f, 32.f);
 
 	// Mirrored Feet
-	Graphics()->QuadsSetSubsetFree(1, 0, 0, 0, 0, 1, 1, 1);
+	SelectSkinAtlasPart(CSkin::ATLAS_FEET_OUTLINE, true);
 	QuadContainerAddSprite(m_TeeQuadContainerIndex, -32.f, -16.f, 64.f, 32.f);
-	Graphics()->QuadsSetSubsetFree(1, 0, 0, 0, 0, 1, 1, 1);
+	SelectSkinAtlasPart(CSkin::ATLAS_FEET, true);
 	QuadContainerAddSprite(m_TeeQuadContainerIndex, -32.f, -16.f, 64.f, 32.f);
 
 	Graphics()->QuadContainerUpload(m_TeeQuadContainerIndex);
@@ -152,6 +154,16 @@ void CRenderTools::SelectSprite(const CDataSprite *pSprite, int Flags)
 	Graphics()->QuadsSetSubset(x1, y1, x2, y2);
 }
 
+void CRenderTools::SelectSkinAtlasPart(int Part, bool Mirrored) const
+{
+	float U0, V0, U1, V1;
+	CSkin::AtlasPartSubset(Part, U0, V0, U1, V1);
+	if(Mirrored)
+		Graphics()->QuadsSetSubsetFree(U1, V0, U0, V0, U0, V1, U1, V1);
+	else
+		Graphics()->QuadsSetSubset(U0, V0, U1, V1);
+}
+
 void CRenderTools::SelectSprite(int Id, int Flags)
 {
 	dbg_assert(Id >= 0 && Id < g_pData->m_NumSprites, "Id invalid");
@@ -580,6 +592,8 @@ void CRenderTools::RenderTee6(const CAnimState *pAnim, const CTeeRenderInfo *pIn
 	vec2 Position = Pos;
 
 	const CSkin::CSkinTextures *pSkinTextures = pInfo->m_CustomColoredSkin ? &pInfo->m_ColorableRenderSkin : &pInfo->m_OriginalRenderSkin;
+	// all parts are in the atlas, so one texture is enough for the whole tee
+	Graphics()->TextureSet(pSkinTextures->m_Atlas);
 
 	// first pass we draw the outline
 	// second pass we draw the filling
@@ -600,7 +614,6 @@ void CRenderTools::RenderTee6(const CAnimState *pAnim, const CTeeRenderInfo *pIn
 				vec2 BodyPos = Position + vec2(pAnim->GetBody()->m_X, pAnim->GetBody()->m_Y) * AnimScale;
 				float BodyScale;
 				GetRenderTeeBodyScale(BaseSize, BodyScale);
-				Graphics()->TextureSet(OutLine == 1 ? pSkinTextures->m_BodyOutline : pSkinTextures->m_Body);
 				Graphics()->RenderQuadContainerAsSprite(m_TeeQuadContainerIndex, OutLine, BodyPos.x, BodyPos.y, BodyScale, BodyScale);
 
 				// draw eyes
@@ -608,25 +621,20 @@ void CRenderTools::RenderTee6(const CAnimState *pAnim, const CTeeRenderInfo *pIn
 				{
 					int QuadOffset = 2;
 					int EyeQuadOffset = 0;
-					int TeeEye = 0;
 
 					switch(Emote)
 					{
 					case EMOTE_PAIN:
 						EyeQuadOffset = 0;
-						TeeEye = SPRITE_TEE_EYE_PAIN - SPRITE_TEE_EYE_NORMAL;
 						break;
 					case EMOTE_HAPPY:
 						EyeQuadOffset = 1;
-						TeeEye = SPRITE_TEE_EYE_HAPPY - SPRITE_TEE_EYE_NORMAL;
 						break;
 					case EMOTE_SURPRISE:
 						EyeQuadOffset = 2;
-						TeeEye = SPRITE_TEE_EYE_SURPRISE - SPRITE_TEE_EYE_NORMAL;
 						break;
 					case EMOTE_ANGRY:
 						EyeQuadOffset = 3;
-						TeeEye = SPRITE_TEE_EYE_ANGRY - SPRITE_TEE_EYE_NORMAL;
 						break;
 					default:
 						EyeQuadOffset = 4;
@@ -638,7 +646,6 @@ void CRenderTools::RenderTee6(const CAnimState *pAnim, const CTeeRenderInfo *pIn
 					float EyeSeparation = (0.075f - 0.010f * absolute(Direction.x)) * BaseSize;
 					vec2 Offset = vec2(Direction.x * 0.125f, -0.05f + Direction.y * 0.10f) * BaseSize;
 
-					Graphics()->TextureSet(pSkinTextures->m_aEyes[TeeEye]);
 					Graphics()->RenderQuadContainerAsSprite(m_TeeQuadContainerIndex, QuadOffset + EyeQuadOffset, BodyPos.x - EyeSeparation + Offset.x, BodyPos.y + Offset.y, EyeScale / (64.f * 0.4f), h / (64.f * 0.4f));
 					Graphics()->RenderQuadContainerAsSprite(m_TeeQuadContainerIndex, QuadOffset + EyeQuadOffset, BodyPos.x + EyeSeparation + Offset.x, BodyPos.y + Offset.y, -EyeScale / (64.f * 0.4f), h / (64.f * 0.4f));
 				}
@@ -673,7 +680,6 @@ void CRenderTools::RenderTee6(const CAnimState *pAnim, const CTeeRenderInfo *pIn
 
 				Graphics()->SetColor(pInfo->m_ColorFeet.r * ColorScale, pInfo->m_ColorFeet.g * ColorScale, pInfo->m_ColorFeet.b * ColorScale, Alpha);
 
-				Graphics()->TextureSet(OutLine == 1 ? pSkinTextures->m_FeetOutline : pSkinTextures->m_Feet);
 				Graphics()->RenderQuadContainerAsSprite(m_TeeQuadContainerIndex, QuadOffset, Position.x + pFoot->m_X * AnimScale, Position.y + pFoot->m_Y * AnimScale, w / 64.f, h / 32.f);
 			}
 			else
@@ -700,7 +706,6 @@ void CRenderTools::RenderTee6(const CAnimState *pAnim, const CTeeRenderInfo *pIn
 
 				Graphics()->SetColor(pInfo->m_ColorFeet.r * ColorScale, pInfo->m_ColorFeet.g * ColorScale, pInfo->m_ColorFeet.b * ColorScale, Alpha);
 
-				Graphics()->TextureSet(OutLine == 1 ? pSkinTextures->m_FeetOutline : pSkinTextures->m_Feet);
 				Graphics()->RenderQuadContainerAsSprite(m_TeeQuadContainerIndex, QuadOffset, Position.x + pFoot->m_X * AnimScale, Position.y + pFoot->m_Y * AnimScale, w / 64.f, h / 32.f);
 			}
 		}
@@ -21,6 +21,9 @@ class CSwitchTile;
 class CTeleTile;
 class CTile;
 class CTuneTile;
+struct SGraphicTile;
+struct SGraphicTileTexureCoords;
+struct STextContainerIndex;
 namespace client_data7 {
 struct CDataSprite;
 }
@@ -131,7 +134,7 @@ public:
 
 	bool Valid() const
 	{
-		return m_CustomColoredSkin ? m_ColorableRenderSkin.m_Body.IsValid() : m_OriginalRenderSkin.m_Body.IsValid();
+		return m_CustomColoredSkin ? m_ColorableRenderSkin.m_Atlas.IsValid() : m_OriginalRenderSkin.m_Atlas.IsValid();
 	}
 
 	class CSixup
@@ -277,6 +280,10 @@ public:
 
 	void SelectSprite(int Id, int Flags = 0);
 	void SelectSprite7(int Id, int Flags = 0);
+	/**
+	 * Sets the quad subset to a part of the skin atlas, see @link CSkin::CSkinTextures::m_Atlas @endlink.
+	 */
+	void SelectSkinAtlasPart(int Part, bool Mirrored = false) const;
 
 	void GetSpriteScale(const CDataSprite *pSprite, float &ScaleX, float &ScaleY) const;
 	void GetSpriteScale(int Id, float &ScaleX, float &ScaleY) const;
@@ -313,6 +320,9 @@ public:
 
 	void RenderTile(int x, int y, unsigned char Index, float Scale, ColorRGBA Color) const;
 
+	// fill the vertices of one tile for the buffered tile renderer, pTexCoords can be null for untextured layers
+	static void FillTileQuad(SGraphicTile *pTile, SGraphicTileTexureCoords *pTexCoords, unsigned char Flags, unsigned char Index, int x, int y, const ivec2 &Offset, int Scale);
+
 	// helpers
 	void CalcScreenParams(float Aspect, float Zoom, float *pWidth, float *pHeight);
 	void MapScreenToWorld(float CenterX, float CenterY, float ParallaxX, float ParallaxY,
@@ -325,13 +335,19 @@ public:
 	void RenderSpeedupOverlay(CSpeedupTile *pSpeedup, int w, int h, float Scale, int OverlayRenderFlags, float Alpha = 1.0f);
 	void RenderSwitchOverlay(CSwitchTile *pSwitch, int w, int h, float Scale, int OverlayRenderFlags, float Alpha = 1.0f) const;
 	void RenderTuneOverlay(CTuneTile *pTune, int w, int h, float Scale, int OverlayRenderFlags, float Alpha = 1.0f) const;
+	// build the overlay text of the tiles in [X0, X1) x [Y0, Y1) into one text container using the current text color
+	void CreateTeleOverlayText(STextContainerIndex &TextContainer, const CTeleTile *pTele, int w, int h, int X0, int Y0, int X1, int Y1, float Scale) const;
+	void CreateSpeedupOverlayText(STextContainerIndex &TextContainer, const CSpeedupTile *pSpeedup, int w, int h, int X0, int Y0, int X1, int Y1, float Scale, int OverlayRenderFlags) const;
+	void CreateSwitchOverlayText(STextContainerIndex &TextContainer, const CSwitchTile *pSwitch, int w, int h, int X0, int Y0, int X1, int Y1, float Scale) const;
+	void CreateTuneOverlayText(STextContainerIndex &TextContainer, const CTuneTile *pTune, int w, int h, int X0, int Y0, int X1, int Y1, float Scale) const;
+	void RenderSpeedupArrows(const CSpeedupTile *pSpeedup, int w, int h, int X0, int Y0, int X1, int Y1, float Scale, int OverlayRenderFlags, float Alpha = 1.0f);
 	void RenderTelemap(CTeleTile *pTele, int w, int h, float Scale, ColorRGBA Color, int RenderFlags) const;
 	void RenderSwitchmap(CSwitchTile *pSwitch, int w, int h, float Scale, ColorRGBA Color, int RenderFlags) const;
 	void RenderTunemap(CTuneTile *pTune, int w, int h, float Scale, ColorRGBA Color, int RenderFlags) const;
 
 	// TClient
-	void RenderGameTileOutlines(CTile *pTiles, int w, int h, float Scale, int TileType, float Alpha = 1.0f) const;
-	void RenderTeleOutlines(CTile *pTiles, CTeleTile *pTele, int w, int h, float Scale, float Alpha = 1.0f) const;
+	int GameTileOutlineQuads(const CTile *pTiles, int w, int h, int x, int y, float Scale, float Size, int TileType, IGraphics::CQuadItem *pQuads) const;
+	int TeleOutlineQuads(const CTile *pTiles, const CTeleTile *pTele, int w, int h, int x, int y, float Scale, float Size, IGraphics::CQuadItem *pQuads) const;
 };
 
 #endif
@@ -534,6 +534,80 @@ void CRenderTools::RenderTileRectangle(int RectX, int RectY, int RectW, int Rect
 	Graphics()->MapScreen(ScreenX0, ScreenY0, ScreenX1, ScreenY1);
 }
 
+void CRenderTools::FillTileQuad(SGraphicTile *pTmpTile, SGraphicTileTexureCoords *pTmpTex, unsigned char Flags, unsigned char Index, int x, int y, const ivec2 &Offset, int Scale)
+{
+	if(pTmpTex)
+	{
+		unsigned char x0 = 0;
+		unsigned char y0 = 0;
+		unsigned char x1 = x0 + 1;
+		unsigned char y1 = y0;
+		unsigned char x2 = x0 + 1;
+		unsigned char y2 = y0 + 1;
+		unsigned char x3 = x0;
+		unsigned char y3 = y0 + 1;
+
+		if(Flags & TILEFLAG_XFLIP)
+		{
+			x0 = x2;
+			x1 = x3;
+			x2 = x3;
+			x3 = x0;
+		}
+
+		if(Flags & TILEFLAG_YFLIP)
+		{
+			y0 = y3;
+			y2 = y1;
+			y3 = y1;
+			y1 = y0;
+		}
+
+		if(Flags & TILEFLAG_ROTATE)
+		{
+			unsigned char Tmp = x0;
+			x0 = x3;
+			x3 = x2;
+			x2 = x1;
+			x1 = Tmp;
+			Tmp = y0;
+			y0 = y3;
+			y3 = y2;
+			y2 = y1;
+			y1 = Tmp;
+		}
+
+		pTmpTex->m_TexCoordTopLeft.x = x0;
+		pTmpTex->m_TexCoordTopLeft.y = y0;
+		pTmpTex->m_TexCoordBottomLeft.x = x3;
+		pTmpTex->m_TexCoordBottomLeft.y = y3;
+		pTmpTex->m_TexCoordTopRight.x = x1;
+		pTmpTex->m_TexCoordTopRight.y = y1;
+		pTmpTex->m_TexCoordBottomRight.x = x2;
+		pTmpTex->m_TexCoordBottomRight.y = y2;
+
+		pTmpTex->m_TexCoordTopLeft.z = Index;
+		pTmpTex->m_TexCoordBottomLeft.z = Index;
+		pTmpTex->m_TexCoordTopRight.z = Index;
+		pTmpTex->m_TexCoordBottomRight.z = Index;
+
+		bool HasRotation = (Flags & TILEFLAG_ROTATE) != 0;
+		pTmpTex->m_TexCoordTopLeft.w = HasRotation;
+		pTmpTex->m_TexCoordBottomLeft.w = HasRotation;
+		pTmpTex->m_TexCoordTopRight.w = HasRotation;
+		pTmpTex->m_TexCoordBottomRight.w = HasRotation;
+	}
+
+	pTmpTile->m_TopLeft.x = x * Scale + Offset.x;
+	pTmpTile->m_TopLeft.y = y * Scale + Offset.y;
+	pTmpTile->m_BottomLeft.x = x * Scale + Offset.x;
+	pTmpTile->m_BottomLeft.y = y * Scale + Scale + Offset.y;
+	pTmpTile->m_TopRight.x = x * Scale + Scale + Offset.x;
+	pTmpTile->m_TopRight.y = y * Scale + Offset.y;
+	pTmpTile->m_BottomRight.x = x * Scale + Scale + Offset.x;
+	pTmpTile->m_BottomRight.y = y * Scale + Scale + Offset.y;
+}
+
 void CRenderTools::RenderTilemap(CTile *pTiles, int w, int h, float Scale, ColorRGBA Color, int RenderFlags) const
 {
 	float ScreenX0, ScreenY0, ScreenX1, ScreenY1;
@@ -702,345 +776,118 @@ int ClampedIndex(int x, int y, int w, int h)
 	return x + y * w;
 }
 
-void CRenderTools::RenderGameTileOutlines(CTile *pTiles, int w, int h, float Scale, int TileType, float Alpha) const
+static int OutlineQuads(const bool *pNeighbors, int x, int y, float Scale, float Size, IGraphics::CQuadItem *pQuads)
 {
-	float ScreenX0, ScreenY0, ScreenX1, ScreenY1;
-	Graphics()->GetScreen(&ScreenX0, &ScreenY0, &ScreenX1, &ScreenY1);
+	const float X = x * Scale;
+	const float Y = y * Scale;
+	int NumQuads = 0;
+
+	// Do lonely corners first
+	if(pNeighbors[0] && !pNeighbors[1] && !pNeighbors[3])
+		pQuads[NumQuads++] = IGraphics::CQuadItem(X, Y, Size, Size);
+	if(pNeighbors[2] && !pNeighbors[1] && !pNeighbors[4])
+		pQuads[NumQuads++] = IGraphics::CQuadItem(X + Scale - Size, Y, Size, Size);
+	if(pNeighbors[5] && !pNeighbors[3] && !pNeighbors[6])
+		pQuads[NumQuads++] = IGraphics::CQuadItem(X, Y + Scale - Size, Size, Size);
+	if(pNeighbors[7] && !pNeighbors[6] && !pNeighbors[4])
+		pQuads[NumQuads++] = IGraphics::CQuadItem(X + Scale - Size, Y + Scale - Size, Size, Size);
+	// Top
+	if(pNeighbors[1])
+		pQuads[NumQuads++] = IGraphics::CQuadItem(X, Y, Scale, Size);
+	// Bottom
+	if(pNeighbors[6])
+		pQuads[NumQuads++] = IGraphics::CQuadItem(X, Y + Scale - Size, Scale, Size);
+	// Left
+	if(pNeighbors[3])
+	{
+		if(!pNeighbors[1] && !pNeighbors[6])
+			pQuads[NumQuads++] = IGraphics::CQuadItem(X, Y, Size, Scale);
+		else if(!pNeighbors[6])
+			pQuads[NumQuads++] = IGraphics::CQuadItem(X, Y + Size, Size, Scale - Size);
+		else if(!pNeighbors[1])
+			pQuads[NumQuads++] = IGraphics::CQuadItem(X, Y, Size, Scale - Size);
+		else
+			pQuads[NumQuads++] = IGraphics::CQuadItem(X, Y + Size, Size, Scale - Size * 2.0f);
+	}
+	// Right
+	if(pNeighbors[4])
+	{
+		if(!pNeighbors[1] && !pNeighbors[6])
+			pQuads[NumQuads++] = IGraphics::CQuadItem(X + Scale - Size, Y, Size, Scale);
+		else if(!pNeighbors[6])
+			pQuads[NumQuads++] = IGraphics::CQuadItem(X + Scale - Size, Y + Size, Size, Scale - Size);
+		else if(!pNeighbors[1])
+			pQuads[NumQuads++] = IGraphics::CQuadItem(X + Scale - Size, Y, Size, Scale - Size);
+		else
+			pQuads[NumQuads++] = IGraphics::CQuadItem(X + Scale - Size, Y + Size, Size, Scale - Size * 2.0f);
+	}
+	return NumQuads;
+}
 
-	int StartY = (int)(ScreenY0 / Scale) - 1;
-	int StartX = (int)(ScreenX0 / Scale) - 1;
-	int EndY = (int)(ScreenY1 / Scale) + 1;
-	int EndX = (int)(ScreenX1 / Scale) + 1;
-	int MaxScale = 12;
-	if(EndX - StartX > Graphics()->ScreenWidth() / MaxScale || EndY - StartY > Graphics()->ScreenHeight() / MaxScale)
+static bool IsOutlineNeighbor(int TileType, unsigned char Index, unsigned char IndexN)
+{
+	switch(TileType)
 	{
-		int EdgeX = (EndX - StartX) - (Graphics()->ScreenWidth() / MaxScale);
-		StartX += EdgeX / 2;
-		EndX -= EdgeX / 2;
-		int EdgeY = (EndY - StartY) - (Graphics()->ScreenHeight() / MaxScale);
-		StartY += EdgeY / 2;
-		EndY -= EdgeY / 2;
+	case TILE_FREEZE:
+		return IndexN == TILE_AIR || IndexN == TILE_UNFREEZE || IndexN == TILE_DUNFREEZE;
+	case TILE_SOLID:
+		return IndexN != TILE_NOHOOK && IndexN != Index;
+	case TILE_DEATH:
+		return IndexN != TILE_DEATH && IndexN != Index;
+	default:
+		return IndexN != TILE_UNFREEZE && IndexN != TILE_DUNFREEZE;
 	}
-	Graphics()->TextureClear();
-	Graphics()->QuadsBegin();
-	ColorRGBA Col = ColorRGBA(0.0f, 0.0f, 0.0f, 1.0f);
-	if(TileType == TILE_FREEZE)
-		Col = color_cast<ColorRGBA>(ColorHSLA(g_Config.m_ClOutlineColorFreeze));
-	else if(TileType == TILE_SOLID)
-		Col = color_cast<ColorRGBA>(ColorHSLA(g_Config.m_ClOutlineColorSolid));
-	else if(TileType == TILE_UNFREEZE)
-		Col = color_cast<ColorRGBA>(ColorHSLA(g_Config.m_ClOutlineColorUnfreeze));
-	else if(TileType == TILE_DEATH)
-		Col = color_cast<ColorRGBA>(ColorHSLA(g_Config.m_ClOutlineColorKill));
-
-	Graphics()->SetColor(Col.r, Col.g, Col.b, Alpha);
+}
 
-	for(int y = StartY; y < EndY; y++)
+int CRenderTools::GameTileOutlineQuads(const CTile *pTiles, int w, int h, int x, int y, float Scale, float Size, int TileType, IGraphics::CQuadItem *pQuads) const
+{
+	const unsigned char Index = pTiles[x + y * w].m_Index;
+	const bool IsFreeze = Index == TILE_FREEZE || Index == TILE_DFREEZE;
+	const bool IsUnFreeze = Index == TILE_UNFREEZE || Index == TILE_DUNFREEZE;
+	const bool IsSolid = Index == TILE_SOLID || Index == TILE_NOHOOK;
+	const bool IsKill = Index == TILE_DEATH;
+
+	if(!((IsSolid && TileType == TILE_SOLID) || (IsFreeze && TileType == TILE_FREEZE) || (IsUnFreeze && TileType == TILE_UNFREEZE) || (IsKill && TileType == TILE_DEATH)))
+		return 0;
+
+	bool aNeighbors[8];
+	int n = 0;
+	for(int dy = -1; dy <= 1; dy++)
 	{
-		for(int x = StartX; x < EndX; x++)
+		for(int dx = -1; dx <= 1; dx++)
 		{
-			int mx = x;
-			int my = y;
-
-			int c = ClampedIndex(mx, my, w, h);
-
-			unsigned char Index = pTiles[c].m_Index;
-			bool IsFreeze = Index == TILE_FREEZE || Index == TILE_DFREEZE;
-			bool IsUnFreeze = Index == TILE_UNFREEZE || Index == TILE_DUNFREEZE;
-			bool IsSolid = Index == TILE_SOLID || Index == TILE_NOHOOK;
-			bool IsKill = Index == TILE_DEATH;
-
-			if(!(IsSolid || IsFreeze || IsUnFreeze || IsKill)) // Not an tile we care about
-				continue;
-			if(IsSolid && !(TileType == TILE_SOLID))
+			if(dx == 0 && dy == 0)
 				continue;
-			if(IsFreeze && !(TileType == TILE_FREEZE))
-				continue;
-			if(IsUnFreeze && !(TileType == TILE_UNFREEZE))
-				continue;
-			if(IsKill && !(TileType == TILE_DEATH))
-				continue;
-
-			IGraphics::CQuadItem Array[8];
-			bool Neighbors[8];
-			if(IsFreeze && TileType == TILE_FREEZE)
-			{
-				int IndexN;
-
-				IndexN = pTiles[ClampedIndex(mx - 1, my - 1, w, h)].m_Index;
-				Neighbors[0] = IndexN == TILE_AIR || IndexN == TILE_UNFREEZE || IndexN == TILE_DUNFREEZE;
-				IndexN = pTiles[ClampedIndex(mx - 0, my - 1, w, h)].m_Index;
-				Neighbors[1] = IndexN == TILE_AIR || IndexN == TILE_UNFREEZE || IndexN == TILE_DUNFREEZE;
-				IndexN = pTiles[ClampedIndex(mx + 1, my - 1, w, h)].m_Index;
-				Neighbors[2] = IndexN == TILE_AIR || IndexN == TILE_UNFREEZE || IndexN == TILE_DUNFREEZE;
-				IndexN = pTiles[ClampedIndex(mx - 1, my + 0, w, h)].m_Index;
-				Neighbors[3] = IndexN == TILE_AIR || IndexN == TILE_UNFREEZE || IndexN == TILE_DUNFREEZE;
-				IndexN = pTiles[ClampedIndex(mx + 1, my + 0, w, h)].m_Index;
-				Neighbors[4] = IndexN == TILE_AIR || IndexN == TILE_UNFREEZE || IndexN == TILE_DUNFREEZE;
-				IndexN = pTiles[ClampedIndex(mx - 1, my + 1, w, h)].m_Index;
-				Neighbors[5] = IndexN == TILE_AIR || IndexN == TILE_UNFREEZE || IndexN == TILE_DUNFREEZE;
-				IndexN = pTiles[ClampedIndex(mx + 0, my + 1, w, h)].m_Index;
-				Neighbors[6] = IndexN == TILE_AIR || IndexN == TILE_UNFREEZE || IndexN == TILE_DUNFREEZE;
-				IndexN = pTiles[ClampedIndex(mx + 1, my + 1, w, h)].m_Index;
-				Neighbors[7] = IndexN == TILE_AIR || IndexN == TILE_UNFREEZE || IndexN == TILE_DUNFREEZE;
-			}
-			else if(IsSolid && TileType == TILE_SOLID)
-			{
-				int IndexN;
-				IndexN = pTiles[ClampedIndex(mx - 1, my - 1, w, h)].m_Index;
-				Neighbors[0] = IndexN != TILE_NOHOOK && IndexN != Index;
-				IndexN = pTiles[ClampedIndex(mx - 0, my - 1, w, h)].m_Index;
-				Neighbors[1] = IndexN != TILE_NOHOOK && IndexN != Index;
-				IndexN = pTiles[ClampedIndex(mx + 1, my - 1, w, h)].m_Index;
-				Neighbors[2] = IndexN != TILE_NOHOOK && IndexN != Index;
-				IndexN = pTiles[ClampedIndex(mx - 1, my + 0, w, h)].m_Index;
-				Neighbors[3] = IndexN != TILE_NOHOOK && IndexN != Index;
-				IndexN = pTiles[ClampedIndex(mx + 1, my + 0, w, h)].m_Index;
-				Neighbors[4] = IndexN != TILE_NOHOOK && IndexN != Index;
-				IndexN = pTiles[ClampedIndex(mx - 1, my + 1, w, h)].m_Index;
-				Neighbors[5] = IndexN != TILE_NOHOOK && IndexN != Index;
-				IndexN = pTiles[ClampedIndex(mx + 0, my + 1, w, h)].m_Index;
-				Neighbors[6] = IndexN != TILE_NOHOOK && IndexN != Index;
-				IndexN = pTiles[ClampedIndex(mx + 1, my + 1, w, h)].m_Index;
-				Neighbors[7] = IndexN != TILE_NOHOOK && IndexN != Index;
-			}
-			else if(IsKill && TileType == TILE_DEATH)
-			{
-				int IndexN;
-				IndexN = pTiles[ClampedIndex(mx - 1, my - 1, w, h)].m_Index;
-				Neighbors[0] = IndexN != TILE_DEATH && IndexN != Index;
-				IndexN = pTiles[ClampedIndex(mx - 0, my - 1, w, h)].m_Index;
-				Neighbors[1] = IndexN != TILE_DEATH && IndexN != Index;
-				IndexN = pTiles[ClampedIndex(mx + 1, my - 1, w, h)].m_Index;
-				Neighbors[2] = IndexN != TILE_DEATH && IndexN != Index;
-				IndexN = pTiles[ClampedIndex(mx - 1, my + 0, w, h)].m_Index;
-				Neighbors[3] = IndexN != TILE_DEATH && IndexN != Index;
-				IndexN = pTiles[ClampedIndex(mx + 1, my + 0, w, h)].m_Index;
-				Neighbors[4] = IndexN != TILE_DEATH && IndexN != Index;
-				IndexN = pTiles[ClampedIndex(mx - 1, my + 1, w, h)].m_Index;
-				Neighbors[5] = IndexN != TILE_DEATH && IndexN != Index;
-				IndexN = pTiles[ClampedIndex(mx + 0, my + 1, w, h)].m_Index;
-				Neighbors[6] = IndexN != TILE_DEATH && IndexN != Index;
-				IndexN = pTiles[ClampedIndex(mx + 1, my + 1, w, h)].m_Index;
-				Neighbors[7] = IndexN != TILE_DEATH && IndexN != Index;
-			}
-			else
-			{
-				int IndexN;
-				IndexN = pTiles[ClampedIndex(mx - 1, my - 1, w, h)].m_Index;
-				Neighbors[0] = IndexN != TILE_UNFREEZE && IndexN != TILE_DUNFREEZE;
-				IndexN = pTiles[ClampedIndex(mx - 0, my - 1, w, h)].m_Index;
-				Neighbors[1] = IndexN != TILE_UNFREEZE && IndexN != TILE_DUNFREEZE;
-				IndexN = pTiles[ClampedIndex(mx + 1, my - 1, w, h)].m_Index;
-				Neighbors[2] = IndexN != TILE_UNFREEZE && IndexN != TILE_DUNFREEZE;
-				IndexN = pTiles[ClampedIndex(mx - 1, my + 0, w, h)].m_Index;
-				Neighbors[3] = IndexN != TILE_UNFREEZE && IndexN != TILE_DUNFREEZE;
-				IndexN = pTiles[ClampedIndex(mx + 1, my + 0, w, h)].m_Index;
-				Neighbors[4] = IndexN != TILE_UNFREEZE && IndexN != TILE_DUNFREEZE;
-				IndexN = pTiles[ClampedIndex(mx - 1, my + 1, w, h)].m_Index;
-				Neighbors[5] = IndexN != TILE_UNFREEZE && IndexN != TILE_DUNFREEZE;
-				IndexN = pTiles[ClampedIndex(mx + 0, my + 1, w, h)].m_Index;
-				Neighbors[6] = IndexN != TILE_UNFREEZE && IndexN != TILE_DUNFREEZE;
-				IndexN = pTiles[ClampedIndex(mx + 1, my + 1, w, h)].m_Index;
-				Neighbors[7] = IndexN != TILE_UNFREEZE && IndexN != TILE_DUNFREEZE;
-			}
-
-			float Size = (float)g_Config.m_ClOutlineWidth;
-			int NumQuads = 0;
-
-			// Do lonely corners first
-			if(Neighbors[0] && !Neighbors[1] && !Neighbors[3])
-			{
-				Array[NumQuads] = IGraphics::CQuadItem(mx * Scale, my * Scale, Size, Size);
-				NumQuads++;
-			}
-			if(Neighbors[2] && !Neighbors[1] && !Neighbors[4])
-			{
-				Array[NumQuads] = IGraphics::CQuadItem(mx * Scale + Scale - Size, my * Scale, Size, Size);
-				NumQuads++;
-			}
-			if(Neighbors[5] && !Neighbors[3] && !Neighbors[6])
-			{
-				Array[NumQuads] = IGraphics::CQuadItem(mx * Scale, my * Scale + Scale - Size, Size, Size);
-				NumQuads++;
-			}
-			if(Neighbors[7] && !Neighbors[6] && !Neighbors[4])
-			{
-				Array[NumQuads] = IGraphics::CQuadItem(mx * Scale + Scale - Size, my * Scale + Scale - Size, Size, Size);
-				NumQuads++;
-			}
-			// Top
-			if(Neighbors[1])
-			{
-				Array[NumQuads] = IGraphics::CQuadItem(mx * Scale, my * Scale, Scale, Size);
-				NumQuads++;
-			}
-			// Bottom
-			if(Neighbors[6])
-			{
-				Array[NumQuads] = IGraphics::CQuadItem(mx * Scale, my * Scale + Scale - Size, Scale, Size);
-				NumQuads++;
-			}
-			// Left
-			if(Neighbors[3])
-			{
-				if(!Neighbors[1] && !Neighbors[6])
-					Array[NumQuads] = IGraphics::CQuadItem(mx * Scale, my * Scale, Size, Scale);
-				else if(!Neighbors[6])
-					Array[NumQuads] = IGraphics::CQuadItem(mx * Scale, my * Scale + Size, Size, Scale - Size);
-				else if(!Neighbors[1])
-					Array[NumQuads] = IGraphics::CQuadItem(mx * Scale, my * Scale, Size, Scale - Size);
-				else
-					Array[NumQuads] = IGraphics::CQuadItem(mx * Scale, my * Scale + Size, Size, Scale - Size * 2.0f);
-				NumQuads++;
-			}
-			// Right
-			if(Neighbors[4])
-			{
-				if(!Neighbors[1] && !Neighbors[6])
-					Array[NumQuads] = IGraphics::CQuadItem(mx * Scale + Scale - Size, my * Scale, Size, Scale);
-				else if(!Neighbors[6])
-					Array[NumQuads] = IGraphics::CQuadItem(mx * Scale + Scale - Size, my * Scale + Size, Size, Scale - Size);
-				else if(!Neighbors[1])
-					Array[NumQuads] = IGraphics::CQuadItem(mx * Scale + Scale - Size, my * Scale, Size, Scale - Size);
-				else
-					Array[NumQuads] = IGraphics::CQuadItem(mx * Scale + Scale - Size, my * Scale + Size, Size, Scale - Size * 2.0f);
-				NumQuads++;
-			}
-
-			Graphics()->QuadsDrawTL(Array, NumQuads);
+			aNeighbors[n++] = IsOutlineNeighbor(TileType, Index, pTiles[ClampedIndex(x + dx, y + dy, w, h)].m_Index);
 		}
 	}
-	Graphics()->QuadsEnd();
-	Graphics()->MapScreen(ScreenX0, ScreenY0, ScreenX1, ScreenY1);
+
+	return OutlineQuads(aNeighbors, x, y, Scale, Size, pQuads);
 }
 
-void CRenderTools::RenderTeleOutlines(CTile *pTiles, CTeleTile *pTele, int w, int h, float Scale, float Alpha) const
+int CRenderTools::TeleOutlineQuads(const CTile *pTiles, const CTeleTile *pTele, int w, int h, int x, int y, float Scale, float Size, IGraphics::CQuadItem *pQuads) const
 {
-	float ScreenX0, ScreenY0, ScreenX1, ScreenY1;
-	Graphics()->GetScreen(&ScreenX0, &ScreenY0, &ScreenX1, &ScreenY1);
+	if(x < 1 || x >= w - 1 || y < 1 || y >= h - 1)
+		return 0;
 
-	int StartY = (int)(ScreenY0 / Scale) - 1;
-	int StartX = (int)(ScreenX0 / Scale) - 1;
-	int EndY = (int)(ScreenY1 / Scale) + 1;
-	int EndX = (int)(ScreenX1 / Scale) + 1;
+	const unsigned char Index = pTele[x + y * w].m_Type;
+	if(!(Index == TILE_TELECHECKINEVIL || Index == TILE_TELEIN || Index == TILE_TELEINEVIL))
+		return 0;
 
-	int MaxScale = 12;
-	if(EndX - StartX > Graphics()->ScreenWidth() / MaxScale || EndY - StartY > Graphics()->ScreenHeight() / MaxScale)
+	bool aNeighbors[8];
+	int n = 0;
+	for(int dy = -1; dy <= 1; dy++)
 	{
-		int EdgeX = (EndX - StartX) - (Graphics()->ScreenWidth() / MaxScale);
-		StartX += EdgeX / 2;
-		EndX -= EdgeX / 2;
-		int EdgeY = (EndY - StartY) - (Graphics()->ScreenHeight() / MaxScale);
-		StartY += EdgeY / 2;
-		EndY -= EdgeY / 2;
-	}
-
-	Graphics()->TextureClear();
-	Graphics()->QuadsBegin();
-	ColorRGBA Col = color_cast<ColorRGBA>(ColorHSLA(g_Config.m_ClOutlineColorTele));
-	Graphics()->SetColor(Col.r, Col.g, Col.b, Alpha);
-
-	for(int y = StartY; y < EndY; y++)
-		for(int x = StartX; x < EndX; x++)
+		for(int dx = -1; dx <= 1; dx++)
 		{
-			int mx = x;
-			int my = y;
-
-			if(mx < 1)
-				continue; // mx = 0;
-			if(mx >= w - 1)
-				continue; // mx = w-1;
-			if(my < 1)
-				continue; // my = 0;
-			if(my >= h - 1)
-				continue; // my = h-1;
-
-			int c = mx + my * w;
-
-			unsigned char Index = pTele[c].m_Type;
-			if(!Index)
-				continue;
-			if(!(Index == TILE_TELECHECKINEVIL || Index == TILE_TELEIN || Index == TILE_TELEINEVIL))
+			if(dx == 0 && dy == 0)
 				continue;
-
-			IGraphics::CQuadItem Array[8];
-			bool Neighbors[8];
-			Neighbors[0] = pTiles[(mx - 1) + (my - 1) * w].m_Index == 0 && !pTele[(mx - 1) + (my - 1) * w].m_Number;
-			Neighbors[1] = pTiles[(mx + 0) + (my - 1) * w].m_Index == 0 && !pTele[(mx + 0) + (my - 1) * w].m_Number;
-			Neighbors[2] = pTiles[(mx + 1) + (my - 1) * w].m_Index == 0 && !pTele[(mx + 1) + (my - 1) * w].m_Number;
-			Neighbors[3] = pTiles[(mx - 1) + (my + 0) * w].m_Index == 0 && !pTele[(mx - 1) + (my + 0) * w].m_Number;
-			Neighbors[4] = pTiles[(mx + 1) + (my + 0) * w].m_Index == 0 && !pTele[(mx + 1) + (my + 0) * w].m_Number;
-			Neighbors[5] = pTiles[(mx - 1) + (my + 1) * w].m_Index == 0 && !pTele[(mx - 1) + (my + 1) * w].m_Number;
-			Neighbors[6] = pTiles[(mx + 0) + (my + 1) * w].m_Index == 0 && !pTele[(mx + 0) + (my + 1) * w].m_Number;
-			Neighbors[7] = pTiles[(mx + 1) + (my + 1) * w].m_Index == 0 && !pTele[(mx + 1) + (my + 1) * w].m_Number;
-
-			float Size = (float)g_Config.m_ClOutlineWidth;
-			int NumQuads = 0;
-
-			// Do lonely corners first
-			if(Neighbors[0] && !Neighbors[1] && !Neighbors[3])
-			{
-				Array[NumQuads] = IGraphics::CQuadItem(mx * Scale, my * Scale, Size, Size);
-				NumQuads++;
-			}
-			if(Neighbors[2] && !Neighbors[1] && !Neighbors[4])
-			{
-				Array[NumQuads] = IGraphics::CQuadItem(mx * Scale + Scale - Size, my * Scale, Size, Size);
-				NumQuads++;
-			}
-			if(Neighbors[5] && !Neighbors[3] && !Neighbors[6])
-			{
-				Array[NumQuads] = IGraphics::CQuadItem(mx * Scale, my * Scale + Scale - Size, Size, Size);
-				NumQuads++;
-			}
-			if(Neighbors[7] && !Neighbors[6] && !Neighbors[4])
-			{
-				Array[NumQuads] = IGraphics::CQuadItem(mx * Scale + Scale - Size, my * Scale + Scale - Size, Size, Size);
-				NumQuads++;
-			}
-			// Top
-			if(Neighbors[1])
-			{
-				Array[NumQuads] = IGraphics::CQuadItem(mx * Scale, my * Scale, Scale, Size);
-				NumQuads++;
-			}
-			// Bottom
-			if(Neighbors[6])
-			{
-				Array[NumQuads] = IGraphics::CQuadItem(mx * Scale, my * Scale + Scale - Size, Scale, Size);
-				NumQuads++;
-			}
-			// Left
-			if(Neighbors[3])
-			{
-				if(!Neighbors[1] && !Neighbors[6])
-					Array[NumQuads] = IGraphics::CQuadItem(mx * Scale, my * Scale, Size, Scale);
-				else if(!Neighbors[6])
-					Array[NumQuads] = IGraphics::CQuadItem(mx * Scale, my * Scale + Size, Size, Scale - Size);
-				else if(!Neighbors[1])
-					Array[NumQuads] = IGraphics::CQuadItem(mx * Scale, my * Scale, Size, Scale - Size);
-				else
-					Array[NumQuads] = IGraphics::CQuadItem(mx * Scale, my * Scale + Size, Size, Scale - Size * 2.0f);
-				NumQuads++;
-			}
-			// Right
-			if(Neighbors[4])
-			{
-				if(!Neighbors[1] && !Neighbors[6])
-					Array[NumQuads] = IGraphics::CQuadItem(mx * Scale + Scale - Size, my * Scale, Size, Scale);
-				else if(!Neighbors[6])
-					Array[NumQuads] = IGraphics::CQuadItem(mx * Scale + Scale - Size, my * Scale + Size, Size, Scale - Size);
-				else if(!Neighbors[1])
-					Array[NumQuads] = IGraphics::CQuadItem(mx * Scale + Scale - Size, my * Scale, Size, Scale - Size);
-				else
-					Array[NumQuads] = IGraphics::CQuadItem(mx * Scale + Scale - Size, my * Scale + Size, Size, Scale - Size * 2.0f);
-				NumQuads++;
-			}
-
-			Graphics()->QuadsDrawTL(Array, NumQuads);
+			const int c = (x + dx) + (y + dy) * w;
+			aNeighbors[n++] = pTiles[c].m_Index == 0 && !pTele[c].m_Number;
 		}
-	Graphics()->QuadsEnd();
+	}
+
+	return OutlineQuads(aNeighbors, x, y, Scale, Size, pQuads);
 }
 
 void CRenderTools::RenderTile(int x, int y, unsigned char Index, float Scale, ColorRGBA Color) const
@@ -1110,42 +957,66 @@ void CRenderTools::RenderTile(int x, int y, unsigned char Index, float Scale, Co
 	Graphics()->MapScreen(ScreenX0, ScreenY0, ScreenX1, ScreenY1);
 }
 
-void CRenderTools::RenderTeleOverlay(CTeleTile *pTele, int w, int h, float Scale, int OverlayRenderFlag, float Alpha) const
+// computes the visible tile range, returns false if the overlay text would be too small to read
+static bool OverlayTextRange(IGraphics *pGraphics, float Scale, int &StartX, int &StartY, int &EndX, int &EndY)
 {
-	if(!(OverlayRenderFlag & OVERLAYRENDERFLAG_TEXT))
-		return;
+	float ScreenX0, ScreenY0, ScreenX1, ScreenY1;
+	pGraphics->GetScreen(&ScreenX0, &ScreenY0, &ScreenX1, &ScreenY1);
+
+	StartY = (int)(ScreenY0 / Scale) - 1;
+	StartX = (int)(ScreenX0 / Scale) - 1;
+	EndY = (int)(ScreenY1 / Scale) + 1;
+	EndX = (int)(ScreenX1 / Scale) + 1;
 
+	// its useless to render text at this distance
+	return EndX - StartX <= pGraphics->ScreenWidth() / g_Config.m_GfxTextOverlay && EndY - StartY <= pGraphics->ScreenHeight() / g_Config.m_GfxTextOverlay;
+}
+
+static void AppendOverlayText(ITextRender *pTextRender, STextContainerIndex &TextContainer, float x, float y, float Size, const char *pText)
+{
+	CTextCursor Cursor;
+	pTextRender->SetCursor(&Cursor, x, y, Size, TEXTFLAG_RENDER);
+	pTextRender->CreateOrAppendTextContainer(TextContainer, &Cursor, pText);
+}
+
+// builds the overlay text of the visible tiles with the given builder and renders it for this frame only
+template<typename TBuildText>
+static void RenderOverlayTextOnce(IGraphics *pGraphics, ITextRender *pTextRender, float Scale, float Alpha, TBuildText &&BuildText)
+{
 	float ScreenX0, ScreenY0, ScreenX1, ScreenY1;
-	Graphics()->GetScreen(&ScreenX0, &ScreenY0, &ScreenX1, &ScreenY1);
+	pGraphics->GetScreen(&ScreenX0, &ScreenY0, &ScreenX1, &ScreenY1);
 
-	int StartY = (int)(ScreenY0 / Scale) - 1;
-	int StartX = (int)(ScreenX0 / Scale) - 1;
-	int EndY = (int)(ScreenY1 / Scale) + 1;
-	int EndX = (int)(ScreenX1 / Scale) + 1;
+	int StartX, StartY, EndX, EndY;
+	if(!OverlayTextRange(pGraphics, Scale, StartX, StartY, EndX, EndY))
+		return;
 
-	if(EndX - StartX > Graphics()->ScreenWidth() / g_Config.m_GfxTextOverlay || EndY - StartY > Graphics()->ScreenHeight() / g_Config.m_GfxTextOverlay)
-		return; // its useless to render text at this distance
+	STextContainerIndex TextContainer;
+	const unsigned OldRenderFlags = pTextRender->GetRenderFlags();
+	pTextRender->SetRenderFlags(OldRenderFlags | TEXT_RENDER_FLAG_ONE_TIME_USE);
+	pTextRender->TextColor(1.0f, 1.0f, 1.0f, Alpha);
+	BuildText(TextContainer, StartX, StartY, EndX, EndY);
+	pTextRender->TextColor(pTextRender->DefaultTextColor());
+	pTextRender->SetRenderFlags(OldRenderFlags);
+	if(TextContainer.Valid())
+	{
+		pTextRender->RenderTextContainer(TextContainer, pTextRender->DefaultTextColor(), pTextRender->DefaultTextOutlineColor());
+		pTextRender->DeleteTextContainer(TextContainer);
+	}
+	pGraphics->MapScreen(ScreenX0, ScreenY0, ScreenX1, ScreenY1);
+}
+
+void CRenderTools::CreateTeleOverlayText(STextContainerIndex &TextContainer, const CTeleTile *pTele, int w, int h, int X0, int Y0, int X1, int Y1, float Scale) const
+{
+	const unsigned OldRenderFlags = TextRender()->GetRenderFlags();
+	TextRender()->SetRenderFlags(OldRenderFlags | TEXT_RENDER_FLAG_NO_AUTOMATIC_QUAD_UPLOAD);
 
 	float Size = g_Config.m_ClTextEntitiesSize / 100.f;
 	char aBuf[16];
 
-	TextRender()->TextColor(1.0f, 1.0f, 1.0f, Alpha);
-	for(int y = StartY; y < EndY; y++)
+	for(int my = maximum(Y0, 0); my < minimum(Y1, h); my++)
 	{
-		for(int x = StartX; x < EndX; x++)
+		for(int mx = maximum(X0, 0); mx < minimum(X1, w); mx++)
 		{
-			int mx = x;
-			int my = y;
-
-			if(mx < 0)
-				continue; // mx = 0;
-			if(mx >= w)
-				continue; // mx = w-1;
-			if(my < 0)
-				continue; // my = 0;
-			if(my >= h)
-				continue; // my = h-1;
-
 			int c = mx + my * w;
 
 			unsigned char Index = pTele[c].m_Number;
@@ -1157,48 +1028,32 @@ void CRenderTools::RenderTeleOverlay(CTeleTile *pTele, int w, int h, float Scale
 				float Factor = clamp(Scale / ScaledWidth, 0.0f, 1.0f);
 				float LocalSize = Size * Factor;
 				float ToCenterOffset = (1 - LocalSize) / 2.f;
-				TextRender()->Text((mx + 0.5f) * Scale - (ScaledWidth * Factor) / 2.0f, (my + ToCenterOffset) * Scale, LocalSize * Scale, aBuf);
+				AppendOverlayText(TextRender(), TextContainer, (mx + 0.5f) * Scale - (ScaledWidth * Factor) / 2.0f, (my + ToCenterOffset) * Scale, LocalSize * Scale, aBuf);
 			}
 		}
 	}
-	TextRender()->TextColor(TextRender()->DefaultTextColor());
-	Graphics()->MapScreen(ScreenX0, ScreenY0, ScreenX1, ScreenY1);
+
+	TextRender()->SetRenderFlags(OldRenderFlags);
+	if(TextContainer.Valid())
+		TextRender()->UploadTextContainer(TextContainer);
 }
 
-void CRenderTools::RenderSpeedupOverlay(CSpeedupTile *pSpeedup, int w, int h, float Scale, int OverlayRenderFlag, float Alpha)
+void CRenderTools::CreateSpeedupOverlayText(STextContainerIndex &TextContainer, const CSpeedupTile *pSpeedup, int w, int h, int X0, int Y0, int X1, int Y1, float Scale, int OverlayRenderFlag) const
 {
-	float ScreenX0, ScreenY0, ScreenX1, ScreenY1;
-	Graphics()->GetScreen(&ScreenX0, &ScreenY0, &ScreenX1, &ScreenY1);
-
-	int StartY = (int)(ScreenY0 / Scale) - 1;
-	int StartX = (int)(ScreenX0 / Scale) - 1;
-	int EndY = (int)(ScreenY1 / Scale) + 1;
-	int EndX = (int)(ScreenX1 / Scale) + 1;
+	if(!(OverlayRenderFlag & OVERLAYRENDERFLAG_TEXT))
+		return;
 
-	if(EndX - StartX > Graphics()->ScreenWidth() / g_Config.m_GfxTextOverlay || EndY - StartY > Graphics()->ScreenHeight() / g_Config.m_GfxTextOverlay)
-		return; // its useless to render text at this distance
+	const unsigned OldRenderFlags = TextRender()->GetRenderFlags();
+	TextRender()->SetRenderFlags(OldRenderFlags | TEXT_RENDER_FLAG_NO_AUTOMATIC_QUAD_UPLOAD);
 
 	float Size = g_Config.m_ClTextEntitiesSize / 100.f;
 	float ToCenterOffset = (1 - Size) / 2.f;
 	char aBuf[16];
 
-	TextRender()->TextColor(1.0f, 1.0f, 1.0f, Alpha);
-	for(int y = StartY; y < EndY; y++)
+	for(int my = maximum(Y0, 0); my < minimum(Y1, h); my++)
 	{
-		for(int x = StartX; x < EndX; x++)
+		for(int mx = maximum(X0, 0); mx < minimum(X1, w); mx++)
 		{
-			int mx = x;
-			int my = y;
-
-			if(mx < 0)
-				continue; // mx = 0;
-			if(mx >= w)
-				continue; // mx = w-1;
-			if(my < 0)
-				continue; // my = 0;
-			if(my >= h)
-				continue; // my = h-1;
-
 			int c = mx + my * w;
 
 			int Force = (int)pSpeedup[c].m_Force;
@@ -1209,143 +1064,84 @@ void CRenderTools::RenderSpeedupOverlay(CSpeedupTile *pSpeedup, int w, int h, fl
 			{
 				if(IsValidSpeedupTile(Type))
 				{
-					// draw arrow
-					Graphics()->TextureSet(g_pData->m_aImages[IMAGE_SPEEDUP_ARROW].m_Id);
-					Graphics()->QuadsBegin();
-					Graphics()->SetColor(1.0f, 1.0f, 1.0f, Alpha);
-					SelectSprite(SPRITE_SPEEDUP_ARROW);
-					Graphics()->QuadsSetRotation(pSpeedup[c].m_Angle * (pi / 180.0f));
-					DrawSprite(mx * Scale + 16, my * Scale + 16, 35.0f);
-					Graphics()->QuadsEnd();
-
 					// draw force and max speed
-					if(OverlayRenderFlag & OVERLAYRENDERFLAG_TEXT)
+					str_format(aBuf, sizeof(aBuf), "%d", Force);
+					AppendOverlayText(TextRender(), TextContainer, mx * Scale, (my + 0.5f + ToCenterOffset / 2) * Scale, Size * Scale / 2.f, aBuf);
+					if(MaxSpeed)
 					{
-						str_format(aBuf, sizeof(aBuf), "%d", Force);
-						TextRender()->Text(mx * Scale, (my + 0.5f + ToCenterOffset / 2) * Scale, Size * Scale / 2.f, aBuf);
-						if(MaxSpeed)
-						{
-							str_format(aBuf, sizeof(aBuf), "%d", MaxSpeed);
-							TextRender()->Text(mx * Scale, (my + ToCenterOffset / 2) * Scale, Size * Scale / 2.f, aBuf);
-						}
+						str_format(aBuf, sizeof(aBuf), "%d", MaxSpeed);
+						AppendOverlayText(TextRender(), TextContainer, mx * Scale, (my + ToCenterOffset / 2) * Scale, Size * Scale / 2.f, aBuf);
 					}
 				}
 				else
 				{
 					// draw all three values
-					if(OverlayRenderFlag & OVERLAYRENDERFLAG_TEXT)
-					{
-						float LineSpacing = Size * Scale / 3.f;
-						float BaseY = (my + ToCenterOffset) * Scale;
-						str_format(aBuf, sizeof(aBuf), "%d", Force);
-						TextRender()->Text(mx * Scale, BaseY, LineSpacing, aBuf);
-						str_format(aBuf, sizeof(aBuf), "%d", MaxSpeed);
-						TextRender()->Text(mx * Scale, BaseY + LineSpacing, LineSpacing, aBuf);
-						str_format(aBuf, sizeof(aBuf), "%d", Angle);
-						TextRender()->Text(mx * Scale, BaseY + 2 * LineSpacing, LineSpacing, aBuf);
-					}
+					float LineSpacing = Size * Scale / 3.f;
+					float BaseY = (my + ToCenterOffset) * Scale;
+					str_format(aBuf, sizeof(aBuf), "%d", Force);
+					AppendOverlayText(TextRender(), TextContainer, mx * Scale, BaseY, LineSpacing, aBuf);
+					str_format(aBuf, sizeof(aBuf), "%d", MaxSpeed);
+					AppendOverlayText(TextRender(), TextContainer, mx * Scale, BaseY + LineSpacing, LineSpacing, aBuf);
+					str_format(aBuf, sizeof(aBuf), "%d", Angle);
+					AppendOverlayText(TextRender(), TextContainer, mx * Scale, BaseY + 2 * LineSpacing, LineSpacing, aBuf);
 				}
 			}
 		}
 	}
-	TextRender()->TextColor(TextRender()->DefaultTextColor());
-	Graphics()->MapScreen(ScreenX0, ScreenY0, ScreenX1, ScreenY1);
+
+	TextRender()->SetRenderFlags(OldRenderFlags);
+	if(TextContainer.Valid())
+		TextRender()->UploadTextContainer(TextContainer);
 }
 
-void CRenderTools::RenderSwitchOverlay(CSwitchTile *pSwitch, int w, int h, float Scale, int OverlayRenderFlag, float Alpha) const
+void CRenderTools::CreateSwitchOverlayText(STextContainerIndex &TextContainer, const CSwitchTile *pSwitch, int w, int h, int X0, int Y0, int X1, int Y1, float Scale) const
 {
-	if(!(OverlayRenderFlag & OVERLAYRENDERFLAG_TEXT))
-		return;
-
-	float ScreenX0, ScreenY0, ScreenX1, ScreenY1;
-	Graphics()->GetScreen(&ScreenX0, &ScreenY0, &ScreenX1, &ScreenY1);
-
-	int StartY = (int)(ScreenY0 / Scale) - 1;
-	int StartX = (int)(ScreenX0 / Scale) - 1;
-	int EndY = (int)(ScreenY1 / Scale) + 1;
-	int EndX = (int)(ScreenX1 / Scale) + 1;
-
-	if(EndX - StartX > Graphics()->ScreenWidth() / g_Config.m_GfxTextOverlay || EndY - StartY > Graphics()->ScreenHeight() / g_Config.m_GfxTextOverlay)
-		return; // its useless to render text at this distance
+	const unsigned OldRenderFlags = TextRender()->GetRenderFlags();
+	TextRender()->SetRenderFlags(OldRenderFlags | TEXT_RENDER_FLAG_NO_AUTOMATIC_QUAD_UPLOAD);
 
 	float Size = g_Config.m_ClTextEntitiesSize / 100.f;
 	float ToCenterOffset = (1 - Size) / 2.f;
 	char aBuf[16];
 
-	TextRender()->TextColor(1.0f, 1.0f, 1.0f, Alpha);
-	for(int y = StartY; y < EndY; y++)
+	for(int my = maximum(Y0, 0); my < minimum(Y1, h); my++)
 	{
-		for(int x = StartX; x < EndX; x++)
+		for(int mx = maximum(X0, 0); mx < minimum(X1, w); mx++)
 		{
-			int mx = x;
-			int my = y;
-
-			if(mx < 0)
-				continue; // mx = 0;
-			if(mx >= w)
-				continue; // mx = w-1;
-			if(my < 0)
-				continue; // my = 0;
-			if(my >= h)
-				continue; // my = h-1;
-
 			int c = mx + my * w;
 
 			unsigned char Index = pSwitch[c].m_Number;
 			if(Index && IsSwitchTileNumberUsed(pSwitch[c].m_Type))
 			{
 				str_format(aBuf, sizeof(aBuf), "%d", Index);
-				TextRender()->Text(mx * Scale, (my + ToCenterOffset / 2) * Scale, Size * Scale / 2.f, aBuf);
+				AppendOverlayText(TextRender(), TextContainer, mx * Scale, (my + ToCenterOffset / 2) * Scale, Size * Scale / 2.f, aBuf);
 			}
 
 			unsigned char Delay = pSwitch[c].m_Delay;
 			if(Delay && IsSwitchTileDelayUsed(pSwitch[c].m_Type))
 			{
 				str_format(aBuf, sizeof(aBuf), "%d", Delay);
-				TextRender()->Text(mx * Scale, (my + 0.5f + ToCenterOffset / 2) * Scale, Size * Scale / 2.f, aBuf);
+				AppendOverlayText(TextRender(), TextContainer, mx * Scale, (my + 0.5f + ToCenterOffset / 2) * Scale, Size * Scale / 2.f, aBuf);
 			}
 		}
 	}
-	TextRender()->TextColor(TextRender()->DefaultTextColor());
-	Graphics()->MapScreen(ScreenX0, ScreenY0, ScreenX1, ScreenY1);
+
+	TextRender()->SetRenderFlags(OldRenderFlags);
+	if(TextContainer.Valid())
+		TextRender()->UploadTextContainer(TextContainer);
 }
 
-void CRenderTools::RenderTuneOverlay(CTuneTile *pTune, int w, int h, float Scale, int OverlayRenderFlag, float Alpha) const
+void CRenderTools::CreateTuneOverlayText(STextContainerIndex &TextContainer, const CTuneTile *pTune, int w, int h, int X0, int Y0, int X1, int Y1, float Scale) const
 {
-	if(!(OverlayRenderFlag & OVERLAYRENDERFLAG_TEXT))
-		return;
-
-	float ScreenX0, ScreenY0, ScreenX1, ScreenY1;
-	Graphics()->GetScreen(&ScreenX0, &ScreenY0, &ScreenX1, &ScreenY1);
-
-	int StartY = (int)(ScreenY0 / Scale) - 1;
-	int StartX = (int)(ScreenX0 / Scale) - 1;
-	int EndY = (int)(ScreenY1 / Scale) + 1;
-	int EndX = (int)(ScreenX1 / Scale) + 1;
-
-	if(EndX - StartX > Graphics()->ScreenWidth() / g_Config.m_GfxTextOverlay || EndY - StartY > Graphics()->ScreenHeight() / g_Config.m_GfxTextOverlay)
-		return; // its useless to render text at this distance
+	const unsigned OldRenderFlags = TextRender()->GetRenderFlags();
+	TextRender()->SetRenderFlags(OldRenderFlags | TEXT_RENDER_FLAG_NO_AUTOMATIC_QUAD_UPLOAD);
 
 	float Size = g_Config.m_ClTextEntitiesSize / 200.f;
 	char aBuf[16];
 
-	TextRender()->TextColor(1.0f, 1.0f, 1.0f, Alpha);
-	for(int y = StartY; y < EndY; y++)
+	for(int my = maximum(Y0, 0); my < minimum(Y1, h); my++)
 	{
-		for(int x = StartX; x < EndX; x++)
+		for(int mx = maximum(X0, 0); mx < minimum(X1, w); mx++)
 		{
-			int mx = x;
-			int my = y;
-
-			if(mx < 0)
-				continue; // mx = 0;
-			if(mx >= w)
-				continue; // mx = w-1;
-			if(my < 0)
-				continue; // my = 0;
-			if(my >= h)
-				continue; // my = h-1;
-
 			int c = mx + my * w;
 
 			unsigned char Index = pTune[c].m_Number;
@@ -1357,12 +1153,83 @@ void CRenderTools::RenderTuneOverlay(CTuneTile *pTune, int w, int h, float Scale
 				float Factor = clamp(Scale / ScaledWidth, 0.0f, 1.0f);
 				float LocalSize = Size * Factor;
 				float ToCenterOffset = (1 - LocalSize) / 2.f;
-				TextRender()->Text((mx + 0.5f) * Scale - (ScaledWidth * Factor) / 2.0f, (my + ToCenterOffset) * Scale, LocalSize * Scale, aBuf);
+				AppendOverlayText(TextRender(), TextContainer, (mx + 0.5f) * Scale - (ScaledWidth * Factor) / 2.0f, (my + ToCenterOffset) * Scale, LocalSize * Scale, aBuf);
 			}
 		}
 	}
-	TextRender()->TextColor(TextRender()->DefaultTextColor());
-	Graphics()->MapScreen(ScreenX0, ScreenY0, ScreenX1, ScreenY1);
+
+	TextRender()->SetRenderFlags(OldRenderFlags);
+	if(TextContainer.Valid())
+		TextRender()->UploadTextContainer(TextContainer);
+}
+
+void CRenderTools::RenderSpeedupArrows(const CSpeedupTile *pSpeedup, int w, int h, int X0, int Y0, int X1, int Y1, float Scale, int OverlayRenderFlag, float Alpha)
+{
+	Graphics()->TextureSet(g_pData->m_aImages[IMAGE_SPEEDUP_ARROW].m_Id);
+	Graphics()->QuadsBegin();
+	Graphics()->SetColor(1.0f, 1.0f, 1.0f, Alpha);
+	SelectSprite(SPRITE_SPEEDUP_ARROW);
+
+	for(int my = maximum(Y0, 0); my < minimum(Y1, h); my++)
+	{
+		for(int mx = maximum(X0, 0); mx < minimum(X1, w); mx++)
+		{
+			int c = mx + my * w;
+
+			int Force = (int)pSpeedup[c].m_Force;
+			int MaxSpeed = (int)pSpeedup[c].m_MaxSpeed;
+			int Type = (int)pSpeedup[c].m_Type;
+			int Angle = (int)pSpeedup[c].m_Angle;
+			if(!IsValidSpeedupTile(Type))
+				continue;
+			if((Force && Type == TILE_SPEED_BOOST_OLD) || ((Force || MaxSpeed) && Type == TILE_SPEED_BOOST) || (OverlayRenderFlag & OVERLAYRENDERFLAG_EDITOR && (Type || Force || MaxSpeed || Angle)))
+			{
+				Graphics()->QuadsSetRotation(Angle * (pi / 180.0f));
+				DrawSprite(mx * Scale + 16, my * Scale + 16, 35.0f);
+			}
+		}
+	}
+
+	Graphics()->QuadsEnd();
+}
+
+void CRenderTools::RenderTeleOverlay(CTeleTile *pTele, int w, int h, float Scale, int OverlayRenderFlag, float Alpha) const
+{
+	if(!(OverlayRenderFlag & OVERLAYRENDERFLAG_TEXT))
+		return;
+
+	RenderOverlayTextOnce(Graphics(), TextRender(), Scale, Alpha, [&](STextContainerIndex &TextContainer, int X0, int Y0, int X1, int Y1) {
+		CreateTeleOverlayText(TextContainer, pTele, w, h, X0, Y0, X1, Y1, Scale);
+	});
+}
+
+void CRenderTools::RenderSpeedupOverlay(CSpeedupTile *pSpeedup, int w, int h, float Scale, int OverlayRenderFlag, float Alpha)
+{
+	// the arrows are drawn even without text, CreateSpeedupOverlayText checks the flag itself
+	RenderOverlayTextOnce(Graphics(), TextRender(), Scale, Alpha, [&](STextContainerIndex &TextContainer, int X0, int Y0, int X1, int Y1) {
+		RenderSpeedupArrows(pSpeedup, w, h, X0, Y0, X1, Y1, Scale, OverlayRenderFlag, Alpha);
+		CreateSpeedupOverlayText(TextContainer, pSpeedup, w, h, X0, Y0, X1, Y1, Scale, OverlayRenderFlag);
+	});
+}
+
+void CRenderTools::RenderSwitchOverlay(CSwitchTile *pSwitch, int w, int h, float Scale, int OverlayRenderFlag, float Alpha) const
+{
+	if(!(OverlayRenderFlag & OVERLAYRENDERFLAG_TEXT))
+		return;
+
+	RenderOverlayTextOnce(Graphics(), TextRender(), Scale, Alpha, [&](STextContainerIndex &TextContainer, int X0, int Y0, int X1, int Y1) {
+		CreateSwitchOverlayText(TextContainer, pSwitch, w, h, X0, Y0, X1, Y1, Scale);
+	});
+}
+
+void CRenderTools::RenderTuneOverlay(CTuneTile *pTune, int w, int h, float Scale, int OverlayRenderFlag, float Alpha) const
+{
+	if(!(OverlayRenderFlag & OVERLAYRENDERFLAG_TEXT))
+		return;
+
+	RenderOverlayTextOnce(Graphics(), TextRender(), Scale, Alpha, [&](STextContainerIndex &TextContainer, int X0, int Y0, int X1, int Y1) {
+		CreateTuneOverlayText(TextContainer, pTune, w, h, X0, Y0, X1, Y1, Scale);
+	});
 }
 
 void CRenderTools::RenderTelemap(CTeleTile *pTele, int w, int h, float Scale, ColorRGBA Color, int RenderFlags) const
@@ -3,36 +3,87 @@
 #include <base/math.h>
 #include <base/system.h>
 
+#include <game/generated/client_data.h>
+
 #include <limits>
 
+// Size of the skin atlas and position of each part in it, in eighths of a sprite grid cell.
+// The atlas is mipmapped, so the parts and the transparent gaps of half a cell between them
+// are aligned to half cells. This keeps the parts apart down to the mipmap level where half
+// a cell is one texel, i.e. a sixteenth of the size for 256x128 skins.
+static constexpr int ATLAS_WIDTH = 100;
+static constexpr int ATLAS_HEIGHT = 44;
+
+static const struct
+{
+	int m_X;
+	int m_Y;
+} gs_aAtlasPartPositions[CSkin::NUM_ATLAS_PARTS] = {
+	{4, 4}, // body
+	{32, 4}, // body outline
+	{60, 4}, // feet
+	{60, 16}, // feet outline
+	{4, 32}, // hands
+	{16, 32}, // hands outline
+	{28, 32}, // eyes
+	{40, 32},
+	{52, 32},
+	{64, 32},
+	{76, 32},
+	{88, 32},
+};
+
 void CSkin::CSkinTextures::Reset()
 {
-	m_Body = IGraphics::CTextureHandle();
-	m_BodyOutline = IGraphics::CTextureHandle();
-	m_Feet = IGraphics::CTextureHandle();
-	m_FeetOutline = IGraphics::CTextureHandle();
-	m_Hands = IGraphics::CTextureHandle();
-	m_HandsOutline = IGraphics::CTextureHandle();
-	for(auto &Eye : m_aEyes)
-	{
-		Eye = IGraphics::CTextureHandle();
-	}
+	m_Atlas = IGraphics::CTextureHandle();
 }
 
 void CSkin::CSkinTextures::Unload(IGraphics *pGraphics)
 {
-	pGraphics->UnloadTexture(&m_Body);
-	pGraphics->UnloadTexture(&m_BodyOutline);
-	pGraphics->UnloadTexture(&m_Feet);
-	pGraphics->UnloadTexture(&m_FeetOutline);
-	pGraphics->UnloadTexture(&m_Hands);
-	pGraphics->UnloadTexture(&m_HandsOutline);
-	for(auto &Eye : m_aEyes)
+	pGraphics->UnloadTexture(&m_Atlas);
+}
+
+int CSkin::AtlasPartSprite(int Part)
+{
+	dbg_assert(Part >= 0 && Part < NUM_ATLAS_PARTS, "invalid skin atlas part");
+	switch(Part)
 	{
-		pGraphics->UnloadTexture(&Eye);
+	case ATLAS_BODY: return SPRITE_TEE_BODY;
+	case ATLAS_BODY_OUTLINE: return SPRITE_TEE_BODY_OUTLINE;
+	case ATLAS_FEET: return SPRITE_TEE_FOOT;
+	case ATLAS_FEET_OUTLINE: return SPRITE_TEE_FOOT_OUTLINE;
+	case ATLAS_HANDS: return SPRITE_TEE_HAND;
+	case ATLAS_HANDS_OUTLINE: return SPRITE_TEE_HAND_OUTLINE;
+	default: return SPRITE_TEE_EYE_NORMAL + Part - ATLAS_EYES;
 	}
 }
 
+void CSkin::AtlasSize(int CellWidth, int CellHeight, int &Width, int &Height)
+{
+	Width = ATLAS_WIDTH * CellWidth / 8;
+	Height = ATLAS_HEIGHT * CellHeight / 8;
+}
+
+void CSkin::AtlasPartRect(int Part, int CellWidth, int CellHeight, int &X, int &Y, int &Width, int &Height)
+{
+	const CDataSprite &Sprite = g_pData->m_aSprites[AtlasPartSprite(Part)];
+	X = gs_aAtlasPartPositions[Part].m_X * CellWidth / 8;
+	Y = gs_aAtlasPartPositions[Part].m_Y * CellHeight / 8;
+	Width = Sprite.m_W * CellWidth;
+	Height = Sprite.m_H * CellHeight;
+}
+
+void CSkin::AtlasPartSubset(int Part, float &TopLeftU, float &TopLeftV, float &BottomRightU, float &BottomRightV)
+{
+	const CDataSprite &Sprite = g_pData->m_aSprites[AtlasPartSprite(Part)];
+	// like CRenderTools::SelectSprite, stay half a texel inside the part, assuming 32 pixels per cell
+	const float HalfTexel = 0.5f * 8 / 32;
+	TopLeftU = (gs_aAtlasPartPositions[Part].m_X + HalfTexel) / ATLAS_WIDTH;
+	TopLeftV = (gs_aAtlasPartPositions[Part].m_Y + HalfTexel) / ATLAS_HEIGHT;
+	BottomRightU = (gs_aAtlasPartPositions[Part].m_X + Sprite.m_W * 8 - HalfTexel) / ATLAS_WIDTH;
+	BottomRightV = (gs_aAtlasPartPositions[Part].m_Y + Sprite.m_H * 8 - HalfTexel) / ATLAS_HEIGHT;
+}
+
 CSkin::CSkinMetricVariableInt::operator int() const
 {
 	return m_Value;
@@ -12,19 +12,29 @@ class CSkin
 	char m_aName[MAX_SKIN_LENGTH];
 
 public:
+	/**
+	 * Parts of a skin in the order they are packed into the skin atlas.
+	 */
+	enum
+	{
+		ATLAS_BODY = 0,
+		ATLAS_BODY_OUTLINE,
+		ATLAS_FEET,
+		ATLAS_FEET_OUTLINE,
+		ATLAS_HANDS,
+		ATLAS_HANDS_OUTLINE,
+		// in the order of the eye sprites, starting with SPRITE_TEE_EYE_NORMAL
+		ATLAS_EYES,
+		NUM_ATLAS_PARTS = ATLAS_EYES + 6,
+	};
+
 	class CSkinTextures
 	{
 	public:
-		IGraphics::CTextureHandle m_Body;
-		IGraphics::CTextureHandle m_BodyOutline;
-
-		IGraphics::CTextureHandle m_Feet;
-		IGraphics::CTextureHandle m_FeetOutline;
-
-		IGraphics::CTextureHandle m_Hands;
-		IGraphics::CTextureHandle m_HandsOutline;
-
-		IGraphics::CTextureHandle m_aEyes[6];
+		/**
+		 * All parts of the skin in one texture, so a tee can be rendered without switching textures.
+		 */
+		IGraphics::CTextureHandle m_Atlas;
 
 		void Reset();
 		void Unload(IGraphics *pGraphics);
@@ -96,6 +106,21 @@ public:
 	const char *GetName() const { return m_aName; }
 
 	static bool IsValidName(const char *pName);
+
+	/**
+	 * Returns the size of the atlas for a skin with the given size of one sprite grid cell in pixels.
+	 * The cell size must be divisible by 8.
+	 */
+	static void AtlasSize(int CellWidth, int CellHeight, int &Width, int &Height);
+	/**
+	 * Returns the pixel rectangle of a part in the atlas for a skin with the given size of one sprite grid cell.
+	 */
+	static void AtlasPartRect(int Part, int CellWidth, int CellHeight, int &X, int &Y, int &Width, int &Height);
+	/**
+	 * Returns the texture coordinates of a part in the atlas, which are the same for all skins.
+	 */
+	static void AtlasPartSubset(int Part, float &TopLeftU, float &TopLeftV, float &BottomRightU, float &BottomRightV);
+	static int AtlasPartSprite(int Part);
 	static const char m_aSkinNameRestrictions[];
 };
 
@@ -6,6 +6,7 @@
 
 #include <antibot/antibot_data.h>
 
+#include <algorithm>
 #include <cmath>
 #include <engine/map.h>
 
@@ -47,6 +48,27 @@ CCollision::~CCollision()
 	Unload();
 }
 
+void CCollision::SanitizeSwitchLayer(CLayers *pLayers)
+{
+	if(!pLayers->SwitchLayer())
+		return;
+
+	const size_t NumTiles = (size_t)pLayers->GameLayer()->m_Width * pLayers->GameLayer()->m_Height;
+	if((size_t)pLayers->Map()->GetDataSize(pLayers->SwitchLayer()->m_Switch) < NumTiles * sizeof(CSwitchTile))
+		return;
+
+	CSwitchTile *pSwitch = static_cast<CSwitchTile *>(pLayers->Map()->GetData(pLayers->SwitchLayer()->m_Switch));
+	for(size_t i = 0; i < NumTiles; i++)
+	{
+		const int Index = pSwitch[i].m_Type;
+		if(Index == 0 || Index > TILE_NPH_ENABLE)
+			continue;
+		// only write when something changes, so sanitizing again does not race with readers
+		if(!((Index >= TILE_JUMP && Index <= TILE_SUBTRACT_TIME) || Index == TILE_ALLOW_TELE_GUN || Index == TILE_ALLOW_BLUE_TELE_GUN))
+			pSwitch[i].m_Type = 0;
+	}
+}
+
 void CCollision::Init(class CLayers *pLayers)
 {
 	Unload();
@@ -94,9 +116,11 @@ void CCollision::Init(class CLayers *pLayers)
 			m_pFront = static_cast<CTile *>(m_pLayers->Map()->GetData(m_pLayers->FrontLayer()->m_Front));
 	}
 
+	if(m_pSwitch)
+		SanitizeSwitchLayer(m_pLayers);
+
 	for(int i = 0; i < m_Width * m_Height; i++)
 	{
-		int Index;
 		if(m_pSwitch)
 		{
 			if(m_pSwitch[i].m_Number > m_HighestSwitchNumber)
@@ -106,16 +130,6 @@ void CCollision::Init(class CLayers *pLayers)
 				m_pDoor[i].m_Number = m_pSwitch[i].m_Number;
 			else
 				m_pDoor[i].m_Number = 0;
-
-			Index = m_pSwitch[i].m_Type;
-
-			if(Index <= TILE_NPH_ENABLE)
-			{
-				if((Index >= TILE_JUMP && Index <= TILE_SUBTRACT_TIME) || Index == TILE_ALLOW_TELE_GUN || Index == TILE_ALLOW_BLUE_TELE_GUN)
-					m_pSwitch[i].m_Type = Index;
-				else
-					m_pSwitch[i].m_Type = 0;
-			}
 		}
 	}
 
@@ -325,30 +339,64 @@ int CCollision::GetTile(int x, int y) const
 	return 0;
 }
 
-// TODO: rewrite this smarter!
-int CCollision::IntersectLine(vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision) const
+static int FloorDivTile(int Coord)
 {
-	float Distance = distance(Pos0, Pos1);
-	int End(Distance + 1);
-	vec2 Last = Pos0;
-	for(int i = 0; i <= End; i++)
-	{
-		float a = i / (float)End;
-		vec2 Pos = mix(Pos0, Pos1, a);
-		// Temporary position for checking collision
-		int ix = round_to_int(Pos.x);
-		int iy = round_to_int(Pos.y);
+	return Coord >= 0 ? Coord / 32 : -((31 - Coord) / 32);
+}
+
+// Tile that a line sample falls into. Every tile lookup done while
+// intersecting (clamped map indices, through offsets, teleporters) only
+// depends on this, so all samples within one tile give the same answer.
+static ivec2 SampleTile(vec2 Pos)
+{
+	return ivec2(FloorDivTile(round_to_int(Pos.x)), FloorDivTile(round_to_int(Pos.y)));
+}
 
-		if(CheckPoint(ix, iy))
+// Visits the samples mix(Pos0, Pos1, i / Divisor) for 0 <= i < NumSamples in
+// the same order as stepping through them one by one, but calls HitAt only for
+// the first sample of every tile the line crosses. Both sample coordinates are
+// monotonic in i, so the samples inside one tile form a consecutive run; its
+// end is estimated from where the line leaves the tile and then corrected
+// against the actual samples, which keeps the result bit-identical.
+template<typename THitAt>
+static int IntersectTiles(vec2 Pos0, vec2 Pos1, int NumSamples, float Divisor, THitAt &&HitAt, vec2 *pOutCollision, vec2 *pOutBeforeCollision)
+{
+	const vec2 Delta = Pos1 - Pos0;
+	const auto &&Sample = [&](int i) {
+		return mix(Pos0, Pos1, i / Divisor);
+	};
+
+	int i = 0;
+	while(i < NumSamples)
+	{
+		const vec2 Pos = Sample(i);
+		int Result;
+		if(HitAt(Pos, &Result))
 		{
 			if(pOutCollision)
 				*pOutCollision = Pos;
 			if(pOutBeforeCollision)
-				*pOutBeforeCollision = Last;
-			return GetCollisionAt(ix, iy);
+				*pOutBeforeCollision = i > 0 ? Sample(i - 1) : Pos0;
+			return Result;
 		}
 
-		Last = Pos;
+		const ivec2 Tile = SampleTile(Pos);
+		double Exit = NumSamples;
+		if(Delta.x > 0.0f)
+			Exit = std::min(Exit, (Tile.x * 32 + 31.5 - Pos0.x) / Delta.x * Divisor);
+		else if(Delta.x < 0.0f)
+			Exit = std::min(Exit, (Tile.x * 32 - 0.5 - Pos0.x) / Delta.x * Divisor);
+		if(Delta.y > 0.0f)
+			Exit = std::min(Exit, (Tile.y * 32 + 31.5 - Pos0.y) / Delta.y * Divisor);
+		else if(Delta.y < 0.0f)
+			Exit = std::min(Exit, (Tile.y * 32 - 0.5 - Pos0.y) / Delta.y * Divisor);
+
+		int Last = clamp((int)std::ceil(std::max(Exit, (double)i)) - 1, i, NumSamples - 1);
+		while(Last > i && SampleTile(Sample(Last)) != Tile)
+			Last--;
+		while(Last + 1 < NumSamples && SampleTile(Sample(Last + 1)) == Tile)
+			Last++;
+		i = Last + 1;
 	}
 	if(pOutCollision)
 		*pOutCollision = Pos1;
@@ -357,112 +405,98 @@ int CCollision::IntersectLine(vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *p
 	return 0;
 }
 
+int CCollision::IntersectLine(vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision) const
+{
+	float Distance = distance(Pos0, Pos1);
+	int End(Distance + 1);
+	return IntersectTiles(
+		Pos0, Pos1, End + 1, End, [&](vec2 Pos, int *pResult) {
+			int ix = round_to_int(Pos.x);
+			int iy = round_to_int(Pos.y);
+			if(!CheckPoint(ix, iy))
+				return false;
+			*pResult = GetCollisionAt(ix, iy);
+			return true;
+		},
+		pOutCollision, pOutBeforeCollision);
+}
+
 int CCollision::IntersectLineTeleHook(vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision, int *pTeleNr) const
 {
 	float Distance = distance(Pos0, Pos1);
 	int End(Distance + 1);
-	vec2 Last = Pos0;
 	int dx = 0, dy = 0; // Offset for checking the "through" tile
 	ThroughOffset(Pos0, Pos1, &dx, &dy);
-	for(int i = 0; i <= End; i++)
-	{
-		float a = i / (float)End;
-		vec2 Pos = mix(Pos0, Pos1, a);
-		// Temporary position for checking collision
-		int ix = round_to_int(Pos.x);
-		int iy = round_to_int(Pos.y);
-
-		int Index = GetPureMapIndex(Pos);
-		if(pTeleNr)
-		{
-			if(g_Config.m_SvOldTeleportHook)
-				*pTeleNr = IsTeleport(Index);
-			else
-				*pTeleNr = IsTeleportHook(Index);
-		}
-		if(pTeleNr && *pTeleNr)
-		{
-			if(pOutCollision)
-				*pOutCollision = Pos;
-			if(pOutBeforeCollision)
-				*pOutBeforeCollision = Last;
-			return TILE_TELEINHOOK;
-		}
-
-		int hit = 0;
-		if(CheckPoint(ix, iy))
-		{
-			if(!IsThrough(ix, iy, dx, dy, Pos0, Pos1))
-				hit = GetCollisionAt(ix, iy);
-		}
-		else if(IsHookBlocker(ix, iy, Pos0, Pos1))
-		{
-			hit = TILE_NOHOOK;
-		}
-		if(hit)
-		{
-			if(pOutCollision)
-				*pOutCollision = Pos;
-			if(pOutBeforeCollision)
-				*pOutBeforeCollision = Last;
-			return hit;
-		}
+	if(pTeleNr)
+		*pTeleNr = 0;
+	return IntersectTiles(
+		Pos0, Pos1, End + 1, End, [&](vec2 Pos, int *pResult) {
+			// Temporary position for checking collision
+			int ix = round_to_int(Pos.x);
+			int iy = round_to_int(Pos.y);
+
+			int Index = GetPureMapIndex(Pos);
+			if(pTeleNr)
+			{
+				if(g_Config.m_SvOldTeleportHook)
+					*pTeleNr = IsTeleport(Index);
+				else
+					*pTeleNr = IsTeleportHook(Index);
+			}
+			if(pTeleNr && *pTeleNr)
+			{
+				*pResult = TILE_TELEINHOOK;
+				return true;
+			}
 
-		Last = Pos;
-	}
-	if(pOutCollision)
-		*pOutCollision = Pos1;
-	if(pOutBeforeCollision)
-		*pOutBeforeCollision = Pos1;
-	return 0;
+			int hit = 0;
+			if(CheckPoint(ix, iy))
+			{
+				if(!IsThrough(ix, iy, dx, dy, Pos0, Pos1))
+					hit = GetCollisionAt(ix, iy);
+			}
+			else if(IsHookBlocker(ix, iy, Pos0, Pos1))
+			{
+				hit = TILE_NOHOOK;
+			}
+			*pResult = hit;
+			return hit != 0;
+		},
+		pOutCollision, pOutBeforeCollision);
 }
 
 int CCollision::IntersectLineTeleWeapon(vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision, int *pTeleNr) const
 {
 	float Distance = distance(Pos0, Pos1);
 	int End(Distance + 1);
-	vec2 Last = Pos0;
-	for(int i = 0; i <= End; i++)
-	{
-		float a = i / (float)End;
-		vec2 Pos = mix(Pos0, Pos1, a);
-		// Temporary position for checking collision
-		int ix = round_to_int(Pos.x);
-		int iy = round_to_int(Pos.y);
-
-		int Index = GetPureMapIndex(Pos);
-		if(pTeleNr)
-		{
-			if(g_Config.m_SvOldTeleportWeapons)
-				*pTeleNr = IsTeleport(Index);
-			else
-				*pTeleNr = IsTeleportWeapon(Index);
-		}
-		if(pTeleNr && *pTeleNr)
-		{
-			if(pOutCollision)
-				*pOutCollision = Pos;
-			if(pOutBeforeCollision)
-				*pOutBeforeCollision = Last;
-			return TILE_TELEINWEAPON;
-		}
-
-		if(CheckPoint(ix, iy))
-		{
-			if(pOutCollision)
-				*pOutCollision = Pos;
-			if(pOutBeforeCollision)
-				*pOutBeforeCollision = Last;
-			return GetCollisionAt(ix, iy);
-		}
+	if(pTeleNr)
+		*pTeleNr = 0;
+	return IntersectTiles(
+		Pos0, Pos1, End + 1, End, [&](vec2 Pos, int *pResult) {
+			// Temporary position for checking collision
+			int ix = round_to_int(Pos.x);
+			int iy = round_to_int(Pos.y);
+
+			int Index = GetPureMapIndex(Pos);
+			if(pTeleNr)
+			{
+				if(g_Config.m_SvOldTeleportWeapons)
+					*pTeleNr = IsTeleport(Index);
+				else
+					*pTeleNr = IsTeleportWeapon(Index);
+			}
+			if(pTeleNr && *pTeleNr)
+			{
+				*pResult = TILE_TELEINWEAPON;
+				return true;
+			}
 
-		Last = Pos;
-	}
-	if(pOutCollision)
-		*pOutCollision = Pos1;
-	if(pOutBeforeCollision)
-		*pOutBeforeCollision = Pos1;
-	return 0;
+			if(!CheckPoint(ix, iy))
+				return false;
+			*pResult = GetCollisionAt(ix, iy);
+			return true;
+		},
+		pOutCollision, pOutBeforeCollision);
 }
 
 // TODO: OPT: rewrite this smarter!
@@ -1140,92 +1174,59 @@ void ThroughOffset(vec2 Pos0, vec2 Pos1, int *pOffsetX, int *pOffsetY)
 int CCollision::IntersectNoLaser(vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision) const
 {
 	float d = distance(Pos0, Pos1);
-	vec2 Last = Pos0;
-
-	for(int i = 0, id = std::ceil(d); i < id; i++)
-	{
-		float a = i / d;
-		vec2 Pos = mix(Pos0, Pos1, a);
-		int Nx = clamp(round_to_int(Pos.x) / 32, 0, m_Width - 1);
-		int Ny = clamp(round_to_int(Pos.y) / 32, 0, m_Height - 1);
-		if(GetIndex(Nx, Ny) == TILE_SOLID || GetIndex(Nx, Ny) == TILE_NOHOOK || GetIndex(Nx, Ny) == TILE_NOLASER || GetFrontIndex(Nx, Ny) == TILE_NOLASER)
-		{
-			if(pOutCollision)
-				*pOutCollision = Pos;
-			if(pOutBeforeCollision)
-				*pOutBeforeCollision = Last;
-			if(GetFrontIndex(Nx, Ny) == TILE_NOLASER)
-				return GetFrontCollisionAt(Pos.x, Pos.y);
-			else
-				return GetCollisionAt(Pos.x, Pos.y);
-		}
-		Last = Pos;
-	}
-	if(pOutCollision)
-		*pOutCollision = Pos1;
-	if(pOutBeforeCollision)
-		*pOutBeforeCollision = Pos1;
-	return 0;
+	return IntersectTiles(
+		Pos0, Pos1, (int)std::ceil(d), d, [&](vec2 Pos, int *pResult) {
+			int Nx = clamp(round_to_int(Pos.x) / 32, 0, m_Width - 1);
+			int Ny = clamp(round_to_int(Pos.y) / 32, 0, m_Height - 1);
+			if(GetIndex(Nx, Ny) == TILE_SOLID || GetIndex(Nx, Ny) == TILE_NOHOOK || GetIndex(Nx, Ny) == TILE_NOLASER || GetFrontIndex(Nx, Ny) == TILE_NOLASER)
+			{
+				if(GetFrontIndex(Nx, Ny) == TILE_NOLASER)
+					*pResult = GetFrontCollisionAt(Pos.x, Pos.y);
+				else
+					*pResult = GetCollisionAt(Pos.x, Pos.y);
+				return true;
+			}
+			return false;
+		},
+		pOutCollision, pOutBeforeCollision);
 }
 
 int CCollision::IntersectNoLaserNoWalls(vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision) const
 {
 	float d = distance(Pos0, Pos1);
-	vec2 Last = Pos0;
-
-	for(int i = 0, id = std::ceil(d); i < id; i++)
-	{
-		float a = (float)i / d;
-		vec2 Pos = mix(Pos0, Pos1, a);
-		if(IsNoLaser(round_to_int(Pos.x), round_to_int(Pos.y)) || IsFrontNoLaser(round_to_int(Pos.x), round_to_int(Pos.y)))
-		{
-			if(pOutCollision)
-				*pOutCollision = Pos;
-			if(pOutBeforeCollision)
-				*pOutBeforeCollision = Last;
-			if(IsNoLaser(round_to_int(Pos.x), round_to_int(Pos.y)))
-				return GetCollisionAt(Pos.x, Pos.y);
-			else
-				return GetFrontCollisionAt(Pos.x, Pos.y);
-		}
-		Last = Pos;
-	}
-	if(pOutCollision)
-		*pOutCollision = Pos1;
-	if(pOutBeforeCollision)
-		*pOutBeforeCollision = Pos1;
-	return 0;
+	return IntersectTiles(
+		Pos0, Pos1, (int)std::ceil(d), d, [&](vec2 Pos, int *pResult) {
+			if(IsNoLaser(round_to_int(Pos.x), round_to_int(Pos.y)) || IsFrontNoLaser(round_to_int(Pos.x), round_to_int(Pos.y)))
+			{
+				if(IsNoLaser(round_to_int(Pos.x), round_to_int(Pos.y)))
+					*pResult = GetCollisionAt(Pos.x, Pos.y);
+				else
+					*pResult = GetFrontCollisionAt(Pos.x, Pos.y);
+				return true;
+			}
+			return false;
+		},
+		pOutCollision, pOutBeforeCollision);
 }
 
 int CCollision::IntersectAir(vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision) const
 {
 	float d = distance(Pos0, Pos1);
-	vec2 Last = Pos0;
-
-	for(int i = 0, id = std::ceil(d); i < id; i++)
-	{
-		float a = (float)i / d;
-		vec2 Pos = mix(Pos0, Pos1, a);
-		if(IsSolid(round_to_int(Pos.x), round_to_int(Pos.y)) || (!GetTile(round_to_int(Pos.x), round_to_int(Pos.y)) && !GetFrontTile(round_to_int(Pos.x), round_to_int(Pos.y))))
-		{
-			if(pOutCollision)
-				*pOutCollision = Pos;
-			if(pOutBeforeCollision)
-				*pOutBeforeCollision = Last;
-			if(!GetTile(round_to_int(Pos.x), round_to_int(Pos.y)) && !GetFrontTile(round_to_int(Pos.x), round_to_int(Pos.y)))
-				return -1;
-			else if(!GetTile(round_to_int(Pos.x), round_to_int(Pos.y)))
-				return GetTile(round_to_int(Pos.x), round_to_int(Pos.y));
-			else
-				return GetFrontTile(round_to_int(Pos.x), round_to_int(Pos.y));
-		}
-		Last = Pos;
-	}
-	if(pOutCollision)
-		*pOutCollision = Pos1;
-	if(pOutBeforeCollision)
-		*pOutBeforeCollision = Pos1;
-	return 0;
+	return IntersectTiles(
+		Pos0, Pos1, (int)std::ceil(d), d, [&](vec2 Pos, int *pResult) {
+			if(IsSolid(round_to_int(Pos.x), round_to_int(Pos.y)) || (!GetTile(round_to_int(Pos.x), round_to_int(Pos.y)) && !GetFrontTile(round_to_int(Pos.x), round_to_int(Pos.y))))
+			{
+				if(!GetTile(round_to_int(Pos.x), round_to_int(Pos.y)) && !GetFrontTile(round_to_int(Pos.x), round_to_int(Pos.y)))
+					*pResult = -1;
+				else if(!GetTile(round_to_int(Pos.x), round_to_int(Pos.y)))
+					*pResult = GetTile(round_to_int(Pos.x), round_to_int(Pos.y));
+				else
+					*pResult = GetFrontTile(round_to_int(Pos.x), round_to_int(Pos.y));
+				return true;
+			}
+			return false;
+		},
+		pOutCollision, pOutBeforeCollision);
 }
 
 int CCollision::IsTimeCheckpoint(int Index) const
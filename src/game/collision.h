@@ -38,6 +38,11 @@ public:
 
 	void Init(CLayers *pLayers);
 	void Unload();
+	/**
+	 * Clears unsupported switch tile types in the map data. Init does this as well, but it can be
+	 * called earlier when other threads read the switch layer while collision is initialized.
+	 */
+	static void SanitizeSwitchLayer(CLayers *pLayers);
 	void FillAntibot(CAntibotMapData *pMapData) const;
 
 	bool CheckPoint(float x, float y) const { return IsSolid(round_to_int(x), round_to_int(y)); }
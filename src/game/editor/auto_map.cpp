@@ -449,6 +449,8 @@ void CAutoMapper::ProceedLocalized(CLayerTiles *pLayer, CLayerTiles *pGameLayer,
 			pGameLayer->RecordStateChange(x, y, PreviousGame, *pOutGame);
 		}
 	}
+	pLayer->InvalidateRender(CommitFromX, CommitFromY, CommitToX - CommitFromX, CommitToY - CommitFromY);
+	pGameLayer->InvalidateRender(CommitFromX, CommitFromY, CommitToX - CommitFromX, CommitToY - CommitFromY);
 
 	delete pUpdateLayer;
 	delete pUpdateGame;
@@ -605,4 +607,6 @@ void CAutoMapper::Proceed(CLayerTiles *pLayer, CLayerTiles *pGameLayer, int Refe
 		if(pRun->m_AutomapCopy && pReadLayer != pLayer)
 			delete pReadLayer;
 	}
+
+	pLayer->InvalidateRender();
 }
@@ -9393,6 +9393,7 @@ void CEditor::AdjustBrushSpecialTiles(bool UseNextFree, int Adjust)
 			continue;
 
 		std::shared_ptr<CLayerTiles> pLayerTiles = std::static_pointer_cast<CLayerTiles>(pLayer);
+		pLayerTiles->InvalidateRender();
 
 		if(pLayerTiles->m_HasTele)
 		{
@@ -256,15 +256,17 @@ class CDataFileWriterFinishJob : public IJob
 	char m_aRealFileName[IO_MAX_PATH_LENGTH];
 	char m_aTempFileName[IO_MAX_PATH_LENGTH];
 	CDataFileWriter m_Writer;
+	std::function<void(std::shared_ptr<IJob>)> m_AddJob;
 
 	void Run() override
 	{
-		m_Writer.Finish();
+		m_Writer.Finish(m_AddJob);
 	}
 
 public:
-	CDataFileWriterFinishJob(const char *pRealFileName, const char *pTempFileName, CDataFileWriter &&Writer) :
-		m_Writer(std::move(Writer))
+	CDataFileWriterFinishJob(const char *pRealFileName, const char *pTempFileName, CDataFileWriter &&Writer, std::function<void(std::shared_ptr<IJob>)> &&AddJob = nullptr) :
+		m_Writer(std::move(Writer)),
+		m_AddJob(std::move(AddJob))
 	{
 		str_copy(m_aRealFileName, pRealFileName);
 		str_copy(m_aTempFileName, pTempFileName);
@@ -171,6 +171,7 @@ void CEditorBrushDrawAction::Apply(bool Undo)
 			Map.m_pSpeedupLayer->m_pSpeedupTile[Index].m_Angle = Data.m_Angle;
 			Map.m_pSpeedupLayer->m_pSpeedupTile[Index].m_Type = Data.m_Type;
 			Map.m_pSpeedupLayer->m_pTiles[Index].m_Index = Data.m_Index;
+			Map.m_pSpeedupLayer->InvalidateRender(x, y, 1, 1);
 		}
 	}
 
@@ -189,6 +190,7 @@ void CEditorBrushDrawAction::Apply(bool Undo)
 			Map.m_pTeleLayer->m_pTeleTile[Index].m_Number = Data.m_Number;
 			Map.m_pTeleLayer->m_pTeleTile[Index].m_Type = Data.m_Type;
 			Map.m_pTeleLayer->m_pTiles[Index].m_Index = Data.m_Index;
+			Map.m_pTeleLayer->InvalidateRender(x, y, 1, 1);
 		}
 	}
 
@@ -209,6 +211,7 @@ void CEditorBrushDrawAction::Apply(bool Undo)
 			Map.m_pSwitchLayer->m_pSwitchTile[Index].m_Flags = Data.m_Flags;
 			Map.m_pSwitchLayer->m_pSwitchTile[Index].m_Delay = Data.m_Delay;
 			Map.m_pSwitchLayer->m_pTiles[Index].m_Index = Data.m_Index;
+			Map.m_pSwitchLayer->InvalidateRender(x, y, 1, 1);
 		}
 	}
 
@@ -227,6 +230,7 @@ void CEditorBrushDrawAction::Apply(bool Undo)
 			Map.m_pTuneLayer->m_pTuneTile[Index].m_Number = Data.m_Number;
 			Map.m_pTuneLayer->m_pTuneTile[Index].m_Type = Data.m_Type;
 			Map.m_pTuneLayer->m_pTiles[Index].m_Index = Data.m_Index;
+			Map.m_pTuneLayer->InvalidateRender(x, y, 1, 1);
 		}
 	}
 }
@@ -1049,6 +1053,7 @@ void CEditorActionEditLayerTilesProp::RestoreLayer(int Layer, const std::shared_
 	{
 		std::shared_ptr<CLayerTiles> pSavedLayerTiles = std::static_pointer_cast<CLayerTiles>(m_SavedLayers[Layer]);
 		mem_copy(pLayerTiles->m_pTiles, pSavedLayerTiles->m_pTiles, (size_t)pLayerTiles->m_Width * pLayerTiles->m_Height * sizeof(CTile));
+		pLayerTiles->InvalidateRender();
 
 		if(pLayerTiles->m_HasTele)
 		{
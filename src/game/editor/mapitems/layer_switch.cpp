@@ -216,6 +216,7 @@ void CLayerSwitch::BrushRotate(float Amount)
 		std::swap(m_Width, m_Height);
 		delete[] pTempData1;
 		delete[] pTempData2;
+		InvalidateRender();
 	}
 
 	if(Rotation == 2 || Rotation == 3)
@@ -73,6 +73,7 @@ CLayerTiles::CLayerTiles(const CLayerTiles &Other) :
 
 CLayerTiles::~CLayerTiles()
 {
+	FreeRenderChunks();
 	delete[] m_pTiles;
 }
 
@@ -96,9 +97,10 @@ void CLayerTiles::SetTile(int x, int y, CTile Tile)
 	}
 }
 
-void CLayerTiles::SetTileIgnoreHistory(int x, int y, CTile Tile) const
+void CLayerTiles::SetTileIgnoreHistory(int x, int y, CTile Tile)
 {
 	m_pTiles[y * m_Width + x] = Tile;
+	InvalidateRender(x, y, 1, 1);
 }
 
 void CLayerTiles::RecordStateChange(int x, int y, CTile Previous, CTile Tile)
@@ -132,11 +134,12 @@ void CLayerTiles::ExtractTiles(int TilemapItemVersion, const CTile *pSavedTiles,
 		mem_copy(m_pTiles, pSavedTiles, DestSize * sizeof(CTile));
 }
 
-void CLayerTiles::MakePalette() const
+void CLayerTiles::MakePalette()
 {
 	for(int y = 0; y < m_Height; y++)
 		for(int x = 0; x < m_Width; x++)
 			m_pTiles[y * m_Width + x].m_Index = y * 16 + x;
+	InvalidateRender();
 }
 
 void CLayerTiles::Render(bool Tileset)
@@ -162,23 +165,238 @@ void CLayerTiles::Render(bool Tileset)
 	CEditor::EnvelopeEval(m_ColorEnvOffset, m_ColorEnv, ColorEnv, 4, m_pEditor);
 	const ColorRGBA Color = ColorRGBA(m_Color.r / 255.0f, m_Color.g / 255.0f, m_Color.b / 255.0f, m_Color.a / 255.0f).Multiply(ColorEnv);
 
-	Graphics()->BlendNone();
-	m_pEditor->RenderTools()->RenderTilemap(m_pTiles, m_Width, m_Height, 32.0f, Color, LAYERRENDERFLAG_OPAQUE);
-	Graphics()->BlendNormal();
-	m_pEditor->RenderTools()->RenderTilemap(m_pTiles, m_Width, m_Height, 32.0f, Color, LAYERRENDERFLAG_TRANSPARENT);
+	if(Graphics()->IsTileBufferingEnabled())
+	{
+		Graphics()->BlendNormal();
+		RenderBuffered(Texture.IsValid(), Color);
+	}
+	else
+	{
+		Graphics()->BlendNone();
+		m_pEditor->RenderTools()->RenderTilemap(m_pTiles, m_Width, m_Height, 32.0f, Color, LAYERRENDERFLAG_OPAQUE);
+		Graphics()->BlendNormal();
+		m_pEditor->RenderTools()->RenderTilemap(m_pTiles, m_Width, m_Height, 32.0f, Color, LAYERRENDERFLAG_TRANSPARENT);
+	}
 
 	// Render DDRace Layers
 	if(!Tileset)
 	{
 		int OverlayRenderFlags = (g_Config.m_ClTextEntitiesEditor ? OVERLAYRENDERFLAG_TEXT : 0) | OVERLAYRENDERFLAG_EDITOR;
-		if(m_HasTele)
-			m_pEditor->RenderTools()->RenderTeleOverlay(static_cast<CLayerTele *>(this)->m_pTeleTile, m_Width, m_Height, 32.0f, OverlayRenderFlags);
-		if(m_HasSpeedup)
-			m_pEditor->RenderTools()->RenderSpeedupOverlay(static_cast<CLayerSpeedup *>(this)->m_pSpeedupTile, m_Width, m_Height, 32.0f, OverlayRenderFlags);
-		if(m_HasSwitch)
-			m_pEditor->RenderTools()->RenderSwitchOverlay(static_cast<CLayerSwitch *>(this)->m_pSwitchTile, m_Width, m_Height, 32.0f, OverlayRenderFlags);
-		if(m_HasTune)
-			m_pEditor->RenderTools()->RenderTuneOverlay(static_cast<CLayerTune *>(this)->m_pTuneTile, m_Width, m_Height, 32.0f, OverlayRenderFlags);
+		RenderOverlay(OverlayRenderFlags);
+	}
+}
+
+void CLayerTiles::FreeRenderChunks()
+{
+	for(SRenderChunk &Chunk : m_vRenderChunks)
+	{
+		if(Chunk.m_BufferContainerIndex != -1)
+			Graphics()->DeleteBufferContainer(Chunk.m_BufferContainerIndex, true);
+		TextRender()->DeleteTextContainer(Chunk.m_OverlayText);
+	}
+	m_vRenderChunks.clear();
+	m_RenderChunksWidth = 0;
+}
+
+bool CLayerTiles::VisibleRenderChunks(int &ChunkX0, int &ChunkY0, int &ChunkX1, int &ChunkY1)
+{
+	float ScreenX0, ScreenY0, ScreenX1, ScreenY1;
+	Graphics()->GetScreen(&ScreenX0, &ScreenY0, &ScreenX1, &ScreenY1);
+
+	const float ChunkSize = RENDER_CHUNK_SIZE * 32.0f;
+	ChunkX0 = maximum((int)std::floor(ScreenX0 / ChunkSize), 0);
+	ChunkY0 = maximum((int)std::floor(ScreenY0 / ChunkSize), 0);
+	ChunkX1 = minimum((int)std::ceil(ScreenX1 / ChunkSize), m_RenderChunksWidth);
+	ChunkY1 = minimum((int)std::ceil(ScreenY1 / ChunkSize), (m_Height + RENDER_CHUNK_SIZE - 1) / RENDER_CHUNK_SIZE);
+	return ChunkX0 < ChunkX1 && ChunkY0 < ChunkY1;
+}
+
+void CLayerTiles::UpdateRenderChunk(SRenderChunk &Chunk, int ChunkX, int ChunkY)
+{
+	if(!Chunk.m_Dirty)
+		return;
+	Chunk.m_Dirty = false;
+
+	const int X0 = ChunkX * RENDER_CHUNK_SIZE;
+	const int Y0 = ChunkY * RENDER_CHUNK_SIZE;
+	const int X1 = minimum(X0 + (int)RENDER_CHUNK_SIZE, m_Width);
+	const int Y1 = minimum(Y0 + (int)RENDER_CHUNK_SIZE, m_Height);
+
+	std::vector<SGraphicTile> vTiles;
+	std::vector<SGraphicTileTexureCoords> vTexCoords;
+	for(int y = Y0; y < Y1; y++)
+	{
+		for(int x = X0; x < X1; x++)
+		{
+			const CTile &Tile = m_pTiles[y * m_Width + x];
+			if(!Tile.m_Index)
+				continue;
+			vTiles.emplace_back();
+			if(m_RenderTextured)
+				vTexCoords.emplace_back();
+			CRenderTools::FillTileQuad(&vTiles.back(), m_RenderTextured ? &vTexCoords.back() : nullptr, Tile.m_Flags, Tile.m_Index, x, y, ivec2(0, 0), 32);
+		}
+	}
+
+	Chunk.m_NumTiles = vTiles.size();
+	if(Chunk.m_NumTiles == 0)
+		return; // keep the buffer around, the chunk is just not drawn
+
+	// interleave positions and texture coordinates per vertex
+	const size_t Stride = sizeof(vec2) + (m_RenderTextured ? sizeof(ubvec4) : 0);
+	const size_t NumVertices = vTiles.size() * 4;
+	const size_t UploadDataSize = NumVertices * Stride;
+	char *pUploadData = (char *)malloc(UploadDataSize);
+	const char *pPositions = (const char *)vTiles.data();
+	const char *pTexCoords = (const char *)vTexCoords.data();
+	for(size_t Vertex = 0; Vertex < NumVertices; Vertex++)
+	{
+		mem_copy(pUploadData + Vertex * Stride, pPositions + Vertex * sizeof(vec2), sizeof(vec2));
+		if(m_RenderTextured)
+			mem_copy(pUploadData + Vertex * Stride + sizeof(vec2), pTexCoords + Vertex * sizeof(ubvec4), sizeof(ubvec4));
+	}
+
+	if(Chunk.m_BufferContainerIndex != -1)
+	{
+		Graphics()->RecreateBufferObject(Chunk.m_BufferObjectIndex, UploadDataSize, pUploadData, 0, true);
+	}
+	else
+	{
+		Chunk.m_BufferObjectIndex = Graphics()->CreateBufferObject(UploadDataSize, pUploadData, 0, true);
+
+		SBufferContainerInfo ContainerInfo;
+		ContainerInfo.m_Stride = m_RenderTextured ? (sizeof(float) * 2 + sizeof(ubvec4)) : 0;
+		ContainerInfo.m_VertBufferBindingIndex = Chunk.m_BufferObjectIndex;
+		ContainerInfo.m_vAttributes.emplace_back();
+		SBufferContainerInfo::SAttribute *pAttr = &ContainerInfo.m_vAttributes.back();
+		pAttr->m_DataTypeCount = 2;
+		pAttr->m_Type = GRAPHICS_TYPE_FLOAT;
+		pAttr->m_Normalized = false;
+		pAttr->m_pOffset = nullptr;
+		pAttr->m_FuncType = 0;
+		if(m_RenderTextured)
+		{
+			ContainerInfo.m_vAttributes.emplace_back();
+			pAttr = &ContainerInfo.m_vAttributes.back();
+			pAttr->m_DataTypeCount = 4;
+			pAttr->m_Type = GRAPHICS_TYPE_UNSIGNED_BYTE;
+			pAttr->m_Normalized = false;
+			pAttr->m_pOffset = (void *)(sizeof(vec2));
+			pAttr->m_FuncType = 1;
+		}
+		Chunk.m_BufferContainerIndex = Graphics()->CreateBufferContainer(&ContainerInfo);
+	}
+	Graphics()->IndicesNumRequiredNotify(Chunk.m_NumTiles * 6);
+}
+
+void CLayerTiles::RenderBuffered(bool Textured, const ColorRGBA &Color)
+{
+	if(m_RenderWidth != m_Width || m_RenderHeight != m_Height || m_RenderTextured != Textured)
+	{
+		FreeRenderChunks();
+		m_RenderWidth = m_Width;
+		m_RenderHeight = m_Height;
+		m_RenderTextured = Textured;
+	}
+	if(m_vRenderChunks.empty())
+	{
+		m_RenderChunksWidth = (m_Width + RENDER_CHUNK_SIZE - 1) / RENDER_CHUNK_SIZE;
+		m_vRenderChunks.resize((size_t)m_RenderChunksWidth * ((m_Height + RENDER_CHUNK_SIZE - 1) / RENDER_CHUNK_SIZE));
+	}
+
+	int ChunkX0, ChunkY0, ChunkX1, ChunkY1;
+	if(!VisibleRenderChunks(ChunkX0, ChunkY0, ChunkX1, ChunkY1))
+		return;
+
+	for(int ChunkY = ChunkY0; ChunkY < ChunkY1; ChunkY++)
+	{
+		for(int ChunkX = ChunkX0; ChunkX < ChunkX1; ChunkX++)
+		{
+			SRenderChunk &Chunk = m_vRenderChunks[ChunkY * m_RenderChunksWidth + ChunkX];
+			UpdateRenderChunk(Chunk, ChunkX, ChunkY);
+			if(Chunk.m_NumTiles == 0)
+				continue;
+
+			char *pOffset = nullptr;
+			unsigned int DrawCount = Chunk.m_NumTiles * 6;
+			Graphics()->RenderTileLayer(Chunk.m_BufferContainerIndex, Color, &pOffset, &DrawCount, 1);
+		}
+	}
+}
+
+void CLayerTiles::UpdateOverlayChunk(SRenderChunk &Chunk, int ChunkX, int ChunkY, float Zoom, int OverlayRenderFlags)
+{
+	if(!Chunk.m_OverlayDirty && Chunk.m_OverlayZoom == Zoom && Chunk.m_OverlayFlags == OverlayRenderFlags && Chunk.m_OverlaySize == g_Config.m_ClTextEntitiesSize)
+		return;
+	Chunk.m_OverlayDirty = false;
+	Chunk.m_OverlayZoom = Zoom;
+	Chunk.m_OverlayFlags = OverlayRenderFlags;
+	Chunk.m_OverlaySize = g_Config.m_ClTextEntitiesSize;
+
+	const int X0 = ChunkX * RENDER_CHUNK_SIZE;
+	const int Y0 = ChunkY * RENDER_CHUNK_SIZE;
+	const int X1 = minimum(X0 + (int)RENDER_CHUNK_SIZE, m_Width);
+	const int Y1 = minimum(Y0 + (int)RENDER_CHUNK_SIZE, m_Height);
+
+	TextRender()->DeleteTextContainer(Chunk.m_OverlayText);
+	TextRender()->TextColor(1.0f, 1.0f, 1.0f, 1.0f);
+	if(m_HasTele)
+		m_pEditor->RenderTools()->CreateTeleOverlayText(Chunk.m_OverlayText, static_cast<CLayerTele *>(this)->m_pTeleTile, m_Width, m_Height, X0, Y0, X1, Y1, 32.0f);
+	else if(m_HasSpeedup)
+		m_pEditor->RenderTools()->CreateSpeedupOverlayText(Chunk.m_OverlayText, static_cast<CLayerSpeedup *>(this)->m_pSpeedupTile, m_Width, m_Height, X0, Y0, X1, Y1, 32.0f, OverlayRenderFlags);
+	else if(m_HasSwitch)
+		m_pEditor->RenderTools()->CreateSwitchOverlayText(Chunk.m_OverlayText, static_cast<CLayerSwitch *>(this)->m_pSwitchTile, m_Width, m_Height, X0, Y0, X1, Y1, 32.0f);
+	else if(m_HasTune)
+		m_pEditor->RenderTools()->CreateTuneOverlayText(Chunk.m_OverlayText, static_cast<CLayerTune *>(this)->m_pTuneTile, m_Width, m_Height, X0, Y0, X1, Y1, 32.0f);
+	TextRender()->TextColor(TextRender()->DefaultTextColor());
+}
+
+void CLayerTiles::RenderOverlay(int OverlayRenderFlags)
+{
+	if(!m_HasTele && !m_HasSpeedup && !m_HasSwitch && !m_HasTune)
+		return;
+
+	float ScreenX0, ScreenY0, ScreenX1, ScreenY1;
+	Graphics()->GetScreen(&ScreenX0, &ScreenY0, &ScreenX1, &ScreenY1);
+
+	const int StartY = (int)(ScreenY0 / 32.0f) - 1;
+	const int StartX = (int)(ScreenX0 / 32.0f) - 1;
+	const int EndY = (int)(ScreenY1 / 32.0f) + 1;
+	const int EndX = (int)(ScreenX1 / 32.0f) + 1;
+	if(EndX - StartX > Graphics()->ScreenWidth() / g_Config.m_GfxTextOverlay || EndY - StartY > Graphics()->ScreenHeight() / g_Config.m_GfxTextOverlay)
+		return; // its useless to render text at this distance
+
+	if(m_HasSpeedup)
+		m_pEditor->RenderTools()->RenderSpeedupArrows(static_cast<CLayerSpeedup *>(this)->m_pSpeedupTile, m_Width, m_Height, StartX, StartY, EndX, EndY, 32.0f, OverlayRenderFlags);
+
+	if(!(OverlayRenderFlags & OVERLAYRENDERFLAG_TEXT))
+		return;
+
+	// the chunks share the buffered tile chunks, which may not exist without tile buffering
+	if(m_RenderWidth != m_Width || m_RenderHeight != m_Height || m_vRenderChunks.empty())
+	{
+		FreeRenderChunks();
+		m_RenderWidth = m_Width;
+		m_RenderHeight = m_Height;
+		m_RenderChunksWidth = (m_Width + RENDER_CHUNK_SIZE - 1) / RENDER_CHUNK_SIZE;
+		m_vRenderChunks.resize((size_t)m_RenderChunksWidth * ((m_Height + RENDER_CHUNK_SIZE - 1) / RENDER_CHUNK_SIZE));
+	}
+
+	int ChunkX0, ChunkY0, ChunkX1, ChunkY1;
+	if(!VisibleRenderChunks(ChunkX0, ChunkY0, ChunkX1, ChunkY1))
+		return;
+
+	// glyphs are rasterized for the font size in screen pixels, so the text has to be rebuilt when zooming
+	const float Zoom = Graphics()->ScreenHeight() / (ScreenY1 - ScreenY0);
+	for(int ChunkY = ChunkY0; ChunkY < ChunkY1; ChunkY++)
+	{
+		for(int ChunkX = ChunkX0; ChunkX < ChunkX1; ChunkX++)
+		{
+			SRenderChunk &Chunk = m_vRenderChunks[ChunkY * m_RenderChunksWidth + ChunkX];
+			UpdateOverlayChunk(Chunk, ChunkX, ChunkY, Zoom, OverlayRenderFlags);
+			if(Chunk.m_OverlayText.Valid())
+				TextRender()->RenderTextContainer(Chunk.m_OverlayText, TextRender()->DefaultTextColor(), TextRender()->DefaultTextOutlineColor());
+		}
 	}
 }
 
@@ -591,6 +809,7 @@ void CLayerTiles::BrushDraw(std::shared_ptr<CLayer> pBrush, vec2 WorldPos)
 void CLayerTiles::BrushFlipX()
 {
 	BrushFlipXImpl(m_pTiles);
+	InvalidateRender();
 
 	if(m_HasTele || m_HasSpeedup || m_HasTune)
 		return;
@@ -607,6 +826,7 @@ void CLayerTiles::BrushFlipX()
 void CLayerTiles::BrushFlipY()
 {
 	BrushFlipYImpl(m_pTiles);
+	InvalidateRender();
 
 	if(m_HasTele || m_HasSpeedup || m_HasTune)
 		return;
@@ -649,6 +869,7 @@ void CLayerTiles::BrushRotate(float Amount)
 
 		std::swap(m_Width, m_Height);
 		delete[] pTempData;
+		InvalidateRender();
 	}
 
 	if(Rotation == 2 || Rotation == 3)
@@ -682,6 +903,7 @@ void CLayerTiles::Resize(int NewW, int NewH)
 	m_pTiles = pNewData;
 	m_Width = NewW;
 	m_Height = NewH;
+	InvalidateRender();
 
 	// resize tele layer if available
 	if(m_HasGame && m_pEditor->m_Map.m_pTeleLayer && (m_pEditor->m_Map.m_pTeleLayer->m_Width != NewW || m_pEditor->m_Map.m_pTeleLayer->m_Height != NewH))
@@ -707,6 +929,7 @@ void CLayerTiles::Resize(int NewW, int NewH)
 void CLayerTiles::Shift(int Direction)
 {
 	ShiftImpl(m_pTiles, Direction, m_pEditor->m_ShiftBy);
+	InvalidateRender();
 }
 
 void CLayerTiles::ShowInfo()
@@ -933,6 +1156,7 @@ void CLayerTiles::FillGameTiles(EGameTileOp Fill)
 					}
 				}
 			}
+			pTLayer->InvalidateRender();
 
 			vpActions.push_back(std::make_shared<CEditorBrushDrawAction>(m_pEditor, GameGroupIndex));
 			char aDisplay[256];
@@ -1341,9 +1565,35 @@ CUi::EPopupMenuFunctionResult CLayerTiles::RenderCommonProperties(SCommonPropSta
 	return CUi::POPUP_KEEP_OPEN;
 }
 
+void CLayerTiles::InvalidateRender(int x, int y, int w, int h)
+{
+	if(m_RenderChunksWidth == 0)
+		return;
+	// the chunk grid is only rebuilt on the next render after a resize, so clamp to it
+	const int NumChunksY = (int)m_vRenderChunks.size() / m_RenderChunksWidth;
+	for(int ChunkY = maximum(y / RENDER_CHUNK_SIZE, 0); ChunkY <= minimum((y + h - 1) / RENDER_CHUNK_SIZE, NumChunksY - 1); ChunkY++)
+	{
+		for(int ChunkX = maximum(x / RENDER_CHUNK_SIZE, 0); ChunkX <= minimum((x + w - 1) / RENDER_CHUNK_SIZE, m_RenderChunksWidth - 1); ChunkX++)
+		{
+			m_vRenderChunks[ChunkY * m_RenderChunksWidth + ChunkX].m_Dirty = true;
+			m_vRenderChunks[ChunkY * m_RenderChunksWidth + ChunkX].m_OverlayDirty = true;
+		}
+	}
+}
+
+void CLayerTiles::InvalidateRender()
+{
+	for(SRenderChunk &Chunk : m_vRenderChunks)
+	{
+		Chunk.m_Dirty = true;
+		Chunk.m_OverlayDirty = true;
+	}
+}
+
 void CLayerTiles::FlagModified(int x, int y, int w, int h)
 {
 	m_pEditor->m_Map.OnModify();
+	InvalidateRender(x, y, w, h);
 	if(m_Seed != 0 && m_AutoMapperConfig != -1 && m_AutoAutoMap && m_Image >= 0)
 	{
 		m_pEditor->m_Map.m_vpImages[m_Image]->m_AutoMapper.ProceedLocalized(this, m_pEditor->m_Map.m_pGameLayer.get(), m_AutoMapperReference, m_AutoMapperConfig, m_Seed, x, y, w, h);
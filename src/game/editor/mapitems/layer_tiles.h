@@ -1,9 +1,12 @@
 #ifndef GAME_EDITOR_MAPITEMS_LAYER_TILES_H
 #define GAME_EDITOR_MAPITEMS_LAYER_TILES_H
 
+#include <engine/textrender.h>
+
 #include <game/editor/editor_trackers.h>
 #include <game/editor/enums.h>
 #include <map>
+#include <vector>
 
 #include "layer.h"
 
@@ -103,12 +106,12 @@ public:
 
 	virtual CTile GetTile(int x, int y);
 	virtual void SetTile(int x, int y, CTile Tile);
-	void SetTileIgnoreHistory(int x, int y, CTile Tile) const;
+	void SetTileIgnoreHistory(int x, int y, CTile Tile);
 
 	virtual void Resize(int NewW, int NewH);
 	virtual void Shift(int Direction);
 
-	void MakePalette() const;
+	void MakePalette();
 	void Render(bool Tileset = false) override;
 
 	int ConvertX(float x) const;
@@ -163,6 +166,9 @@ public:
 	}
 
 	void FlagModified(int x, int y, int w, int h);
+	// marks the render chunks covering the area for rebuilding, has to be called after writing tiles directly
+	void InvalidateRender(int x, int y, int w, int h);
+	void InvalidateRender();
 
 	bool m_HasGame;
 	int m_Image;
@@ -198,6 +204,39 @@ protected:
 
 	void ShowPreventUnusedTilesWarning();
 
+	// buffered rendering, the layer is split into chunks that are uploaded and drawn separately
+	enum
+	{
+		RENDER_CHUNK_SIZE = 64,
+	};
+
+	struct SRenderChunk
+	{
+		int m_BufferObjectIndex = -1;
+		int m_BufferContainerIndex = -1;
+		int m_NumTiles = 0;
+		bool m_Dirty = true;
+
+		STextContainerIndex m_OverlayText;
+		bool m_OverlayDirty = true;
+		float m_OverlayZoom = 0.0f;
+		int m_OverlayFlags = 0;
+		int m_OverlaySize = 0;
+	};
+
+	std::vector<SRenderChunk> m_vRenderChunks;
+	int m_RenderChunksWidth = 0;
+	int m_RenderWidth = 0;
+	int m_RenderHeight = 0;
+	bool m_RenderTextured = false;
+
+	void FreeRenderChunks();
+	bool VisibleRenderChunks(int &ChunkX0, int &ChunkY0, int &ChunkX1, int &ChunkY1);
+	void UpdateRenderChunk(SRenderChunk &Chunk, int ChunkX, int ChunkY);
+	void UpdateOverlayChunk(SRenderChunk &Chunk, int ChunkX, int ChunkY, float Zoom, int OverlayRenderFlags);
+	void RenderBuffered(bool Textured, const ColorRGBA &Color);
+	void RenderOverlay(int OverlayRenderFlags);
+
 	friend class CAutoMapper;
 };
 
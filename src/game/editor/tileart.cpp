@@ -136,6 +136,7 @@ static void SetTilelayerIndices(const std::shared_ptr<CLayerTiles> &pLayer, cons
 		for(int y = 0; y < pLayer->m_Height; y++)
 			pLayer->m_pTiles[x + y * pLayer->m_Width].m_Index = GetColorIndex(aColorGroup, Image.PixelColor(x, y));
 	}
+	pLayer->InvalidateRender();
 }
 
 void CEditor::AddTileart(bool IgnoreHistory)
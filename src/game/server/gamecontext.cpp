@@ -1042,6 +1042,15 @@ void CGameContext::OnTick()
 			m_TeeHistorian.EndInputs();
 			m_TeeHistorian.EndTick();
 		}
+
+		// don't keep a partial compressed frame back for long, it would be lost on a crash.
+		// Flush between ticks so that every frame starts with a tick record.
+		if(m_pTeeHistorianCompressor && Server()->Tick() % (Server()->TickSpeed() * CTeeHistorianCompressor::FLUSH_INTERVAL) == 0)
+		{
+			aio_flush(m_pTeeHistorianFile);
+			m_TeeHistorian.ExplicitNextTick();
+		}
+
 		m_TeeHistorian.BeginTick(Server()->Tick());
 		m_TeeHistorian.BeginPlayers();
 	}
@@ -3987,7 +3996,7 @@ void CGameContext::OnInit(const void *pPersistentData)
 		FormatUuid(m_GameUuid, aGameUuid, sizeof(aGameUuid));
 
 		char aFilename[IO_MAX_PATH_LENGTH];
-		str_format(aFilename, sizeof(aFilename), "teehistorian/%s.teehistorian", aGameUuid);
+		str_format(aFilename, sizeof(aFilename), "teehistorian/%s.teehistorian%s", aGameUuid, g_Config.m_SvTeeHistorianCompression ? ".z" : "");
 
 		IOHANDLE THFile = Storage()->OpenFile(aFilename, IOFLAG_WRITE, IStorage::TYPE_SAVE);
 		if(!THFile)
@@ -4000,7 +4009,16 @@ void CGameContext::OnInit(const void *pPersistentData)
 		{
 			dbg_msg("teehistorian", "recording to '%s'", aFilename);
 		}
-		m_pTeeHistorianFile = aio_new(THFile);
+		if(g_Config.m_SvTeeHistorianCompression)
+		{
+			// compression runs on the writer thread, not on the tick thread
+			m_pTeeHistorianCompressor = std::make_unique<CTeeHistorianCompressor>();
+			m_pTeeHistorianFile = aio_new_filtered(THFile, CTeeHistorianCompressor::Filter, m_pTeeHistorianCompressor.get());
+		}
+		else
+		{
+			m_pTeeHistorianFile = aio_new(THFile);
+		}
 
 		char aVersion[128];
 		if(GIT_SHORTREV_HASH)
@@ -4292,7 +4310,7 @@ void CGameContext::OnMapChange(char *pNewMapName, int MapNameSize)
 	Reader.Close();
 	char aTemp[IO_MAX_PATH_LENGTH];
 	Writer.Open(Storage(), IStorage::FormatTmpPath(aTemp, sizeof(aTemp), pNewMapName));
-	Writer.Finish();
+	Writer.Finish([this](std::shared_ptr<IJob> pJob) { Engine()->AddJob(std::move(pJob)); });
 
 	str_copy(pNewMapName, aTemp, MapNameSize);
 	str_copy(m_aDeleteTempfile, aTemp, sizeof(m_aDeleteTempfile));
@@ -4321,6 +4339,7 @@ void CGameContext::OnShutdown(void *pPersistentData)
 			Server()->SetErrorShutdown("teehistorian close error");
 		}
 		aio_free(m_pTeeHistorianFile);
+		m_pTeeHistorianCompressor = nullptr;
 	}
 
 	// Stop any demos being recorded.
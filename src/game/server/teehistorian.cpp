@@ -9,6 +9,8 @@
 
 #include <game/gamecore.h>
 
+#include <zlib.h>
+
 class CTeehistorianPacker : public CAbstractPacker
 {
 public:
@@ -63,6 +65,7 @@ void CTeeHistorian::Reset(const CGameInfo *pGameInfo, WRITE_CALLBACK pfnWriteCal
 	m_LastWrittenTick = 0;
 	// Tick 0 is implicit at the start, game starts as tick 1.
 	m_TickWritten = true;
+	m_ExplicitTick = false;
 	m_MaxClientId = MAX_CLIENTS;
 
 	// `m_PrevMaxClientId` is initialized in `BeginPlayers`
@@ -270,7 +273,7 @@ void CTeeHistorian::EnsureTickWrittenPlayerData(int ClientId)
 	dbg_assert(ClientId > m_MaxClientId, "invalid player data order");
 	m_MaxClientId = ClientId;
 
-	if(!m_TickWritten && (ClientId > m_PrevMaxClientId || m_LastWrittenTick + 1 != m_Tick))
+	if(!m_TickWritten && (m_ExplicitTick || ClientId > m_PrevMaxClientId || m_LastWrittenTick + 1 != m_Tick))
 	{
 		WriteTick();
 	}
@@ -419,6 +422,7 @@ void CTeeHistorian::WriteTick()
 	Write(TickPacker.Data(), TickPacker.Size());
 
 	m_TickWritten = true;
+	m_ExplicitTick = false;
 	m_LastWrittenTick = m_Tick;
 }
 
@@ -877,3 +881,99 @@ void CTeeHistorian::Finish()
 
 	Write(Buffer.Data(), Buffer.Size());
 }
+
+const unsigned char CTeeHistorianCompressor::MAGIC[8] = {'T', 'H', 'Z', 'L', 'I', 'B', 0, 1};
+
+int CTeeHistorianCompressor::Filter(IOHANDLE File, const void *pData, unsigned DataSize, void *pUser)
+{
+	CTeeHistorianCompressor *pSelf = (CTeeHistorianCompressor *)pUser;
+	if(pData == nullptr)
+	{
+		// flushed or about to be closed
+		return pSelf->WriteFrame(File);
+	}
+	return pSelf->Write(File, pData, DataSize);
+}
+
+int CTeeHistorianCompressor::Write(IOHANDLE File, const void *pData, unsigned DataSize)
+{
+	// split the data so that no frame gets larger than FRAME_SIZE
+	const unsigned char *pBytes = (const unsigned char *)pData;
+	while(DataSize > 0)
+	{
+		const unsigned Size = minimum<size_t>(DataSize, FRAME_SIZE - m_vFrame.size());
+		m_vFrame.insert(m_vFrame.end(), pBytes, pBytes + Size);
+		pBytes += Size;
+		DataSize -= Size;
+		if(m_vFrame.size() == FRAME_SIZE)
+		{
+			const int Result = WriteFrame(File);
+			if(Result)
+				return Result;
+		}
+	}
+	return 0;
+}
+
+int CTeeHistorianCompressor::WriteFrame(IOHANDLE File)
+{
+	if(!m_MagicWritten)
+	{
+		io_write(File, MAGIC, sizeof(MAGIC));
+		m_MagicWritten = true;
+	}
+	if(m_vFrame.empty())
+	{
+		io_flush(File);
+		return io_error(File);
+	}
+
+	uLongf CompressedSize = compressBound(m_vFrame.size());
+	m_vCompressed.resize(FRAME_HEADER_SIZE + CompressedSize);
+	const int Result = compress2(m_vCompressed.data() + FRAME_HEADER_SIZE, &CompressedSize, m_vFrame.data(), m_vFrame.size(), Z_DEFAULT_COMPRESSION);
+	if(Result != Z_OK)
+		return Result;
+	uint_to_bytes_be(&m_vCompressed[0], m_vFrame.size());
+	uint_to_bytes_be(&m_vCompressed[4], CompressedSize);
+	m_vFrame.clear();
+
+	io_write(File, m_vCompressed.data(), FRAME_HEADER_SIZE + CompressedSize);
+	io_flush(File);
+	return io_error(File);
+}
+
+size_t CTeeHistorianCompressor::DecompressFrame(const unsigned char *pData, size_t DataSize, size_t Offset, std::vector<unsigned char> &vOut)
+{
+	if(Offset > DataSize || DataSize - Offset < FRAME_HEADER_SIZE)
+		return 0;
+	const unsigned UncompressedSize = bytes_be_to_uint(&pData[Offset]);
+	const unsigned CompressedSize = bytes_be_to_uint(&pData[Offset + 4]);
+	Offset += FRAME_HEADER_SIZE;
+	// the sizes come from the file, don't allocate more than a valid frame can hold
+	if(UncompressedSize > FRAME_SIZE || DataSize - Offset < CompressedSize)
+		return 0;
+
+	const size_t OldSize = vOut.size();
+	vOut.resize(OldSize + UncompressedSize);
+	uLongf DestSize = UncompressedSize;
+	if(uncompress(vOut.data() + OldSize, &DestSize, &pData[Offset], CompressedSize) != Z_OK || DestSize != UncompressedSize)
+	{
+		vOut.resize(OldSize);
+		return 0;
+	}
+	return Offset + CompressedSize;
+}
+
+bool CTeeHistorianCompressor::Decompress(const unsigned char *pData, size_t DataSize, std::vector<unsigned char> &vOut)
+{
+	if(DataSize < sizeof(MAGIC) || mem_comp(pData, MAGIC, sizeof(MAGIC)) != 0)
+		return false;
+	size_t Offset = sizeof(MAGIC);
+	while(Offset < DataSize)
+	{
+		Offset = DecompressFrame(pData, DataSize, Offset, vOut);
+		if(Offset == 0)
+			return false;
+	}
+	return true;
+}
@@ -2,11 +2,13 @@
 #define GAME_SERVER_TEEHISTORIAN_H
 
 #include <base/hash.h>
+#include <base/system.h>
 #include <engine/console.h>
 #include <engine/shared/protocol.h>
 #include <game/generated/protocol.h>
 
 #include <ctime>
+#include <vector>
 
 class CConfig;
 class CTuningParams;
@@ -54,6 +56,10 @@ public:
 
 	bool Starting() const { return m_State == STATE_START; }
 
+	// Writes the next tick with player data as an explicit tick record, even
+	// if it could be implicit, so the output continues with a tick record.
+	void ExplicitNextTick() { m_ExplicitTick = true; }
+
 	void BeginTick(int Tick);
 
 	void BeginPlayers();
@@ -141,6 +147,7 @@ private:
 
 	int m_LastWrittenTick;
 	bool m_TickWritten;
+	bool m_ExplicitTick;
 	int m_Tick;
 	int m_PrevMaxClientId;
 	int m_MaxClientId;
@@ -148,4 +155,39 @@ private:
 	CTeam m_aPrevTeams[MAX_CLIENTS];
 };
 
+// Compresses the teehistorian output on the writer thread of an ASYNCIO.
+//
+// The file starts with MAGIC, followed by frames of a big endian
+// uncompressed size, a big endian compressed size and a zlib stream.
+// Every frame can be decompressed on its own, so readers can start at
+// any frame boundary. A frame holds at most FRAME_SIZE bytes and also
+// ends when the file is flushed with aio_flush, which the game server
+// does between ticks at least every FLUSH_INTERVAL seconds.
+class CTeeHistorianCompressor
+{
+public:
+	enum
+	{
+		FRAME_SIZE = 64 * 1024,
+		FRAME_HEADER_SIZE = 8,
+		FLUSH_INTERVAL = 1,
+	};
+	static const unsigned char MAGIC[8];
+
+	// ASYNCIO_FILTER, pUser is the CTeeHistorianCompressor
+	static int Filter(IOHANDLE File, const void *pData, unsigned DataSize, void *pUser);
+
+	// returns the offset of the frame after the one at Offset, or 0 if the frame is invalid
+	static size_t DecompressFrame(const unsigned char *pData, size_t DataSize, size_t Offset, std::vector<unsigned char> &vOut);
+	static bool Decompress(const unsigned char *pData, size_t DataSize, std::vector<unsigned char> &vOut);
+
+private:
+	int Write(IOHANDLE File, const void *pData, unsigned DataSize);
+	int WriteFrame(IOHANDLE File);
+
+	bool m_MagicWritten = false;
+	std::vector<unsigned char> m_vFrame;
+	std::vector<unsigned char> m_vCompressed;
+};
+
 #endif // GAME_SERVER_TEEHISTORIAN_H
@@ -0,0 +1,390 @@
+#include "test.h"
+#include <gtest/gtest.h>
+
+#include <base/log.h>
+#include <base/system.h>
+#include <engine/kernel.h>
+#include <engine/map.h>
+#include <engine/shared/config.h>
+#include <engine/storage.h>
+#include <game/collision.h>
+#include <game/layers.h>
+#include <game/mapitems.h>
+#include <game/prng.h>
+
+#include <cmath>
+#include <memory>
+
+// Unit-stepping implementations the tile traversal in CCollision has to match
+// exactly, kept as they were before it.
+static int RefIntersectLine(const CCollision &Collision, vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision)
+{
+	float Distance = distance(Pos0, Pos1);
+	int End(Distance + 1);
+	vec2 Last = Pos0;
+	for(int i = 0; i <= End; i++)
+	{
+		float a = i / (float)End;
+		vec2 Pos = mix(Pos0, Pos1, a);
+		int ix = round_to_int(Pos.x);
+		int iy = round_to_int(Pos.y);
+		if(Collision.CheckPoint(ix, iy))
+		{
+			*pOutCollision = Pos;
+			*pOutBeforeCollision = Last;
+			return Collision.GetCollisionAt(ix, iy);
+		}
+		Last = Pos;
+	}
+	*pOutCollision = Pos1;
+	*pOutBeforeCollision = Pos1;
+	return 0;
+}
+
+static int RefIntersectLineTeleHook(const CCollision &Collision, vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision, int *pTeleNr)
+{
+	float Distance = distance(Pos0, Pos1);
+	int End(Distance + 1);
+	vec2 Last = Pos0;
+	int dx = 0, dy = 0;
+	ThroughOffset(Pos0, Pos1, &dx, &dy);
+	for(int i = 0; i <= End; i++)
+	{
+		float a = i / (float)End;
+		vec2 Pos = mix(Pos0, Pos1, a);
+		int ix = round_to_int(Pos.x);
+		int iy = round_to_int(Pos.y);
+
+		*pTeleNr = Collision.IsTeleportHook(Collision.GetPureMapIndex(Pos));
+		if(*pTeleNr)
+		{
+			*pOutCollision = Pos;
+			*pOutBeforeCollision = Last;
+			return TILE_TELEINHOOK;
+		}
+
+		int hit = 0;
+		if(Collision.CheckPoint(ix, iy))
+		{
+			if(!Collision.IsThrough(ix, iy, dx, dy, Pos0, Pos1))
+				hit = Collision.GetCollisionAt(ix, iy);
+		}
+		else if(Collision.IsHookBlocker(ix, iy, Pos0, Pos1))
+		{
+			hit = TILE_NOHOOK;
+		}
+		if(hit)
+		{
+			*pOutCollision = Pos;
+			*pOutBeforeCollision = Last;
+			return hit;
+		}
+		Last = Pos;
+	}
+	*pOutCollision = Pos1;
+	*pOutBeforeCollision = Pos1;
+	return 0;
+}
+
+static int RefIntersectLineTeleWeapon(const CCollision &Collision, vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision, int *pTeleNr)
+{
+	float Distance = distance(Pos0, Pos1);
+	int End(Distance + 1);
+	vec2 Last = Pos0;
+	for(int i = 0; i <= End; i++)
+	{
+		float a = i / (float)End;
+		vec2 Pos = mix(Pos0, Pos1, a);
+		int ix = round_to_int(Pos.x);
+		int iy = round_to_int(Pos.y);
+
+		*pTeleNr = Collision.IsTeleportWeapon(Collision.GetPureMapIndex(Pos));
+		if(*pTeleNr)
+		{
+			*pOutCollision = Pos;
+			*pOutBeforeCollision = Last;
+			return TILE_TELEINWEAPON;
+		}
+		if(Collision.CheckPoint(ix, iy))
+		{
+			*pOutCollision = Pos;
+			*pOutBeforeCollision = Last;
+			return Collision.GetCollisionAt(ix, iy);
+		}
+		Last = Pos;
+	}
+	*pOutCollision = Pos1;
+	*pOutBeforeCollision = Pos1;
+	return 0;
+}
+
+static int RefIntersectNoLaser(const CCollision &Collision, vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision)
+{
+	float d = distance(Pos0, Pos1);
+	vec2 Last = Pos0;
+	for(int i = 0, id = std::ceil(d); i < id; i++)
+	{
+		float a = i / d;
+		vec2 Pos = mix(Pos0, Pos1, a);
+		int Nx = clamp(round_to_int(Pos.x) / 32, 0, Collision.GetWidth() - 1);
+		int Ny = clamp(round_to_int(Pos.y) / 32, 0, Collision.GetHeight() - 1);
+		if(Collision.GetIndex(Nx, Ny) == TILE_SOLID || Collision.GetIndex(Nx, Ny) == TILE_NOHOOK || Collision.GetIndex(Nx, Ny) == TILE_NOLASER || Collision.GetFrontIndex(Nx, Ny) == TILE_NOLASER)
+		{
+			*pOutCollision = Pos;
+			*pOutBeforeCollision = Last;
+			if(Collision.GetFrontIndex(Nx, Ny) == TILE_NOLASER)
+				return Collision.GetFrontCollisionAt(Pos.x, Pos.y);
+			else
+				return Collision.GetCollisionAt(Pos.x, Pos.y);
+		}
+		Last = Pos;
+	}
+	*pOutCollision = Pos1;
+	*pOutBeforeCollision = Pos1;
+	return 0;
+}
+
+static int RefIntersectNoLaserNoWalls(const CCollision &Collision, vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision)
+{
+	float d = distance(Pos0, Pos1);
+	vec2 Last = Pos0;
+	for(int i = 0, id = std::ceil(d); i < id; i++)
+	{
+		float a = (float)i / d;
+		vec2 Pos = mix(Pos0, Pos1, a);
+		int ix = round_to_int(Pos.x);
+		int iy = round_to_int(Pos.y);
+		if(Collision.IsNoLaser(ix, iy) || Collision.IsFrontNoLaser(ix, iy))
+		{
+			*pOutCollision = Pos;
+			*pOutBeforeCollision = Last;
+			if(Collision.IsNoLaser(ix, iy))
+				return Collision.GetCollisionAt(Pos.x, Pos.y);
+			else
+				return Collision.GetFrontCollisionAt(Pos.x, Pos.y);
+		}
+		Last = Pos;
+	}
+	*pOutCollision = Pos1;
+	*pOutBeforeCollision = Pos1;
+	return 0;
+}
+
+static int RefIntersectAir(const CCollision &Collision, vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision)
+{
+	float d = distance(Pos0, Pos1);
+	vec2 Last = Pos0;
+	for(int i = 0, id = std::ceil(d); i < id; i++)
+	{
+		float a = (float)i / d;
+		vec2 Pos = mix(Pos0, Pos1, a);
+		int ix = round_to_int(Pos.x);
+		int iy = round_to_int(Pos.y);
+		if(Collision.IsSolid(ix, iy) || (!Collision.GetTile(ix, iy) && !Collision.GetFrontTile(ix, iy)))
+		{
+			*pOutCollision = Pos;
+			*pOutBeforeCollision = Last;
+			if(!Collision.GetTile(ix, iy) && !Collision.GetFrontTile(ix, iy))
+				return -1;
+			else if(!Collision.GetTile(ix, iy))
+				return Collision.GetTile(ix, iy);
+			else
+				return Collision.GetFrontTile(ix, iy);
+		}
+		Last = Pos;
+	}
+	*pOutCollision = Pos1;
+	*pOutBeforeCollision = Pos1;
+	return 0;
+}
+
+class CollisionTest : public ::testing::Test
+{
+protected:
+	CTestInfo m_TestInfo;
+	std::unique_ptr<IKernel> m_pKernel;
+	std::unique_ptr<IStorage> m_pStorage;
+	IEngineMap *m_pMap = nullptr;
+	CLayers m_Layers;
+	CCollision m_Collision;
+	CPrng m_Prng;
+
+	CollisionTest()
+	{
+		m_pKernel = std::unique_ptr<IKernel>(IKernel::Create());
+		m_TestInfo.m_DeleteTestStorageFilesOnSuccess = true;
+		m_pStorage = m_TestInfo.CreateTestStorage();
+		m_pKernel->RegisterInterface(m_pStorage.get(), false);
+		m_pMap = CreateEngineMap();
+		m_pKernel->RegisterInterface(m_pMap);
+		m_pKernel->RegisterInterface(static_cast<IMap *>(m_pMap), false);
+
+		uint64_t aSeed[2] = {0x2c0ab5fb1e9dd3a1, 0x94d049bb133111eb};
+		m_Prng.Seed(aSeed);
+	}
+
+	~CollisionTest() override
+	{
+		m_Collision.Unload();
+		m_pMap->Unload();
+	}
+
+	float RandomFloat(float Min, float Max)
+	{
+		return Min + (Max - Min) * (m_Prng.RandomBits() / (float)0xffffffffu);
+	}
+
+	int RandomInt(int Num)
+	{
+		return m_Prng.RandomBits() % Num;
+	}
+
+	// Loads the coverage map and scrambles its physics layers so that every
+	// tile type the intersection functions look at shows up densely.
+	void LoadScrambledMap()
+	{
+		ASSERT_TRUE(m_pMap->Load("maps/coverage.map"));
+		m_Layers.Init(m_pMap, false);
+
+		static const int s_aGameTiles[] = {TILE_AIR, TILE_AIR, TILE_AIR, TILE_AIR, TILE_SOLID, TILE_NOHOOK, TILE_NOLASER, TILE_THROUGH_CUT, TILE_THROUGH, TILE_THROUGH_ALL, TILE_THROUGH_DIR, TILE_DEATH};
+		static const int s_aFrontTiles[] = {TILE_AIR, TILE_AIR, TILE_AIR, TILE_AIR, TILE_NOLASER, TILE_THROUGH_CUT, TILE_THROUGH, TILE_THROUGH_ALL, TILE_THROUGH_DIR, TILE_DEATH};
+		static const int s_aTeleTypes[] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, TILE_TELEIN, TILE_TELEINWEAPON, TILE_TELEINHOOK};
+		static const int s_aRotations[] = {ROTATION_0, ROTATION_90, ROTATION_180, ROTATION_270};
+
+		const CMapItemLayerTilemap *pGameLayer = m_Layers.GameLayer();
+		const int NumTiles = pGameLayer->m_Width * pGameLayer->m_Height;
+		CTile *pTiles = static_cast<CTile *>(m_pMap->GetData(pGameLayer->m_Data));
+		for(int i = 0; i < NumTiles; i++)
+		{
+			pTiles[i].m_Index = s_aGameTiles[RandomInt(std::size(s_aGameTiles))];
+			pTiles[i].m_Flags = s_aRotations[RandomInt(std::size(s_aRotations))];
+		}
+		if(m_Layers.FrontLayer())
+		{
+			CTile *pFront = static_cast<CTile *>(m_pMap->GetData(m_Layers.FrontLayer()->m_Front));
+			for(int i = 0; i < NumTiles; i++)
+			{
+				pFront[i].m_Index = s_aFrontTiles[RandomInt(std::size(s_aFrontTiles))];
+				pFront[i].m_Flags = s_aRotations[RandomInt(std::size(s_aRotations))];
+			}
+		}
+		if(m_Layers.TeleLayer())
+		{
+			CTeleTile *pTele = static_cast<CTeleTile *>(m_pMap->GetData(m_Layers.TeleLayer()->m_Tele));
+			for(int i = 0; i < NumTiles; i++)
+			{
+				pTele[i].m_Type = s_aTeleTypes[RandomInt(std::size(s_aTeleTypes))];
+				pTele[i].m_Number = pTele[i].m_Type ? 1 + RandomInt(8) : 0;
+			}
+		}
+		m_Collision.Init(&m_Layers);
+	}
+
+	// Mixes arbitrary segments with the cases stepping is most sensitive to:
+	// axis-aligned and diagonal rays, endpoints on rounding boundaries,
+	// degenerate and very short segments and segments leaving the map.
+	void RandomSegment(vec2 *pPos0, vec2 *pPos1)
+	{
+		const float Width = m_Collision.GetWidth() * 32.0f;
+		const float Height = m_Collision.GetHeight() * 32.0f;
+		vec2 Pos0 = vec2(RandomFloat(-64.0f, Width + 64.0f), RandomFloat(-64.0f, Height + 64.0f));
+		if(RandomInt(4) == 0)
+			Pos0 = vec2(RandomInt(m_Collision.GetWidth()) * 32 + 31.5f, RandomInt(m_Collision.GetHeight()) * 32 - 0.5f);
+
+		float Length;
+		switch(RandomInt(4))
+		{
+		case 0: Length = RandomFloat(0.0f, 2.0f); break;
+		case 1: Length = RandomFloat(0.0f, 64.0f); break;
+		default: Length = RandomFloat(0.0f, 900.0f); break;
+		}
+		float Angle;
+		switch(RandomInt(4))
+		{
+		case 0: Angle = RandomInt(8) * pi / 4.0f; break;
+		default: Angle = RandomFloat(0.0f, 2.0f * pi); break;
+		}
+		*pPos0 = Pos0;
+		*pPos1 = RandomInt(32) == 0 ? Pos0 : Pos0 + direction(Angle) * Length;
+	}
+};
+
+TEST_F(CollisionTest, IntersectMatchesStepping)
+{
+	LoadScrambledMap();
+	ASSERT_NE(m_Collision.GameLayer(), nullptr);
+	g_Config.m_SvOldTeleportHook = 0;
+	g_Config.m_SvOldTeleportWeapons = 0;
+
+	for(int Run = 0; Run < 20000; Run++)
+	{
+		vec2 Pos0, Pos1;
+		RandomSegment(&Pos0, &Pos1);
+		SCOPED_TRACE(testing::Message() << "Pos0=(" << Pos0.x << ", " << Pos0.y << ") Pos1=(" << Pos1.x << ", " << Pos1.y << ")");
+
+		vec2 Col, Before, RefCol, RefBefore;
+		int TeleNr = -1, RefTeleNr = -2;
+
+		EXPECT_EQ(m_Collision.IntersectLine(Pos0, Pos1, &Col, &Before), RefIntersectLine(m_Collision, Pos0, Pos1, &RefCol, &RefBefore));
+		EXPECT_EQ(Col, RefCol);
+		EXPECT_EQ(Before, RefBefore);
+
+		EXPECT_EQ(m_Collision.IntersectLineTeleHook(Pos0, Pos1, &Col, &Before, &TeleNr), RefIntersectLineTeleHook(m_Collision, Pos0, Pos1, &RefCol, &RefBefore, &RefTeleNr));
+		EXPECT_EQ(Col, RefCol);
+		EXPECT_EQ(Before, RefBefore);
+		EXPECT_EQ(TeleNr, RefTeleNr);
+
+		EXPECT_EQ(m_Collision.IntersectLineTeleWeapon(Pos0, Pos1, &Col, &Before, &TeleNr), RefIntersectLineTeleWeapon(m_Collision, Pos0, Pos1, &RefCol, &RefBefore, &RefTeleNr));
+		EXPECT_EQ(Col, RefCol);
+		EXPECT_EQ(Before, RefBefore);
+		EXPECT_EQ(TeleNr, RefTeleNr);
+
+		EXPECT_EQ(m_Collision.IntersectNoLaser(Pos0, Pos1, &Col, &Before), RefIntersectNoLaser(m_Collision, Pos0, Pos1, &RefCol, &RefBefore));
+		EXPECT_EQ(Col, RefCol);
+		EXPECT_EQ(Before, RefBefore);
+
+		EXPECT_EQ(m_Collision.IntersectNoLaserNoWalls(Pos0, Pos1, &Col, &Before), RefIntersectNoLaserNoWalls(m_Collision, Pos0, Pos1, &RefCol, &RefBefore));
+		EXPECT_EQ(Col, RefCol);
+		EXPECT_EQ(Before, RefBefore);
+
+		EXPECT_EQ(m_Collision.IntersectAir(Pos0, Pos1, &Col, &Before), RefIntersectAir(m_Collision, Pos0, Pos1, &RefCol, &RefBefore));
+		EXPECT_EQ(Col, RefCol);
+		EXPECT_EQ(Before, RefBefore);
+
+		if(HasFailure())
+			break;
+	}
+}
+
+// Run with --gtest_also_run_disabled_tests --gtest_filter=CollisionTest.DISABLED_*
+TEST_F(CollisionTest, DISABLED_BenchmarkIntersectLine)
+{
+	ASSERT_TRUE(m_pMap->Load("maps/coverage.map"));
+	m_Layers.Init(m_pMap, false);
+	m_Collision.Init(&m_Layers);
+
+	// Hook-length rays through mostly open space, as in regular gameplay.
+	const int NumRays = 100000;
+	std::vector<std::pair<vec2, vec2>> vRays;
+	vRays.reserve(NumRays);
+	for(int i = 0; i < NumRays; i++)
+	{
+		vec2 Pos0 = vec2(RandomFloat(0.0f, m_Collision.GetWidth() * 32.0f), RandomFloat(0.0f, m_Collision.GetHeight() * 32.0f));
+		vRays.emplace_back(Pos0, Pos0 + direction(RandomFloat(0.0f, 2.0f * pi)) * 700.0f);
+	}
+
+	vec2 Col, Before;
+	int Checksum = 0;
+	int64_t Start = time_get();
+	for(const auto &[Pos0, Pos1] : vRays)
+		Checksum += RefIntersectLine(m_Collision, Pos0, Pos1, &Col, &Before);
+	int64_t Stepping = time_get() - Start;
+
+	Start = time_get();
+	for(const auto &[Pos0, Pos1] : vRays)
+		Checksum -= m_Collision.IntersectLine(Pos0, Pos1, &Col, &Before);
+	int64_t Traversal = time_get() - Start;
+
+	EXPECT_EQ(Checksum, 0);
+	log_info("collision", "IntersectLine over %d rays: stepping %.2fms, tile traversal %.2fms", NumRays, Stepping * 1000.0 / time_freq(), Traversal * 1000.0 / time_freq());
+}
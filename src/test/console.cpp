@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <engine/console.h>
+#include <engine/shared/config.h>
+
+static void ConIncrement(IConsole::IResult *pResult, void *pUserData)
+{
+	int *pCalls = static_cast<int *>(pUserData);
+	*pCalls += pResult->NumArguments() ? pResult->GetInteger(0) : 1;
+}
+
+TEST(Console, FindCommandNoCase)
+{
+	std::unique_ptr<IConsole> pConsole = CreateConsole(CFGFLAG_SERVER);
+	int Calls = 0;
+	pConsole->Register("test_command", "?i[amount]", CFGFLAG_SERVER, ConIncrement, &Calls, "");
+
+	pConsole->ExecuteLine("test_command");
+	EXPECT_EQ(Calls, 1);
+	pConsole->ExecuteLine("TEST_Command 5");
+	EXPECT_EQ(Calls, 6);
+	pConsole->ExecuteLine("test_command 2; test_command 3");
+	EXPECT_EQ(Calls, 11);
+	pConsole->ExecuteLine("test_comman 100");
+	EXPECT_EQ(Calls, 11);
+
+	EXPECT_TRUE(pConsole->LineIsValid("Test_Command 1"));
+	EXPECT_FALSE(pConsole->LineIsValid("test_commands 1"));
+	EXPECT_NE(pConsole->GetCommandInfo("TEST_COMMAND", CFGFLAG_SERVER, false), nullptr);
+	EXPECT_EQ(pConsole->GetCommandInfo("test_command", CFGFLAG_CLIENT, false), nullptr);
+}
+
+TEST(Console, SameNameDifferentFlags)
+{
+	std::unique_ptr<IConsole> pConsole = CreateConsole(CFGFLAG_SERVER);
+	int ServerCalls = 0;
+	int ClientCalls = 0;
+	pConsole->Register("shared", "", CFGFLAG_SERVER, ConIncrement, &ServerCalls, "");
+	pConsole->Register("shared", "", CFGFLAG_CLIENT, ConIncrement, &ClientCalls, "");
+
+	pConsole->ExecuteLine("shared");
+	EXPECT_EQ(ServerCalls, 1);
+	EXPECT_EQ(ClientCalls, 0);
+
+	pConsole->ExecuteLineFlag("shared", CFGFLAG_CLIENT);
+	EXPECT_EQ(ServerCalls, 1);
+	EXPECT_EQ(ClientCalls, 1);
+
+	// re-registering with matching flags replaces the existing command
+	int NewCalls = 0;
+	pConsole->Register("shared", "", CFGFLAG_SERVER, ConIncrement, &NewCalls, "");
+	pConsole->ExecuteLine("shared");
+	EXPECT_EQ(ServerCalls, 1);
+	EXPECT_EQ(NewCalls, 1);
+}
+
+TEST(Console, TempCommands)
+{
+	std::unique_ptr<IConsole> pConsole = CreateConsole(CFGFLAG_SERVER);
+	pConsole->RegisterTemp("temp_a", "", CFGFLAG_SERVER, "");
+	pConsole->RegisterTemp("temp_b", "", CFGFLAG_SERVER, "");
+	EXPECT_NE(pConsole->GetCommandInfo("temp_a", CFGFLAG_SERVER, true), nullptr);
+	EXPECT_NE(pConsole->GetCommandInfo("Temp_B", CFGFLAG_SERVER, true), nullptr);
+	EXPECT_EQ(pConsole->GetCommandInfo("temp_a", CFGFLAG_SERVER, false), nullptr);
+
+	pConsole->DeregisterTemp("temp_a");
+	EXPECT_EQ(pConsole->GetCommandInfo("temp_a", CFGFLAG_SERVER, true), nullptr);
+	EXPECT_NE(pConsole->GetCommandInfo("temp_b", CFGFLAG_SERVER, true), nullptr);
+
+	// reuses the recycled entry of temp_a
+	pConsole->RegisterTemp("temp_c", "", CFGFLAG_SERVER, "");
+	EXPECT_EQ(pConsole->GetCommandInfo("temp_a", CFGFLAG_SERVER, true), nullptr);
+	EXPECT_NE(pConsole->GetCommandInfo("temp_c", CFGFLAG_SERVER, true), nullptr);
+
+	pConsole->DeregisterTempAll();
+	EXPECT_EQ(pConsole->GetCommandInfo("temp_b", CFGFLAG_SERVER, true), nullptr);
+	EXPECT_EQ(pConsole->GetCommandInfo("temp_c", CFGFLAG_SERVER, true), nullptr);
+	EXPECT_NE(pConsole->GetCommandInfo("echo", CFGFLAG_SERVER, false), nullptr);
+}
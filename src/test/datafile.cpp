@@ -1,8 +1,10 @@
 #include "test.h"
 #include <gtest/gtest.h>
 #include <memory>
+#include <vector>
 
 #include <engine/shared/datafile.h>
+#include <engine/shared/jobs.h>
 #include <engine/storage.h>
 #include <game/mapitems_ex.h>
 
@@ -109,3 +111,158 @@ TEST(Datafile, StringData)
 		pStorage->RemoveFile(Info.m_aFilename, IStorage::TYPE_SAVE);
 	}
 }
+
+static std::vector<int> PatternData(int Index)
+{
+	// compressible, but different for every data index
+	std::vector<int> vData(1000 + Index * 997);
+	for(size_t i = 0; i < vData.size(); i++)
+		vData[i] = (int)(i / 13) * (Index + 1);
+	return vData;
+}
+
+TEST(Datafile, PrefetchData)
+{
+	std::unique_ptr<IStorage> pStorage = CreateLocalStorage();
+	ASSERT_NE(pStorage, nullptr) << "Error creating local storage";
+
+	CTestInfo Info;
+	const int NumData = 32;
+
+	{
+		CDataFileWriter Writer;
+		Writer.Open(pStorage.get(), Info.m_aFilename);
+		for(int i = 0; i < NumData; i++)
+		{
+			const std::vector<int> vData = PatternData(i);
+			EXPECT_EQ(Writer.AddData(vData.size() * sizeof(int), vData.data()), i);
+		}
+		Writer.Finish();
+	}
+
+	CJobPool Pool;
+	Pool.Init(4);
+
+	{
+		CDataFileReader Reader;
+		ASSERT_TRUE(Reader.Open(pStorage.get(), Info.m_aFilename, IStorage::TYPE_ALL, true));
+		ASSERT_EQ(Reader.NumData(), NumData);
+
+		std::vector<int> vIndices;
+		for(int i = NumData - 1; i >= -2; i--)
+			vIndices.push_back(i);
+		vIndices.push_back(3); // duplicates are only loaded once
+		vIndices.push_back(NumData); // invalid indices are ignored
+		Reader.PrefetchData(vIndices, [&](std::shared_ptr<IJob> pJob) { Pool.Add(std::move(pJob)); });
+
+		for(int i = 0; i < NumData; i++)
+		{
+			const std::vector<int> vExpected = PatternData(i);
+			ASSERT_EQ(Reader.GetDataSize(i), (int)(vExpected.size() * sizeof(int)));
+			const int *pData = static_cast<const int *>(Reader.GetData(i));
+			ASSERT_NE(pData, nullptr);
+			EXPECT_EQ(mem_comp(pData, vExpected.data(), vExpected.size() * sizeof(int)), 0) << "Index=" << i;
+		}
+
+		// unloaded data is decompressed from the file again
+		Reader.UnloadData(5);
+		const std::vector<int> vExpected = PatternData(5);
+		const int *pData = static_cast<const int *>(Reader.GetData(5));
+		ASSERT_NE(pData, nullptr);
+		EXPECT_EQ(mem_comp(pData, vExpected.data(), vExpected.size() * sizeof(int)), 0);
+
+		// prefetching loaded data does nothing
+		Reader.PrefetchData({5}, nullptr);
+		EXPECT_EQ(Reader.GetData(5), pData);
+
+		Reader.Close();
+	}
+
+	{
+		// files that are not mapped can be truncated while they are open
+		CDataFileReader Reader;
+		ASSERT_TRUE(Reader.Open(pStorage.get(), Info.m_aFilename, IStorage::TYPE_ALL));
+		ASSERT_EQ(Reader.NumData(), NumData);
+		Reader.PrefetchData({0, 1}, [&](std::shared_ptr<IJob> pJob) { Pool.Add(std::move(pJob)); });
+		ASSERT_NE(Reader.GetData(0), nullptr);
+
+		IOHANDLE File = pStorage->OpenFile(Info.m_aFilename, IOFLAG_WRITE, IStorage::TYPE_SAVE);
+		ASSERT_TRUE(File);
+		io_close(File);
+
+		const std::vector<int> vExpected = PatternData(1);
+		const int *pData = static_cast<const int *>(Reader.GetData(1));
+		ASSERT_NE(pData, nullptr);
+		EXPECT_EQ(mem_comp(pData, vExpected.data(), vExpected.size() * sizeof(int)), 0);
+		EXPECT_EQ(Reader.GetData(NumData - 1), nullptr);
+		Reader.Close();
+	}
+
+	Pool.Shutdown();
+
+	if(!HasFailure())
+	{
+		pStorage->RemoveFile(Info.m_aFilename, IStorage::TYPE_SAVE);
+	}
+}
+
+TEST(Datafile, ParallelFinish)
+{
+	std::unique_ptr<IStorage> pStorage = CreateLocalStorage();
+	ASSERT_NE(pStorage, nullptr) << "Error creating local storage";
+
+	CTestInfo Info;
+	char aParallelFilename[IO_MAX_PATH_LENGTH];
+	str_format(aParallelFilename, sizeof(aParallelFilename), "%s.parallel", Info.m_aFilename);
+	const int NumData = 32;
+
+	CJobPool Pool;
+	Pool.Init(4);
+
+	for(int Parallel = 0; Parallel < 2; Parallel++)
+	{
+		CDataFileWriter Writer;
+		ASSERT_TRUE(Writer.Open(pStorage.get(), Parallel ? aParallelFilename : Info.m_aFilename));
+		for(int i = 0; i < NumData; i++)
+		{
+			const std::vector<int> vData = PatternData(i);
+			if(i % 3 == 0)
+				Writer.AddDataSwapped(vData.size() * sizeof(int), vData.data());
+			else
+				Writer.AddData(vData.size() * sizeof(int), vData.data(), i % 3 == 1 ? CDataFileWriter::COMPRESSION_BEST : CDataFileWriter::COMPRESSION_DEFAULT);
+		}
+		Writer.AddDataString("end");
+		if(Parallel)
+			Writer.Finish([&](std::shared_ptr<IJob> pJob) { Pool.Add(std::move(pJob)); });
+		else
+			Writer.Finish();
+	}
+
+	Pool.Shutdown();
+
+	// the file must not depend on how the data was compressed
+	SHA256_DIGEST Serial, Parallel;
+	ASSERT_TRUE(pStorage->CalculateHashes(Info.m_aFilename, IStorage::TYPE_SAVE, &Serial));
+	ASSERT_TRUE(pStorage->CalculateHashes(aParallelFilename, IStorage::TYPE_SAVE, &Parallel));
+	EXPECT_EQ(Serial, Parallel);
+
+	{
+		CDataFileReader Reader;
+		ASSERT_TRUE(Reader.Open(pStorage.get(), aParallelFilename, IStorage::TYPE_ALL));
+		ASSERT_EQ(Reader.NumData(), NumData + 1);
+		for(int i = 0; i < NumData; i++)
+		{
+			const std::vector<int> vExpected = PatternData(i);
+			ASSERT_EQ(Reader.GetDataSize(i), (int)(vExpected.size() * sizeof(int)));
+			EXPECT_EQ(mem_comp(Reader.GetData(i), vExpected.data(), vExpected.size() * sizeof(int)), 0) << "Index=" << i;
+		}
+		EXPECT_STREQ(Reader.GetDataString(NumData), "end");
+		Reader.Close();
+	}
+
+	if(!HasFailure())
+	{
+		pStorage->RemoveFile(Info.m_aFilename, IStorage::TYPE_SAVE);
+		pStorage->RemoveFile(aParallelFilename, IStorage::TYPE_SAVE);
+	}
+}
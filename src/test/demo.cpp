@@ -0,0 +1,224 @@
+#include "test.h"
+#include <gtest/gtest.h>
+
+#include <engine/shared/demo.h>
+#include <engine/shared/network.h>
+#include <engine/shared/snapshot.h>
+#include <engine/storage.h>
+#include <game/generated/protocol.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class CDemoTestListener : public CDemoPlayer::IListener
+{
+public:
+	std::vector<int> m_vSnapshotValues;
+	int m_NumMessages = 0;
+
+	void OnDemoPlayerSnapshot(void *pData, int Size) override
+	{
+		const CSnapshot *pSnapshot = (const CSnapshot *)pData;
+		const CNetObj_Flag *pFlag = (const CNetObj_Flag *)pSnapshot->FindItem(CNetObj_Flag::ms_MsgId, 0);
+		m_vSnapshotValues.push_back(pFlag ? pFlag->m_X : -1);
+	}
+
+	void OnDemoPlayerMessage(void *pData, int Size) override
+	{
+		m_NumMessages++;
+	}
+};
+
+static void RecordTestDemo(IStorage *pStorage, CSnapshotDelta *pSnapshotDelta, const char *pFilename, int NumTicks)
+{
+	CDemoRecorder Recorder(pSnapshotDelta, true);
+	Recorder.SetDropChunks(false);
+	unsigned char aMapData[1] = {0};
+	SHA256_DIGEST Sha256 = {};
+	ASSERT_EQ(Recorder.Start(pStorage, nullptr, pFilename, "0.6 626fce9a778df4d4", "test", Sha256, 0, "client", 0, aMapData, nullptr, nullptr, nullptr), 0);
+
+	for(int Tick = 1; Tick <= NumTicks; Tick++)
+	{
+		CSnapshotBuilder Builder;
+		Builder.Init();
+		CNetObj_Flag *pFlag = (CNetObj_Flag *)Builder.NewItem(CNetObj_Flag::ms_MsgId, 0, sizeof(CNetObj_Flag));
+		ASSERT_NE(pFlag, nullptr);
+		pFlag->m_X = Tick;
+		pFlag->m_Y = 0;
+		pFlag->m_Team = 0;
+
+		char aData[CSnapshot::MAX_SIZE];
+		const int Size = Builder.Finish(aData);
+		Recorder.RecordSnapshot(Tick, aData, Size);
+
+		const int aMessage[2] = {Tick, 0};
+		Recorder.RecordMessage(aMessage, sizeof(aMessage));
+	}
+
+	EXPECT_EQ(Recorder.NumDroppedChunks(), 0);
+	EXPECT_EQ(Recorder.Stop(IDemoRecorder::EStopMode::KEEP_FILE), 0);
+}
+
+TEST(Demo, RecordAndPlay)
+{
+	std::unique_ptr<IStorage> pStorage = CreateLocalStorage();
+	ASSERT_NE(pStorage, nullptr) << "Error creating local storage";
+	CNetBase::Init();
+
+	CTestInfo Info;
+	CSnapshotDelta SnapshotDelta;
+	const int NumTicks = 300;
+	RecordTestDemo(pStorage.get(), &SnapshotDelta, Info.m_aFilename, NumTicks);
+
+	{
+		CDemoPlayer Player(&SnapshotDelta, false);
+		ASSERT_EQ(Player.Load(pStorage.get(), nullptr, Info.m_aFilename, IStorage::TYPE_ALL), 0);
+		CDemoTestListener Listener;
+		Player.SetListener(&Listener);
+		Player.Play();
+		while(Player.IsPlaying() && !Player.BaseInfo()->m_Paused)
+			Player.Update(false);
+		Player.Stop();
+
+		ASSERT_EQ((int)Listener.m_vSnapshotValues.size(), NumTicks);
+		for(int i = 0; i < NumTicks; i++)
+			EXPECT_EQ(Listener.m_vSnapshotValues[i], i + 1);
+		EXPECT_EQ(Listener.m_NumMessages, NumTicks);
+	}
+
+	if(!HasFailure())
+		pStorage->RemoveFile(Info.m_aFilename, IStorage::TYPE_SAVE);
+}
+
+TEST(Demo, ConcurrentRecorders)
+{
+	std::unique_ptr<IStorage> pStorage = CreateLocalStorage();
+	ASSERT_NE(pStorage, nullptr) << "Error creating local storage";
+	CNetBase::Init();
+
+	// all recorders share one writer thread, their chunks must not get mixed up
+	const int NumRecorders = 4;
+	const int NumTicks = 200;
+	CSnapshotDelta SnapshotDelta;
+	std::vector<std::string> vFilenames;
+	std::vector<std::unique_ptr<CDemoRecorder>> vpRecorders;
+	unsigned char aMapData[1] = {0};
+	SHA256_DIGEST Sha256 = {};
+	for(int i = 0; i < NumRecorders; i++)
+	{
+		CTestInfo Info;
+		vFilenames.emplace_back(std::string(Info.m_aFilename) + "-" + std::to_string(i));
+		vpRecorders.push_back(std::make_unique<CDemoRecorder>(&SnapshotDelta, true));
+		vpRecorders.back()->SetDropChunks(false);
+		ASSERT_EQ(vpRecorders.back()->Start(pStorage.get(), nullptr, vFilenames.back().c_str(), "0.6 626fce9a778df4d4", "test", Sha256, 0, "client", 0, aMapData, nullptr, nullptr, nullptr), 0);
+	}
+
+	for(int Tick = 1; Tick <= NumTicks; Tick++)
+	{
+		for(int i = 0; i < NumRecorders; i++)
+		{
+			if(i == 0 && Tick > NumTicks / 2)
+				continue;
+			CSnapshotBuilder Builder;
+			Builder.Init();
+			CNetObj_Flag *pFlag = (CNetObj_Flag *)Builder.NewItem(CNetObj_Flag::ms_MsgId, 0, sizeof(CNetObj_Flag));
+			ASSERT_NE(pFlag, nullptr);
+			pFlag->m_X = Tick * (i + 1);
+			pFlag->m_Y = 0;
+			pFlag->m_Team = 0;
+
+			char aData[CSnapshot::MAX_SIZE];
+			const int Size = Builder.Finish(aData);
+			vpRecorders[i]->RecordSnapshot(Tick, aData, Size);
+		}
+		// stop one recorder early while the others keep recording
+		if(Tick == NumTicks / 2)
+		{
+			EXPECT_EQ(vpRecorders[0]->Stop(IDemoRecorder::EStopMode::KEEP_FILE), 0);
+		}
+	}
+	for(int i = NumRecorders - 1; i > 0; i--)
+		EXPECT_EQ(vpRecorders[i]->Stop(IDemoRecorder::EStopMode::KEEP_FILE), 0);
+
+	for(int i = 0; i < NumRecorders; i++)
+	{
+		const int RecordedTicks = i == 0 ? NumTicks / 2 : NumTicks;
+		CDemoPlayer Player(&SnapshotDelta, false);
+		ASSERT_EQ(Player.Load(pStorage.get(), nullptr, vFilenames[i].c_str(), IStorage::TYPE_ALL), 0);
+		CDemoTestListener Listener;
+		Player.SetListener(&Listener);
+		Player.Play();
+		while(Player.IsPlaying() && !Player.BaseInfo()->m_Paused)
+			Player.Update(false);
+		Player.Stop();
+
+		ASSERT_EQ((int)Listener.m_vSnapshotValues.size(), RecordedTicks) << "Recorder " << i;
+		for(int Tick = 1; Tick <= RecordedTicks; Tick++)
+			EXPECT_EQ(Listener.m_vSnapshotValues[Tick - 1], Tick * (i + 1)) << "Recorder " << i;
+	}
+
+	if(!HasFailure())
+	{
+		for(const std::string &Filename : vFilenames)
+			pStorage->RemoveFile(Filename.c_str(), IStorage::TYPE_SAVE);
+	}
+}
+
+TEST(Demo, Seek)
+{
+	std::unique_ptr<IStorage> pStorage = CreateLocalStorage();
+	ASSERT_NE(pStorage, nullptr) << "Error creating local storage";
+	CNetBase::Init();
+
+	// long enough for seek points and the index
+	CTestInfo Info;
+	CSnapshotDelta SnapshotDelta;
+	const int NumTicks = 65 * SERVER_TICK_SPEED;
+	RecordTestDemo(pStorage.get(), &SnapshotDelta, Info.m_aFilename, NumTicks);
+
+	const bool CreatedDemosFolder = !pStorage->FolderExists("demos", IStorage::TYPE_SAVE) && pStorage->CreateFolder("demos", IStorage::TYPE_SAVE);
+	const bool CreatedIndexFolder = !pStorage->FolderExists("demos/index", IStorage::TYPE_SAVE) && pStorage->CreateFolder("demos/index", IStorage::TYPE_SAVE);
+
+	const int aWantedTicks[] = {100, 1234, 3000, 50, 2999, 3001, 3010, NumTicks, 10};
+	// without the index, the first scan creating it and loading the index
+	for(int Pass = 0; Pass < 3; Pass++)
+	{
+		CDemoPlayer Player(&SnapshotDelta, false);
+		Player.SetUseIndex(Pass > 0);
+		ASSERT_EQ(Player.Load(pStorage.get(), nullptr, Info.m_aFilename, IStorage::TYPE_ALL), 0);
+		EXPECT_EQ(Player.BaseInfo()->m_FirstTick, 1);
+		EXPECT_EQ(Player.BaseInfo()->m_LastTick, NumTicks);
+		CDemoTestListener Listener;
+		Player.SetListener(&Listener);
+		Player.Play();
+		for(const int WantedTick : aWantedTicks)
+		{
+			ASSERT_EQ(Player.SetPos(WantedTick), 0);
+			EXPECT_EQ(Player.BaseInfo()->m_CurrentTick, WantedTick - 1) << "Pass " << Pass;
+			EXPECT_EQ(Listener.m_vSnapshotValues.back(), WantedTick - 1) << "Pass " << Pass;
+		}
+		Player.Stop();
+	}
+
+	if(CreatedIndexFolder)
+	{
+		std::vector<std::string> vIndexFiles;
+		pStorage->ListDirectory(
+			IStorage::TYPE_SAVE, "demos/index", [](const char *pName, int IsDir, int StorageType, void *pUser) {
+				if(!IsDir)
+					((std::vector<std::string> *)pUser)->emplace_back(pName);
+				return 0;
+			},
+			&vIndexFiles);
+		EXPECT_EQ(vIndexFiles.size(), 1u);
+		for(const std::string &IndexFile : vIndexFiles)
+			pStorage->RemoveFile(("demos/index/" + IndexFile).c_str(), IStorage::TYPE_SAVE);
+		pStorage->RemoveFolder("demos/index", IStorage::TYPE_SAVE);
+	}
+	if(CreatedDemosFolder)
+		pStorage->RemoveFolder("demos", IStorage::TYPE_SAVE);
+
+	if(!HasFailure())
+		pStorage->RemoveFile(Info.m_aFilename, IStorage::TYPE_SAVE);
+}
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <base/vmath.h>
+#include <game/client/prediction/entity_pool.h>
+
+#include <vector>
+
+// The prediction world itself can't be linked next to the server's entities,
+// so these entities mimic CEntity's pooled storage and CGameWorld::CopyWorld.
+static CEntityPool gs_TestPool;
+
+class CTestEntity
+{
+public:
+	void *operator new(size_t Size) { return gs_TestPool.Allocate(Size); }
+	void operator delete(void *pPtr, size_t Size) { gs_TestPool.Free(pPtr, Size); }
+
+	CTestEntity(int Id, vec2 Pos) :
+		m_Id(Id), m_Pos(Pos) {}
+	virtual ~CTestEntity() = default;
+
+	int m_Id;
+	vec2 m_Pos;
+	int m_Health = 10;
+	CTestEntity *m_pParent = nullptr;
+	CTestEntity *m_pChild = nullptr;
+};
+
+class CTestProjectile : public CTestEntity
+{
+public:
+	CTestProjectile(int Id, vec2 Pos, vec2 Direction) :
+		CTestEntity(Id, Pos), m_Direction(Direction) {}
+
+	vec2 m_Direction;
+	int m_LifeSpan = 50;
+};
+
+class CTestWorld
+{
+public:
+	std::vector<CTestEntity *> m_vpEntities;
+
+	~CTestWorld() { Clear(); }
+
+	void Clear()
+	{
+		for(CTestEntity *pEnt : m_vpEntities)
+			delete pEnt;
+		m_vpEntities.clear();
+	}
+
+	void CopyWorld(CTestWorld *pFrom)
+	{
+		Clear();
+		for(CTestEntity *pEnt : pFrom->m_vpEntities)
+		{
+			CTestEntity *pCopy;
+			if(CTestProjectile *pProj = dynamic_cast<CTestProjectile *>(pEnt))
+				pCopy = new CTestProjectile(*pProj);
+			else
+				pCopy = new CTestEntity(*pEnt);
+			pCopy->m_pParent = pEnt;
+			pEnt->m_pChild = pCopy;
+			m_vpEntities.push_back(pCopy);
+		}
+	}
+};
+
+static void ExpectCopyMatches(const CTestWorld &Source, const CTestWorld &Copy)
+{
+	ASSERT_EQ(Source.m_vpEntities.size(), Copy.m_vpEntities.size());
+	for(size_t i = 0; i < Source.m_vpEntities.size(); i++)
+	{
+		const CTestEntity *pEnt = Source.m_vpEntities[i];
+		const CTestEntity *pCopy = Copy.m_vpEntities[i];
+		EXPECT_NE(pEnt, pCopy);
+		EXPECT_EQ(pCopy->m_pParent, pEnt);
+		EXPECT_EQ(pEnt->m_pChild, pCopy);
+		EXPECT_EQ(pCopy->m_Id, pEnt->m_Id);
+		EXPECT_EQ(pCopy->m_Pos, pEnt->m_Pos);
+		EXPECT_EQ(pCopy->m_Health, pEnt->m_Health);
+		const CTestProjectile *pProj = dynamic_cast<const CTestProjectile *>(pEnt);
+		const CTestProjectile *pProjCopy = dynamic_cast<const CTestProjectile *>(pCopy);
+		ASSERT_EQ(pProj == nullptr, pProjCopy == nullptr);
+		if(pProj)
+		{
+			EXPECT_EQ(pProjCopy->m_Direction, pProj->m_Direction);
+			EXPECT_EQ(pProjCopy->m_LifeSpan, pProj->m_LifeSpan);
+		}
+	}
+}
+
+TEST(EntityPool, ReuseAndRelease)
+{
+	CEntityPool Pool;
+	void *pFirst = Pool.Allocate(32);
+	mem_copy(pFirst, "stale data, must not survive....", 32);
+	Pool.Free(pFirst, 32);
+	EXPECT_EQ(Pool.Stats().m_NumFree, 1);
+	EXPECT_EQ(Pool.Stats().m_NumLive, 0);
+
+	// different sizes never share storage
+	void *pOther = Pool.Allocate(48);
+	EXPECT_EQ(Pool.Stats().m_NumHeapAllocs, 2);
+	EXPECT_EQ(Pool.Stats().m_NumReused, 0);
+
+	void *pSecond = Pool.Allocate(32);
+	EXPECT_EQ(pSecond, pFirst);
+	EXPECT_EQ(Pool.Stats().m_NumReused, 1);
+	EXPECT_EQ(Pool.Stats().m_NumFree, 0);
+	const char aZeroes[32] = {0};
+	EXPECT_EQ(mem_comp(pSecond, aZeroes, sizeof(aZeroes)), 0);
+
+	Pool.Free(pSecond, 32);
+	Pool.Free(pOther, 48);
+	EXPECT_EQ(Pool.Stats().m_NumFree, 2);
+	Pool.Release();
+	EXPECT_EQ(Pool.Stats().m_NumFree, 0);
+	EXPECT_EQ(Pool.Stats().m_NumLive, 0);
+
+	Pool.Free(Pool.Allocate(32), 32);
+	EXPECT_EQ(Pool.Stats().m_NumHeapAllocs, 3);
+	EXPECT_EQ(Pool.Stats().m_NumReused, 1);
+}
+
+TEST(EntityPool, CopiedWorldMatchesAfterRecycling)
+{
+	{
+		CTestWorld Source;
+		for(int i = 0; i < 8; i++)
+		{
+			if(i % 2)
+				Source.m_vpEntities.push_back(new CTestProjectile(i, vec2(i * 32.0f, 64.0f), vec2(1.0f, -i)));
+			else
+				Source.m_vpEntities.push_back(new CTestEntity(i, vec2(i * 32.0f, 0.0f)));
+			Source.m_vpEntities.back()->m_Health = 100 + i;
+		}
+
+		CTestWorld Copy;
+		Copy.CopyWorld(&Source);
+		ExpectCopyMatches(Source, Copy);
+		const int64_t NumHeapAllocs = gs_TestPool.Stats().m_NumHeapAllocs;
+		EXPECT_EQ(NumHeapAllocs, 16);
+		EXPECT_EQ(gs_TestPool.Stats().m_NumReused, 0);
+
+		// the second copy runs entirely on the storage the first one gave back
+		for(CTestEntity *pEnt : Copy.m_vpEntities)
+			pEnt->m_Health = -1;
+		Copy.CopyWorld(&Source);
+		ExpectCopyMatches(Source, Copy);
+		EXPECT_EQ(gs_TestPool.Stats().m_NumHeapAllocs, NumHeapAllocs);
+		EXPECT_EQ(gs_TestPool.Stats().m_NumReused, 8);
+		EXPECT_EQ(gs_TestPool.Stats().m_NumFree, 0);
+		EXPECT_EQ(gs_TestPool.Stats().m_NumLive, 16);
+
+		// the source changed, the next copy must not keep stale state
+		Source.m_vpEntities[0]->m_Pos = vec2(-5.0f, 5.0f);
+		Source.m_vpEntities[1]->m_Health = 0;
+		Copy.CopyWorld(&Source);
+		ExpectCopyMatches(Source, Copy);
+		EXPECT_EQ(gs_TestPool.Stats().m_NumHeapAllocs, NumHeapAllocs);
+	}
+
+	EXPECT_EQ(gs_TestPool.Stats().m_NumLive, 0);
+	EXPECT_EQ(gs_TestPool.Stats().m_NumFree, 16);
+	gs_TestPool.Release();
+	EXPECT_EQ(gs_TestPool.Stats().m_NumFree, 0);
+}
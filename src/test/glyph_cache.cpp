@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <engine/client/glyph_cache.h>
+
+#include <vector>
+
+static const SHA256_DIGEST FONT_KEY = sha256("fonts", 5);
+
+static void AddGlyph(std::vector<unsigned char> &vData, int FaceIndex, int Chr, uint16_t Width, uint16_t Height)
+{
+	SGlyphCacheEntry Entry = {};
+	Entry.m_FaceIndex = FaceIndex;
+	Entry.m_Chr = Chr;
+	Entry.m_FontSize = 12;
+	Entry.m_GlyphIndex = Chr + 1;
+	Entry.m_Width = Width;
+	Entry.m_Height = Height;
+	const unsigned char *pEntry = (const unsigned char *)&Entry;
+	vData.insert(vData.end(), pEntry, pEntry + sizeof(Entry));
+	vData.insert(vData.end(), (size_t)Width * Height, 0x11);
+	vData.insert(vData.end(), (size_t)Width * Height, 0x22);
+}
+
+static std::vector<unsigned char> CacheData(int NumGlyphs)
+{
+	SGlyphCacheHeader Header;
+	mem_copy(Header.m_aMagic, SGlyphCacheHeader::MAGIC, sizeof(Header.m_aMagic));
+	Header.m_Version = SGlyphCacheHeader::VERSION;
+	Header.m_FontKey = FONT_KEY;
+	Header.m_NumGlyphs = NumGlyphs;
+	const unsigned char *pHeader = (const unsigned char *)&Header;
+	std::vector<unsigned char> vData(pHeader, pHeader + sizeof(Header));
+	for(int i = 0; i < NumGlyphs; i++)
+		AddGlyph(vData, i % 2, 'a' + i, 3 + i, 4);
+	return vData;
+}
+
+TEST(GlyphCache, Read)
+{
+	const std::vector<unsigned char> vData = CacheData(3);
+	std::vector<SCachedGlyph> vGlyphs;
+	ASSERT_TRUE(ReadGlyphCache(vData.data(), vData.size(), FONT_KEY, 2, vGlyphs));
+	ASSERT_EQ(vGlyphs.size(), 3u);
+	for(int i = 0; i < 3; i++)
+	{
+		EXPECT_EQ(vGlyphs[i].m_Entry.m_FaceIndex, i % 2);
+		EXPECT_EQ(vGlyphs[i].m_Entry.m_Chr, 'a' + i);
+		EXPECT_EQ(vGlyphs[i].m_Entry.m_GlyphIndex, (uint32_t)('a' + i + 1));
+		EXPECT_EQ(vGlyphs[i].m_vFill, std::vector<uint8_t>((3 + i) * 4, 0x11));
+		EXPECT_EQ(vGlyphs[i].m_vOutline, std::vector<uint8_t>((3 + i) * 4, 0x22));
+	}
+}
+
+TEST(GlyphCache, RejectMagic)
+{
+	std::vector<unsigned char> vData = CacheData(1);
+	vData[0] = 'X';
+	std::vector<SCachedGlyph> vGlyphs;
+	EXPECT_FALSE(ReadGlyphCache(vData.data(), vData.size(), FONT_KEY, 2, vGlyphs));
+	EXPECT_TRUE(vGlyphs.empty());
+}
+
+TEST(GlyphCache, RejectVersion)
+{
+	std::vector<unsigned char> vData = CacheData(1);
+	SGlyphCacheHeader Header;
+	mem_copy(&Header, vData.data(), sizeof(Header));
+	Header.m_Version = SGlyphCacheHeader::VERSION + 1;
+	mem_copy(vData.data(), &Header, sizeof(Header));
+	std::vector<SCachedGlyph> vGlyphs;
+	EXPECT_FALSE(ReadGlyphCache(vData.data(), vData.size(), FONT_KEY, 2, vGlyphs));
+	EXPECT_TRUE(vGlyphs.empty());
+}
+
+TEST(GlyphCache, RejectFontKey)
+{
+	const std::vector<unsigned char> vData = CacheData(1);
+	std::vector<SCachedGlyph> vGlyphs;
+	EXPECT_FALSE(ReadGlyphCache(vData.data(), vData.size(), sha256("other fonts", 11), 2, vGlyphs));
+	EXPECT_TRUE(vGlyphs.empty());
+}
+
+TEST(GlyphCache, RejectShortHeader)
+{
+	const std::vector<unsigned char> vData = CacheData(0);
+	std::vector<SCachedGlyph> vGlyphs;
+	EXPECT_FALSE(ReadGlyphCache(vData.data(), vData.size() - 1, FONT_KEY, 2, vGlyphs));
+	EXPECT_TRUE(ReadGlyphCache(vData.data(), vData.size(), FONT_KEY, 2, vGlyphs));
+	EXPECT_TRUE(vGlyphs.empty());
+}
+
+TEST(GlyphCache, StopAtBadEntry)
+{
+	// truncated bitmap data
+	std::vector<unsigned char> vData = CacheData(3);
+	vData.pop_back();
+	std::vector<SCachedGlyph> vGlyphs;
+	EXPECT_TRUE(ReadGlyphCache(vData.data(), vData.size(), FONT_KEY, 2, vGlyphs));
+	EXPECT_EQ(vGlyphs.size(), 2u);
+
+	// unknown face
+	vData = CacheData(3);
+	vGlyphs.clear();
+	EXPECT_TRUE(ReadGlyphCache(vData.data(), vData.size(), FONT_KEY, 1, vGlyphs));
+	EXPECT_EQ(vGlyphs.size(), 1u);
+}
+
+TEST(GlyphCache, HugeGlyphCount)
+{
+	// a corrupt count must not make the reader allocate for it
+	std::vector<unsigned char> vData = CacheData(2);
+	SGlyphCacheHeader Header;
+	mem_copy(&Header, vData.data(), sizeof(Header));
+	Header.m_NumGlyphs = 0x7fffffff;
+	mem_copy(vData.data(), &Header, sizeof(Header));
+	std::vector<SCachedGlyph> vGlyphs;
+	EXPECT_TRUE(ReadGlyphCache(vData.data(), vData.size(), FONT_KEY, 2, vGlyphs));
+	EXPECT_EQ(vGlyphs.size(), 2u);
+	EXPECT_LT(vGlyphs.capacity(), 16u);
+}
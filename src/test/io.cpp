@@ -126,6 +126,41 @@ TEST(Io, SeekTellSkip)
 	EXPECT_FALSE(fs_remove(Info.m_aFilename));
 }
 
+TEST(Io, Map)
+{
+	char aWritten[3 * 4096 + 123];
+	for(size_t i = 0; i < sizeof(aWritten); i++)
+		aWritten[i] = (char)(i * 7);
+	CTestInfo Info;
+
+	IOHANDLE File = io_open(Info.m_aFilename, IOFLAG_WRITE);
+	ASSERT_TRUE(File);
+	EXPECT_EQ(io_write(File, aWritten, sizeof(aWritten)), sizeof(aWritten));
+	EXPECT_FALSE(io_close(File));
+
+	File = io_open(Info.m_aFilename, IOFLAG_READ);
+	ASSERT_TRUE(File);
+	char *pMapped = static_cast<char *>(io_map(File, sizeof(aWritten)));
+	EXPECT_FALSE(io_close(File));
+	ASSERT_TRUE(pMapped);
+	EXPECT_EQ(mem_comp(pMapped, aWritten, sizeof(aWritten)), 0);
+
+	// released pages are read from the file again
+	io_map_release(pMapped + 1, sizeof(aWritten) - 1);
+	EXPECT_EQ(mem_comp(pMapped, aWritten, sizeof(aWritten)), 0);
+
+	// writes are private to the mapping
+	pMapped[0] = aWritten[0] + 1;
+	io_unmap(pMapped, sizeof(aWritten));
+	File = io_open(Info.m_aFilename, IOFLAG_READ);
+	ASSERT_TRUE(File);
+	char aRead[sizeof(aWritten)];
+	EXPECT_EQ(io_read(File, aRead, sizeof(aRead)), sizeof(aRead));
+	EXPECT_EQ(mem_comp(aRead, aWritten, sizeof(aWritten)), 0);
+	EXPECT_FALSE(io_close(File));
+	EXPECT_FALSE(fs_remove(Info.m_aFilename));
+}
+
 TEST(Io, CurrentExe)
 {
 	IOHANDLE CurrentExe = io_current_exe();
@@ -44,8 +44,21 @@ public:
 	{
 		IJob::Abortable(Abortable);
 	}
+
+	void SetPriority(EJobPriority Priority)
+	{
+		IJob::SetPriority(Priority);
+	}
 };
 
+static void WaitDone(const std::shared_ptr<IJob> &pJob)
+{
+	while(!pJob->Done())
+	{
+		thread_yield();
+	}
+}
+
 TEST_F(Jobs, Constructor)
 {
 }
@@ -163,3 +176,184 @@ TEST_F(Jobs, Many)
 	}
 	SetUp();
 }
+
+TEST_F(Jobs, Priority)
+{
+	// a single worker makes the order deterministic
+	CJobPool Pool;
+	Pool.Init(1);
+	SEMAPHORE sphore;
+	sphore_init(&sphore);
+	auto pBlocker = std::make_shared<CJob>([&] { sphore_wait(&sphore); });
+	Pool.Add(pBlocker);
+
+	std::vector<int> vOrder;
+	std::vector<std::shared_ptr<IJob>> vpJobs;
+	for(int i = 0; i < 4; i++)
+	{
+		auto pJob = std::make_shared<CJob>([&vOrder, i] { vOrder.push_back(i); });
+		pJob->SetPriority(i < 2 ? IJob::PRIORITY_NORMAL : IJob::PRIORITY_HIGH);
+		EXPECT_EQ(pJob->Priority(), i < 2 ? IJob::PRIORITY_NORMAL : IJob::PRIORITY_HIGH);
+		vpJobs.push_back(pJob);
+		Pool.Add(pJob);
+	}
+	sphore_signal(&sphore);
+	for(auto &pJob : vpJobs)
+	{
+		WaitDone(pJob);
+	}
+	EXPECT_EQ(vOrder, std::vector<int>({2, 3, 0, 1}));
+	Pool.Shutdown();
+	sphore_destroy(&sphore);
+}
+
+TEST_F(Jobs, Dependencies)
+{
+	std::atomic<int> NumDone(0);
+	std::atomic<bool> DependenciesDone(false);
+	std::vector<std::shared_ptr<IJob>> vpDependencies;
+	for(int i = 0; i < 8; i++)
+	{
+		vpDependencies.push_back(std::make_shared<CJob>([&] { NumDone++; }));
+	}
+	auto pContinuation = std::make_shared<CJob>([&] { DependenciesDone = NumDone == 8; });
+	for(auto &pDependency : vpDependencies)
+	{
+		pContinuation->AddDependency(pDependency);
+	}
+
+	// the continuation may be added before its dependencies
+	Add(pContinuation);
+	for(auto &pDependency : vpDependencies)
+	{
+		Add(pDependency);
+	}
+	WaitDone(pContinuation);
+	EXPECT_EQ(pContinuation->State(), IJob::STATE_DONE);
+	EXPECT_TRUE(DependenciesDone);
+
+	// dependencies that have already finished do not delay the job
+	auto pLate = std::make_shared<CJob>([] {});
+	pLate->AddDependency(pContinuation);
+	Add(pLate);
+	WaitDone(pLate);
+	EXPECT_EQ(pLate->State(), IJob::STATE_DONE);
+}
+
+TEST_F(Jobs, DependencyChain)
+{
+	std::vector<int> vOrder;
+	std::vector<std::shared_ptr<CJob>> vpJobs;
+	for(int i = 0; i < 20; i++)
+	{
+		vpJobs.push_back(std::make_shared<CJob>([&vOrder, i] { vOrder.push_back(i); }));
+		if(i > 0)
+			vpJobs[i]->AddDependency(vpJobs[i - 1]);
+	}
+	for(int i = vpJobs.size() - 1; i >= 0; i--)
+	{
+		Add(vpJobs[i]);
+	}
+	WaitDone(vpJobs.back());
+	ASSERT_EQ(vOrder.size(), vpJobs.size());
+	for(size_t i = 0; i < vOrder.size(); i++)
+	{
+		EXPECT_EQ(vOrder[i], (int)i);
+	}
+}
+
+TEST_F(Jobs, DependencyAborted)
+{
+	CJobPool Pool;
+	Pool.Init(1);
+	SEMAPHORE sphore;
+	sphore_init(&sphore);
+	Pool.Add(std::make_shared<CJob>([&] { sphore_wait(&sphore); }));
+
+	bool DependencyRan = false;
+	auto pDependency = std::make_shared<CJob>([&] { DependencyRan = true; });
+	pDependency->Abortable(true);
+	auto pContinuation = std::make_shared<CJob>([] {});
+	pContinuation->AddDependency(pDependency);
+	Pool.Add(pDependency);
+	Pool.Add(pContinuation);
+	EXPECT_TRUE(pDependency->Abort());
+	sphore_signal(&sphore);
+
+	// continuations also run after aborted dependencies
+	WaitDone(pContinuation);
+	EXPECT_EQ(pContinuation->State(), IJob::STATE_DONE);
+	EXPECT_EQ(pDependency->State(), IJob::STATE_ABORTED);
+	EXPECT_FALSE(DependencyRan);
+	Pool.Shutdown();
+	sphore_destroy(&sphore);
+}
+
+TEST_F(Jobs, Stats)
+{
+	CJobPool Pool;
+	Pool.Init(2);
+	std::vector<std::shared_ptr<IJob>> vpJobs;
+	for(int i = 0; i < 10; i++)
+	{
+		auto pJob = std::make_shared<CJob>([] {});
+		pJob->SetPriority(i < 3 ? IJob::PRIORITY_HIGH : IJob::PRIORITY_NORMAL);
+		vpJobs.push_back(pJob);
+		Pool.Add(pJob);
+	}
+	for(auto &pJob : vpJobs)
+	{
+		WaitDone(pJob);
+	}
+
+	std::vector<CJobQueueStats> vStats;
+	Pool.GetStats(vStats);
+	ASSERT_EQ(vStats.size(), 2 * IJob::NUM_PRIORITIES);
+	uint64_t aNumAdded[IJob::NUM_PRIORITIES] = {0};
+	uint64_t aNumTaken[IJob::NUM_PRIORITIES] = {0};
+	for(const CJobQueueStats &Stats : vStats)
+	{
+		EXPECT_EQ(Stats.m_Depth, 0);
+		EXPECT_LE(Stats.m_NumStolen, Stats.m_NumTaken);
+		EXPECT_LE(Stats.m_WaitMax, Stats.m_WaitTotal);
+		aNumAdded[Stats.m_Priority] += Stats.m_NumAdded;
+		aNumTaken[Stats.m_Priority] += Stats.m_NumTaken;
+	}
+	EXPECT_EQ(aNumAdded[IJob::PRIORITY_HIGH], 3);
+	EXPECT_EQ(aNumTaken[IJob::PRIORITY_HIGH], 3);
+	EXPECT_EQ(aNumAdded[IJob::PRIORITY_NORMAL], 7);
+	EXPECT_EQ(aNumTaken[IJob::PRIORITY_NORMAL], 7);
+	Pool.Shutdown();
+}
+
+TEST_F(Jobs, WorkBatch)
+{
+	const size_t Num = 1000;
+	std::vector<int> vProcessed(Num, 0);
+	{
+		CWorkBatch Batch(Num, [&](size_t Index) { vProcessed[Index]++; });
+		Batch.Start([&](std::shared_ptr<IJob> pJob) { Add(std::move(pJob)); }, TEST_NUM_THREADS);
+		for(size_t i = 0; i < Num; i += 100)
+		{
+			Batch.Wait(i);
+			EXPECT_EQ(vProcessed[i], 1);
+		}
+		Batch.Wait();
+	}
+	for(size_t i = 0; i < Num; i++)
+	{
+		EXPECT_EQ(vProcessed[i], 1) << "Index=" << i;
+	}
+}
+
+TEST_F(Jobs, WorkBatchWithoutJobs)
+{
+	// items are processed by the waiting thread if no job runs
+	std::vector<int> vProcessed(10, 0);
+	CWorkBatch Batch(vProcessed.size(), [&](size_t Index) { vProcessed[Index]++; });
+	Batch.Start([](std::shared_ptr<IJob> pJob) {}, 4);
+	Batch.Wait(3);
+	EXPECT_EQ(vProcessed, std::vector<int>({1, 1, 1, 1, 0, 0, 0, 0, 0, 0}));
+	Batch.Wait();
+	EXPECT_EQ(vProcessed, std::vector<int>(10, 1));
+}
@@ -48,3 +48,51 @@ TEST(Net, Ipv4AndIpv6Work)
 	net_udp_close(Socket1);
 	net_udp_close(Socket2);
 }
+
+TEST(Net, UdpSendBatching)
+{
+	NETADDR Bindaddr = {};
+	NETSOCKET Sender;
+	NETSOCKET Receiver;
+
+	Bindaddr.type = NETTYPE_IPV4;
+	Sender = net_udp_create(Bindaddr);
+	ASSERT_TRUE(Sender);
+	do
+	{
+		Bindaddr.port = secure_rand() % 64511 + 1024;
+	} while(!(Receiver = net_udp_create(Bindaddr)));
+
+	NETADDR Target;
+	ASSERT_FALSE(net_addr_from_str(&Target, "127.0.0.1"));
+	Target.port = Bindaddr.port;
+
+	net_udp_set_batching(Sender, true);
+	const int NumPackets = 200; // more than fit into one batch
+	for(int i = 0; i < NumPackets; i++)
+		EXPECT_EQ(net_udp_send(Sender, &Target, &i, sizeof(i)), (int)sizeof(i));
+	net_udp_flush(Sender);
+
+	// received packets are buffered too, so only wait for the first one
+	ASSERT_EQ(net_socket_read_wait(Receiver, 10000000), 1);
+	for(int i = 0; i < NumPackets; i++)
+	{
+		NETADDR Addr;
+		unsigned char *pData;
+		ASSERT_EQ(net_udp_recv(Receiver, &Addr, &pData), (int)sizeof(i));
+		int Value;
+		mem_copy(&Value, pData, sizeof(Value));
+		EXPECT_EQ(Value, i);
+	}
+
+	net_udp_set_batching(Sender, false);
+	EXPECT_EQ(net_udp_send(Sender, &Target, "abc", 3), 3);
+	NETADDR Addr;
+	unsigned char *pData;
+	ASSERT_EQ(net_socket_read_wait(Receiver, 10000000), 1);
+	ASSERT_EQ(net_udp_recv(Receiver, &Addr, &pData), 3);
+	EXPECT_EQ(mem_comp(pData, "abc", 3), 0);
+
+	net_udp_close(Sender);
+	net_udp_close(Receiver);
+}
@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <engine/shared/config.h>
+#include <engine/shared/network.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+class NetServer : public ::testing::Test
+{
+protected:
+	std::unique_ptr<CNetServer> m_pServer = std::make_unique<CNetServer>();
+	NETADDR m_ServerAddr;
+	std::vector<std::unique_ptr<CNetClient>> m_vpClients;
+	std::vector<int> m_vNewClients;
+	std::vector<int> m_vDelClients;
+
+	class CReceived
+	{
+	public:
+		int m_ClientId;
+		std::string m_Data;
+	};
+	std::vector<CReceived> m_vReceived;
+
+	static int NewClientCallback(int ClientId, void *pUser, bool Sixup)
+	{
+		static_cast<NetServer *>(pUser)->m_vNewClients.push_back(ClientId);
+		return 0;
+	}
+
+	static int DelClientCallback(int ClientId, const char *pReason, void *pUser)
+	{
+		static_cast<NetServer *>(pUser)->m_vDelClients.push_back(ClientId);
+		return 0;
+	}
+
+	NetServer()
+	{
+		CNetBase::Init();
+		g_Config.m_ConnTimeout = 100;
+		g_Config.m_SvConnlimit = 5;
+		g_Config.m_SvConnlimitTime = 20;
+
+		NETADDR BindAddr = {};
+		BindAddr.type = NETTYPE_IPV4;
+		do
+		{
+			BindAddr.port = secure_rand() % 64511 + 1024;
+		} while(!m_pServer->Open(BindAddr, nullptr, 4, 4));
+		m_pServer->SetCallbacks(NewClientCallback, DelClientCallback, this);
+
+		EXPECT_FALSE(net_addr_from_str(&m_ServerAddr, "127.0.0.1"));
+		m_ServerAddr.port = BindAddr.port;
+	}
+
+	~NetServer()
+	{
+		for(auto &pClient : m_vpClients)
+			pClient->Close();
+		m_pServer->Close();
+	}
+
+	CNetClient *AddClient()
+	{
+		NETADDR BindAddr = {};
+		BindAddr.type = NETTYPE_IPV4;
+		m_vpClients.push_back(std::make_unique<CNetClient>());
+		EXPECT_TRUE(m_vpClients.back()->Open(BindAddr));
+		return m_vpClients.back().get();
+	}
+
+	void Pump()
+	{
+		CNetChunk Chunk;
+		SECURITY_TOKEN ResponseToken;
+		for(auto &pClient : m_vpClients)
+		{
+			pClient->Update();
+			while(pClient->Recv(&Chunk, &ResponseToken, false))
+			{
+			}
+			pClient->Flush();
+		}
+		m_pServer->Update();
+		while(m_pServer->Recv(&Chunk, &ResponseToken))
+		{
+			if(Chunk.m_ClientId >= 0)
+				m_vReceived.push_back({Chunk.m_ClientId, std::string((const char *)Chunk.m_pData, Chunk.m_DataSize)});
+		}
+		std::this_thread::sleep_for(1ms);
+	}
+
+	template<typename F>
+	bool PumpUntil(F &&Done)
+	{
+		for(int i = 0; i < 5000; i++)
+		{
+			if(Done())
+				return true;
+			Pump();
+		}
+		return Done();
+	}
+
+	// returns the slot the server gave the client
+	int Connect(CNetClient *pClient)
+	{
+		const size_t NumNewClients = m_vNewClients.size();
+		pClient->Connect(&m_ServerAddr, 1);
+		EXPECT_TRUE(PumpUntil([&]() { return pClient->State() == NETSTATE_ONLINE && m_vNewClients.size() > NumNewClients; }));
+		return m_vNewClients.size() > NumNewClients ? m_vNewClients.back() : -1;
+	}
+
+	// returns the slot the server attributed the message to
+	int SendToServer(CNetClient *pClient, const char *pMessage)
+	{
+		CNetChunk Chunk;
+		Chunk.m_ClientId = 0;
+		Chunk.m_Flags = NETSENDFLAG_VITAL | NETSENDFLAG_FLUSH;
+		Chunk.m_DataSize = str_length(pMessage);
+		Chunk.m_pData = pMessage;
+		pClient->Send(&Chunk);
+
+		int ClientId = -1;
+		EXPECT_TRUE(PumpUntil([&]() {
+			for(const CReceived &Received : m_vReceived)
+				if(Received.m_Data == pMessage)
+					ClientId = Received.m_ClientId;
+			return ClientId != -1;
+		}));
+		return ClientId;
+	}
+
+	void Drop(int ClientId, CNetClient *pClient)
+	{
+		m_pServer->Drop(ClientId, "test");
+		EXPECT_TRUE(PumpUntil([&]() { return pClient->State() == NETSTATE_OFFLINE; }));
+	}
+};
+
+TEST_F(NetServer, ReconnectFromSameAddress)
+{
+	CNetClient *pFirst = AddClient();
+	CNetClient *pSecond = AddClient();
+	ASSERT_EQ(Connect(pFirst), 0);
+	ASSERT_EQ(Connect(pSecond), 1);
+	const NETADDR FirstAddr = *m_pServer->ClientAddr(0);
+	EXPECT_EQ(SendToServer(pFirst, "first"), 0);
+	EXPECT_EQ(SendToServer(pSecond, "second"), 1);
+
+	Drop(0, pFirst);
+	EXPECT_EQ(m_vDelClients, std::vector<int>{0});
+
+	// same socket, so same address and port as before
+	ASSERT_EQ(Connect(pFirst), 0);
+	EXPECT_EQ(*m_pServer->ClientAddr(0), FirstAddr);
+	EXPECT_EQ(SendToServer(pFirst, "first again"), 0);
+	EXPECT_EQ(SendToServer(pSecond, "second again"), 1);
+}
+
+TEST_F(NetServer, SlotReusedAfterDrop)
+{
+	CNetClient *pFirst = AddClient();
+	CNetClient *pSecond = AddClient();
+	ASSERT_EQ(Connect(pFirst), 0);
+	ASSERT_EQ(Connect(pSecond), 1);
+	const NETADDR SecondAddr = *m_pServer->ClientAddr(1);
+
+	Drop(1, pSecond);
+
+	// a peer from another address gets the slot, the old address no longer maps to it
+	CNetClient *pThird = AddClient();
+	ASSERT_EQ(Connect(pThird), 1);
+	EXPECT_NE(*m_pServer->ClientAddr(1), SecondAddr);
+	EXPECT_EQ(SendToServer(pThird, "third"), 1);
+	EXPECT_EQ(SendToServer(pFirst, "first"), 0);
+
+	Drop(0, pFirst);
+	Drop(1, pThird);
+	EXPECT_EQ(m_vDelClients, (std::vector<int>{1, 0, 1}));
+
+	// a dropped client reconnecting gets the first free slot again
+	ASSERT_EQ(Connect(pSecond), 0);
+	EXPECT_EQ(SendToServer(pSecond, "second"), 0);
+}
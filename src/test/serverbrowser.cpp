@@ -1,13 +1,17 @@
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 #include <base/system.h>
 
+#include <engine/client/serverbrowser.h>
 #include <engine/client/serverbrowser_ping_cache.h>
 #include <engine/console.h>
 #include <engine/engine.h>
 #include <engine/shared/config.h>
 #include <engine/storage.h>
+#include <game/prng.h>
 #include <test/test.h>
 
 TEST(ServerBrowser, PingCache)
@@ -100,3 +104,55 @@ TEST(ServerBrowser, PingCache)
 	EXPECT_EQ(pPingCache->GetPing(&OtherLocalhost4, 1), 1337);
 	EXPECT_EQ(pPingCache->GetPing(&OtherLocalhost6, 1), 345);
 }
+
+TEST(ServerBrowser, MergeDirtyServers)
+{
+	uint64_t aSeed[2] = {0x5eed5eed5eed5eed, 0x0123456789abcdef};
+	CPrng Prng;
+	Prng.Seed(aSeed);
+
+	// few distinct keys, so that many servers compare equal
+	const int NumServers = 200;
+	std::vector<int> vKeys(NumServers);
+	std::vector<bool> vVisible(NumServers);
+	for(int i = 0; i < NumServers; i++)
+	{
+		vKeys[i] = Prng.RandomBits() % 16;
+		vVisible[i] = Prng.RandomBits() % 4 != 0;
+	}
+
+	const auto &&Filter = [&](int Index) { return vVisible[Index]; };
+	const auto &&Less = [&](int Index1, int Index2) {
+		if(vKeys[Index1] != vKeys[Index2])
+			return vKeys[Index1] < vKeys[Index2];
+		return Index1 < Index2;
+	};
+	const auto &&FullSort = [&]() {
+		std::vector<int> vSorted;
+		for(int i = 0; i < NumServers; i++)
+		{
+			if(Filter(i))
+				vSorted.push_back(i);
+		}
+		std::sort(vSorted.begin(), vSorted.end(), Less);
+		return vSorted;
+	};
+
+	std::vector<int> vSorted = FullSort();
+	std::vector<int> vDirty;
+	for(int Round = 0; Round < 1000; Round++)
+	{
+		// some rounds change nothing, some change many servers, possibly the same one twice
+		const int NumUpdates = Prng.RandomBits() % (Round % 10 == 0 ? NumServers : 8);
+		for(int i = 0; i < NumUpdates; i++)
+		{
+			const int Index = Prng.RandomBits() % NumServers;
+			vKeys[Index] = Prng.RandomBits() % 16;
+			vVisible[Index] = Prng.RandomBits() % 4 != 0;
+			vDirty.push_back(Index);
+		}
+		CServerBrowser::MergeDirtyServers(vSorted, vDirty, Filter, Less);
+		EXPECT_TRUE(vDirty.empty());
+		ASSERT_EQ(vSorted, FullSort()) << "Round " << Round;
+	}
+}
@@ -1,8 +1,14 @@
 #include <gtest/gtest.h>
 
 #include <base/system.h>
+#include <engine/server/snapshot_workers.h>
 #include <engine/shared/snapshot.h>
 #include <game/generated/protocol.h>
+#include <game/generated/protocol7.h>
+#include <game/prng.h>
+
+#include <memory>
+#include <vector>
 
 TEST(Snapshot, CrcOneInt)
 {
@@ -83,3 +89,217 @@ TEST(Snapshot, CrcOverflow)
 
 	ASSERT_EQ(pSnapshot->Crc(), 1);
 }
+
+TEST(Snapshot, IndexLookup)
+{
+	CSnapshotBuilder Builder;
+	Builder.Init();
+
+	for(int Id = 5; Id >= 0; Id--)
+	{
+		CNetObj_Flag *pFlag = static_cast<CNetObj_Flag *>(Builder.NewItem(CNetObj_Flag::ms_MsgId, Id, sizeof(CNetObj_Flag)));
+		ASSERT_FALSE(pFlag == nullptr);
+		pFlag->m_X = Id;
+	}
+	for(int Id = 0; Id < 3; Id++)
+	{
+		CNetObj_Pickup *pPickup = static_cast<CNetObj_Pickup *>(Builder.NewItem(CNetObj_Pickup::ms_MsgId, Id, sizeof(CNetObj_Pickup)));
+		ASSERT_FALSE(pPickup == nullptr);
+		pPickup->m_X = 100 + Id;
+	}
+	CNetObj_DDNetPlayer *pDDNetPlayer = static_cast<CNetObj_DDNetPlayer *>(Builder.NewItem(CNetObj_DDNetPlayer::ms_MsgId, 7, sizeof(CNetObj_DDNetPlayer)));
+	ASSERT_FALSE(pDDNetPlayer == nullptr);
+	pDDNetPlayer->m_AuthLevel = 3;
+
+	char aData[CSnapshot::MAX_SIZE];
+	CSnapshot *pSnapshot = (CSnapshot *)aData;
+	Builder.Finish(pSnapshot);
+
+	CSnapshotIndex Index;
+	Index.Build(pSnapshot);
+	EXPECT_EQ(Index.Snapshot(), pSnapshot);
+
+	for(int i = 0; i < pSnapshot->NumItems(); i++)
+	{
+		const int Key = pSnapshot->GetItem(i)->Key();
+		EXPECT_EQ(Index.GetItemIndex(Key), pSnapshot->GetItemIndex(Key));
+		EXPECT_EQ(Index.GetItemType(i), pSnapshot->GetItemType(i));
+	}
+	EXPECT_EQ(Index.GetItemIndex((CNetObj_Flag::ms_MsgId << 16) | 6), -1);
+
+	for(int Id = 0; Id < 8; Id++)
+	{
+		EXPECT_EQ(Index.FindItem(CNetObj_Flag::ms_MsgId, Id), pSnapshot->FindItem(CNetObj_Flag::ms_MsgId, Id));
+		EXPECT_EQ(Index.FindItem(CNetObj_DDNetPlayer::ms_MsgId, Id), pSnapshot->FindItem(CNetObj_DDNetPlayer::ms_MsgId, Id));
+	}
+	const CNetObj_DDNetPlayer *pFound = static_cast<const CNetObj_DDNetPlayer *>(Index.FindItem(CNetObj_DDNetPlayer::ms_MsgId, 7));
+	ASSERT_FALSE(pFound == nullptr);
+	EXPECT_EQ(pFound->m_AuthLevel, 3);
+
+	int ExpectedId = 0;
+	for(int ItemIndex : Index.ItemsOfType(CNetObj_Flag::ms_MsgId))
+	{
+		const CSnapshotItem *pItem = pSnapshot->GetItem(ItemIndex);
+		EXPECT_EQ(pItem->Type(), CNetObj_Flag::ms_MsgId);
+		EXPECT_EQ(pItem->Id(), ExpectedId);
+		EXPECT_EQ(static_cast<const CNetObj_Flag *>((const void *)pItem->Data())->m_X, ExpectedId);
+		ExpectedId++;
+	}
+	EXPECT_EQ(ExpectedId, 6);
+	EXPECT_EQ(Index.ItemsOfType(CNetObj_Pickup::ms_MsgId).Size(), 3);
+	EXPECT_EQ(Index.ItemsOfType(CNetObj_DDNetPlayer::ms_MsgId).Size(), 1);
+	EXPECT_EQ(Index.ItemsOfType(CNetObj_Laser::ms_MsgId).Size(), 0);
+
+	// the sorted items are built lazily and must not outlive a rebuild
+	Index.Build(CSnapshot::EmptySnapshot());
+	EXPECT_EQ(Index.ItemsOfType(CNetObj_Flag::ms_MsgId).Size(), 0);
+	EXPECT_EQ(Index.FindItem(CNetObj_DDNetPlayer::ms_MsgId, 7), nullptr);
+}
+
+TEST(Snapshot, StorageRing)
+{
+	CSnapshotStorage Storage;
+	int aData[64];
+	for(int i = 0; i < 64; i++)
+		aData[i] = i;
+
+	// fill the storage far beyond its arena, purging like the server does
+	for(int Tick = 0; Tick < 10000; Tick++)
+	{
+		Storage.PurgeUntil(Tick - 150);
+		aData[0] = Tick;
+		Storage.Add(Tick, Tick * 10, sizeof(aData), aData, Tick % 2 ? sizeof(int) : 0, aData);
+	}
+	EXPECT_EQ(Storage.NumArenaAllocations(), 10000u);
+	EXPECT_EQ(Storage.NumHeapAllocations(), 0u);
+
+	EXPECT_EQ(Storage.Get(9848, nullptr, nullptr, nullptr), -1);
+	for(int Tick = 9849; Tick < 10000; Tick++)
+	{
+		int64_t Tagtime;
+		const CSnapshot *pData;
+		const CSnapshot *pAltData;
+		ASSERT_EQ(Storage.Get(Tick, &Tagtime, &pData, &pAltData), (int)sizeof(aData));
+		EXPECT_EQ(Tagtime, Tick * 10);
+		EXPECT_EQ(((const int *)pData)[0], Tick);
+		EXPECT_EQ(((const int *)pData)[63], 63);
+		if(Tick % 2)
+			EXPECT_EQ(((const int *)pAltData)[0], Tick);
+		else
+			EXPECT_EQ(pAltData, nullptr);
+	}
+
+	// snapshots that don't fit into the arena go to the heap
+	EXPECT_EQ(Storage.ArenaSize(), (size_t)CSnapshotStorage::MIN_ARENA_SIZE);
+	for(int Tick = 10000; Tick < 10010; Tick++)
+	{
+		char aBigData[CSnapshot::MAX_SIZE] = {0};
+		Storage.Add(Tick, 0, sizeof(aBigData), aBigData, 0, nullptr);
+	}
+	EXPECT_GT(Storage.NumHeapAllocations(), 0u);
+	EXPECT_EQ(Storage.Get(9999, nullptr, nullptr, nullptr), (int)sizeof(aData));
+	EXPECT_EQ(Storage.Get(10000, nullptr, nullptr, nullptr), CSnapshot::MAX_SIZE);
+
+	Storage.PurgeUntil(10005);
+	EXPECT_EQ(Storage.Get(10004, nullptr, nullptr, nullptr), -1);
+	EXPECT_EQ(Storage.Get(10005, nullptr, nullptr, nullptr), CSnapshot::MAX_SIZE);
+	Storage.PurgeAll();
+	EXPECT_EQ(Storage.Get(10005, nullptr, nullptr, nullptr), -1);
+	EXPECT_EQ(Storage.ArenaSize(), 0u);
+}
+
+TEST(Snapshot, StorageArenaGrows)
+{
+	CSnapshotStorage Storage;
+	static char s_aData[CSnapshot::MAX_SIZE / 4] = {0};
+
+	// retain more than fits into the initial arena, it grows once the snapshots in it are purged
+	const int Retention = 20;
+	uint64_t NumHeapAllocations = 0;
+	for(int Tick = 0; Tick < 10 * Retention; Tick++)
+	{
+		if(Tick == 5 * Retention)
+			NumHeapAllocations = Storage.NumHeapAllocations();
+		Storage.PurgeUntil(Tick - Retention);
+		Storage.Add(Tick, 0, sizeof(s_aData), s_aData, 0, nullptr);
+	}
+	EXPECT_GT(NumHeapAllocations, 0u);
+	EXPECT_EQ(Storage.NumHeapAllocations(), NumHeapAllocations);
+	EXPECT_GT(Storage.ArenaSize(), (size_t)CSnapshotStorage::MIN_ARENA_SIZE);
+	EXPECT_LE(Storage.ArenaSize(), (size_t)CSnapshotStorage::MAX_ARENA_SIZE);
+	EXPECT_EQ(Storage.Get(10 * Retention - 1, nullptr, nullptr, nullptr), (int)sizeof(s_aData));
+}
+
+TEST(Snapshot, DeltaWorkersMatchSingleThreaded)
+{
+	// random snapshots with some items kept, changed, added and removed between the two of each pair
+	const int NumJobs = 32;
+	const int NumTypes = 24;
+	std::vector<std::vector<char>> vFrom(NumJobs, std::vector<char>(CSnapshot::MAX_SIZE));
+	std::vector<std::vector<char>> vTo(NumJobs, std::vector<char>(CSnapshot::MAX_SIZE));
+	CPrng Prng;
+	uint64_t aSeed[2] = {1, 2};
+	Prng.Seed(aSeed);
+	for(int Job = 0; Job < NumJobs; Job++)
+	{
+		for(int Which = 0; Which < 2; Which++)
+		{
+			CSnapshotBuilder Builder;
+			Builder.Init();
+			for(int Type = 1; Type < NumTypes; Type++)
+			{
+				for(int Id = 0; Id < 8; Id++)
+				{
+					if(Prng.RandomBits() % 4 == 0)
+						continue;
+					const int Size = (Type % 4 + 1) * sizeof(int32_t);
+					int *pItem = (int *)Builder.NewItem(Type, Id, Size);
+					ASSERT_NE(pItem, nullptr);
+					for(int i = 0; i < Size / (int)sizeof(int32_t); i++)
+						pItem[i] = Prng.RandomBits() % 3 ? Type + Id + i : Prng.RandomBits();
+				}
+			}
+			Builder.Finish(Which ? vTo[Job].data() : vFrom[Job].data());
+		}
+	}
+
+	CSnapshotDelta Delta;
+	for(int Type = 1; Type < NumTypes; Type += 2)
+		Delta.SetStaticsize(Type, (Type % 4 + 1) * sizeof(int32_t));
+
+	// what the server does without snapshot threads, changing the shared delta for every client
+	std::vector<std::vector<char>> vExpected(NumJobs, std::vector<char>(CSnapshot::MAX_SIZE));
+	std::vector<int> vExpectedSize(NumJobs);
+	for(int Job = 0; Job < NumJobs; Job++)
+	{
+		CSnapshotDelta SingleDelta(Delta);
+		SingleDelta.SetStaticsize(protocol7::NETEVENTTYPE_SOUNDWORLD, Job % 2);
+		SingleDelta.SetStaticsize(protocol7::NETEVENTTYPE_DAMAGE, Job % 2);
+		vExpectedSize[Job] = SingleDelta.CreateDelta((CSnapshot *)vFrom[Job].data(), (CSnapshot *)vTo[Job].data(), vExpected[Job].data());
+	}
+
+	CSnapshotWorkers Workers;
+	Workers.Init(3);
+	std::vector<std::unique_ptr<char[]>> vpDeltaData;
+	for(int i = 0; i < Workers.NumWorkers(); i++)
+		vpDeltaData.push_back(std::make_unique<char[]>(CSnapshot::MAX_SIZE));
+	std::vector<std::vector<char>> vResult(NumJobs, std::vector<char>(CSnapshot::MAX_SIZE));
+	std::vector<int> vResultSize(NumJobs);
+	Workers.Process(NumJobs, [&](int Worker, int Job) {
+		short aItemSizes[CSnapshotDelta::MAX_NETOBJSIZES];
+		mem_copy(aItemSizes, Delta.Staticsizes(), sizeof(aItemSizes));
+		aItemSizes[protocol7::NETEVENTTYPE_SOUNDWORLD] = Job % 2;
+		aItemSizes[protocol7::NETEVENTTYPE_DAMAGE] = Job % 2;
+		char *pDeltaData = vpDeltaData[Worker].get();
+		vResultSize[Job] = CSnapshotDelta::CreateDelta((CSnapshot *)vFrom[Job].data(), (CSnapshot *)vTo[Job].data(), pDeltaData, aItemSizes);
+		mem_copy(vResult[Job].data(), pDeltaData, vResultSize[Job]);
+	});
+	Workers.Shutdown();
+
+	for(int Job = 0; Job < NumJobs; Job++)
+	{
+		ASSERT_GT(vExpectedSize[Job], 0);
+		ASSERT_EQ(vResultSize[Job], vExpectedSize[Job]);
+		EXPECT_EQ(mem_comp(vResult[Job].data(), vExpected[Job].data(), vExpectedSize[Job]), 0) << "job " << Job;
+	}
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <base/log.h>
+#include <base/system.h>
+#include <engine/client/sound_mix.h>
+#include <game/prng.h>
+
+#include <limits>
+#include <vector>
+
+class SoundMix : public ::testing::Test
+{
+protected:
+	CPrng m_Prng;
+
+	SoundMix()
+	{
+		uint64_t aSeed[2] = {0x853c49e6748fea9b, 0xda3e39cb94b95bdb};
+		m_Prng.Seed(aSeed);
+	}
+
+	std::vector<short> RandomSamples(size_t Num)
+	{
+		std::vector<short> vSamples(Num);
+		for(short &Sample : vSamples)
+			Sample = (short)m_Prng.RandomBits();
+		// the extremes are where 16 bit multiplications go wrong
+		if(Num >= 2)
+		{
+			vSamples[0] = std::numeric_limits<short>::min();
+			vSamples[Num - 1] = std::numeric_limits<short>::max();
+		}
+		return vSamples;
+	}
+};
+
+TEST_F(SoundMix, MatchesScalar)
+{
+	const int aVolumes[] = {0, 1, 127, 255, 256, 32767, -32768, 40000};
+	for(int Channels = 1; Channels <= 2; Channels++)
+	{
+		for(unsigned Frames = 0; Frames < 40; Frames++)
+		{
+			for(int Offset = 0; Offset < 3; Offset++)
+			{
+				const std::vector<short> vSamples = RandomSamples((Frames + Offset) * Channels);
+				const int VolumeL = aVolumes[m_Prng.RandomBits() % std::size(aVolumes)];
+				const int VolumeR = aVolumes[m_Prng.RandomBits() % std::size(aVolumes)];
+
+				std::vector<int> vExpected(Frames * 2 + 1);
+				for(int &Value : vExpected)
+					Value = (int)(m_Prng.RandomBits() % 2000000) - 1000000;
+				std::vector<int> vActual = vExpected;
+
+				SoundMixVoiceScalar(vExpected.data(), vSamples.data() + Offset * Channels, Channels, Frames, VolumeL, VolumeR);
+				SoundMixVoice(vActual.data(), vSamples.data() + Offset * Channels, Channels, Frames, VolumeL, VolumeR);
+				ASSERT_EQ(vActual, vExpected) << "Channels=" << Channels << " Frames=" << Frames << " Offset=" << Offset << " VolumeL=" << VolumeL << " VolumeR=" << VolumeR;
+			}
+		}
+	}
+}
+
+TEST_F(SoundMix, MonoUsesSameSampleForBothChannels)
+{
+	const short aSamples[] = {100, -200, 300};
+	int aOut[6] = {0};
+	SoundMixVoice(aOut, aSamples, 1, 3, 2, 3);
+	const int aExpected[] = {200, 300, -400, -600, 600, 900};
+	for(int i = 0; i < 6; i++)
+		EXPECT_EQ(aOut[i], aExpected[i]);
+}
+
+// Run with --gtest_also_run_disabled_tests --gtest_filter=SoundMix.DISABLED_*
+TEST_F(SoundMix, DISABLED_BenchmarkMixVoices)
+{
+	// ten seconds of 48 kHz audio for 64 stereo and mono voices, in callback sized chunks
+	const int NumVoices = 64;
+	const unsigned MixingRate = 48000;
+	const unsigned ChunkFrames = 512;
+	const unsigned Duration = 10;
+
+	std::vector<std::vector<short>> vvSamples;
+	for(int Voice = 0; Voice < NumVoices; Voice++)
+		vvSamples.push_back(RandomSamples(MixingRate * (Voice % 2 + 1)));
+	std::vector<int> vMixBuffer(ChunkFrames * 2);
+
+	for(int Simd = 0; Simd < 2; Simd++)
+	{
+		const int64_t Start = time_get();
+		for(unsigned Mixed = 0; Mixed < MixingRate * Duration; Mixed += ChunkFrames)
+		{
+			std::fill(vMixBuffer.begin(), vMixBuffer.end(), 0);
+			for(int Voice = 0; Voice < NumVoices; Voice++)
+			{
+				const int Channels = Voice % 2 + 1;
+				const short *pIn = vvSamples[Voice].data() + (Mixed % (MixingRate - ChunkFrames)) * Channels;
+				if(Simd)
+					SoundMixVoice(vMixBuffer.data(), pIn, Channels, ChunkFrames, 200, 100);
+				else
+					SoundMixVoiceScalar(vMixBuffer.data(), pIn, Channels, ChunkFrames, 200, 100);
+			}
+		}
+		log_info("sound_mix", "%s: mixed %d voices for %us of audio in %.2fms", Simd ? "SoundMixVoice" : "SoundMixVoiceScalar", NumVoices, Duration, (time_get() - Start) * 1000.0 / time_freq());
+	}
+}
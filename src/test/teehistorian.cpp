@@ -1,3 +1,4 @@
+#include "test.h"
 #include <gtest/gtest.h>
 
 #include <base/detect.h>
@@ -264,6 +265,26 @@ TEST_F(TeeHistorian, TickImplicitTwoTicks)
 	Expect(EXPECTED, sizeof(EXPECTED));
 }
 
+TEST_F(TeeHistorian, TickExplicitNextTick)
+{
+	const unsigned char EXPECTED[] = {
+		0x42, 0x00, 0x01, 0x02, // PLAYER_NEW cid=0 x=1 y=2
+		0x41, 0x00, // TICK_SKIP dt=0
+		0x00, 0x01, 0x40, // PLAYER cid=0 dx=1 dy=-1
+		0x00, 0x01, 0x40, // PLAYER cid=0 dx=1 dy=-1
+		0x40, // FINISH
+	};
+	Tick(1);
+	Player(0, 1, 2);
+	m_TH.ExplicitNextTick();
+	Tick(2);
+	Player(0, 2, 1);
+	Tick(3);
+	Player(0, 3, 0);
+	Finish();
+	Expect(EXPECTED, sizeof(EXPECTED));
+}
+
 TEST_F(TeeHistorian, TickImplicitDescendingClientId)
 {
 	const unsigned char EXPECTED[] = {
@@ -904,3 +925,81 @@ TEST_F(TeeHistorian, PrevGameUuid)
 	EXPECT_STREQ(JsonPrevGameUuid, "fe19c218-f555-4002-a273-126c59ccc17a");
 	json_value_free(pJson);
 }
+
+TEST_F(TeeHistorian, CompressedRoundTrip)
+{
+	// enough movement to fill several frames
+	for(int i = 1; i <= 2000; i++)
+	{
+		Tick(i);
+		for(int ClientId = 0; ClientId < 32; ClientId++)
+			Player(ClientId, (i * (ClientId + 3)) % 4099, (i * i + ClientId) % 1021);
+	}
+	Finish();
+	ASSERT_GT(m_vBuffer.size(), (size_t)CTeeHistorianCompressor::FRAME_SIZE * 3);
+
+	CTestInfo Info;
+	IOHANDLE File = io_open(Info.m_aFilename, IOFLAG_WRITE);
+	ASSERT_TRUE(File);
+	CTeeHistorianCompressor Compressor;
+	ASYNCIO *pAio = aio_new_filtered(File, CTeeHistorianCompressor::Filter, &Compressor);
+	ASSERT_TRUE(pAio);
+	// write in odd sized pieces like the tick thread does, flushing from time to time
+	for(size_t Offset = 0; Offset < m_vBuffer.size(); Offset += 777)
+	{
+		aio_write(pAio, m_vBuffer.data() + Offset, minimum<size_t>(777, m_vBuffer.size() - Offset));
+		if(Offset % (777 * 50) == 0)
+			aio_flush(pAio);
+	}
+	aio_close(pAio);
+	aio_wait(pAio);
+	EXPECT_EQ(aio_error(pAio), 0);
+	aio_free(pAio);
+
+	File = io_open(Info.m_aFilename, IOFLAG_READ);
+	ASSERT_TRUE(File);
+	void *pCompressed;
+	unsigned CompressedSize;
+	ASSERT_TRUE(io_read_all(File, &pCompressed, &CompressedSize));
+	io_close(File);
+	const unsigned char *pData = (const unsigned char *)pCompressed;
+	EXPECT_LT(CompressedSize, m_vBuffer.size());
+
+	std::vector<unsigned char> vDecompressed;
+	EXPECT_TRUE(CTeeHistorianCompressor::Decompress(pData, CompressedSize, vDecompressed));
+	EXPECT_EQ(vDecompressed, m_vBuffer);
+
+	// every frame is a sync point that can be decompressed without the ones before it
+	size_t Offset = sizeof(CTeeHistorianCompressor::MAGIC);
+	size_t Position = 0;
+	int NumFrames = 0;
+	while(Offset < CompressedSize)
+	{
+		std::vector<unsigned char> vFrame;
+		Offset = CTeeHistorianCompressor::DecompressFrame(pData, CompressedSize, Offset, vFrame);
+		ASSERT_NE(Offset, 0u);
+		EXPECT_LE(vFrame.size(), (size_t)CTeeHistorianCompressor::FRAME_SIZE);
+		ASSERT_LE(Position + vFrame.size(), m_vBuffer.size());
+		EXPECT_EQ(mem_comp(vFrame.data(), m_vBuffer.data() + Position, vFrame.size()), 0) << "Frame=" << NumFrames;
+		Position += vFrame.size();
+		NumFrames++;
+	}
+	EXPECT_EQ(Position, m_vBuffer.size());
+	EXPECT_GT(NumFrames, 1);
+
+	// truncated files are rejected
+	vDecompressed.clear();
+	EXPECT_FALSE(CTeeHistorianCompressor::Decompress(pData, CompressedSize - 1, vDecompressed));
+
+	// so are frames claiming to be larger than a frame can be, without allocating for them
+	std::vector<unsigned char> vHostile(pData, pData + CompressedSize);
+	const size_t FirstFrame = sizeof(CTeeHistorianCompressor::MAGIC);
+	uint_to_bytes_be(&vHostile[FirstFrame], 0xffffffff);
+	std::vector<unsigned char> vFrame;
+	EXPECT_EQ(CTeeHistorianCompressor::DecompressFrame(vHostile.data(), vHostile.size(), FirstFrame, vFrame), 0u);
+	EXPECT_TRUE(vFrame.empty());
+
+	free(pCompressed);
+	if(!HasFailure())
+		fs_remove(Info.m_aFilename);
+}
@@ -4,8 +4,10 @@
 #include <cstdint>
 #include <engine/gfx/image_manipulation.h>
 #include <engine/shared/datafile.h>
+#include <engine/shared/jobs.h>
 #include <engine/storage.h>
 #include <game/mapitems.h>
+#include <thread>
 #include <vector>
 
 void ClearTransparentPixels(uint8_t *pImg, int Width, int Height)
@@ -319,7 +321,12 @@ int main(int argc, const char **argv)
 	}
 
 	Reader.Close();
-	Writer.Finish();
+
+	// all data is compressed with the best compression, spread it over all cores
+	CJobPool JobPool;
+	JobPool.Init(std::thread::hardware_concurrency());
+	Writer.Finish([&JobPool](std::shared_ptr<IJob> pJob) { JobPool.Add(std::move(pJob)); });
+	JobPool.Shutdown();
 
 	return 0;
 }
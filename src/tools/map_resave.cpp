@@ -2,14 +2,19 @@
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
 
 #include <base/logger.h>
+#include <base/math.h>
 #include <base/system.h>
 
 #include <engine/shared/datafile.h>
+#include <engine/shared/jobs.h>
 #include <engine/storage.h>
 
+#include <limits>
+#include <thread>
+
 static const char *TOOL_NAME = "map_resave";
 
-static int ResaveMap(const char *pSourceMap, const char *pDestinationMap, IStorage *pStorage)
+static int ResaveMap(const char *pSourceMap, const char *pDestinationMap, IStorage *pStorage, const std::function<void(std::shared_ptr<IJob>)> &AddJob)
 {
 	CDataFileReader Reader;
 	if(!Reader.Open(pStorage, pSourceMap, IStorage::TYPE_ABSOLUTE))
@@ -52,8 +57,40 @@ static int ResaveMap(const char *pSourceMap, const char *pDestinationMap, IStora
 	}
 
 	Reader.Close();
-	Writer.Finish();
-	log_info(TOOL_NAME, "Resaved '%s' to '%s'", pSourceMap, pDestinationMap);
+	Writer.Finish(AddJob);
+	return 0;
+}
+
+// resaves the map repeatedly with serial and parallel compression and checks that both produce the same file
+static int BenchmarkResave(const char *pSourceMap, const char *pDestinationMap, IStorage *pStorage, const std::function<void(std::shared_ptr<IJob>)> &AddJob, int Runs)
+{
+	SHA256_DIGEST aSha256[2];
+	for(int Parallel = 0; Parallel < 2; Parallel++)
+	{
+		int64_t Total = 0;
+		int64_t Best = std::numeric_limits<int64_t>::max();
+		for(int Run = 0; Run < Runs; Run++)
+		{
+			const int64_t Start = time_get();
+			if(ResaveMap(pSourceMap, pDestinationMap, pStorage, Parallel ? AddJob : nullptr) != 0)
+				return -1;
+			const int64_t Duration = time_get() - Start;
+			Total += Duration;
+			Best = minimum(Best, Duration);
+		}
+		if(!pStorage->CalculateHashes(pDestinationMap, IStorage::TYPE_SAVE, &aSha256[Parallel]))
+		{
+			log_error(TOOL_NAME, "Failed to hash destination map '%s'", pDestinationMap);
+			return -1;
+		}
+		log_info(TOOL_NAME, "%s compression: %d runs, best %.2fms, average %.2fms", Parallel ? "parallel" : "serial", Runs, Best * 1000.0 / time_freq(), Total * 1000.0 / time_freq() / Runs);
+	}
+
+	if(aSha256[0] != aSha256[1])
+	{
+		log_error(TOOL_NAME, "Serial and parallel compression produced different files");
+		return -1;
+	}
 	return 0;
 }
 
@@ -62,9 +99,9 @@ int main(int argc, const char **argv)
 	CCmdlineFix CmdlineFix(&argc, &argv);
 	log_set_global_logger_default();
 
-	if(argc != 3)
+	if(argc != 3 && argc != 4)
 	{
-		log_error(TOOL_NAME, "Usage: %s <source map> <destination map>", TOOL_NAME);
+		log_error(TOOL_NAME, "Usage: %s <source map> <destination map> [benchmark runs]", TOOL_NAME);
 		return -1;
 	}
 
@@ -75,5 +112,22 @@ int main(int argc, const char **argv)
 		return -1;
 	}
 
-	return ResaveMap(argv[1], argv[2], pStorage.get());
+	CJobPool JobPool;
+	JobPool.Init(std::thread::hardware_concurrency());
+	const auto AddJob = [&JobPool](std::shared_ptr<IJob> pJob) { JobPool.Add(std::move(pJob)); };
+
+	int Result;
+	if(argc == 4)
+	{
+		Result = BenchmarkResave(argv[1], argv[2], pStorage.get(), AddJob, maximum(str_toint(argv[3]), 1));
+	}
+	else
+	{
+		Result = ResaveMap(argv[1], argv[2], pStorage.get(), AddJob);
+		if(Result == 0)
+			log_info(TOOL_NAME, "Resaved '%s' to '%s'", argv[1], argv[2]);
+	}
+
+	JobPool.Shutdown();
+	return Result;
 }